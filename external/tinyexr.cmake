@@ -0,0 +1,7 @@
+set(tinyexr_TAG "v1.0.1")
+
+UpdateExternalLibTag("tinyexr" "https://github.com/syoyo/tinyexr.git" ${tinyexr_TAG})
+
+# Header-only; the implementation is compiled into jadehare with zlib.
+add_library(tinyexr INTERFACE)
+target_include_directories(tinyexr INTERFACE ${CMAKE_CURRENT_SOURCE_DIR}/tinyexr)
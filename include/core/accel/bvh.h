@@ -0,0 +1,201 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_ACCEL_BVH_H
+#define JADEHARE_CORE_ACCEL_BVH_H
+
+#include "jadehare.h"
+#include "core/math/animatedTransform.h"
+#include "core/math/bounds.h"
+#include "core/math/ray.h"
+#include "core/math/transform.h"
+#include "core/shape/triangle.h"
+#include "util/span.h"
+
+#include <optional>
+#include <vector>
+
+namespace jadehare {
+
+    // BVHPrimitive Definition
+    // A triangle, or an object instance if meshIndex is InstanceMesh, in
+    // which case triangleIndex holds the instance index.
+    struct BVHPrimitive {
+        static constexpr uint32_t InstanceMesh = ~uint32_t(0);
+
+        bool IsInstance() const { return meshIndex == InstanceMesh; }
+
+        uint32_t meshIndex;
+        uint32_t triangleIndex;
+    };
+
+    // ObjectInstance Definition
+    // Placement of a shared prototype BVH in the scene.
+    struct ObjectInstance {
+        // Where the instance is at the start of its motion, if it moves.
+        Transform renderFromInstance;
+        // Render-space bounds of the transformed prototype, over the whole
+        // motion for moving instances.
+        Bounds3f bounds;
+        uint32_t prototypeIndex;
+        // Index of the instance's motion in the scene's AnimatedTransforms,
+        // or -1 if it doesn't move.
+        int32_t motionIndex = -1;
+    };
+
+    // LinearBVHNode Definition
+    // Depth-first flattened node; the first child of an interior node
+    // immediately follows it. Plain data so that the node array can be
+    // used straight out of the scene cache.
+    struct alignas(32) LinearBVHNode {
+        Bounds3f bounds;
+        union {
+            int primitivesOffset;   // leaf
+            int secondChildOffset;  // interior
+        };
+        uint16_t nPrimitives;  // 0 -> interior node
+        uint8_t axis;          // interior node: xyz, or TemporalSplit
+
+        // Interior node of a motion BVH whose children cover the first and
+        // second part of its time range.
+        static constexpr uint8_t TemporalSplit = 3;
+    };
+
+    static_assert(sizeof(LinearBVHNode) == 32, "LinearBVHNode should fill half a cache line");
+
+    // LinearBVHNodeMotion Definition
+    // What a motion BVH stores for each node besides its LinearBVHNode,
+    // whose bounds are those at timeStart: the bounds at timeEnd. Bounds in
+    // between are interpolated, and times outside the range clamp to it.
+    struct alignas(32) LinearBVHNodeMotion {
+        Bounds3f boundsEnd;
+        float timeStart, timeEnd;
+    };
+
+    static_assert(sizeof(LinearBVHNodeMotion) == 32, "LinearBVHNodeMotion should fill half a cache line");
+
+    // ShapeIntersection Definition
+    // For hits inside an instance, meshIndex is relative to the instance's
+    // prototype and intr.t is also valid for the render-space ray.
+    struct ShapeIntersection {
+        uint32_t meshIndex;
+        uint32_t triangleIndex;
+        TriangleIntersection intr;
+        int instanceIndex = -1;
+    };
+
+    // ShadowRay Definition
+    // Occlusion query of a batch: whether anything lies along _ray_ before
+    // _tMax_, which by default covers a ray spawned towards a point at t = 1.
+    struct ShadowRay {
+        Ray ray;
+        float tMax = 1 - ShadowEpsilon;
+        bool occluded = false;
+    };
+
+    // BVHAggregate Definition
+    // Bounding volume hierarchy over the triangles of a set of meshes, built
+    // with the binned surface area heuristic. A top-level BVH may also hold
+    // object instances, each referring to one of the _prototypes_ BVHs; rays
+    // are transformed into instance space when they reach one.
+    //
+    // If any instance moves, the hierarchy is a motion BVH: every node also
+    // has bounds at the end of its time range, which are interpolated by
+    // ray time, rather than bounds over the whole motion. Where primitives
+    // move apart, up to _maxTemporalSplits_ levels of temporal splits divide
+    // the time range and the nodes below each part bound the primitives over
+    // that part only.
+    class BVHAggregate {
+    public:
+        // BVHAggregate Public Methods
+        BVHAggregate() = default;
+
+        // Builds the hierarchy; large subtrees are built in parallel.
+        BVHAggregate(span<const TriangleMesh> meshes, span<const ObjectInstance> instances = {},
+                     span<const BVHAggregate> prototypes = {}, span<const AnimatedTransform> instanceMotion = {},
+                     int maxPrimsInNode = 4, int maxTemporalSplits = 2);
+
+        // Uses an already built hierarchy, e.g. one mapped from the scene cache.
+        BVHAggregate(span<const TriangleMesh> meshes, span<const LinearBVHNode> nodes,
+                     span<const BVHPrimitive> primitives, span<const ObjectInstance> instances = {},
+                     span<const BVHAggregate> prototypes = {}, span<const AnimatedTransform> instanceMotion = {},
+                     span<const LinearBVHNodeMotion> motionNodes = {})
+                : meshes(meshes), instances(instances), prototypes(prototypes), instanceMotion(instanceMotion),
+                  nodes(nodes), primitives(primitives), motionNodes(motionNodes) {}
+
+        BVHAggregate(BVHAggregate &&) = default;
+
+        BVHAggregate &operator=(BVHAggregate &&) = default;
+
+        Bounds3f Bounds() const { return nodes.empty() ? Bounds3f() : nodes[0].bounds; }
+
+        std::optional<ShapeIntersection> Intersect(const Ray &ray, float tMax = Infinity) const;
+
+        // Whether anything intersects the ray before tMax. Stops at the
+        // first hit found, without ordering children or computing
+        // barycentrics.
+        bool IntersectP(const Ray &ray, float tMax = 1 - ShadowEpsilon) const;
+
+        // IntersectP() for each ray of the queue, setting its occluded flag.
+        void IntersectP(span<ShadowRay> queue) const;
+
+        span<const LinearBVHNode> Nodes() const { return nodes; }
+
+        span<const BVHPrimitive> Primitives() const { return primitives; }
+
+        // Empty unless this is a motion BVH.
+        span<const LinearBVHNodeMotion> MotionNodes() const { return motionNodes; }
+
+        // Updates the hierarchy after the bounds of the _changed_ instances
+        // have changed, without rebuilding it: the leaves holding them and
+        // their ancestors get new bounds, bottom-up. _instances_ replaces the
+        // instance array, which may have been copied to be modified. Tree
+        // quality degrades as instances move far from where they were built.
+        // Motion BVH nodes are rebounded over their own time ranges.
+        void Refit(span<const ObjectInstance> instances, span<const uint32_t> changed);
+
+    private:
+        // BVHAggregate Private Methods
+        // Intersect() without counting a ray; instances trace through
+        // their prototypes with it.
+        std::optional<ShapeIntersection> IntersectNodes(const Ray &ray, float tMax) const;
+
+        bool IntersectPNodes(const Ray &ray, float tMax, int64_t *nodesVisited, int64_t *triangleTests) const;
+
+        void BuildStatic(int maxPrimsInNode);
+
+        void BuildMotion(int maxPrimsInNode, int maxTemporalSplits);
+
+        // Bounds of the primitive over [t0, t1], at both ends.
+        void PrimitiveLinearBounds(const BVHPrimitive &prim, float t0, float t1, Bounds3f *b0, Bounds3f *b1) const;
+
+        // BVHAggregate Private Members
+        span<const TriangleMesh> meshes;
+        span<const ObjectInstance> instances;
+        span<const BVHAggregate> prototypes;
+        span<const AnimatedTransform> instanceMotion;
+        span<const LinearBVHNode> nodes;
+        span<const BVHPrimitive> primitives;
+        span<const LinearBVHNodeMotion> motionNodes;
+        std::vector<LinearBVHNode> nodeStorage;
+        std::vector<BVHPrimitive> primitiveStorage;
+        std::vector<LinearBVHNodeMotion> motionNodeStorage;
+        // Built by the first Refit(): the parent of every node, -1 for the
+        // root, and the leaves that hold each instance, which are
+        // instanceLeaves[instanceLeafStart[i]] up to the next instance's;
+        // temporal splits put an instance in more than one leaf.
+        std::vector<int> parentNodes;
+        std::vector<int> instanceLeafStart, instanceLeaves;
+    };
+
+    // BVH Inline Functions
+    // Transformation of an instance at the given time.
+    inline Transform InstanceTransform(const ObjectInstance &instance, span<const AnimatedTransform> instanceMotion,
+                                       float time) {
+        return instance.motionIndex < 0 ? instance.renderFromInstance
+                                        : instanceMotion[instance.motionIndex].Interpolate(time);
+    }
+}
+
+#endif //JADEHARE_CORE_ACCEL_BVH_H
@@ -0,0 +1,88 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_CAMERA_CAMERA_H
+#define JADEHARE_CORE_CAMERA_CAMERA_H
+
+#include "jadehare.h"
+#include "core/math/bounds.h"
+#include "core/math/point.h"
+#include "core/math/ray.h"
+#include "core/math/transform.h"
+#include "core/math/vector.h"
+#include "core/volumeScattering/medium.h"
+
+namespace jadehare {
+
+    // PerspectiveCamera Definition
+    // Pinhole camera looking down +z of camera space, as in pbrt: _fov_
+    // spans the shorter image axis, and raster y grows downwards. The
+    // shutter is open over [shutterOpen, shutterClose].
+    class PerspectiveCamera {
+    public:
+        // PerspectiveCamera Public Methods
+        PerspectiveCamera(const Transform &worldFromCamera, float fov, Point2i resolution, MediumHandle medium,
+                          float shutterOpen = 0, float shutterClose = 1)
+                : worldFromCamera(worldFromCamera), resolution(resolution), medium(medium),
+                  shutterOpen(shutterOpen), shutterClose(shutterClose) {
+            float aspect = float(resolution.x) / float(resolution.y);
+            float tanHalfFov = std::tan(fov * Pi / 360);
+            screenExtent = aspect > 1 ? Vector2f(aspect * tanHalfFov, tanHalfFov)
+                                      : Vector2f(tanHalfFov, tanHalfFov / aspect);
+            pCamera = worldFromCamera(Point3f(0, 0, 0));
+            zAxis = worldFromCamera(Vector3f(0, 0, 1));
+            dxPixel = worldFromCamera(Vector3f(2 * screenExtent.x / resolution.x, 0, 0));
+            dyPixel = worldFromCamera(Vector3f(0, -2 * screenExtent.y / resolution.y, 0));
+        }
+
+        Point2i Resolution() const { return resolution; }
+
+        // Ray time for the uniform sample u.
+        float SampleTime(float u) const { return Lerp(u, shutterOpen, shutterClose); }
+
+        // Ray through the continuous raster position pRaster, in [0, resolution).
+        Ray GenerateRay(const Point2f &pRaster, float time = 0) const {
+            float sx = (2 * pRaster.x / resolution.x - 1) * screenExtent.x;
+            float sy = (1 - 2 * pRaster.y / resolution.y) * screenExtent.y;
+            Vector3f d = Normalize(Vector3f(sx, sy, 1));
+            return worldFromCamera(Ray(Point3f(0, 0, 0), d, time, medium));
+        }
+
+        // Approximates the change in position on the plane through _p_ with
+        // normal _n_ from one pixel to the next, as if _p_ were seen
+        // directly by the camera; used for texture filtering at every path
+        // vertex, as in pbrt-v4. More pixel samples shrink the footprint.
+        void Approximate_dp_dxy(const Point3f &p, const Normal3f &n, int samplesPerPixel, Vector3f *dpdx,
+                                Vector3f *dpdy) const {
+            // Direction to p through the z = 1 plane, offset by a pixel
+            Vector3f v = p - pCamera;
+            Vector3f nv(n);
+            float z = Dot(v, zAxis);
+            float sppScale = std::max<float>(.125f, 1 / std::sqrt(float(samplesPerPixel)));
+            auto offset = [&](const Vector3f &dPixel) {
+                Vector3f d = v / z + dPixel;
+                float t = Dot(nv, v) / Dot(nv, d);
+                Vector3f dp = sppScale * (t * d - v);
+                return z > 0 && IsFinite(t) ? dp : Vector3f(0, 0, 0);
+            };
+            *dpdx = offset(dxPixel);
+            *dpdy = offset(dyPixel);
+        }
+
+    private:
+        // PerspectiveCamera Private Members
+        Transform worldFromCamera;
+        Point2i resolution;
+        // Half extents of the image on the z = 1 plane
+        Vector2f screenExtent;
+        MediumHandle medium;
+        float shutterOpen, shutterClose;
+        // Camera position and axis, and how far the z = 1 plane point of a
+        // ray moves from one pixel to the next, in world space
+        Point3f pCamera;
+        Vector3f zAxis, dxPixel, dyPixel;
+    };
+}
+
+#endif //JADEHARE_CORE_CAMERA_CAMERA_H
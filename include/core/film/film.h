@@ -0,0 +1,65 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_FILM_FILM_H
+#define JADEHARE_CORE_FILM_FILM_H
+
+#include "jadehare.h"
+#include "core/math/bounds.h"
+#include "core/math/point.h"
+#include "core/spectrum/color.h"
+#include "core/texture/image.h"
+#include "util/check.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace jadehare {
+
+    // RGBFilm Definition
+    // Accumulates box-filtered RGB samples per pixel. Every pixel belongs
+    // to a single tile, so tiles rendered in parallel never write to the
+    // same pixel and AddSample() needs no synchronization.
+    class RGBFilm {
+    public:
+        // RGBFilm Public Methods
+        explicit RGBFilm(Point2i resolution)
+                : resolution(resolution), pixels(size_t(resolution.x) * resolution.y) {}
+
+        Point2i Resolution() const { return resolution; }
+
+        Bounds2i PixelBounds() const { return Bounds2i(Point2i(0, 0), resolution); }
+
+        void AddSample(Point2i p, const RGB &L, float weight = 1) {
+            DCHECK(Inside(p, PixelBounds()));
+            Pixel &pixel = pixels[size_t(p.y) * resolution.x + p.x];
+            pixel.rgbSum += L * weight;
+            pixel.weightSum += weight;
+        }
+
+        RGB GetPixelRGB(Point2i p) const {
+            const Pixel &pixel = pixels[size_t(p.y) * resolution.x + p.x];
+            return pixel.weightSum == 0 ? RGB(0, 0, 0) : pixel.rgbSum / pixel.weightSum;
+        }
+
+        void Clear() { std::fill(pixels.begin(), pixels.end(), Pixel()); }
+
+        Image GetImage() const;
+
+        // Throws std::runtime_error if the file can't be written.
+        void WriteImage(const std::string &filename) const { GetImage().Write(filename); }
+
+    private:
+        // RGBFilm Private Members
+        struct Pixel {
+            RGB rgbSum = RGB(0, 0, 0);
+            float weightSum = 0;
+        };
+        Point2i resolution;
+        std::vector<Pixel> pixels;
+    };
+}
+
+#endif //JADEHARE_CORE_FILM_FILM_H
@@ -0,0 +1,35 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_FILM_TILEORDER_H
+#define JADEHARE_CORE_FILM_TILEORDER_H
+
+#include "jadehare.h"
+#include "core/math/bounds.h"
+
+#include <string>
+#include <vector>
+
+namespace jadehare {
+
+    // TileOrder Definition
+    // Order in which the tiles of an image are handed out for rendering.
+    // Threads take consecutive runs of tiles, so with the space-filling
+    // curves the tiles in flight at any time lie close together and share
+    // BVH nodes and texture tiles in the cache. Spiral starts at the image
+    // center and works outwards, which shows the usual subject first.
+    enum class TileOrder {
+        RowMajor, Morton, Hilbert, Spiral
+    };
+
+    // Parses "rowmajor", "morton", "hilbert" or "spiral"; throws
+    // std::runtime_error otherwise.
+    TileOrder ParseTileOrder(const std::string &name);
+
+    // Splits _bounds_ into tiles of tileSize pixels, cut off at its upper
+    // edges, and returns them in the given order.
+    std::vector<Bounds2i> OrderedTiles(const Bounds2i &bounds, int tileSize, TileOrder order);
+}
+
+#endif //JADEHARE_CORE_FILM_TILEORDER_H
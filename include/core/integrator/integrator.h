@@ -0,0 +1,139 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_INTEGRATOR_INTEGRATOR_H
+#define JADEHARE_CORE_INTEGRATOR_INTEGRATOR_H
+
+#include "jadehare.h"
+#include "core/accel/bvh.h"
+#include "core/camera/camera.h"
+#include "core/film/film.h"
+#include "core/film/tileOrder.h"
+#include "core/light/lightSampler.h"
+#include "core/math/point.h"
+#include "core/math/ray.h"
+#include "core/sampling/sampler.h"
+#include "core/scene/scene.h"
+#include "core/spectrum/color.h"
+#include "util/memory.h"
+#include "util/rng.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace jadehare {
+
+    // RenderStats Definition
+    // What a call to PathIntegrator::Render() did and how long it took.
+    // Camera rays are the first ray of every sample; all others, including
+    // shadow rays and rays continuing through interface surfaces, are
+    // secondary.
+    struct RenderStats {
+        int64_t cameraRays = 0, secondaryRays = 0;
+        double seconds = 0;
+        // Until the first tile was done, i.e. the first pixels were final.
+        double firstTileSeconds = 0;
+    };
+
+    // PathIntegrator Definition
+    // Unidirectional path tracer with next event estimation through the
+    // scene's light sampler and multiple importance sampling of area and
+    // environment lights. Participating media are handled with delta
+    // tracking along the path and ratio tracking for shadow rays. Surfaces
+    // scatter with the BxDF of their MaterialHandle; interfaces, which only
+    // bound media, have none.
+    class PathIntegrator {
+    public:
+        // PathIntegrator Public Methods
+        PathIntegrator(const Scene &scene, int maxDepth);
+
+        // Renders spp samples per pixel of _camera_ into _film_, in tiles
+        // that are distributed over the threads in the tile order. The
+        // ZSobol sampler rounds spp up to a power of two.
+        RenderStats Render(const PerspectiveCamera &camera, int spp, RGBFilm &film) const;
+
+        // Radiance arriving along _ray_ from _camera_; adds the number of
+        // rays traced to *nRays. The path's BxDFs are allocated from
+        // _scratchBuffer_, which the caller resets once the sample is done.
+        template<typename Sampler>
+        RGB Li(Ray ray, const PerspectiveCamera &camera, Sampler &sampler, ScratchBuffer &scratchBuffer, RNG &rng,
+               int64_t *nRays) const;
+
+        int MaxDepth() const { return maxDepth; }
+
+        // Nothing built for the scene depends on the depth, so a resident
+        // integrator can serve renders with different depths.
+        void SetMaxDepth(int depth) { maxDepth = depth; }
+
+        TileOrder GetTileOrder() const { return tileOrder; }
+
+        void SetTileOrder(TileOrder order) { tileOrder = order; }
+
+        // The scene's Sampler directive chooses it unless set here.
+        SamplerType GetSamplerType() const { return samplerType; }
+
+        void SetSamplerType(SamplerType type) { samplerType = type; }
+
+        static constexpr int TileSize = 16;
+
+    private:
+        // PathIntegrator Private Methods
+        // Renders with copies of _prototype_, one per tile.
+        template<typename Sampler>
+        RenderStats RenderTiles(const PerspectiveCamera &camera, RGBFilm &film, const Sampler &prototype) const;
+
+        // Render-space position, with its error bounds, unit face normal
+        // and texture coordinates of an intersection; moving instances are
+        // placed where they are at _time_.
+        struct SurfaceHit {
+            Point3fi pi;
+            Normal3f n;
+            Point2f uv;
+            Vector3f dpdu, dpdv;
+            const TriangleMesh *mesh;
+        };
+
+        SurfaceHit GetSurfaceHit(const ShapeIntersection &si, float time) const;
+
+        MaterialHandle GetMaterial(const TriangleMesh &mesh) const { return scene.GetMaterial(mesh.materialIndex); }
+
+        // Where the hit's material is evaluated from direction wo; textures
+        // are filtered over the footprint of a pixel of _camera_.
+        MaterialEvalContext GetMaterialEvalContext(const SurfaceHit &hit, const Vector3f &wo,
+                                                   const PerspectiveCamera &camera, int samplesPerPixel) const;
+
+        // Medium on the side of the surface that w points to; surfaces that
+        // don't separate two media keep the current one.
+        MediumHandle NextMedium(const SurfaceHit &hit, const Vector3f &w, MediumHandle current) const {
+            MediumInterface mi = scene.GetMediumInterface(*hit.mesh);
+            if (!mi.IsMediumTransition())
+                return current;
+            return Dot(w, hit.n) > 0 ? mi.outside : mi.inside;
+        }
+
+        // Transmittance between a point and pTo at the given time, passing
+        // through interface surfaces; n is zero for points in media. Plain
+        // occlusion tests use the BVH's any-hit traversal.
+        RGB Transmittance(const Point3fi &pFrom, const Normal3f &n, const Point3f &pTo, float time,
+                          MediumHandle medium, RNG &rng, int64_t *nRays) const;
+
+        // MIS-weighted light sampled by the light sampler; f(wi) returns the
+        // scattering function times the cosine, if any, and pdf(wi) its
+        // sampling density.
+        template<typename F, typename PDF, typename Sampler>
+        RGB SampleLd(const LightSampleContext &ctx, const Point3fi &pi, float time, MediumHandle medium, F &&f,
+                     PDF &&pdf, Sampler &sampler, RNG &rng, int64_t *nRays) const;
+
+        // PathIntegrator Private Members
+        const Scene &scene;
+        int maxDepth;
+        BVHLightSampler lightSampler;
+        std::vector<int> infiniteLights;
+        bool hasInterfaces = false;
+        TileOrder tileOrder = TileOrder::Hilbert;
+        SamplerType samplerType;
+    };
+}
+
+#endif //JADEHARE_CORE_INTEGRATOR_INTEGRATOR_H
@@ -0,0 +1,115 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_INTEGRATOR_RENDERSERVER_H
+#define JADEHARE_CORE_INTEGRATOR_RENDERSERVER_H
+
+#include "jadehare.h"
+#include "core/integrator/integrator.h"
+#include "core/math/transform.h"
+#include "core/scene/scene.h"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace jadehare {
+
+    // RenderRequest Definition
+    // One line of the server protocol: a command followed by key=value
+    // pairs, with values that contain spaces in double quotes, e.g.
+    //   render scene=a.pbrt outfile=a.exr spp=64 lookat="0 1 5 0 1 0 0 1 0"
+    // Unset overrides keep what the scene file specifies; lookat replaces
+    // the scene's LookAt but keeps the transformations around it. Update
+    // requests move object instances of a resident scene, e.g.
+    //   update scene=a.pbrt instance=3 transform="1 0 0 0 0 1 0 0 0 0 1 0 2 0 0 1"
+    // with the matrix given as in a Transform directive.
+    struct RenderRequest {
+        enum class Command { Render, Update, Evict, Status, Shutdown };
+
+        // Throws std::runtime_error if the line is malformed.
+        static RenderRequest Parse(const std::string &line);
+
+        Command command = Command::Render;
+        // Files of the scene, in parser order; they are also its cache key.
+        std::vector<std::string> sceneFiles;
+        std::string outFilename;
+        std::optional<int> spp, maxDepth, xResolution, yResolution;
+        std::optional<float> fov;
+        // Camera position, look-at point and up vector.
+        std::optional<std::array<float, 9>> lookAt;
+        // Instances to move and their new transformations, pairwise.
+        std::vector<int> instances;
+        std::vector<Transform> transforms;
+    };
+
+    // RenderServer Definition
+    // Renders requests arriving on a Unix domain socket, one at a time, and
+    // keeps the most recently used scenes resident between them: their
+    // meshes, BVH, light BVH and the images of lights and media are built
+    // once, and later requests for the same files only pay for rendering.
+    // A scene is rebuilt when any file it was built from has changed.
+    // Each request line is answered with one line, "ok key=value..." or
+    // "error <message>".
+    class RenderServer {
+    public:
+        // RenderServer Public Methods
+        // Keeps up to _maxScenes_ scenes resident, evicting the least
+        // recently used one beyond that.
+        RenderServer(const std::string &socketPath, int maxScenes, bool quiet);
+
+        ~RenderServer();
+
+        // Binds the socket and serves connections until a shutdown request
+        // arrives. Throws std::runtime_error if the socket can't be set up.
+        void Run();
+
+        // Carries out one request line and returns its reply, without the
+        // newline. Sets *shutdown on a shutdown request.
+        std::string Handle(const std::string &line, bool *shutdown);
+
+        RenderServer(const RenderServer &) = delete;
+
+        RenderServer &operator=(const RenderServer &) = delete;
+
+    private:
+        // RenderServer Private Methods
+        // ResidentScene Definition
+        struct ResidentScene {
+            std::vector<std::string> sceneFiles;
+            std::unique_ptr<Scene> scene;
+            std::unique_ptr<PathIntegrator> integrator;
+            // Modification times of everything the scene was built from.
+            std::vector<std::pair<std::string, std::filesystem::file_time_type>> inputTimes;
+        };
+
+        // Returns the resident scene for the files, building it if it isn't
+        // resident or is out of date; *built reports which happened.
+        ResidentScene &GetScene(const std::vector<std::string> &sceneFiles, bool *built);
+
+        std::string Render(const RenderRequest &request);
+
+        std::string Update(const RenderRequest &request);
+
+        // Serves one connection until the client closes it or asks for a
+        // shutdown.
+        void Serve(int fd, bool *shutdown);
+
+        // RenderServer Private Members
+        std::string socketPath;
+        int maxScenes;
+        bool quiet;
+        int listenFd = -1;
+        // Most recently used first.
+        std::list<ResidentScene> scenes;
+    };
+}
+
+#endif //JADEHARE_CORE_INTEGRATOR_RENDERSERVER_H
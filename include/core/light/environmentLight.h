@@ -0,0 +1,76 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_LIGHT_ENVIRONMENTLIGHT_H
+#define JADEHARE_CORE_LIGHT_ENVIRONMENTLIGHT_H
+
+#include "jadehare.h"
+#include "core/light/light.h"
+#include "core/math/bounds.h"
+#include "core/math/point.h"
+#include "core/math/vector.h"
+#include "core/sampling/distributions.h"
+#include "core/spectrum/color.h"
+#include "core/texture/image.h"
+#include "util/span.h"
+
+#include <optional>
+#include <vector>
+
+namespace jadehare {
+
+    // EnvironmentLight Definition
+    // Infinitely far light around the scene, given by an equirectangular
+    // (latitude-longitude) image whose pole points along w. Directions are
+    // importance sampled in proportion to the image's luminance times the
+    // sine of the latitude: SampleLi() inverts a PiecewiseConstant2D,
+    // which keeps low-discrepancy samples well distributed, and the batched
+    // form uses alias tables instead for constant-time sampling. Both
+    // sample the same density, returned by PDF_Li().
+    class EnvironmentLight {
+    public:
+        // EnvironmentLight Public Methods
+        // sceneBounds places the end points of shadow rays.
+        EnvironmentLight(Image image, const Vector3f &w, float scale, const Bounds3f &sceneBounds);
+
+        bool IsDelta() const { return false; }
+
+        // Radiance arriving along a ray leaving the scene in direction w.
+        RGB Le(const Vector3f &w) const { return LookupLight(LightFromRender(Normalize(w))); }
+
+        std::optional<LightLiSample> SampleLi(const LightSampleContext &ctx, const Point2f &u) const;
+
+        // Samples every u[i] for ctx[i]; failed samples get a pdf of zero.
+        void SampleLi(span<const LightSampleContext> ctx, span<const Point2f> u,
+                      span<LightLiSample> samples) const;
+
+        float PDF_Li(const LightSampleContext &ctx, const Vector3f &wi) const;
+
+        Point2i Resolution() const { return image.Resolution(); }
+
+    private:
+        // EnvironmentLight Private Methods
+        Vector3f LightFromRender(const Vector3f &w) const { return Vector3f(Dot(w, x), Dot(w, y), Dot(w, z)); }
+
+        Vector3f RenderFromLight(const Vector3f &w) const { return w.x * x + w.y * y + w.z * z; }
+
+        RGB LookupLight(const Vector3f &wLight) const;
+
+        // Turns a point of the image's [0,1]^2 domain and its density there
+        // into a sample.
+        std::optional<LightLiSample> MakeSample(const LightSampleContext &ctx, const Point2f &uv,
+                                                float mapPDF) const;
+
+        // EnvironmentLight Private Members
+        Image image;
+        Vector3f x, y, z;
+        float scale;
+        float sceneRadius;
+        PiecewiseConstant2D distribution;
+        AliasTable marginalAlias;
+        std::vector<AliasTable> conditionalAlias;
+    };
+}
+
+#endif //JADEHARE_CORE_LIGHT_ENVIRONMENTLIGHT_H
@@ -0,0 +1,57 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_LIGHT_LIGHT_H
+#define JADEHARE_CORE_LIGHT_LIGHT_H
+
+#include "jadehare.h"
+#include "core/math/normal.h"
+#include "core/math/point.h"
+#include "core/math/vector.h"
+#include "core/spectrum/color.h"
+#include "util/taggedPointer.h"
+
+#include <optional>
+
+namespace jadehare {
+
+    // LightSampleContext Definition
+    // Point being shaded; n is zero for points in participating media.
+    struct LightSampleContext {
+        Point3f p;
+        Normal3f n = Normal3f(0, 0, 0);
+    };
+
+    // LightLiSample Definition
+    // Radiance L arriving at the shading point from direction wi, with
+    // solid angle density pdf, or one for lights described by a delta
+    // distribution. Shadow rays go to pLight, which is far beyond the
+    // scene for infinite lights.
+    struct LightLiSample {
+        RGB L;
+        Vector3f wi;
+        float pdf = 0;
+        Point3f pLight;
+    };
+
+    // LightHandle Definition
+    // Any of the renderer's lights. The lights are defined in lights.h,
+    // along with these methods, which dispatch on the light's type.
+    class LightHandle
+            : public TaggedPointer<PointLight, SpotLight, DistantLight, DiffuseAreaLight, EnvironmentLight> {
+    public:
+        // LightHandle Interface
+        using TaggedPointer::TaggedPointer;
+
+        // Point, spot and distant lights can only be sampled, never hit.
+        bool IsDelta() const;
+
+        std::optional<LightLiSample> SampleLi(const LightSampleContext &ctx, const Point2f &u) const;
+
+        // Density of SampleLi() choosing wi, or zero for delta lights.
+        float PDF_Li(const LightSampleContext &ctx, const Vector3f &wi) const;
+    };
+}
+
+#endif //JADEHARE_CORE_LIGHT_LIGHT_H
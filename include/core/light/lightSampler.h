@@ -0,0 +1,250 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_LIGHT_LIGHTSAMPLER_H
+#define JADEHARE_CORE_LIGHT_LIGHTSAMPLER_H
+
+#include "jadehare.h"
+#include "core/light/light.h"
+#include "core/math/bounds.h"
+#include "core/math/directionCone.h"
+#include "core/math/mathematics.h"
+#include "core/math/normal.h"
+#include "core/math/octahedralVector.h"
+#include "core/math/point.h"
+#include "core/math/vector.h"
+
+#include <optional>
+#include <vector>
+
+namespace jadehare {
+
+    // SampledLight Definition
+    struct SampledLight {
+        int lightIndex;
+        float p;
+    };
+
+#pragma region Light Bounds
+
+    // Conservative estimate of the light a region can contribute at p with
+    // surface normal n (Conty Estevez and Kulla 2018, as in pbrt-v4): power
+    // over squared distance, scaled by how far the emission and normal cones
+    // are from facing each other.
+    inline float LightImportance(const Point3f &p, const Normal3f &n, const Bounds3f &bounds, const Vector3f &w,
+                                 float phi, float cosTheta_o, float cosTheta_e, bool twoSided) {
+        // Clamp the distance so points inside the bounds don't blow up
+        Point3f pc = (bounds.pMin + bounds.pMax) / 2;
+        float d2 = LengthSquared(p - pc);
+        d2 = std::max(d2, Length(bounds.Diagonal()) / 2);
+
+        // cos(a - b), clamped to 1 when a < b, and the matching sine
+        auto cosSubClamped = [](float sinTheta_a, float cosTheta_a, float sinTheta_b, float cosTheta_b) -> float {
+            if (cosTheta_a > cosTheta_b)
+                return 1;
+            return cosTheta_a * cosTheta_b + sinTheta_a * sinTheta_b;
+        };
+        auto sinSubClamped = [](float sinTheta_a, float cosTheta_a, float sinTheta_b, float cosTheta_b) -> float {
+            if (cosTheta_a > cosTheta_b)
+                return 0;
+            return sinTheta_a * cosTheta_b - cosTheta_a * sinTheta_b;
+        };
+
+        // Angle between the emission axis and the direction to p
+        Vector3f wi = LengthSquared(p - pc) > 0 ? Normalize(p - pc) : w;
+        float cosTheta_w = Dot(w, wi);
+        if (twoSided)
+            cosTheta_w = std::abs(cosTheta_w);
+        float sinTheta_w = SafeSqrt(1 - Sqr(cosTheta_w));
+
+        // Widen it by the emission cone and the angle the bounds subtend
+        float cosTheta_b = BoundSubtendedDirections(bounds, p).cosTheta;
+        float sinTheta_b = SafeSqrt(1 - Sqr(cosTheta_b));
+        float sinTheta_o = SafeSqrt(1 - Sqr(cosTheta_o));
+        float cosTheta_x = cosSubClamped(sinTheta_w, cosTheta_w, sinTheta_o, cosTheta_o);
+        float sinTheta_x = sinSubClamped(sinTheta_w, cosTheta_w, sinTheta_o, cosTheta_o);
+        float cosThetap = cosSubClamped(sinTheta_x, cosTheta_x, sinTheta_b, cosTheta_b);
+        // Points inside the emission cone always count, even with no falloff
+        if (cosThetap < 1 && cosThetap <= cosTheta_e)
+            return 0;
+        float importance = phi * cosThetap / d2;
+
+        // Account for the incident angle at surface points
+        if (n != Normal3f(0, 0, 0)) {
+            float cosTheta_i = AbsDot(wi, n);
+            float sinTheta_i = SafeSqrt(1 - Sqr(cosTheta_i));
+            importance *= cosSubClamped(sinTheta_i, cosTheta_i, sinTheta_b, cosTheta_b);
+        }
+        return std::max<float>(importance, 0);
+    }
+
+    // LightBounds Definition
+    // Spatial bounds, emitted power phi and emission cone of one or more
+    // lights: emission is centered around w, spreads over angle theta_o and
+    // falls off to zero within theta_e beyond it.
+    class LightBounds {
+    public:
+        // LightBounds Public Methods
+        LightBounds() = default;
+
+        LightBounds(const Bounds3f &b, const Vector3f &w, float phi, float cosTheta_o, float cosTheta_e,
+                    bool twoSided)
+                : bounds(b), w(Normalize(w)), phi(phi), cosTheta_o(cosTheta_o), cosTheta_e(cosTheta_e),
+                  twoSided(twoSided) {}
+
+        Point3f Centroid() const { return (bounds.pMin + bounds.pMax) / 2; }
+
+        float Importance(const Point3f &p, const Normal3f &n) const {
+            return LightImportance(p, n, bounds, w, phi, cosTheta_o, cosTheta_e, twoSided);
+        }
+
+        // LightBounds Public Members
+        Bounds3f bounds;
+        Vector3f w = Vector3f(0, 0, 1);
+        float phi = 0;
+        float cosTheta_o = 1, cosTheta_e = 1;
+        bool twoSided = false;
+    };
+
+    // LightBounds Inline Functions
+    inline LightBounds Union(const LightBounds &a, const LightBounds &b) {
+        // Lights without power don't widen the bounds
+        if (a.phi == 0)
+            return b;
+        if (b.phi == 0)
+            return a;
+
+        DirectionCone cone = Union(DirectionCone(a.w, a.cosTheta_o), DirectionCone(b.w, b.cosTheta_o));
+        return LightBounds(Union(a.bounds, b.bounds), cone.w, a.phi + b.phi, cone.cosTheta,
+                           std::min(a.cosTheta_e, b.cosTheta_e), a.twoSided || b.twoSided);
+    }
+
+    // CompactLightBounds Definition
+    // LightBounds in 24 bytes: the direction is octahedral-encoded, the
+    // cosines are quantized downward and the bounds outward relative to the
+    // bounds of all lights, so the importance stays conservative.
+    class CompactLightBounds {
+    public:
+        // CompactLightBounds Public Methods
+        CompactLightBounds() = default;
+
+        CompactLightBounds(const LightBounds &lb, const Bounds3f &allb)
+                : w(lb.w), phi(lb.phi), qCosTheta_o(QuantizeCos(lb.cosTheta_o)),
+                  qCosTheta_e(QuantizeCos(lb.cosTheta_e)), twoSided(lb.twoSided) {
+            for (int c = 0; c < 3; ++c) {
+                qb[0][c] = uint16_t(std::floor(QuantizeBounds(lb.bounds.pMin[c], allb.pMin[c], allb.pMax[c])));
+                qb[1][c] = uint16_t(std::ceil(QuantizeBounds(lb.bounds.pMax[c], allb.pMin[c], allb.pMax[c])));
+            }
+        }
+
+        float CosTheta_o() const { return 2 * (qCosTheta_o / 32767.f) - 1; }
+
+        float CosTheta_e() const { return 2 * (qCosTheta_e / 32767.f) - 1; }
+
+        bool TwoSided() const { return twoSided; }
+
+        float Phi() const { return phi; }
+
+        Bounds3f Bounds(const Bounds3f &allb) const {
+            return {Point3f(Lerp(qb[0][0] / 65535.f, allb.pMin.x, allb.pMax.x),
+                            Lerp(qb[0][1] / 65535.f, allb.pMin.y, allb.pMax.y),
+                            Lerp(qb[0][2] / 65535.f, allb.pMin.z, allb.pMax.z)),
+                    Point3f(Lerp(qb[1][0] / 65535.f, allb.pMin.x, allb.pMax.x),
+                            Lerp(qb[1][1] / 65535.f, allb.pMin.y, allb.pMax.y),
+                            Lerp(qb[1][2] / 65535.f, allb.pMin.z, allb.pMax.z))};
+        }
+
+        float Importance(const Point3f &p, const Normal3f &n, const Bounds3f &allb) const {
+            return LightImportance(p, n, Bounds(allb), Vector3f(w), phi, CosTheta_o(), CosTheta_e(), twoSided);
+        }
+
+    private:
+        // CompactLightBounds Private Methods
+        static unsigned int QuantizeCos(float c) { return (unsigned int) std::floor(32767.f * ((c + 1) / 2)); }
+
+        static float QuantizeBounds(float c, float min, float max) {
+            if (min == max)
+                return 0;
+            return 65535.f * Clamp((c - min) / (max - min), 0, 1);
+        }
+
+        // CompactLightBounds Private Members
+        OctahedralVector w;
+        float phi = 0;
+        struct {
+            unsigned int qCosTheta_o: 15;
+            unsigned int qCosTheta_e: 15;
+            unsigned int twoSided: 1;
+        };
+        uint16_t qb[2][3];
+    };
+
+#pragma endregion Light Bounds
+
+    // LightBVHNode Definition
+    // Depth-first flattened node; the first child of an interior node
+    // immediately follows it, like LinearBVHNode.
+    struct alignas(32) LightBVHNode {
+        static LightBVHNode MakeLeaf(unsigned int lightIndex, const CompactLightBounds &cb) {
+            return LightBVHNode{cb, {lightIndex, 1}};
+        }
+
+        static LightBVHNode MakeInterior(unsigned int child1Index, const CompactLightBounds &cb) {
+            return LightBVHNode{cb, {child1Index, 0}};
+        }
+
+        CompactLightBounds lightBounds;
+        struct {
+            unsigned int childOrLightIndex: 31;
+            unsigned int isLeaf: 1;
+        };
+    };
+
+    static_assert(sizeof(LightBVHNode) == 32, "LightBVHNode should fill half a cache line");
+
+    // BVHLightSampler Definition
+    // Chooses a light for a shading point by walking a BVH over the lights'
+    // LightBounds, picking each child in proportion to its importance, so
+    // the cost is logarithmic in the number of lights and nearby, facing
+    // lights are preferred. Each triangle of an area light is a separate
+    // light. Distant and infinite lights can't be bounded and are chosen
+    // uniformly with probability nInfinite / (nInfinite + 1); lights that
+    // emit nothing are never sampled.
+    class BVHLightSampler {
+    public:
+        // BVHLightSampler Public Methods
+        explicit BVHLightSampler(const Scene &scene);
+
+        std::optional<SampledLight> Sample(const LightSampleContext &ctx, float u) const;
+
+        // Probability that Sample() returns lightIndex for ctx.
+        float PMF(const LightSampleContext &ctx, int lightIndex) const;
+
+        const std::vector<LightBVHNode> &Nodes() const { return nodes; }
+
+    private:
+        // BVHLightSampler Private Methods
+        std::pair<int, LightBounds> BuildBVH(std::vector<std::pair<int, LightBounds>> &bvhLights, size_t start,
+                                             size_t end, uint64_t bitTrail, int depth);
+
+        float EvaluateCost(const LightBounds &b, const Bounds3f &bounds, int dim) const;
+
+        float InfiniteProbability() const {
+            return float(infiniteLights.size()) / float(infiniteLights.size() + (nodes.empty() ? 0 : 1));
+        }
+
+        // Bit trails are the branches from the root to each light's leaf,
+        // least significant first.
+        static constexpr uint64_t NotSampled = ~uint64_t(0);
+        static constexpr uint64_t InfiniteLight = ~uint64_t(0) - 1;
+
+        // BVHLightSampler Private Members
+        std::vector<int> infiniteLights;
+        std::vector<LightBVHNode> nodes;
+        Bounds3f allLightBounds;
+        std::vector<uint64_t> lightToBitTrail;
+    };
+}
+
+#endif //JADEHARE_CORE_LIGHT_LIGHTSAMPLER_H
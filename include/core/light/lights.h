@@ -0,0 +1,161 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_LIGHT_LIGHTS_H
+#define JADEHARE_CORE_LIGHT_LIGHTS_H
+
+#include "jadehare.h"
+#include "core/light/environmentLight.h"
+#include "core/light/light.h"
+#include "core/math/bounds.h"
+#include "core/math/mathematics.h"
+#include "core/shape/triangle.h"
+#include "core/spectrum/color.h"
+
+#include <optional>
+
+namespace jadehare {
+
+    // PointLight Definition
+    // Emits intensity I equally in all directions from p.
+    class PointLight {
+    public:
+        // PointLight Public Methods
+        PointLight(const Point3f &p, const RGB &I, float scale) : p(p), I(I * scale) {}
+
+        bool IsDelta() const { return true; }
+
+        std::optional<LightLiSample> SampleLi(const LightSampleContext &ctx, const Point2f &u) const {
+            Vector3f d = p - ctx.p;
+            float d2 = LengthSquared(d);
+            if (d2 == 0)
+                return {};
+            return LightLiSample{I / d2, Normalize(d), 1, p};
+        }
+
+        float PDF_Li(const LightSampleContext &ctx, const Vector3f &wi) const { return 0; }
+
+    private:
+        // PointLight Private Members
+        Point3f p;
+        RGB I;
+    };
+
+    // SpotLight Definition
+    // Point light restricted to a cone around w, falling off smoothly from
+    // full intensity inside cosFalloffStart to zero outside cosFalloffEnd.
+    class SpotLight {
+    public:
+        // SpotLight Public Methods
+        SpotLight(const Point3f &p, const Vector3f &w, const RGB &I, float scale, float cosFalloffStart,
+                  float cosFalloffEnd)
+                : p(p), w(Normalize(w)), I(I * scale), cosFalloffStart(cosFalloffStart),
+                  cosFalloffEnd(cosFalloffEnd) {}
+
+        bool IsDelta() const { return true; }
+
+        std::optional<LightLiSample> SampleLi(const LightSampleContext &ctx, const Point2f &u) const {
+            Vector3f d = p - ctx.p;
+            float d2 = LengthSquared(d);
+            if (d2 == 0)
+                return {};
+            Vector3f wi = Normalize(d);
+            float falloff = SmoothStep(Dot(-wi, w), cosFalloffEnd, cosFalloffStart);
+            if (falloff == 0)
+                return {};
+            return LightLiSample{I * (falloff / d2), wi, 1, p};
+        }
+
+        float PDF_Li(const LightSampleContext &ctx, const Vector3f &wi) const { return 0; }
+
+    private:
+        // SpotLight Private Methods
+        static float SmoothStep(float x, float a, float b) {
+            if (a == b)
+                return x < a ? 0 : 1;
+            float t = Clamp((x - a) / (b - a), 0, 1);
+            return t * t * (3 - 2 * t);
+        }
+
+        // SpotLight Private Members
+        Point3f p;
+        Vector3f w;
+        RGB I;
+        float cosFalloffStart, cosFalloffEnd;
+    };
+
+    // DistantLight Definition
+    // Radiance L arriving from infinitely far away, traveling along w.
+    class DistantLight {
+    public:
+        // DistantLight Public Methods
+        // sceneBounds places the end points of shadow rays.
+        DistantLight(const Vector3f &w, const RGB &L, float scale, const Bounds3f &sceneBounds)
+                : w(Normalize(w)), L(L * scale), sceneRadius(Length(sceneBounds.Diagonal()) / 2) {}
+
+        bool IsDelta() const { return true; }
+
+        std::optional<LightLiSample> SampleLi(const LightSampleContext &ctx, const Point2f &u) const {
+            return LightLiSample{L, -w, 1, ctx.p - w * (2 * sceneRadius)};
+        }
+
+        float PDF_Li(const LightSampleContext &ctx, const Vector3f &wi) const { return 0; }
+
+    private:
+        // DistantLight Private Members
+        Vector3f w;
+        RGB L;
+        float sceneRadius;
+    };
+
+    // DiffuseAreaLight Definition
+    // One emitting triangle of a mesh: radiance L leaves the side its
+    // FaceNormal() points to, or both sides if twoSided.
+    class DiffuseAreaLight {
+    public:
+        // DiffuseAreaLight Public Methods
+        DiffuseAreaLight(const TriangleMesh *mesh, int triangleIndex, const RGB &L, float scale, bool twoSided)
+                : mesh(mesh), triangleIndex(triangleIndex), n(mesh->FaceNormal(triangleIndex)),
+                  area(mesh->TriangleArea(triangleIndex)), Lemit(L * scale), twoSided(twoSided) {}
+
+        bool IsDelta() const { return false; }
+
+        // Radiance leaving a point of the triangle in direction w.
+        RGB L(const Vector3f &w) const {
+            if (!twoSided && Dot(n, w) < 0)
+                return RGB(0, 0, 0);
+            return Lemit;
+        }
+
+        // Samples a point uniformly over the triangle's area.
+        std::optional<LightLiSample> SampleLi(const LightSampleContext &ctx, const Point2f &u) const;
+
+        float PDF_Li(const LightSampleContext &ctx, const Vector3f &wi) const;
+
+    private:
+        // DiffuseAreaLight Private Members
+        const TriangleMesh *mesh;
+        int triangleIndex;
+        Normal3f n;
+        float area;
+        RGB Lemit;
+        bool twoSided;
+    };
+
+    // LightHandle Inline Methods
+    inline bool LightHandle::IsDelta() const {
+        return Dispatch([](auto light) { return light->IsDelta(); });
+    }
+
+    inline std::optional<LightLiSample> LightHandle::SampleLi(const LightSampleContext &ctx,
+                                                              const Point2f &u) const {
+        return Dispatch([&](auto light) { return light->SampleLi(ctx, u); });
+    }
+
+    inline float LightHandle::PDF_Li(const LightSampleContext &ctx, const Vector3f &wi) const {
+        return Dispatch([&](auto light) { return light->PDF_Li(ctx, wi); });
+    }
+}
+
+#endif //JADEHARE_CORE_LIGHT_LIGHTS_H
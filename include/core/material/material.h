@@ -0,0 +1,42 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_MATERIAL_MATERIAL_H
+#define JADEHARE_CORE_MATERIAL_MATERIAL_H
+
+#include "jadehare.h"
+#include "core/math/normal.h"
+#include "core/math/vector.h"
+#include "core/texture/texture.h"
+#include "util/memory.h"
+#include "util/taggedPointer.h"
+
+namespace jadehare {
+
+    // MaterialEvalContext Definition
+    // Where a material is evaluated: the texture lookup context, with its
+    // filter footprint, plus the outgoing direction and the shading normal
+    // on the side that direction is on.
+    struct MaterialEvalContext : public TextureEvalContext {
+        Vector3f wo;
+        Normal3f ns;
+    };
+
+    // MaterialHandle Definition
+    // Any of the renderer's surface materials, or nullptr for interface
+    // surfaces, which only bound media. The materials are defined in
+    // materials.h, along with these methods, which dispatch on the
+    // material's type. A material type gets a class here once it has a
+    // BxDF of its own; Scene::SetMaterials() renders the others as diffuse.
+    class MaterialHandle : public TaggedPointer<DiffuseMaterial> {
+    public:
+        // MaterialHandle Interface
+        using TaggedPointer::TaggedPointer;
+
+        // Scattering at ctx, in render space, allocated from _buf_.
+        DiffuseBxDF *GetBxDF(const MaterialEvalContext &ctx, ScratchBuffer &buf) const;
+    };
+}
+
+#endif //JADEHARE_CORE_MATERIAL_MATERIAL_H
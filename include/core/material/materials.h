@@ -0,0 +1,95 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_MATERIAL_MATERIALS_H
+#define JADEHARE_CORE_MATERIAL_MATERIALS_H
+
+#include "jadehare.h"
+#include "core/material/material.h"
+#include "core/math/mathematics.h"
+#include "core/math/normal.h"
+#include "core/math/point.h"
+#include "core/math/vector.h"
+#include "core/sampling/sampling.h"
+#include "core/spectrum/color.h"
+#include "core/texture/texture.h"
+#include "util/memory.h"
+
+#include <optional>
+
+namespace jadehare {
+
+    // BSDFSample Definition
+    // Scattering function value f and density pdf of a sampled incident
+    // direction wi.
+    struct BSDFSample {
+        RGB f;
+        Vector3f wi;
+        float pdf = 0;
+    };
+
+    // DiffuseBxDF Definition
+    // Lambertian reflection with reflectance R on the side of the shading
+    // normal ns; directions are in render space.
+    class DiffuseBxDF {
+    public:
+        // DiffuseBxDF Public Methods
+        DiffuseBxDF(const RGB &R, const Normal3f &ns) : R(R), ns(ns) {}
+
+        RGB f(const Vector3f &wo, const Vector3f &wi) const {
+            return Dot(wi, ns) > 0 ? R * InvPi : RGB(0, 0, 0);
+        }
+
+        // Cosine-weighted direction about ns.
+        std::optional<BSDFSample> Sample_f(const Vector3f &wo, const Point2f &u) const {
+            Vector3f s, t;
+            CoordinateSystem(Vector3f(ns), &s, &t);
+            Vector3f wLocal = SampleCosineHemisphere(u);
+            float pdf = CosineHemispherePDF(wLocal.z);
+            if (pdf == 0)
+                return {};
+            Vector3f wi = wLocal.x * s + wLocal.y * t + wLocal.z * Vector3f(ns);
+            return BSDFSample{R * InvPi, wi, pdf};
+        }
+
+        float PDF(const Vector3f &wo, const Vector3f &wi) const {
+            return CosineHemispherePDF(std::max<float>(0, Dot(wi, ns)));
+        }
+
+    private:
+        // DiffuseBxDF Private Members
+        RGB R;
+        Normal3f ns;
+    };
+
+    // Reflectance given by an image texture, if there is one, or a constant.
+    inline RGB EvaluateReflectance(const RGB &reflectance, const ImageTexture *texture,
+                                   const TextureEvalContext &ctx) {
+        return texture ? texture->Evaluate(ctx) : reflectance;
+    }
+
+    // DiffuseMaterial Definition
+    class DiffuseMaterial {
+    public:
+        // DiffuseMaterial Public Methods
+        DiffuseMaterial(const RGB &reflectance, const ImageTexture *reflectanceTexture)
+                : reflectance(reflectance), reflectanceTexture(reflectanceTexture) {}
+
+        DiffuseBxDF *GetBxDF(const MaterialEvalContext &ctx, ScratchBuffer &buf) const {
+            return buf.Alloc<DiffuseBxDF>(EvaluateReflectance(reflectance, reflectanceTexture, ctx), ctx.ns);
+        }
+
+    private:
+        // DiffuseMaterial Private Members
+        RGB reflectance;
+        const ImageTexture *reflectanceTexture;
+    };
+
+    // MaterialHandle Inline Methods
+    inline DiffuseBxDF *MaterialHandle::GetBxDF(const MaterialEvalContext &ctx, ScratchBuffer &buf) const {
+        return Dispatch([&](auto material) { return material->GetBxDF(ctx, buf); });
+    }
+}
+
+#endif //JADEHARE_CORE_MATERIAL_MATERIALS_H
@@ -0,0 +1,67 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_MATH_ANIMATEDTRANSFORM_H
+#define JADEHARE_CORE_MATH_ANIMATEDTRANSFORM_H
+
+#include "jadehare.h"
+#include "core/math/bounds.h"
+#include "core/math/quaternion.h"
+#include "core/math/transform.h"
+#include "core/math/vector.h"
+
+namespace jadehare {
+
+    // AnimatedTransform Definition
+    // Motion between two transformations over [startTime, endTime], as in
+    // pbrt: both are decomposed into translation, rotation and scale, which
+    // are interpolated linearly, spherically and linearly. Times outside
+    // the range clamp to it. Trivially copyable so it can be written to the
+    // scene cache.
+    class AnimatedTransform {
+    public:
+        // AnimatedTransform Public Methods
+        AnimatedTransform() = default;
+
+        AnimatedTransform(const Transform &startTransform, float startTime, const Transform &endTransform,
+                          float endTime);
+
+        bool IsAnimated() const { return actuallyAnimated; }
+
+        float StartTime() const { return startTime; }
+
+        float EndTime() const { return endTime; }
+
+        Transform Interpolate(float time) const;
+
+        // Bounds of _b_ at _t0_ and _t1_, grown so that interpolating
+        // between them linearly contains the transformed _b_ at any time in
+        // between. Found by sampling the motion, with some slack for the
+        // curvature of rotations between samples.
+        void LinearBounds(const Bounds3f &b, float t0, float t1, Bounds3f *b0, Bounds3f *b1) const;
+
+        // Bounds of _b_ over the whole motion.
+        Bounds3f MotionBounds(const Bounds3f &b) const {
+            Bounds3f b0, b1;
+            LinearBounds(b, startTime, endTime, &b0, &b1);
+            return Union(b0, b1);
+        }
+
+    private:
+        // AnimatedTransform Private Methods
+        // Splits the matrix into translation, rotation and the remaining
+        // scale (and shear) by polar decomposition.
+        static void Decompose(const glm::mat4 &m, Vector3f *T, Quaternion *R, glm::mat4 *S);
+
+        // AnimatedTransform Private Members
+        Transform startTransform, endTransform;
+        float startTime = 0, endTime = 1;
+        bool actuallyAnimated = false;
+        Vector3f T[2];
+        Quaternion R[2];
+        glm::mat4 S[2];
+    };
+}
+
+#endif //JADEHARE_CORE_MATH_ANIMATEDTRANSFORM_H
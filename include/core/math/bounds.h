@@ -334,6 +334,17 @@ namespace jadehare {
         return ret;
     }
 
+    // Bounds interpolated corner by corner, as for moving geometry.
+    template<typename T>
+    inline Bounds3<T> Lerp(float t, const Bounds3<T> &b0, const Bounds3<T> &b1) {
+        Bounds3<T> ret;
+        for (int c = 0; c < 3; ++c) {
+            ret.pMin[c] = jadehare::Lerp(t, b0.pMin[c], b1.pMin[c]);
+            ret.pMax[c] = jadehare::Lerp(t, b0.pMax[c], b1.pMax[c]);
+        }
+        return ret;
+    }
+
     template<typename T>
     inline Bounds3<T> Intersect(const Bounds3<T> &b1, const Bounds3<T> &b2) {
         Bounds3<T> b;
@@ -0,0 +1,84 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_MATH_DIRECTIONCONE_H
+#define JADEHARE_CORE_MATH_DIRECTIONCONE_H
+
+#include "jadehare.h"
+#include "core/math/bounds.h"
+#include "core/math/mathematics.h"
+#include "core/math/point.h"
+#include "core/math/transform.h"
+#include "core/math/vector.h"
+
+namespace jadehare {
+
+    // DirectionCone Definition
+    // The set of directions within angle acos(cosTheta) of the central
+    // direction w; cosTheta = Infinity marks the empty cone.
+    class DirectionCone {
+    public:
+        // DirectionCone Public Methods
+        DirectionCone() = default;
+
+        DirectionCone(const Vector3f &w, float cosTheta) : w(Normalize(w)), cosTheta(cosTheta) {}
+
+        explicit DirectionCone(const Vector3f &w) : DirectionCone(w, 1) {}
+
+        static DirectionCone EntireSphere() { return DirectionCone(Vector3f(0, 0, 1), -1); }
+
+        bool IsEmpty() const { return cosTheta == Infinity; }
+
+        // DirectionCone Public Members
+        Vector3f w = Vector3f(0, 0, 0);
+        float cosTheta = Infinity;
+    };
+
+    // DirectionCone Inline Functions
+    inline bool Inside(const DirectionCone &d, const Vector3f &w) {
+        return !d.IsEmpty() && Dot(d.w, Normalize(w)) >= d.cosTheta;
+    }
+
+    // Cone of directions from p toward the bounds' bounding sphere.
+    inline DirectionCone BoundSubtendedDirections(const Bounds3f &b, const Point3f &p) {
+        Point3f pCenter = (b.pMin + b.pMax) / 2;
+        float radius2 = LengthSquared(b.pMax - pCenter);
+        float distance2 = LengthSquared(p - pCenter);
+        if (distance2 < radius2)
+            return DirectionCone::EntireSphere();
+
+        float sin2ThetaMax = radius2 / distance2;
+        float cosThetaMax = SafeSqrt(1 - sin2ThetaMax);
+        return DirectionCone(pCenter - p, cosThetaMax);
+    }
+
+    // Smallest cone containing both cones (pbrt-v4).
+    inline DirectionCone Union(const DirectionCone &a, const DirectionCone &b) {
+        if (a.IsEmpty())
+            return b;
+        if (b.IsEmpty())
+            return a;
+
+        // Return the larger cone if it already contains the other one
+        float theta_a = SafeACos(a.cosTheta), theta_b = SafeACos(b.cosTheta);
+        float theta_d = AngleBetween(a.w, b.w);
+        if (std::min(theta_d + theta_b, Pi) <= theta_a)
+            return a;
+        if (std::min(theta_d + theta_a, Pi) <= theta_b)
+            return b;
+
+        // Otherwise rotate a's axis toward b's by the half-angle difference
+        float theta_o = (theta_a + theta_d + theta_b) / 2;
+        if (theta_o >= Pi)
+            return DirectionCone::EntireSphere();
+        float theta_r = theta_o - theta_a;
+        Vector3f wr = Cross(a.w, b.w);
+        if (LengthSquared(wr) == 0)
+            return DirectionCone::EntireSphere();
+        Vector3f w = Rotate(theta_r * 180 / Pi, wr)(a.w);
+        return DirectionCone(w, std::cos(theta_o));
+    }
+}
+
+#endif //JADEHARE_CORE_MATH_DIRECTIONCONE_H
@@ -0,0 +1,152 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_MATH_INTERVAL_H
+#define JADEHARE_CORE_MATH_INTERVAL_H
+
+#include "jadehare.h"
+#include "mathematics.h"
+
+namespace jadehare {
+
+    // Interval Definition
+    // Conservative floating-point interval; every operation rounds the bounds
+    // outward so the exact result is always contained.
+    template<typename Float>
+    class Interval {
+    public:
+        // Interval Public Methods
+        Interval() = default;
+
+        explicit Interval(Float v) : low(v), high(v) {}
+
+        Interval(Float low, Float high) : low(std::min(low, high)), high(std::max(low, high)) {}
+
+        static Interval FromValueAndError(Float v, Float err) {
+            Interval i;
+            if (err == 0)
+                i.low = i.high = v;
+            else {
+                i.low = NextFloatDown(v - err);
+                i.high = NextFloatUp(v + err);
+            }
+            return i;
+        }
+
+        Float UpperBound() const { return high; }
+
+        Float LowerBound() const { return low; }
+
+        Float Midpoint() const { return (low + high) / 2; }
+
+        Float Width() const { return high - low; }
+
+        explicit operator Float() const { return Midpoint(); }
+
+        bool Exactly(Float v) const { return low == v && high == v; }
+
+        bool operator==(Float v) const { return Exactly(v); }
+
+        bool operator==(const Interval &i) const { return low == i.low && high == i.high; }
+
+        bool operator!=(const Interval &i) const { return !(*this == i); }
+
+        Interval operator-() const { return {-high, -low}; }
+
+        Interval operator+(const Interval &i) const {
+            return {NextFloatDown(low + i.low), NextFloatUp(high + i.high)};
+        }
+
+        Interval operator-(const Interval &i) const {
+            return {NextFloatDown(low - i.high), NextFloatUp(high - i.low)};
+        }
+
+        Interval operator*(const Interval &i) const {
+            Float lp[4] = {low * i.low, high * i.low, low * i.high, high * i.high};
+            return {NextFloatDown(std::min({lp[0], lp[1], lp[2], lp[3]})),
+                    NextFloatUp(std::max({lp[0], lp[1], lp[2], lp[3]}))};
+        }
+
+        Interval operator/(const Interval &i) const {
+            // Division by an interval straddling zero is unbounded
+            if (i.low < 0 && i.high > 0)
+                return {-Infinity, Infinity};
+            Float lq[4] = {low / i.low, high / i.low, low / i.high, high / i.high};
+            return {NextFloatDown(std::min({lq[0], lq[1], lq[2], lq[3]})),
+                    NextFloatUp(std::max({lq[0], lq[1], lq[2], lq[3]}))};
+        }
+
+        Interval operator+(Float f) const { return *this + Interval(f); }
+
+        Interval operator-(Float f) const { return *this - Interval(f); }
+
+        Interval operator*(Float f) const {
+            return f > 0 ? Interval(NextFloatDown(f * low), NextFloatUp(f * high))
+                         : Interval(NextFloatDown(f * high), NextFloatUp(f * low));
+        }
+
+        Interval operator/(Float f) const {
+            if (f == 0)
+                return {-Infinity, Infinity};
+            return f > 0 ? Interval(NextFloatDown(low / f), NextFloatUp(high / f))
+                         : Interval(NextFloatDown(high / f), NextFloatUp(low / f));
+        }
+
+        Interval &operator+=(const Interval &i) { return *this = *this + i; }
+
+        Interval &operator-=(const Interval &i) { return *this = *this - i; }
+
+        Interval &operator*=(const Interval &i) { return *this = *this * i; }
+
+        Interval &operator/=(const Interval &i) { return *this = *this / i; }
+
+        Interval &operator+=(Float f) { return *this = *this + f; }
+
+        Interval &operator-=(Float f) { return *this = *this - f; }
+
+        Interval &operator*=(Float f) { return *this = *this * f; }
+
+        Interval &operator/=(Float f) { return *this = *this / f; }
+
+    private:
+        friend bool IsNaN(const Interval &i) { return std::isnan(i.low) || std::isnan(i.high); }
+
+        // Interval Private Members
+        Float low = 0, high = 0;
+    };
+
+    using FloatInterval = Interval<float>;
+
+    // Interval Inline Functions
+    template<typename Float>
+    inline Interval<Float> operator+(Float f, const Interval<Float> &i) { return i + f; }
+
+    template<typename Float>
+    inline Interval<Float> operator-(Float f, const Interval<Float> &i) { return Interval<Float>(f) - i; }
+
+    template<typename Float>
+    inline Interval<Float> operator*(Float f, const Interval<Float> &i) { return i * f; }
+
+    template<typename Float>
+    inline bool InRange(Float v, const Interval<Float> &i) {
+        return v >= i.LowerBound() && v <= i.UpperBound();
+    }
+
+    template<typename Float>
+    inline Interval<Float> Sqr(const Interval<Float> &i) {
+        Float alow = std::abs(i.LowerBound()), ahigh = std::abs(i.UpperBound());
+        if (alow > ahigh)
+            std::swap(alow, ahigh);
+        if (InRange(Float(0), i))
+            return Interval<Float>(0, NextFloatUp(ahigh * ahigh));
+        return Interval<Float>(NextFloatDown(alow * alow), NextFloatUp(ahigh * ahigh));
+    }
+
+    template<typename Float>
+    inline Interval<Float> Sqrt(const Interval<Float> &i) {
+        return {NextFloatDown(std::sqrt(std::max<Float>(0, i.LowerBound()))), NextFloatUp(std::sqrt(i.UpperBound()))};
+    }
+}
+
+#endif //JADEHARE_CORE_MATH_INTERVAL_H
@@ -5,6 +5,13 @@
 #ifndef JADEHARE_CORE_MATH_H
 #define JADEHARE_CORE_MATH_H
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
 namespace jadehare {
     // Mathematical Constants
     constexpr float ShadowEpsilon = 0.0001f;
@@ -22,6 +29,8 @@ namespace jadehare {
 
     static constexpr float MachineEpsilon = std::numeric_limits<float>::epsilon() * 0.5;
 
+    static constexpr float OneMinusEpsilon = 0x1.fffffep-1;
+
     // Floating-point Inline Functions
     template<typename T>
     inline typename std::enable_if_t<std::is_floating_point<T>::value, bool> IsNaN(T v) {
@@ -33,11 +42,71 @@ namespace jadehare {
         return false;
     }
 
+    template<typename T>
+    inline typename std::enable_if_t<std::is_floating_point<T>::value, bool>
+    IsFinite(T v) {
+        return std::isfinite(v);
+    }
+
     // Math Inline Functions
     inline float Lerp(float t, float a, float b) {
         return (1 - t) * a + t * b;
     }
 
+    template<typename T, typename U, typename V>
+    inline constexpr T Clamp(T val, U low, V high) {
+        if (val < low)
+            return T(low);
+        else if (val > high)
+            return T(high);
+        else
+            return val;
+    }
+
+    template<typename T>
+    inline constexpr T Sqr(T v) { return v * v; }
+
+    inline float SafeSqrt(float x) { return std::sqrt(std::max(0.f, x)); }
+
+    inline float SafeASin(float x) { return std::asin(Clamp(x, -1, 1)); }
+
+    inline float SafeACos(float x) { return std::acos(Clamp(x, -1, 1)); }
+
+    inline float SinXOverX(float x) {
+        if (1 - x * x == 1)
+            return 1;
+        return std::sin(x) / x;
+    }
+
+    // Largest index i in [0, sz - 2] with pred(i) true, given that pred is
+    // true up to some index and false after it; binary search.
+    template<typename Predicate>
+    inline size_t FindInterval(size_t sz, const Predicate &pred) {
+        using ssize_t = std::make_signed_t<size_t>;
+        ssize_t size = ssize_t(sz) - 2, first = 1;
+        while (size > 0) {
+            size_t half = size_t(size) >> 1, middle = first + half;
+            bool predResult = pred(middle);
+            first = predResult ? middle + 1 : first;
+            size = predResult ? size - (half + 1) : half;
+        }
+        return size_t(Clamp(first - 1, 0, ssize_t(sz) - 2));
+    }
+
+    inline float Log2(float x) {
+        const float invLog2 = 1.442695040888963387004650940071;
+        return std::log(x) * invLog2;
+    }
+
+    // Computes a * b - c * d with a single rounding error, via Kahan's FMA trick.
+    template<typename Ta, typename Tb, typename Tc, typename Td>
+    inline auto DifferenceOfProducts(Ta a, Tb b, Tc c, Td d) {
+        auto cd = c * d;
+        auto differenceOfProducts = std::fma(a, b, -cd);
+        auto error = std::fma(-c, d, cd);
+        return differenceOfProducts + error;
+    }
+
     inline constexpr float gamma(int n) {
         return (n * MachineEpsilon) / (1 - n * MachineEpsilon);
     }
@@ -70,37 +139,112 @@ namespace jadehare {
 #endif
     }
 
-//    PBRT_CPU_GPU
-//    inline float NextFloatUp(float v) {
-//        // Handle infinity and negative zero for _NextFloatUp()_
-//        if (IsInf(v) && v > 0.)
-//            return v;
-//        if (v == -0.f)
-//            v = 0.f;
-//
-//        // Advance _v_ to next higher float
-//        uint32_t ui = FloatToBits(v);
-//        if (v >= 0)
-//            ++ui;
-//        else
-//            --ui;
-//        return BitsToFloat(ui);
-//    }
-//
-//    PBRT_CPU_GPU
-//    inline float NextFloatDown(float v) {
-//        // Handle infinity and positive zero for _NextFloatDown()_
-//        if (IsInf(v) && v < 0.)
-//            return v;
-//        if (v == 0.f)
-//            v = -0.f;
-//        uint32_t ui = FloatToBits(v);
-//        if (v > 0)
-//            --ui;
-//        else
-//            ++ui;
-//        return BitsToFloat(ui);
-//    }
+    inline float BitsToFloat(uint32_t ui) {
+        return bit_cast<float>(ui);
+    }
+
+    // Bit Operation Inline Functions
+    inline constexpr uint32_t ReverseBits32(uint32_t n) {
+        n = (n << 16) | (n >> 16);
+        n = ((n & 0x00ff00ff) << 8) | ((n & 0xff00ff00) >> 8);
+        n = ((n & 0x0f0f0f0f) << 4) | ((n & 0xf0f0f0f0) >> 4);
+        n = ((n & 0x33333333) << 2) | ((n & 0xcccccccc) >> 2);
+        n = ((n & 0x55555555) << 1) | ((n & 0xaaaaaaaa) >> 1);
+        return n;
+    }
+
+    inline constexpr uint64_t ReverseBits64(uint64_t n) {
+        uint64_t n0 = ReverseBits32((uint32_t) n);
+        uint64_t n1 = ReverseBits32((uint32_t) (n >> 32));
+        return (n0 << 32) | n1;
+    }
+
+    // Spreads the low 32 bits of _x_ so that there is a zero bit between each.
+    inline constexpr uint64_t LeftShift2(uint64_t x) {
+        x &= 0xffffffff;
+        x = (x ^ (x << 16)) & 0x0000ffff0000ffff;
+        x = (x ^ (x << 8)) & 0x00ff00ff00ff00ff;
+        x = (x ^ (x << 4)) & 0x0f0f0f0f0f0f0f0f;
+        x = (x ^ (x << 2)) & 0x3333333333333333;
+        x = (x ^ (x << 1)) & 0x5555555555555555;
+        return x;
+    }
+
+    inline constexpr uint64_t EncodeMorton2(uint32_t x, uint32_t y) {
+        return (LeftShift2(y) << 1) | LeftShift2(x);
+    }
+
+    inline constexpr int Log2Int(uint32_t v) {
+        int r = 0;
+        while (v >>= 1)
+            ++r;
+        return r;
+    }
+
+    inline constexpr int Log2Int(uint64_t v) {
+        int r = 0;
+        while (v >>= 1)
+            ++r;
+        return r;
+    }
+
+    inline constexpr int Log2Int(int32_t v) { return Log2Int((uint32_t) v); }
+
+    template<typename T>
+    inline constexpr bool IsPowerOf2(T v) {
+        return v && !(v & (v - 1));
+    }
+
+    inline constexpr int32_t RoundUpPow2(int32_t v) {
+        v--;
+        v |= v >> 1;
+        v |= v >> 2;
+        v |= v >> 4;
+        v |= v >> 8;
+        v |= v >> 16;
+        return v + 1;
+    }
+
+    inline constexpr int64_t RoundUpPow2(int64_t v) {
+        v--;
+        v |= v >> 1;
+        v |= v >> 2;
+        v |= v >> 4;
+        v |= v >> 8;
+        v |= v >> 16;
+        v |= v >> 32;
+        return v + 1;
+    }
+
+    inline float NextFloatUp(float v) {
+        // Handle infinity and negative zero for _NextFloatUp()_
+        if (IsInf(v) && v > 0.)
+            return v;
+        if (v == -0.f)
+            v = 0.f;
+
+        // Advance _v_ to next higher float
+        uint32_t ui = FloatToBits(v);
+        if (v >= 0)
+            ++ui;
+        else
+            --ui;
+        return BitsToFloat(ui);
+    }
+
+    inline float NextFloatDown(float v) {
+        // Handle infinity and positive zero for _NextFloatDown()_
+        if (IsInf(v) && v < 0.)
+            return v;
+        if (v == 0.f)
+            v = -0.f;
+        uint32_t ui = FloatToBits(v);
+        if (v > 0)
+            --ui;
+        else
+            ++ui;
+        return BitsToFloat(ui);
+    }
 }
 
 #endif //JADEHARE_UTIL_MATH_H
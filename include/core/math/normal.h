@@ -6,6 +6,7 @@
 #define JADEHARE_CORE_MATH_NORMAL_H
 
 #include "tuple.h"
+#include "vector.h"
 
 namespace jadehare {
 
@@ -37,6 +38,60 @@ namespace jadehare {
     };
 
     using Normal3f = Normal3<float>;
+
+#pragma region Normal3 Inline Functions
+// Normal3 Inline Functions
+
+    template<typename T>
+    inline T Dot(const Normal3<T> &n, const Vector3<T> &v) {
+        DCHECK(!n.HasNaN() && !v.HasNaN());
+        return n.x * v.x + n.y * v.y + n.z * v.z;
+    }
+
+    template<typename T>
+    inline T Dot(const Vector3<T> &v, const Normal3<T> &n) {
+        DCHECK(!v.HasNaN() && !n.HasNaN());
+        return v.x * n.x + v.y * n.y + v.z * n.z;
+    }
+
+    template<typename T>
+    inline T Dot(const Normal3<T> &n1, const Normal3<T> &n2) {
+        DCHECK(!n1.HasNaN() && !n2.HasNaN());
+        return n1.x * n2.x + n1.y * n2.y + n1.z * n2.z;
+    }
+
+    template<typename T>
+    inline T AbsDot(const Normal3<T> &n, const Vector3<T> &v) {
+        return std::abs(Dot(n, v));
+    }
+
+    template<typename T>
+    inline T AbsDot(const Vector3<T> &v, const Normal3<T> &n) {
+        return std::abs(Dot(v, n));
+    }
+
+    template<typename T>
+    inline T LengthSquared(const Normal3<T> &n) {
+        return n.x * n.x + n.y * n.y + n.z * n.z;
+    }
+
+    template<typename T>
+    inline auto Length(const Normal3<T> &n) -> float {
+        using std::sqrt;
+        return sqrt(LengthSquared(n));
+    }
+
+    template<typename T>
+    inline Normal3<T> Normalize(const Normal3<T> &n) {
+        return n / Length(n);
+    }
+
+    template<typename T>
+    inline Normal3<T> FaceForward(const Normal3<T> &n, const Vector3<T> &v) {
+        return (Dot(n, v) < 0.f) ? -n : n;
+    }
+
+#pragma endregion Normal3 Inline Functions
 }
 
 #endif //JADEHARE_CORE_MATH_NORMAL_H
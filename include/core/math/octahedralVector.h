@@ -0,0 +1,60 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_MATH_OCTAHEDRALVECTOR_H
+#define JADEHARE_CORE_MATH_OCTAHEDRALVECTOR_H
+
+#include "jadehare.h"
+#include "core/math/mathematics.h"
+#include "core/math/vector.h"
+
+namespace jadehare {
+
+    // OctahedralVector Definition
+    // Unit vector packed into 32 bits with the octahedral mapping (Cigolle
+    // et al. 2014); the decoding error is under 0.005 degrees.
+    class OctahedralVector {
+    public:
+        // OctahedralVector Public Methods
+        OctahedralVector() = default;
+
+        explicit OctahedralVector(Vector3f v) {
+            v /= std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+            if (v.z >= 0) {
+                x = Encode(v.x);
+                y = Encode(v.y);
+            } else {
+                // Fold the lower hemisphere over the diagonals
+                x = Encode((1 - std::abs(v.y)) * Sign(v.x));
+                y = Encode((1 - std::abs(v.x)) * Sign(v.y));
+            }
+        }
+
+        explicit operator Vector3f() const {
+            Vector3f v;
+            v.x = -1 + 2 * (x / 65535.f);
+            v.y = -1 + 2 * (y / 65535.f);
+            v.z = 1 - (std::abs(v.x) + std::abs(v.y));
+            if (v.z < 0) {
+                float xo = v.x;
+                v.x = (1 - std::abs(v.y)) * Sign(xo);
+                v.y = (1 - std::abs(xo)) * Sign(v.y);
+            }
+            return Normalize(v);
+        }
+
+    private:
+        // OctahedralVector Private Methods
+        static float Sign(float v) { return std::copysign(1.f, v); }
+
+        static uint16_t Encode(float f) {
+            return uint16_t(std::round(Clamp((f + 1) / 2, 0, 1) * 65535.f));
+        }
+
+        // OctahedralVector Private Members
+        uint16_t x = 0, y = 0;
+    };
+}
+
+#endif //JADEHARE_CORE_MATH_OCTAHEDRALVECTOR_H
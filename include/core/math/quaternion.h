@@ -7,6 +7,7 @@
 
 #include "jadehare.h"
 #include "mathematics.h"
+#include "util/check.h"
 
 namespace jadehare{
 #pragma region Quaternion
@@ -104,12 +105,12 @@ namespace jadehare{
 
 // http://www.plunk.org/~hatch/rightway.php
 
-//    inline Quaternion Slerp(float t, const Quaternion &q1, const Quaternion &q2) {
-//        float theta = AngleBetween(q1, q2);
-//        float sinThetaOverTheta = SinXOverX(theta);
-//        return q1 * (1 - t) * SinXOverX((1 - t) * theta) / sinThetaOverTheta +
-//               q2 * t * SinXOverX(t * theta) / sinThetaOverTheta;
-//    }
+    inline Quaternion Slerp(float t, const Quaternion &q1, const Quaternion &q2) {
+        float theta = AngleBetween(q1, q2);
+        float sinThetaOverTheta = SinXOverX(theta);
+        return q1 * (1 - t) * SinXOverX((1 - t) * theta) / sinThetaOverTheta +
+               q2 * t * SinXOverX(t * theta) / sinThetaOverTheta;
+    }
 #pragma endregion Quaternion Inline Functions
 }
 
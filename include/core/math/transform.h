@@ -0,0 +1,187 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_MATH_TRANSFORM_H
+#define JADEHARE_CORE_MATH_TRANSFORM_H
+
+#include "jadehare.h"
+#include "mathematics.h"
+#include "vector.h"
+#include "point.h"
+#include "normal.h"
+#include "bounds.h"
+#include "ray.h"
+
+namespace jadehare {
+
+    // Transform Definition
+    // Affine/projective transform stored as a glm column-major matrix and its
+    // inverse. Trivially copyable so it can be written to the scene cache.
+    class Transform {
+    public:
+        // Transform Public Methods
+        Transform() = default;
+
+        explicit Transform(const glm::mat4 &m) : m(m), mInv(glm::inverse(m)) {}
+
+        Transform(const glm::mat4 &m, const glm::mat4 &mInv) : m(m), mInv(mInv) {}
+
+        // Builds a transform from 16 values in pbrt scene-file order, which
+        // is the column-major order glm uses.
+        static Transform FromArray(const float v[16]) {
+            glm::mat4 m;
+            for (int i = 0; i < 16; ++i)
+                m[i / 4][i % 4] = v[i];
+            return Transform(m);
+        }
+
+        const glm::mat4 &GetMatrix() const { return m; }
+
+        const glm::mat4 &GetInverseMatrix() const { return mInv; }
+
+        bool operator==(const Transform &t) const { return t.m == m; }
+
+        bool operator!=(const Transform &t) const { return t.m != m; }
+
+        bool IsIdentity() const { return m == glm::mat4(1.f); }
+
+        bool SwapsHandedness() const {
+            float det = m[0][0] * (m[1][1] * m[2][2] - m[2][1] * m[1][2]) -
+                        m[1][0] * (m[0][1] * m[2][2] - m[2][1] * m[0][2]) +
+                        m[2][0] * (m[0][1] * m[1][2] - m[1][1] * m[0][2]);
+            return det < 0;
+        }
+
+        Point3f operator()(const Point3f &p) const { return ApplyPoint(m, p); }
+
+        Vector3f operator()(const Vector3f &v) const { return ApplyVector(m, v); }
+
+        // Normals transform by the inverse transpose.
+        Normal3f operator()(const Normal3f &n) const {
+            return {mInv[0][0] * n.x + mInv[0][1] * n.y + mInv[0][2] * n.z,
+                    mInv[1][0] * n.x + mInv[1][1] * n.y + mInv[1][2] * n.z,
+                    mInv[2][0] * n.x + mInv[2][1] * n.y + mInv[2][2] * n.z};
+        }
+
+        Ray operator()(const Ray &r) const { return Ray((*this)(r.o), (*this)(r.d), r.time, r.medium); }
+
+        Bounds3f operator()(const Bounds3f &b) const {
+            Bounds3f bt;
+            for (int i = 0; i < 8; ++i)
+                bt = Union(bt, (*this)(b.Corner(i)));
+            return bt;
+        }
+
+        Point3f ApplyInverse(const Point3f &p) const { return ApplyPoint(mInv, p); }
+
+        Vector3f ApplyInverse(const Vector3f &v) const { return ApplyVector(mInv, v); }
+
+        Ray ApplyInverse(const Ray &r) const {
+            return Ray(ApplyInverse(r.o), ApplyInverse(r.d), r.time, r.medium);
+        }
+
+        Transform operator*(const Transform &t2) const { return Transform(m * t2.m, t2.mInv * mInv); }
+
+    private:
+        // Transform Private Methods
+        static Point3f ApplyPoint(const glm::mat4 &m, const Point3f &p) {
+            float xp = m[0][0] * p.x + m[1][0] * p.y + m[2][0] * p.z + m[3][0];
+            float yp = m[0][1] * p.x + m[1][1] * p.y + m[2][1] * p.z + m[3][1];
+            float zp = m[0][2] * p.x + m[1][2] * p.y + m[2][2] * p.z + m[3][2];
+            float wp = m[0][3] * p.x + m[1][3] * p.y + m[2][3] * p.z + m[3][3];
+            if (wp == 1)
+                return {xp, yp, zp};
+            return Point3f(xp, yp, zp) / wp;
+        }
+
+        static Vector3f ApplyVector(const glm::mat4 &m, const Vector3f &v) {
+            return {m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z,
+                    m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z,
+                    m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z};
+        }
+
+        // Transform Private Members
+        glm::mat4 m{1.f}, mInv{1.f};
+    };
+
+#pragma region Transform Inline Functions
+
+    // Transform Inline Functions
+    inline Transform Inverse(const Transform &t) { return Transform(t.GetInverseMatrix(), t.GetMatrix()); }
+
+    inline Transform Translate(const Vector3f &delta) {
+        glm::mat4 m(1.f), mInv(1.f);
+        for (int i = 0; i < 3; ++i) {
+            m[3][i] = delta[i];
+            mInv[3][i] = -delta[i];
+        }
+        return Transform(m, mInv);
+    }
+
+    inline Transform Scale(float x, float y, float z) {
+        glm::mat4 m(1.f), mInv(1.f);
+        m[0][0] = x, m[1][1] = y, m[2][2] = z;
+        mInv[0][0] = 1 / x, mInv[1][1] = 1 / y, mInv[2][2] = 1 / z;
+        return Transform(m, mInv);
+    }
+
+    // Rotation by _theta_ degrees about _axis_.
+    inline Transform Rotate(float theta, const Vector3f &axis) {
+        Vector3f a = Normalize(axis);
+        float sinTheta = std::sin(theta * Pi / 180), cosTheta = std::cos(theta * Pi / 180);
+        float r[3][3];
+        r[0][0] = a.x * a.x + (1 - a.x * a.x) * cosTheta;
+        r[0][1] = a.x * a.y * (1 - cosTheta) - a.z * sinTheta;
+        r[0][2] = a.x * a.z * (1 - cosTheta) + a.y * sinTheta;
+        r[1][0] = a.x * a.y * (1 - cosTheta) + a.z * sinTheta;
+        r[1][1] = a.y * a.y + (1 - a.y * a.y) * cosTheta;
+        r[1][2] = a.y * a.z * (1 - cosTheta) - a.x * sinTheta;
+        r[2][0] = a.x * a.z * (1 - cosTheta) - a.y * sinTheta;
+        r[2][1] = a.y * a.z * (1 - cosTheta) + a.x * sinTheta;
+        r[2][2] = a.z * a.z + (1 - a.z * a.z) * cosTheta;
+        // _r_ is row-major; the inverse of a rotation is its transpose
+        glm::mat4 m(1.f), mInv(1.f);
+        for (int row = 0; row < 3; ++row)
+            for (int col = 0; col < 3; ++col) {
+                m[col][row] = r[row][col];
+                mInv[row][col] = r[row][col];
+            }
+        return Transform(m, mInv);
+    }
+
+    // Returns cameraFromWorld for a camera at _pos_ looking at _look_.
+    inline Transform LookAt(const Point3f &pos, const Point3f &look, const Vector3f &up) {
+        Vector3f dir = Normalize(look - pos);
+        Vector3f right = Cross(Normalize(up), dir);
+        if (LengthSquared(right) == 0)
+            throw std::runtime_error("LookAt: \"up\" vector and viewing direction are parallel");
+        right = Normalize(right);
+        Vector3f newUp = Cross(dir, right);
+        glm::mat4 worldFromCamera(1.f);
+        for (int i = 0; i < 3; ++i) {
+            worldFromCamera[0][i] = right[i];
+            worldFromCamera[1][i] = newUp[i];
+            worldFromCamera[2][i] = dir[i];
+            worldFromCamera[3][i] = pos[i];
+        }
+        return Transform(glm::inverse(worldFromCamera), worldFromCamera);
+    }
+
+    // Perspective projection with _fov_ in degrees; maps the near plane to
+    // z = 0 and the far plane to z = 1.
+    inline Transform Perspective(float fov, float n, float f) {
+        glm::mat4 persp(0.f);
+        persp[0][0] = 1;
+        persp[1][1] = 1;
+        persp[2][2] = f / (f - n);
+        persp[2][3] = 1;
+        persp[3][2] = -f * n / (f - n);
+        float invTanAng = 1 / std::tan(fov * Pi / 360);
+        return Scale(invTanAng, invTanAng, 1) * Transform(persp);
+    }
+
+#pragma endregion Transform Inline Functions
+}
+
+#endif //JADEHARE_CORE_MATH_TRANSFORM_H
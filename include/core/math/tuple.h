@@ -6,6 +6,7 @@
 #define JADEHARE_CORE_MATH_TUPLE_H
 
 #include "jadehare.h"
+#include "mathematics.h"
 #include "util/check.h"
 
 namespace jadehare {
@@ -30,25 +31,6 @@ namespace jadehare {
 
         [[nodiscard]] bool HasNaN() const { return IsNaN(x) || IsNaN(y); }
 
-#ifndef NDEBUG
-        // The default versions of these are fine for release builds; for debug
-        // we define them so that we can add the Assert checks.
-
-        Tuple2(const Child<T> &c) {
-            DCHECK(!c.HasNaN());
-            x = c.x;
-            y = c.y;
-        }
-
-        Child<T> &operator=(const Child<T> &c) {
-            DCHECK(!c.HasNaN());
-            x = c.x;
-            y = c.y;
-            return static_cast<Child<T> &>(*this);
-        }
-
-#endif  // !NDEBUG
-
         template<typename U>
         auto operator+(const Child<U> &c) const -> Child<decltype(T{} + U{})> {
             DCHECK(!c.HasNaN());
@@ -253,28 +235,6 @@ namespace jadehare {
             return {x + c.x, y + c.y, z + c.z};
         }
 
-#ifndef NDEBUG
-        // The default versions of these are fine for release builds; for debug
-        // we define them so that we can add the Assert checks.
-
-        Tuple3(const Child<T> &c) {
-            DCHECK(!c.HasNaN());
-            x = c.x;
-            y = c.y;
-            z = c.z;
-        }
-
-
-        Child<T> &operator=(const Child<T> &c) {
-            DCHECK(!c.HasNaN());
-            x = c.x;
-            y = c.y;
-            z = c.z;
-            return static_cast<Child<T> &>(*this);
-        }
-
-#endif  // !NDEBUG
-
         template<typename U>
         Child<T> &operator+=(const Child<U> &c) {
             DCHECK(!c.HasNaN());
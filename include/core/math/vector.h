@@ -113,20 +113,22 @@ namespace jadehare {
     template<typename T>
     inline Vector3<T> Cross(const Vector3<T> &v1, const Normal3<T> &v2) {
         DCHECK(!v1.HasNaN() && !v2.HasNaN());
-        auto v3 = glm::cross(v1, v2);
-        return v3;
+        return {DifferenceOfProducts(v1.y, v2.z, v1.z, v2.y), DifferenceOfProducts(v1.z, v2.x, v1.x, v2.z),
+                DifferenceOfProducts(v1.x, v2.y, v1.y, v2.x)};
     }
 
     template<typename T>
     inline Vector3<T> Cross(const Normal3<T> &v1, const Vector3<T> &v2) {
         DCHECK(!v1.HasNaN() && !v2.HasNaN());
-        return glm::cross(v1, v2);
+        return {DifferenceOfProducts(v1.y, v2.z, v1.z, v2.y), DifferenceOfProducts(v1.z, v2.x, v1.x, v2.z),
+                DifferenceOfProducts(v1.x, v2.y, v1.y, v2.x)};
     }
 
     template<typename T>
     inline Vector3<T> Cross(const Vector3<T> &v, const Vector3<T> &w) {
         DCHECK(!v.HasNaN() && !w.HasNaN());
-        return glm::cross(v1, v2);
+        return {DifferenceOfProducts(v.y, w.z, v.z, w.y), DifferenceOfProducts(v.z, w.x, v.x, w.z),
+                DifferenceOfProducts(v.x, w.y, v.y, w.x)};
     }
 
     template<typename T>
@@ -200,6 +202,20 @@ namespace jadehare {
         *v3 = Vector3<T>(b, sign + v1.y * v1.y * a, -v1.y);
     }
 
+    // Spherical coordinates with theta measured from +z and phi in
+    // [0, 2 pi) from +x.
+    inline Vector3f SphericalDirection(float sinTheta, float cosTheta, float phi) {
+        return Vector3f(Clamp(sinTheta, -1, 1) * std::cos(phi), Clamp(sinTheta, -1, 1) * std::sin(phi),
+                        Clamp(cosTheta, -1, 1));
+    }
+
+    inline float SphericalTheta(const Vector3f &v) { return SafeACos(v.z); }
+
+    inline float SphericalPhi(const Vector3f &v) {
+        float p = std::atan2(v.y, v.x);
+        return (p < 0) ? (p + 2 * Pi) : p;
+    }
+
 #pragma endregion Vector3 Inline Functions
 
 }
@@ -0,0 +1,152 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_SAMPLING_DISTRIBUTIONS_H
+#define JADEHARE_CORE_SAMPLING_DISTRIBUTIONS_H
+
+#include "jadehare.h"
+#include "core/math/bounds.h"
+#include "core/math/mathematics.h"
+#include "core/math/point.h"
+#include "util/check.h"
+#include "util/span.h"
+
+#include <vector>
+
+namespace jadehare {
+
+    // PiecewiseConstant1D Definition
+    // Distribution proportional to a step function over [min, max],
+    // sampled by inverting its CDF with a binary search. The inversion is
+    // continuous, so stratified and low-discrepancy samples stay well
+    // distributed.
+    class PiecewiseConstant1D {
+    public:
+        // PiecewiseConstant1D Public Methods
+        PiecewiseConstant1D() = default;
+
+        // Negative values are taken by absolute value; an all-zero function
+        // is sampled uniformly with pdf zero.
+        explicit PiecewiseConstant1D(span<const float> f, float min = 0, float max = 1);
+
+        float Integral() const { return funcInt; }
+
+        size_t size() const { return func.size(); }
+
+        float Func(size_t i) const { return func[i]; }
+
+        float Sample(float u, float *pdf = nullptr, int *offset = nullptr) const {
+            // Find the segment holding u
+            int o = int(FindInterval(cdf.size(), [&](size_t index) { return cdf[index] <= u; }));
+            if (offset)
+                *offset = o;
+
+            // Remap u within the segment
+            float du = u - cdf[o];
+            if (cdf[o + 1] - cdf[o] > 0)
+                du /= cdf[o + 1] - cdf[o];
+            DCHECK(!IsNaN(du));
+            if (pdf)
+                *pdf = funcInt > 0 ? func[o] / funcInt : 0;
+            return Lerp((o + du) / size(), min, max);
+        }
+
+    private:
+        // PiecewiseConstant1D Private Members
+        std::vector<float> func, cdf;
+        float min = 0, max = 1;
+        float funcInt = 0;
+    };
+
+    // PiecewiseConstant2D Definition
+    // Distribution proportional to a nu x nv grid of values over domain:
+    // v is sampled from the marginal distribution of the rows, then u from
+    // the chosen row. Rows are built in parallel.
+    class PiecewiseConstant2D {
+    public:
+        // PiecewiseConstant2D Public Methods
+        PiecewiseConstant2D() = default;
+
+        // func holds nv rows of nu values.
+        PiecewiseConstant2D(span<const float> func, int nu, int nv,
+                            const Bounds2f &domain = Bounds2f(Point2f(0, 0), Point2f(1, 1)));
+
+        float Integral() const { return pMarginal.Integral(); }
+
+        Point2f Sample(const Point2f &u, float *pdf = nullptr, Point2i *offset = nullptr) const {
+            float pdfs[2];
+            int iu, iv;
+            float d1 = pMarginal.Sample(u.y, &pdfs[1], &iv);
+            float d0 = pConditionalV[iv].Sample(u.x, &pdfs[0], &iu);
+            if (pdf)
+                *pdf = pdfs[0] * pdfs[1];
+            if (offset)
+                *offset = Point2i(iu, iv);
+            return Point2f(d0, d1);
+        }
+
+        float PDF(const Point2f &pr) const {
+            Vector2f p = domain.Offset(pr);
+            int iu = Clamp(int(p.x * pConditionalV[0].size()), 0, int(pConditionalV[0].size()) - 1);
+            int iv = Clamp(int(p.y * pMarginal.size()), 0, int(pMarginal.size()) - 1);
+            return Integral() > 0 ? pConditionalV[iv].Func(iu) / Integral() : 0;
+        }
+
+    private:
+        // PiecewiseConstant2D Private Members
+        Bounds2f domain;
+        std::vector<PiecewiseConstant1D> pConditionalV;
+        PiecewiseConstant1D pMarginal;
+    };
+
+    // AliasTable Definition
+    // Discrete distribution sampled in constant time with Vose's alias
+    // method: u picks a bin uniformly and its fractional part chooses
+    // between the bin's own index and its alias.
+    class AliasTable {
+    public:
+        // AliasTable Public Methods
+        AliasTable() = default;
+
+        // An all-zero table is sampled uniformly.
+        explicit AliasTable(span<const float> weights);
+
+        int Sample(float u, float *pmf = nullptr, float *uRemapped = nullptr) const {
+            int offset = std::min<int>(int(u * bins.size()), int(bins.size()) - 1);
+            float up = std::min<float>(u * bins.size() - offset, OneMinusEpsilon);
+            const Bin &bin = bins[offset];
+            if (up < bin.q) {
+                if (pmf)
+                    *pmf = bin.p;
+                if (uRemapped)
+                    *uRemapped = std::min<float>(up / bin.q, OneMinusEpsilon);
+                return offset;
+            }
+            if (pmf)
+                *pmf = bins[bin.alias].p;
+            if (uRemapped)
+                *uRemapped = std::min<float>((up - bin.q) / (1 - bin.q), OneMinusEpsilon);
+            return bin.alias;
+        }
+
+        // Samples every u[i] at once; with SSE2 the index arithmetic and
+        // remapping run four samples at a time. pmf and uRemapped may be
+        // empty.
+        void Sample(span<const float> u, span<int> index, span<float> pmf, span<float> uRemapped) const;
+
+        float PMF(int index) const { return bins[index].p; }
+
+        size_t size() const { return bins.size(); }
+
+    private:
+        // AliasTable Private Members
+        struct Bin {
+            float q, p;
+            int alias;
+        };
+        std::vector<Bin> bins;
+    };
+}
+
+#endif //JADEHARE_CORE_SAMPLING_DISTRIBUTIONS_H
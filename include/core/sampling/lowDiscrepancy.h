@@ -0,0 +1,182 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_SAMPLING_LOWDISCREPANCY_H
+#define JADEHARE_CORE_SAMPLING_LOWDISCREPANCY_H
+
+#include "jadehare.h"
+#include "core/math/mathematics.h"
+#include "core/sampling/sobolMatrices.h"
+#include "util/check.h"
+#include "util/hash.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace jadehare {
+
+    // Converts the high 24 bits of _v_ to a float in $[0,1)$; the low bits
+    // would be rounded away anyway and this way the result never rounds up to one.
+    inline float UIntToUnitFloat(uint32_t v) {
+        return (v >> 8) * 0x1p-24f;
+    }
+
+#pragma region Randomizers
+
+    // NoRandomizer Definition
+    struct NoRandomizer {
+        uint32_t operator()(uint32_t v) const { return v; }
+    };
+
+    // BinaryPermuteScrambler Definition
+    struct BinaryPermuteScrambler {
+        explicit BinaryPermuteScrambler(uint32_t perm) : permutation(perm) {}
+
+        uint32_t operator()(uint32_t v) const { return permutation ^ v; }
+
+        uint32_t permutation;
+    };
+
+    // FastOwenScrambler Definition
+    // Hash-based nested uniform scrambling, after Laine and Karras (2011) and
+    // Burley (2020), "Practical Hash-based Owen Scrambling".
+    struct FastOwenScrambler {
+        explicit FastOwenScrambler(uint32_t seed) : seed(seed) {}
+
+        uint32_t operator()(uint32_t v) const {
+            v = ReverseBits32(v);
+            v ^= v * 0x3d20adea;
+            v += seed;
+            v *= (seed >> 16) | 1;
+            v ^= v * 0x05526c56;
+            v ^= v * 0x53a22864;
+            return ReverseBits32(v);
+        }
+
+        uint32_t seed;
+    };
+
+    // OwenScrambler Definition
+    struct OwenScrambler {
+        explicit OwenScrambler(uint32_t seed) : seed(seed) {}
+
+        uint32_t operator()(uint32_t v) const {
+            if (seed & 1)
+                v ^= 1u << 31;
+            for (int b = 1; b < 32; ++b) {
+                // Apply Owen scrambling to binary digit _b_ in _v_
+                uint32_t mask = (~0u) << (32 - b);
+                if ((uint32_t) MixBits((v & mask) ^ seed) & (1u << b))
+                    v ^= 1u << (31 - b);
+            }
+            return v;
+        }
+
+        uint32_t seed;
+    };
+
+    enum class RandomizeStrategy {
+        None, PermuteDigits, FastOwen, Owen
+    };
+
+#pragma endregion Randomizers
+
+#pragma region Sobol Inline Functions
+
+    inline uint32_t SobolSampleBits(uint64_t a, int dimension) {
+        DCHECK_LT(dimension, NSobolDimensions);
+        uint32_t v = 0;
+        for (int i = dimension * SobolMatrixSize; a != 0; a >>= 1, i++)
+            if (a & 1)
+                v ^= SobolMatrices32[i];
+        return v;
+    }
+
+    template<typename R>
+    inline float SobolSample(uint64_t a, int dimension, R randomizer) {
+        return UIntToUnitFloat(randomizer(SobolSampleBits(a, dimension)));
+    }
+
+#pragma endregion Sobol Inline Functions
+
+#pragma region Sobol Batch Functions
+    // The batch functions below evaluate eight lanes at once; with AVX2 each
+    // one is a single pass over 256-bit registers, otherwise the loops are
+    // written so that the compiler can vectorize them for the target ISA.
+
+#if defined(__AVX2__)
+    namespace detail {
+        inline __m256i ReverseBits32x8(__m256i v) {
+            const __m256i byteSwap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                                      3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+            const __m256i nibbleReverse = _mm256_setr_epi8(0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6, 0xe,
+                                                           0x1, 0x9, 0x5, 0xd, 0x3, 0xb, 0x7, 0xf,
+                                                           0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6, 0xe,
+                                                           0x1, 0x9, 0x5, 0xd, 0x3, 0xb, 0x7, 0xf);
+            const __m256i lowNibbles = _mm256_set1_epi8(0x0f);
+            v = _mm256_shuffle_epi8(v, byteSwap);
+            __m256i lo = _mm256_shuffle_epi8(nibbleReverse, _mm256_and_si256(v, lowNibbles));
+            __m256i hi = _mm256_shuffle_epi8(nibbleReverse, _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibbles));
+            return _mm256_or_si256(_mm256_slli_epi16(lo, 4), hi);
+        }
+
+        inline __m256i FastOwenScramble8(__m256i v, __m256i seed) {
+            v = ReverseBits32x8(v);
+            v = _mm256_xor_si256(v, _mm256_mullo_epi32(v, _mm256_set1_epi32(0x3d20adea)));
+            v = _mm256_add_epi32(v, seed);
+            v = _mm256_mullo_epi32(v, _mm256_or_si256(_mm256_srli_epi32(seed, 16), _mm256_set1_epi32(1)));
+            v = _mm256_xor_si256(v, _mm256_mullo_epi32(v, _mm256_set1_epi32(0x05526c56)));
+            v = _mm256_xor_si256(v, _mm256_mullo_epi32(v, _mm256_set1_epi32(0x53a22864)));
+            return ReverseBits32x8(v);
+        }
+
+        inline void StoreUnitFloat8(__m256i v, float out[8]) {
+            __m256 f = _mm256_cvtepi32_ps(_mm256_srli_epi32(v, 8));
+            _mm256_storeu_ps(out, _mm256_mul_ps(f, _mm256_set1_ps(0x1p-24f)));
+        }
+    }
+#endif
+
+    // Applies FastOwenScrambler(seeds[i]) to v[i] for all eight lanes and
+    // converts the results to floats in $[0,1)$.
+    inline void FastOwenScrambleToFloat8(const uint32_t v[8], const uint32_t seeds[8], float out[8]) {
+#if defined(__AVX2__)
+        __m256i vv = _mm256_loadu_si256((const __m256i *) v);
+        __m256i ss = _mm256_loadu_si256((const __m256i *) seeds);
+        detail::StoreUnitFloat8(detail::FastOwenScramble8(vv, ss), out);
+#else
+        for (int i = 0; i < 8; ++i)
+            out[i] = UIntToUnitFloat(FastOwenScrambler(seeds[i])(v[i]));
+#endif
+    }
+
+    // Returns sample _a_ of the eight Sobol dimensions starting at
+    // _dimension_, which must be a multiple of eight, with each dimension
+    // Owen-scrambled by the corresponding entry of _seeds_.
+    inline void SobolSample8(uint64_t a, int dimension, const uint32_t seeds[8], float out[8]) {
+        DCHECK_EQ(dimension % 8, 0);
+        DCHECK_LT(dimension, NSobolDimensions);
+        const uint32_t(*columns)[8] = SobolMatrices32x8[dimension / 8];
+#if defined(__AVX2__)
+        __m256i v = _mm256_setzero_si256();
+        for (int i = 0; a != 0; a >>= 1, ++i)
+            if (a & 1)
+                v = _mm256_xor_si256(v, _mm256_load_si256((const __m256i *) columns[i]));
+        __m256i ss = _mm256_loadu_si256((const __m256i *) seeds);
+        detail::StoreUnitFloat8(detail::FastOwenScramble8(v, ss), out);
+#else
+        alignas(32) uint32_t v[8] = {};
+        for (int i = 0; a != 0; a >>= 1, ++i)
+            if (a & 1)
+                for (int lane = 0; lane < 8; ++lane)
+                    v[lane] ^= columns[i][lane];
+        FastOwenScrambleToFloat8(v, seeds, out);
+#endif
+    }
+
+#pragma endregion Sobol Batch Functions
+}
+
+#endif //JADEHARE_CORE_SAMPLING_LOWDISCREPANCY_H
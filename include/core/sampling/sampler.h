@@ -0,0 +1,214 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_SAMPLING_SAMPLER_H
+#define JADEHARE_CORE_SAMPLING_SAMPLER_H
+
+#include "jadehare.h"
+#include "core/math/mathematics.h"
+#include "core/math/point.h"
+#include "core/sampling/lowDiscrepancy.h"
+#include "util/check.h"
+#include "util/hash.h"
+
+namespace jadehare {
+
+#pragma region SobolSampler
+
+    // SobolSampler Definition
+    // Per-pixel Owen-scrambled Sobol points: every pixel walks the first
+    // _samplesPerPixel_ points of the same sequence, decorrelated by a
+    // per-pixel, per-dimension scrambling seed. Dimensions past
+    // NSobolDimensions wrap around with fresh seeds.
+    class SobolSampler {
+    public:
+        // SobolSampler Public Methods
+        SobolSampler(int samplesPerPixel, int seed = 0)
+                : samplesPerPixel(samplesPerPixel), seed(seed) {}
+
+        static constexpr const char *Name() { return "SobolSampler"; }
+
+        int SamplesPerPixel() const { return samplesPerPixel; }
+
+        void StartPixelSample(const Point2i &p, int index, int dim = 0) {
+            pixelHash = Hash(p.x, p.y, seed);
+            sampleIndex = index;
+            dimension = dim;
+        }
+
+        float Get1D() {
+            int dim = dimension++;
+            return SobolSample(sampleIndex, dim % NSobolDimensions, FastOwenScrambler(DimensionSeed(dim)));
+        }
+
+        Point2f Get2D() {
+            float u0 = Get1D();
+            float u1 = Get1D();
+            return {u0, u1};
+        }
+
+        Point2f GetPixel2D() { return Get2D(); }
+
+        // Fills _u_ with the next eight dimensions in one SIMD pass. The
+        // current dimension is first rounded up to a multiple of eight;
+        // lane _i_ matches what Get1D() would return for that dimension.
+        void Get8D(float u[8]) {
+            dimension = (dimension + 7) & ~7;
+            uint32_t seeds[8];
+            for (int i = 0; i < 8; ++i)
+                seeds[i] = DimensionSeed(dimension + i);
+            SobolSample8(sampleIndex, dimension % NSobolDimensions, seeds, u);
+            dimension += 8;
+        }
+
+        SobolSampler Clone() const { return *this; }
+
+    private:
+        // SobolSampler Private Methods
+        uint32_t DimensionSeed(int dim) const {
+            return uint32_t(MixBits(pixelHash ^ (0x9e3779b97f4a7c15ull * uint64_t(dim + 1))));
+        }
+
+        // SobolSampler Private Members
+        int samplesPerPixel, seed;
+        uint64_t pixelHash = 0;
+        uint64_t sampleIndex = 0;
+        int dimension = 0;
+    };
+
+#pragma endregion SobolSampler
+
+#pragma region ZSobolSampler
+
+    // ZSobolSampler Definition
+    // Ahmed and Wonka's (2020) "Screen-space blue-noise diffusion of Monte
+    // Carlo sampling error via hierarchical ordering of pixels": pixels are
+    // visited in Morton order and the base-4 digits of the resulting global
+    // index are randomly permuted per dimension.
+    class ZSobolSampler {
+    public:
+        // ZSobolSampler Public Methods
+        ZSobolSampler(int samplesPerPixel, const Point2i &fullResolution,
+                      RandomizeStrategy randomize = RandomizeStrategy::FastOwen, int seed = 0)
+                : randomize(randomize), seed(seed) {
+            DCHECK(IsPowerOf2(samplesPerPixel));
+            log2SamplesPerPixel = Log2Int(samplesPerPixel);
+            int res = RoundUpPow2(std::max(fullResolution.x, fullResolution.y));
+            int log4SamplesPerPixel = (log2SamplesPerPixel + 1) / 2;
+            nBase4Digits = Log2Int(res) + log4SamplesPerPixel;
+        }
+
+        static constexpr const char *Name() { return "ZSobolSampler"; }
+
+        int SamplesPerPixel() const { return 1 << log2SamplesPerPixel; }
+
+        void StartPixelSample(const Point2i &p, int index, int dim = 0) {
+            dimension = dim;
+            mortonIndex = (EncodeMorton2(p.x, p.y) << log2SamplesPerPixel) | index;
+        }
+
+        float Get1D() {
+            uint64_t sampleIndex = GetSampleIndex(dimension);
+            ++dimension;
+            // Generate 1D Sobol sample at _sampleIndex_
+            uint32_t sampleHash = uint32_t(Hash(dimension, seed));
+            return Randomize(SobolSampleBits(sampleIndex, 0), sampleHash);
+        }
+
+        Point2f Get2D() {
+            uint64_t sampleIndex = GetSampleIndex(dimension);
+            dimension += 2;
+            // Generate 2D Sobol sample at _sampleIndex_
+            uint64_t bits = Hash(dimension, seed);
+            uint32_t sampleHash[2] = {uint32_t(bits), uint32_t(bits >> 32)};
+            return {Randomize(SobolSampleBits(sampleIndex, 0), sampleHash[0]),
+                    Randomize(SobolSampleBits(sampleIndex, 1), sampleHash[1])};
+        }
+
+        Point2f GetPixel2D() { return Get2D(); }
+
+        // Returns the next eight 1D dimensions; lane _i_ matches the _i_th of
+        // eight successive Get1D() calls. With FastOwen randomization the
+        // scrambling and float conversion run as one SIMD pass.
+        void Get8D(float u[8]) {
+            if (randomize != RandomizeStrategy::FastOwen) {
+                for (int i = 0; i < 8; ++i)
+                    u[i] = Get1D();
+                return;
+            }
+            alignas(32) uint32_t v[8], seeds[8];
+            for (int i = 0; i < 8; ++i) {
+                // Dimension 0 of the Sobol sequence is the bit-reversed index.
+                v[i] = ReverseBits32(uint32_t(GetSampleIndex(dimension)));
+                ++dimension;
+                seeds[i] = uint32_t(Hash(dimension, seed));
+            }
+            FastOwenScrambleToFloat8(v, seeds, u);
+        }
+
+        ZSobolSampler Clone() const { return *this; }
+
+        uint64_t GetSampleIndex(int dim) const {
+            // Define the full set of 4-way permutations in _permutations_
+            static const uint8_t permutations[24][4] = {
+                    {0, 1, 2, 3}, {0, 1, 3, 2}, {0, 2, 1, 3}, {0, 2, 3, 1},
+                    {0, 3, 2, 1}, {0, 3, 1, 2}, {1, 0, 2, 3}, {1, 0, 3, 2},
+                    {1, 2, 0, 3}, {1, 2, 3, 0}, {1, 3, 2, 0}, {1, 3, 0, 2},
+                    {2, 1, 0, 3}, {2, 1, 3, 0}, {2, 0, 1, 3}, {2, 0, 3, 1},
+                    {2, 3, 0, 1}, {2, 3, 1, 0}, {3, 1, 2, 0}, {3, 1, 0, 2},
+                    {3, 2, 1, 0}, {3, 2, 0, 1}, {3, 0, 2, 1}, {3, 0, 1, 2}};
+
+            uint64_t sampleIndex = 0;
+            // Apply random permutations to full base-4 digits
+            bool pow2Samples = log2SamplesPerPixel & 1;
+            int lastDigit = pow2Samples ? 1 : 0;
+            for (int i = nBase4Digits - 1; i >= lastDigit; --i) {
+                // Randomly permute $i$th base-4 digit in _mortonIndex_
+                int digitShift = 2 * i - (pow2Samples ? 1 : 0);
+                int digit = (mortonIndex >> digitShift) & 3;
+                // Choose permutation _p_ to use for _digit_
+                uint64_t higherDigits = mortonIndex >> (digitShift + 2);
+                int p = (MixBits(higherDigits ^ (0x55555555u * dim)) >> 24) % 24;
+
+                digit = permutations[p][digit];
+                sampleIndex |= uint64_t(digit) << digitShift;
+            }
+
+            // Handle power-of-2 (but not 4) sample count
+            if (pow2Samples) {
+                int digit = mortonIndex & 1;
+                sampleIndex |= digit ^ (MixBits((mortonIndex >> 1) ^ (0x55555555u * dim)) & 1);
+            }
+
+            return sampleIndex;
+        }
+
+    private:
+        // ZSobolSampler Private Methods
+        float Randomize(uint32_t v, uint32_t sampleHash) const {
+            switch (randomize) {
+                case RandomizeStrategy::None:
+                    return UIntToUnitFloat(NoRandomizer()(v));
+                case RandomizeStrategy::PermuteDigits:
+                    return UIntToUnitFloat(BinaryPermuteScrambler(sampleHash)(v));
+                case RandomizeStrategy::FastOwen:
+                    return UIntToUnitFloat(FastOwenScrambler(sampleHash)(v));
+                case RandomizeStrategy::Owen:
+                default:
+                    return UIntToUnitFloat(OwenScrambler(sampleHash)(v));
+            }
+        }
+
+        // ZSobolSampler Private Members
+        RandomizeStrategy randomize;
+        int seed;
+        int log2SamplesPerPixel, nBase4Digits;
+        uint64_t mortonIndex = 0;
+        int dimension = 0;
+    };
+
+#pragma endregion ZSobolSampler
+}
+
+#endif //JADEHARE_CORE_SAMPLING_SAMPLER_H
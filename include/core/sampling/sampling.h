@@ -0,0 +1,116 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_SAMPLING_SAMPLING_H
+#define JADEHARE_CORE_SAMPLING_SAMPLING_H
+
+#include "jadehare.h"
+#include "core/math/mathematics.h"
+#include "core/math/point.h"
+#include "core/math/vector.h"
+
+namespace jadehare {
+
+    // Sampling Inline Functions
+    inline float SampleExponential(float u, float a) {
+        return -std::log(1 - u) / a;
+    }
+
+    // Henyey-Greenstein phase function value for the cosine between the
+    // outgoing direction and the incident direction, both pointing away
+    // from the scattering point.
+    inline float HenyeyGreenstein(float cosTheta, float g) {
+        float denom = 1 + g * g + 2 * g * cosTheta;
+        return Inv4Pi * (1 - g * g) / (denom * std::sqrt(std::max<float>(0, denom)));
+    }
+
+    // Samples an incident direction wi with density HenyeyGreenstein(Dot(wo, wi), g).
+    inline Vector3f SampleHenyeyGreenstein(const Vector3f &wo, float g, const Point2f &u, float *pdf) {
+        // Compute the cosine of the angle to -wo; pbrt's convention keeps wo
+        // pointing away from the scattering point
+        float cosTheta;
+        if (std::abs(g) < 1e-3f)
+            cosTheta = 1 - 2 * u[0];
+        else {
+            float s = (1 - g * g) / (1 + g - 2 * g * u[0]);
+            cosTheta = -1 / (2 * g) * (1 + g * g - s * s);
+        }
+        cosTheta = Clamp(cosTheta, -1, 1);
+        float sinTheta = std::sqrt(std::max<float>(0, 1 - cosTheta * cosTheta));
+        float phi = 2 * Pi * u[1];
+
+        Vector3f x, y;
+        CoordinateSystem(wo, &x, &y);
+        Vector3f wi = sinTheta * std::cos(phi) * x + sinTheta * std::sin(phi) * y + cosTheta * wo;
+        if (pdf)
+            *pdf = HenyeyGreenstein(cosTheta, g);
+        return wi;
+    }
+
+    // Maps the unit square to the unit disk, keeping strata compact
+    // (Shirley and Chiu 1997).
+    inline Point2f SampleUniformDiskConcentric(const Point2f &u) {
+        Point2f uOffset(2 * u[0] - 1, 2 * u[1] - 1);
+        if (uOffset.x == 0 && uOffset.y == 0)
+            return {0, 0};
+        float theta, r;
+        if (std::abs(uOffset.x) > std::abs(uOffset.y)) {
+            r = uOffset.x;
+            theta = PiOver4 * (uOffset.y / uOffset.x);
+        } else {
+            r = uOffset.y;
+            theta = PiOver2 - PiOver4 * (uOffset.x / uOffset.y);
+        }
+        return {r * std::cos(theta), r * std::sin(theta)};
+    }
+
+    // Direction in the +z hemisphere with density cos(theta) / Pi.
+    inline Vector3f SampleCosineHemisphere(const Point2f &u) {
+        Point2f d = SampleUniformDiskConcentric(u);
+        float z = std::sqrt(std::max<float>(0, 1 - d.x * d.x - d.y * d.y));
+        return {d.x, d.y, z};
+    }
+
+    inline float CosineHemispherePDF(float cosTheta) {
+        return cosTheta * InvPi;
+    }
+
+    // Multiple importance sampling weight of a sample from strategy f, with
+    // nf samples, against strategy g, with ng samples (Veach 1997).
+    inline float PowerHeuristic(int nf, float fPdf, int ng, float gPdf) {
+        float f = nf * fPdf, g = ng * gPdf;
+        if (std::isinf(f * f))
+            return 1;
+        return f * f / (f * f + g * g);
+    }
+
+    // Barycentrics of a point distributed uniformly over a triangle's area
+    // (Heitz 2019, as in pbrt-v4).
+    inline void SampleUniformTriangle(const Point2f &u, float b[3]) {
+        if (u[0] < u[1]) {
+            b[0] = u[0] / 2;
+            b[1] = u[1] - b[0];
+        } else {
+            b[1] = u[1] / 2;
+            b[0] = u[0] - b[1];
+        }
+        b[2] = 1 - b[0] - b[1];
+    }
+
+    // Density over [360nm, 830nm] roughly following the luminous
+    // efficiency curve, which keeps the noise of spectral-to-RGB
+    // conversion low (Radziszewski et al. 2009, as in pbrt-v4).
+    inline float VisibleWavelengthsPDF(float lambda) {
+        if (lambda < 360 || lambda > 830)
+            return 0;
+        float c = std::cosh(0.0072f * (lambda - 538));
+        return 0.0039398042f / (c * c);
+    }
+
+    inline float SampleVisibleWavelengths(float u) {
+        return 538 - 138.888889f * std::atanh(0.85691062f - 1.82750197f * u);
+    }
+}
+
+#endif //JADEHARE_CORE_SAMPLING_SAMPLING_H
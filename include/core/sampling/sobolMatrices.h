@@ -0,0 +1,118 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_SAMPLING_SOBOLMATRICES_H
+#define JADEHARE_CORE_SAMPLING_SOBOLMATRICES_H
+
+#include <cstdint>
+
+namespace jadehare {
+
+    // Sobol Matrix Declarations
+    static constexpr int NSobolDimensions = 32;
+    static constexpr int SobolMatrixSize = 52;
+
+    namespace detail {
+        // Primitive polynomial and initial direction numbers of one Sobol
+        // dimension, following Joe and Kuo's new-joe-kuo-6.21201 table.
+        struct SobolDirectionNumbers {
+            int s;
+            uint32_t a;
+            uint32_t m[8];
+        };
+
+        // Dimension 0 is the van der Corput sequence and is handled separately.
+        static constexpr SobolDirectionNumbers SobolInitialNumbers[NSobolDimensions - 1] = {
+                {1, 0,  {1}},
+                {2, 1,  {1, 3}},
+                {3, 1,  {1, 3, 1}},
+                {3, 2,  {1, 1, 1}},
+                {4, 1,  {1, 1, 3, 3}},
+                {4, 4,  {1, 3, 5, 13}},
+                {5, 2,  {1, 1, 5, 5, 17}},
+                {5, 4,  {1, 1, 5, 5, 5}},
+                {5, 7,  {1, 1, 7, 11, 19}},
+                {5, 11, {1, 1, 5, 1, 1}},
+                {5, 13, {1, 1, 1, 3, 11}},
+                {5, 14, {1, 3, 5, 5, 31}},
+                {6, 1,  {1, 3, 3, 9, 7, 49}},
+                {6, 13, {1, 1, 1, 15, 21, 21}},
+                {6, 16, {1, 3, 1, 13, 27, 49}},
+                {6, 19, {1, 1, 1, 15, 7, 5}},
+                {6, 22, {1, 3, 1, 15, 13, 25}},
+                {6, 25, {1, 1, 5, 5, 19, 61}},
+                {7, 1,  {1, 3, 7, 11, 23, 15, 103}},
+                {7, 4,  {1, 3, 7, 13, 13, 15, 69}},
+                {7, 7,  {1, 1, 3, 13, 7, 35, 63}},
+                {7, 8,  {1, 3, 5, 9, 1, 25, 53}},
+                {7, 14, {1, 3, 1, 13, 9, 35, 107}},
+                {7, 19, {1, 3, 1, 5, 27, 61, 31}},
+                {7, 21, {1, 1, 5, 11, 19, 41, 61}},
+                {7, 28, {1, 3, 5, 3, 3, 13, 69}},
+                {7, 31, {1, 1, 7, 13, 1, 19, 1}},
+                {7, 32, {1, 3, 7, 5, 13, 19, 59}},
+                {7, 37, {1, 1, 3, 9, 25, 29, 41}},
+                {7, 41, {1, 3, 5, 13, 23, 1, 55}},
+                {7, 42, {1, 3, 7, 3, 13, 59, 17}}};
+
+        struct SobolMatrixTable {
+            uint32_t columns[NSobolDimensions * SobolMatrixSize];
+        };
+
+        // Runs the Sobol direction number recurrence in 64 bits and keeps
+        // the upper 32 bits of each column, so that the last columns of
+        // the 52 still contribute to the low-order bits of the sample.
+        constexpr SobolMatrixTable ComputeSobolMatrices32() {
+            SobolMatrixTable table{};
+            for (int i = 0; i < SobolMatrixSize; ++i)
+                table.columns[i] = i < 32 ? (0x80000000u >> i) : 0;
+
+            for (int dim = 1; dim < NSobolDimensions; ++dim) {
+                const SobolDirectionNumbers &dn = SobolInitialNumbers[dim - 1];
+                uint64_t m[SobolMatrixSize] = {};
+                for (int k = 0; k < dn.s; ++k)
+                    m[k] = dn.m[k];
+                for (int k = dn.s; k < SobolMatrixSize; ++k) {
+                    m[k] = m[k - dn.s] ^ (m[k - dn.s] << dn.s);
+                    for (int j = 1; j < dn.s; ++j)
+                        if ((dn.a >> (dn.s - 1 - j)) & 1)
+                            m[k] ^= m[k - j] << j;
+                }
+                for (int k = 0; k < SobolMatrixSize; ++k) {
+                    // $V_k = m_k / 2^k$ as a 64-bit fixed-point fraction
+                    uint64_t v = k < 63 ? (m[k] << (63 - k)) : (m[k] >> (k - 63));
+                    table.columns[dim * SobolMatrixSize + k] = uint32_t(v >> 32);
+                }
+            }
+            return table;
+        }
+
+        struct SobolMatrixTable8 {
+            alignas(32) uint32_t columns[NSobolDimensions / 8][SobolMatrixSize][8];
+        };
+
+        // Same matrices, transposed so that column _i_ of eight consecutive
+        // dimensions is contiguous; one SIMD load then serves a whole batch.
+        constexpr SobolMatrixTable8 InterleaveSobolMatrices(const SobolMatrixTable &t) {
+            SobolMatrixTable8 table{};
+            for (int dim = 0; dim < NSobolDimensions; ++dim)
+                for (int i = 0; i < SobolMatrixSize; ++i)
+                    table.columns[dim / 8][i][dim % 8] = t.columns[dim * SobolMatrixSize + i];
+            return table;
+        }
+
+        static constexpr SobolMatrixTable SobolMatrices32Table = ComputeSobolMatrices32();
+        static constexpr SobolMatrixTable8 SobolMatrices32x8Table = InterleaveSobolMatrices(SobolMatrices32Table);
+    }
+
+    static_assert(NSobolDimensions % 8 == 0, "Sobol dimensions must come in batches of eight");
+
+    // Column _i_ of dimension _d_ is SobolMatrices32[d * SobolMatrixSize + i]
+    static constexpr const uint32_t *SobolMatrices32 = detail::SobolMatrices32Table.columns;
+
+    // Column _i_ of dimension _8 * b + l_ is SobolMatrices32x8[b][i][l]
+    static constexpr const uint32_t (*SobolMatrices32x8)[SobolMatrixSize][8] = detail::SobolMatrices32x8Table.columns;
+}
+
+#endif //JADEHARE_CORE_SAMPLING_SOBOLMATRICES_H
@@ -0,0 +1,58 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_SCENE_COMPONENTS_H
+#define JADEHARE_CORE_SCENE_COMPONENTS_H
+
+#include "jadehare.h"
+#include "core/math/transform.h"
+
+#include <entt/entt.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace jadehare {
+
+    // Components of the scene's entity registry. Every material, mesh,
+    // object prototype and object instance of a Scene is an entity; the
+    // flat arrays that the BVH and the integrator read hold the same data
+    // and are brought up to date from the components on commit.
+
+    // MaterialComponent Definition
+    struct MaterialComponent {
+        // Index into Scene::Materials(), or -1 for the default material.
+        int32_t materialIndex;
+    };
+
+    // MeshComponent Definition
+    struct MeshComponent {
+        // Index into Scene::Meshes().
+        uint32_t meshIndex;
+        entt::entity material;
+    };
+
+    // PrototypeComponent Definition
+    struct PrototypeComponent {
+        // Index into Scene::Prototypes().
+        uint32_t prototypeIndex;
+        std::vector<entt::entity> meshes;
+    };
+
+    // InstanceComponent Definition
+    struct InstanceComponent {
+        // Index into Scene::Instances() and of the instance in the BVH.
+        uint32_t instanceIndex;
+        entt::entity prototype;
+    };
+
+    // TransformComponent Definition
+    // Where an instance is placed; replacing it through the registry
+    // (registry.patch/replace) marks the instance as moved.
+    struct TransformComponent {
+        Transform renderFromInstance;
+    };
+}
+
+#endif //JADEHARE_CORE_SCENE_COMPONENTS_H
@@ -0,0 +1,129 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_SCENE_PARSER_H
+#define JADEHARE_CORE_SCENE_PARSER_H
+
+#include "jadehare.h"
+#include "util/file.h"
+
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jadehare {
+
+    // FileLoc Definition
+    struct FileLoc {
+        std::string ToString() const;
+
+        std::string_view filename;
+        int line = 1, column = 0;
+    };
+
+    // Token Definition
+    // Tokens are views into the (memory-mapped) scene file; quoted strings
+    // keep their quotes.
+    struct Token {
+        bool IsQuoted() const { return token.size() >= 2 && token.front() == '"' && token.back() == '"'; }
+
+        std::string_view Dequoted() const {
+            return IsQuoted() ? token.substr(1, token.size() - 2) : token;
+        }
+
+        std::string_view token;
+        FileLoc loc;
+    };
+
+    // Tokenizer Definition
+    class Tokenizer {
+    public:
+        // Tokenizer Public Methods
+        Tokenizer(std::string_view contents, std::string_view filename);
+
+        std::optional<Token> Next();
+
+        // Returns the raw text between the current position and the next
+        // ']', and consumes the bracket. Used to hand large numeric arrays
+        // to the bulk parser without tokenizing them one by one.
+        std::string_view TakeUntilCloseBracket(const FileLoc &openLoc);
+
+        // Returns the first character of the next token without consuming it.
+        char PeekChar();
+
+    private:
+        // Tokenizer Private Methods
+        void SkipWhitespaceAndComments();
+
+        // Tokenizer Private Members
+        const char *pos, *end;
+        FileLoc loc;
+    };
+
+    // ParsedParameter Definition
+    class ParsedParameter {
+    public:
+        // ParsedParameter Public Methods
+        size_t Count() const { return floats.size() + ints.size() + strings.size() + bools.size(); }
+
+        // ParsedParameter Public Members
+        std::string_view type, name;
+        FileLoc loc;
+        std::vector<float> floats;
+        std::vector<int> ints;
+        std::vector<std::string_view> strings;
+        std::vector<uint8_t> bools;
+    };
+
+    // SceneDirective Definition
+    // One statement of a pbrt-v4 scene description: its keyword, the
+    // positional string and numeric arguments, and the parameter list.
+    struct SceneDirective {
+        const ParsedParameter *GetParameter(std::string_view name) const;
+
+        std::string_view keyword;
+        std::vector<std::string_view> strings;
+        std::vector<float> numbers;
+        std::vector<ParsedParameter> parameters;
+        FileLoc loc;
+    };
+
+    // ParsedScene Definition
+    class ParsedScene {
+    public:
+        // ParsedScene Public Methods
+        // Writes the scene in canonical form: one directive per line,
+        // nested blocks indented, parameters one per line.
+        void Print(std::FILE *out) const;
+
+        // Keeps _str_ alive as long as the scene and returns a view of it.
+        std::string_view Intern(std::string str);
+
+        // ParsedScene Public Members
+        std::vector<SceneDirective> directives;
+        // Backing storage for the string_views held by the directives.
+        std::vector<std::unique_ptr<MappedFile>> files;
+        std::deque<std::string> strings;
+    };
+
+    // Parser Function Declarations
+    // Parses the given pbrt-v4 scene files (following Include/Import); throws
+    // std::runtime_error with the offending file location on errors.
+    std::unique_ptr<ParsedScene> ParseFiles(const std::vector<std::string> &filenames);
+
+    std::unique_ptr<ParsedScene> ParseString(std::string str);
+
+    // Resolves a filename given in the scene file _relativeTo_ against that
+    // file's directory.
+    std::string ResolveFilename(std::string_view filename, std::string_view relativeTo);
+
+    // Reports a non-fatal problem with the scene description.
+    void Warning(const FileLoc &loc, const std::string &message);
+}
+
+#endif //JADEHARE_CORE_SCENE_PARSER_H
@@ -0,0 +1,59 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_SCENE_PLY_H
+#define JADEHARE_CORE_SCENE_PLY_H
+
+#include "jadehare.h"
+#include "core/math/normal.h"
+#include "core/math/point.h"
+#include "util/file.h"
+#include "util/span.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jadehare {
+
+    // PLYMesh Definition
+    // Triangle mesh loaded from a binary little-endian PLY file. Positions
+    // point straight into the file mapping when each vertex is exactly three
+    // float32 coordinates (a 12-byte stride); otherwise they are copied, as
+    // are normals, uvs and face indices, which are always unpacked once in
+    // parallel. Quads are split into two triangles.
+    class PLYMesh {
+    public:
+        // PLYMesh Public Methods
+        // Throws std::runtime_error on malformed or unsupported files.
+        static std::unique_ptr<PLYMesh> Read(const std::string &filename);
+
+        // PLYMesh Public Members
+        span<const Point3f> p;
+        span<const Normal3f> n;
+        span<const Point2f> uv;
+        span<const int> indices;
+
+    private:
+        // PLYMesh Private Members
+        std::unique_ptr<MappedFile> file;
+        std::vector<Point3f> pStorage;
+        std::vector<Normal3f> nStorage;
+        std::vector<Point2f> uvStorage;
+        std::vector<int> indexStorage;
+    };
+
+    // Writes a binary little-endian PLY file. The header is padded so that
+    // vertex data starts 16-byte aligned, which lets PLYMesh::Read() use
+    // position-only meshes in place.
+    void WritePLYMesh(const std::string &filename, span<const int> indices, span<const Point3f> p,
+                      span<const Normal3f> n = {}, span<const Point2f> uv = {});
+
+    // Writes each inline "trianglemesh" shape of _scene_ to its own PLY file
+    // (mesh_00000.ply, ...) in parallel and replaces it with a "plymesh"
+    // shape that refers to that file.
+    void ConvertTriangleMeshesToPLY(ParsedScene *scene);
+}
+
+#endif //JADEHARE_CORE_SCENE_PLY_H
@@ -0,0 +1,359 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_SCENE_SCENE_H
+#define JADEHARE_CORE_SCENE_SCENE_H
+
+#include "jadehare.h"
+#include "core/accel/bvh.h"
+#include "core/light/light.h"
+#include "core/material/material.h"
+#include "core/math/transform.h"
+#include "core/scene/components.h"
+#include "core/shape/triangle.h"
+#include "core/spectrum/color.h"
+#include "core/texture/texture.h"
+#include "core/texture/tiledTexture.h"
+#include "core/volumeScattering/medium.h"
+#include "core/volumeScattering/sparseGrid.h"
+#include "util/file.h"
+#include "util/span.h"
+
+#include <entt/entt.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jadehare {
+
+    // MaterialType Definition
+    // The scene's material types. Only Diffuse and Interface can be
+    // rendered so far; the others keep their parameters in MaterialData and
+    // are rendered as Diffuse, with a warning.
+    enum class MaterialType : uint32_t {
+        Diffuse, Conductor, Dielectric, CoatedDiffuse, DiffuseTransmission, Interface
+    };
+
+    // MaterialData Definition
+    struct MaterialData {
+        MaterialType type = MaterialType::Diffuse;
+        RGB reflectance = RGB(0.5f, 0.5f, 0.5f);
+        RGB transmittance = RGB(0.25f, 0.25f, 0.25f);
+        float roughness = 0;
+        float eta = 1.5f;
+        // Index into Scene::Textures() of an image texture that gives the
+        // reflectance instead, or -1.
+        int32_t reflectanceTexture = -1;
+    };
+
+    // TextureData Definition
+    // Image texture read from a tiled texture file (.jtx); index into
+    // Scene::Strings() of the file name.
+    struct TextureData {
+        int32_t filenameIndex = -1;
+        float scale = 1;
+        int32_t invert = 0;
+    };
+
+    // LightType Definition
+    enum class LightType : uint32_t {
+        Point, Spot, Distant, DiffuseArea, Infinite
+    };
+
+    // LightData Definition
+    struct LightData {
+        LightType type;
+        RGB L;
+        float scale = 1;
+        // Point and spot lights: position; distant lights: direction the
+        // light travels in; spot lights: central direction.
+        Point3f p;
+        Vector3f w;
+        float cosFalloffStart = 0, cosFalloffEnd = 0;
+        // Area lights
+        int meshIndex = -1, triangleIndex = -1;
+        int twoSided = 0;
+        // Infinite lights: index into Scene::Strings() of the environment map, or -1.
+        int filenameIndex = -1;
+    };
+
+    // MediumType Definition
+    enum class MediumType : uint32_t {
+        Homogeneous, UniformGrid, SparseGrid
+    };
+
+    // MediumData Definition
+    struct MediumData {
+        MediumType type = MediumType::Homogeneous;
+        RGB sigma_a = RGB(1, 1, 1), sigma_s = RGB(1, 1, 1);
+        float scale = 1;
+        float g = 0;
+        RGB Le;
+        float LeScale = 1;
+        // Grid media: the density samples and majorant voxels are ranges of
+        // the scene's medium arrays.
+        Transform renderFromMedium;
+        Bounds3f bounds;
+        int nx = 0, ny = 0, nz = 0;
+        int majorantResolution = 0;
+        uint64_t densityOffset = 0, majorantOffset = 0;
+        // Sparse grid media: index into Scene::Strings() of the grid file and
+        // the mapping from its temperature grid to Kelvin.
+        int filenameIndex = -1;
+        float temperatureOffset = 0, temperatureScale = 1;
+    };
+
+    // SamplerType Definition
+    enum class SamplerType : uint32_t {
+        Sobol, ZSobol
+    };
+
+    // CameraData Definition
+    struct CameraData {
+        Transform worldFromCamera;
+        // The camera transformation split around the scene's last LookAt:
+        // cameraFromWorld = cameraFromLookAt * LookAt * lookAtFromWorld,
+        // both identity if the camera wasn't placed with LookAt. Replacing
+        // the LookAt keeps whatever the scene applied around it.
+        Transform cameraFromLookAt, lookAtFromWorld;
+        float fov = 90;
+        int xResolution = 1280, yResolution = 720;
+        int samplesPerPixel = 16;
+        SamplerType sampler = SamplerType::Sobol;
+        int maxDepth = 5;
+        // Medium the camera sits in, or -1.
+        int mediumIndex = -1;
+        // Index into Scene::Strings() of the output image name.
+        int filenameIndex = -1;
+        // Ray times are spread over the shutter interval.
+        float shutterOpen = 0, shutterClose = 1;
+    };
+
+    // ObjectPrototype Definition
+    // Meshes of an ObjectBegin/ObjectEnd block and the range of the
+    // prototype BVH arrays that hold its hierarchy.
+    struct ObjectPrototype {
+        uint32_t firstMesh, nMeshes;
+        uint64_t firstNode, nNodes;
+        uint64_t firstPrimitive, nPrimitives;
+    };
+
+    // Scene Definition
+    // Fully built, render-ready scene: flattened render-space meshes, the
+    // materials and lights they refer to, the camera and the BVH. A scene is
+    // either built from a parsed description or mapped from a scene cache
+    // file, in which case all arrays point into the mapping.
+    class Scene {
+    public:
+        // Scene Public Methods
+        static std::unique_ptr<Scene> Build(const ParsedScene &parsed);
+
+        ~Scene();
+
+        // Returns nullptr if the cache file is missing, was written by another
+        // version, or any of the inputs it was built from has changed.
+        static std::unique_ptr<Scene> ReadCache(const std::string &cacheFilename,
+                                                const std::vector<std::string> &sceneFiles);
+
+        // Throws std::runtime_error on I/O errors.
+        void WriteCache(const std::string &cacheFilename, const std::vector<std::string> &sceneFiles) const;
+
+        span<const TriangleMesh> Meshes() const { return meshes; }
+
+        span<const ObjectPrototype> Prototypes() const { return prototypes; }
+
+        span<const ObjectInstance> Instances() const { return instances; }
+
+        // Motions of the moving instances; see ObjectInstance::motionIndex.
+        span<const AnimatedTransform> InstanceMotion() const { return instanceMotion; }
+
+        // Mesh that was hit, resolving hits inside instances.
+        const TriangleMesh &GetMesh(const ShapeIntersection &si) const {
+            if (si.instanceIndex < 0)
+                return meshes[si.meshIndex];
+            return meshes[prototypes[instances[si.instanceIndex].prototypeIndex].firstMesh + si.meshIndex];
+        }
+
+        span<const MaterialData> Materials() const { return materials; }
+
+        // Material made from Materials()[index], a diffuse default for -1,
+        // or nullptr for interface materials.
+        MaterialHandle GetMaterial(int index) const { return index < 0 ? defaultMaterial : materialHandles[index]; }
+
+        span<const TextureData> Textures() const { return textures; }
+
+        // Texture made from Textures()[index]. Lookups go through the
+        // scene's tile cache and fault in only the tiles they touch.
+        const ImageTexture &GetTexture(int index) const { return imageTextures[index]; }
+
+        span<const LightData> Lights() const { return lights; }
+
+        // Light made from Lights()[index].
+        LightHandle GetLight(int index) const { return lightHandles[index]; }
+
+        span<const MediumData> MediumRecords() const { return mediumRecords; }
+
+        // Medium with the given index, or nullptr for -1.
+        MediumHandle GetMedium(int index) const { return index < 0 ? MediumHandle() : media[index]; }
+
+        MediumInterface GetMediumInterface(const TriangleMesh &mesh) const {
+            return MediumInterface(GetMedium(mesh.insideMedium), GetMedium(mesh.outsideMedium));
+        }
+
+        const CameraData &Camera() const { return camera; }
+
+        const BVHAggregate &Aggregate() const { return bvh; }
+
+        const std::vector<std::string> &Strings() const { return strings; }
+
+        const std::vector<std::string> &InputFiles() const { return inputFiles; }
+
+        Bounds3f Bounds() const { return bvh.Bounds(); }
+
+        // Triangles stored in the scene, counting each prototype once.
+        size_t NumTriangles() const;
+
+        // Entities of the scene's materials, meshes, prototypes and
+        // instances; see components.h.
+        entt::registry &Registry() { return registry; }
+
+        const entt::registry &Registry() const { return registry; }
+
+        // Entity of object instance _index_.
+        entt::entity InstanceEntity(uint32_t index) const { return instanceEntities[index]; }
+
+        // Moves object instance _index_ by replacing its TransformComponent,
+        // which stops it moving over the shutter interval if it did.
+        // Instances() and rendering see the move once CommitUpdates() has
+        // been called.
+        void SetInstanceTransform(uint32_t index, const Transform &renderFromInstance);
+
+        // Copies the TransformComponents updated since the last commit into
+        // Instances() and refits the BVH above those instances rather than
+        // rebuilding it, so that interactive edits take well under a frame.
+        // Distant and infinite lights keep the scene bounds the scene was
+        // built with. Must not be called while rendering.
+        void CommitUpdates();
+
+    private:
+        friend class SceneBuilder;
+
+        // MeshRecord Definition
+        // How a mesh is stored: element offsets into the flattened arrays
+        // rather than pointers, so that the cache needs no fixups beyond
+        // adding its base address. Offsets of absent arrays are ~0.
+        struct MeshRecord {
+            uint64_t pOffset, nOffset, uvOffset, indexOffset;
+            uint32_t nVertices, nIndices;
+            int32_t materialIndex, areaLightIndex;
+            int32_t insideMedium, outsideMedium;
+            uint32_t flags;
+        };
+
+        enum MeshFlags : uint32_t {
+            ReverseOrientation = 1, TransformSwapsHandedness = 2
+        };
+
+        // Scene Private Methods
+        Scene() = default;
+
+        // Points the spans at the given arrays and turns mesh records into
+        // TriangleMeshes.
+        void SetArrays(span<const MeshRecord> records, span<const Point3f> p, span<const Normal3f> n,
+                       span<const Point2f> uv, span<const int> indices, span<const MaterialData> materials,
+                       span<const LightData> lights, span<const ObjectPrototype> prototypes,
+                       span<const ObjectInstance> instances, span<const AnimatedTransform> instanceMotion);
+
+        // Creates the media described by the records, whose grids are views
+        // of the given arrays.
+        void SetMedia(span<const MediumData> records, span<const float> densities, span<const float> majorants);
+
+        // Maps the tiled texture files of the texture records and sets up
+        // a tile cache for them.
+        void SetTextures(span<const TextureData> records);
+
+        // Creates the materials described by the material records; needs
+        // the textures.
+        void SetMaterials();
+
+        // Creates the lights described by the light records, loading
+        // environment maps; needs the scene bounds.
+        void SetLights();
+
+        // Creates the prototype BVHs over the given node and primitive arrays.
+        void SetPrototypeBVHs(span<const LinearBVHNode> nodes, span<const BVHPrimitive> primitives);
+
+        // Creates the entities of the materials, meshes, prototypes and
+        // instances; needs the arrays.
+        void CreateEntities();
+
+        // Meshes outside of object definitions come first.
+        size_t NumWorldMeshes() const { return prototypes.empty() ? meshes.size() : prototypes[0].firstMesh; }
+
+        // Scene Private Members
+        std::vector<TriangleMesh> meshes;
+        span<const MeshRecord> meshRecords;
+        span<const Point3f> positions;
+        span<const Normal3f> normals;
+        span<const Point2f> uvs;
+        span<const int> indices;
+        span<const MaterialData> materials;
+        span<const TextureData> textures;
+        span<const LightData> lights;
+        span<const ObjectPrototype> prototypes;
+        span<const ObjectInstance> instances;
+        span<const AnimatedTransform> instanceMotion;
+        span<const LinearBVHNode> prototypeNodes;
+        span<const BVHPrimitive> prototypePrimitives;
+        span<const MediumData> mediumRecords;
+        span<const float> mediumDensities, majorantVoxels;
+        std::vector<MediumHandle> media;
+        std::vector<std::unique_ptr<SparseGridFile>> gridFiles;
+        std::vector<LightHandle> lightHandles;
+        // The cache loads tiles from the mapped files, and the textures
+        // look them up in the cache.
+        std::vector<std::unique_ptr<TiledTextureFile>> textureFiles;
+        std::unique_ptr<TextureCache> textureCache;
+        std::vector<ImageTexture> imageTextures;
+        std::vector<MaterialHandle> materialHandles;
+        MaterialHandle defaultMaterial;
+        CameraData camera;
+        std::vector<BVHAggregate> prototypeBVHs;
+        BVHAggregate bvh;
+        std::vector<std::string> strings;
+        std::vector<std::string> inputFiles;
+        entt::registry registry;
+        std::vector<entt::entity> instanceEntities;
+        // Instances whose TransformComponent was updated since the last
+        // CommitUpdates(), each once; instances and the BVH are left alone
+        // until the commit.
+        entt::observer movedInstances{registry, entt::collector.update<TransformComponent>()};
+
+        // Backing storage: either owned arrays or the cache mapping.
+        std::vector<MeshRecord> recordStorage;
+        std::vector<Point3f> positionStorage;
+        std::vector<Normal3f> normalStorage;
+        std::vector<Point2f> uvStorage;
+        std::vector<int> indexStorage;
+        std::vector<MaterialData> materialStorage;
+        std::vector<TextureData> textureStorage;
+        std::vector<LightData> lightStorage;
+        std::vector<ObjectPrototype> prototypeStorage;
+        std::vector<ObjectInstance> instanceStorage;
+        std::vector<AnimatedTransform> instanceMotionStorage;
+        std::vector<LinearBVHNode> prototypeNodeStorage;
+        std::vector<BVHPrimitive> prototypePrimitiveStorage;
+        std::vector<MediumData> mediumStorage;
+        std::vector<float> mediumDensityStorage, majorantStorage;
+        std::unique_ptr<MappedFile> cacheFile;
+    };
+
+    // Sets the memory for decoded texture tiles given to each scene built or
+    // read from a cache afterwards; 256 MiB unless set. Every scene has its
+    // own tile cache, so resident scenes each take this much.
+    void SetTextureCacheSize(size_t bytes);
+}
+
+#endif //JADEHARE_CORE_SCENE_SCENE_H
@@ -0,0 +1,162 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_SHAPE_TRIANGLE_H
+#define JADEHARE_CORE_SHAPE_TRIANGLE_H
+
+#include "jadehare.h"
+#include "core/math/bounds.h"
+#include "core/math/normal.h"
+#include "core/math/point.h"
+#include "core/math/ray.h"
+#include "core/math/vector.h"
+#include "util/span.h"
+
+#include <optional>
+
+namespace jadehare {
+
+    // TriangleMesh Definition
+    // Render-space triangle mesh. The arrays are views into the scene's
+    // flattened vertex storage, which may be a memory-mapped scene cache.
+    struct TriangleMesh {
+        size_t NumTriangles() const { return indices.size() / 3; }
+
+        Bounds3f TriangleBounds(size_t triangle) const {
+            const int *v = &indices[3 * triangle];
+            return Union(Bounds3f(p[v[0]], p[v[1]]), p[v[2]]);
+        }
+
+        float TriangleArea(size_t triangle) const {
+            const int *v = &indices[3 * triangle];
+            return Length(Cross(p[v[1]] - p[v[0]], p[v[2]] - p[v[0]])) / 2;
+        }
+
+        // Unit normal on the side a triangle faces: that of the shading
+        // normals if there are any, otherwise that of the winding order,
+        // flipped by ReverseOrientation and by handedness-swapping
+        // transforms. Zero for degenerate triangles.
+        Normal3f FaceNormal(size_t triangle) const {
+            const int *v = &indices[3 * triangle];
+            Vector3f ng = Cross(p[v[1]] - p[v[0]], p[v[2]] - p[v[0]]);
+            if (LengthSquared(ng) == 0)
+                return Normal3f(0, 0, 0);
+            Normal3f nf(Normalize(ng));
+            if (!n.empty()) {
+                if (Dot(nf, n[v[0]] + n[v[1]] + n[v[2]]) < 0)
+                    nf = -nf;
+            } else if (reverseOrientation ^ transformSwapsHandedness)
+                nf = -nf;
+            return nf;
+        }
+
+        span<const Point3f> p;
+        span<const Normal3f> n;
+        span<const Point2f> uv;
+        span<const int> indices;
+        int materialIndex = -1;
+        // Index of the area light of triangle 0; triangle i uses areaLightIndex + i.
+        int areaLightIndex = -1;
+        // Indices of the media inside and outside the surface, or -1.
+        int insideMedium = -1, outsideMedium = -1;
+        bool reverseOrientation = false, transformSwapsHandedness = false;
+    };
+
+    // TriangleIntersection Definition
+    struct TriangleIntersection {
+        float b0, b1, b2;
+        float t;
+    };
+
+    namespace detail {
+        // Watertight ray-triangle intersection (Woop et al. 2013), following
+        // pbrt-v4; without _Barycentrics_, only t is valid in the result.
+        template<bool Barycentrics>
+        inline std::optional<TriangleIntersection> IntersectTriangle(const Ray &ray, float tMax, const Point3f &p0,
+                                                                     const Point3f &p1, const Point3f &p2) {
+            // Skip degenerate triangles
+            if (LengthSquared(Cross(p2 - p0, p1 - p0)) == 0)
+                return {};
+
+            // Translate vertices to the ray origin and permute so that z is the
+            // dominant ray direction
+            float ad[3] = {std::abs(ray.d.x), std::abs(ray.d.y), std::abs(ray.d.z)};
+            int kz = ad[0] > ad[1] ? (ad[0] > ad[2] ? 0 : 2) : (ad[1] > ad[2] ? 1 : 2);
+            int kx = kz + 1 == 3 ? 0 : kz + 1;
+            int ky = kx + 1 == 3 ? 0 : kx + 1;
+            Vector3f p0o = p0 - ray.o, p1o = p1 - ray.o, p2o = p2 - ray.o;
+            float dx = ray.d[kx], dy = ray.d[ky], dz = ray.d[kz];
+            float p0x = p0o[kx], p0y = p0o[ky], p0z = p0o[kz];
+            float p1x = p1o[kx], p1y = p1o[ky], p1z = p1o[kz];
+            float p2x = p2o[kx], p2y = p2o[ky], p2z = p2o[kz];
+
+            // Shear so the ray points along +z
+            float sx = -dx / dz, sy = -dy / dz, sz = 1 / dz;
+            p0x += sx * p0z;
+            p0y += sy * p0z;
+            p1x += sx * p1z;
+            p1y += sy * p1z;
+            p2x += sx * p2z;
+            p2y += sy * p2z;
+
+            // Edge functions, falling back to double precision on exact zeros
+            float e0 = DifferenceOfProducts(p1x, p2y, p1y, p2x);
+            float e1 = DifferenceOfProducts(p2x, p0y, p2y, p0x);
+            float e2 = DifferenceOfProducts(p0x, p1y, p0y, p1x);
+            if (e0 == 0 || e1 == 0 || e2 == 0) {
+                e0 = float(double(p2x) * double(p1y) - double(p2y) * double(p1x));
+                e1 = float(double(p0x) * double(p2y) - double(p0y) * double(p2x));
+                e2 = float(double(p1x) * double(p0y) - double(p1y) * double(p0x));
+            }
+            if ((e0 < 0 || e1 < 0 || e2 < 0) && (e0 > 0 || e1 > 0 || e2 > 0))
+                return {};
+            float det = e0 + e1 + e2;
+            if (det == 0)
+                return {};
+
+            // Scaled hit distance, tested against the ray extent without dividing
+            p0z *= sz;
+            p1z *= sz;
+            p2z *= sz;
+            float tScaled = e0 * p0z + e1 * p1z + e2 * p2z;
+            if (det < 0 && (tScaled >= 0 || tScaled < tMax * det))
+                return {};
+            if (det > 0 && (tScaled <= 0 || tScaled > tMax * det))
+                return {};
+
+            float invDet = 1 / det;
+            float t = tScaled * invDet;
+
+            // Make sure t is conservatively greater than zero
+            float maxZt = std::max({std::abs(p0z), std::abs(p1z), std::abs(p2z)});
+            float deltaZ = gamma(3) * maxZt;
+            float maxXt = std::max({std::abs(p0x), std::abs(p1x), std::abs(p2x)});
+            float maxYt = std::max({std::abs(p0y), std::abs(p1y), std::abs(p2y)});
+            float deltaX = gamma(5) * (maxXt + maxZt);
+            float deltaY = gamma(5) * (maxYt + maxZt);
+            float deltaE = 2 * (gamma(2) * maxXt * maxYt + deltaY * maxXt + deltaX * maxYt);
+            float maxE = std::max({std::abs(e0), std::abs(e1), std::abs(e2)});
+            float deltaT = 3 * (gamma(3) * maxE * maxZt + deltaE * maxZt + deltaZ * maxE) * std::abs(invDet);
+            if (t <= deltaT)
+                return {};
+
+            if constexpr (!Barycentrics)
+                return TriangleIntersection{0, 0, 0, t};
+            return TriangleIntersection{e0 * invDet, e1 * invDet, e2 * invDet, t};
+        }
+    }
+
+    inline std::optional<TriangleIntersection> IntersectTriangle(const Ray &ray, float tMax, const Point3f &p0,
+                                                                 const Point3f &p1, const Point3f &p2) {
+        return detail::IntersectTriangle<true>(ray, tMax, p0, p1, p2);
+    }
+
+    // Whether the ray hits the triangle before tMax, for occlusion tests.
+    inline bool IntersectTriangleP(const Ray &ray, float tMax, const Point3f &p0, const Point3f &p1,
+                                   const Point3f &p2) {
+        return detail::IntersectTriangle<false>(ray, tMax, p0, p1, p2).has_value();
+    }
+}
+
+#endif //JADEHARE_CORE_SHAPE_TRIANGLE_H
@@ -0,0 +1,177 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_SPECTRUM_COLOR_H
+#define JADEHARE_CORE_SPECTRUM_COLOR_H
+
+#include "jadehare.h"
+#include "core/math/mathematics.h"
+#include "util/check.h"
+
+#include <array>
+
+namespace jadehare {
+
+    // RGB Definition
+    class RGB {
+    public:
+        // RGB Public Methods
+        RGB() = default;
+
+        RGB(float r, float g, float b) : r(r), g(g), b(b) {}
+
+        float operator[](int c) const {
+            DCHECK(c >= 0 && c < 3);
+            if (c == 0)
+                return r;
+            else if (c == 1)
+                return g;
+            return b;
+        }
+
+        float &operator[](int c) {
+            DCHECK(c >= 0 && c < 3);
+            if (c == 0)
+                return r;
+            else if (c == 1)
+                return g;
+            return b;
+        }
+
+        RGB &operator+=(const RGB &s) {
+            r += s.r;
+            g += s.g;
+            b += s.b;
+            return *this;
+        }
+
+        RGB operator+(const RGB &s) const { return {r + s.r, g + s.g, b + s.b}; }
+
+        RGB operator-(const RGB &s) const { return {r - s.r, g - s.g, b - s.b}; }
+
+        RGB operator*(const RGB &s) const { return {r * s.r, g * s.g, b * s.b}; }
+
+        RGB operator*(float a) const { return {a * r, a * g, a * b}; }
+
+        RGB &operator*=(const RGB &s) {
+            r *= s.r;
+            g *= s.g;
+            b *= s.b;
+            return *this;
+        }
+
+        RGB &operator*=(float a) {
+            r *= a;
+            g *= a;
+            b *= a;
+            return *this;
+        }
+
+        RGB operator/(float a) const {
+            DCHECK_NE(a, 0);
+            return {r / a, g / a, b / a};
+        }
+
+        bool operator==(const RGB &s) const { return r == s.r && g == s.g && b == s.b; }
+
+        bool operator!=(const RGB &s) const { return !(*this == s); }
+
+        bool IsBlack() const { return r == 0 && g == 0 && b == 0; }
+
+        float MaxComponentValue() const { return std::max({r, g, b}); }
+
+        float Average() const { return (r + g + b) / 3; }
+
+        float Luminance() const { return 0.2126f * r + 0.7152f * g + 0.0722f * b; }
+
+        // RGB Public Members
+        float r = 0, g = 0, b = 0;
+    };
+
+    // RGB Inline Functions
+    inline RGB operator*(float a, const RGB &s) {
+        return s * a;
+    }
+
+    inline RGB Lerp(float t, const RGB &s1, const RGB &s2) {
+        return (1 - t) * s1 + t * s2;
+    }
+
+    inline RGB ClampZero(const RGB &rgb) {
+        return {std::max<float>(0, rgb.r), std::max<float>(0, rgb.g), std::max<float>(0, rgb.b)};
+    }
+
+    inline RGB Exp(const RGB &s) {
+        return {std::exp(s.r), std::exp(s.g), std::exp(s.b)};
+    }
+
+    // XYZ Definition
+    // CIE 1931 tristimulus values.
+    struct XYZ {
+        XYZ() = default;
+
+        XYZ(float X, float Y, float Z) : X(X), Y(Y), Z(Z) {}
+
+        float X = 0, Y = 0, Z = 0;
+    };
+
+    // Linear sRGB of XYZ relative to the D65 white point.
+    inline RGB XYZToLinearSRGB(const XYZ &xyz) {
+        return {3.2404542f * xyz.X - 1.5371385f * xyz.Y - 0.4985314f * xyz.Z,
+                -0.9692660f * xyz.X + 1.8760108f * xyz.Y + 0.0415560f * xyz.Z,
+                0.0556434f * xyz.X - 0.2040259f * xyz.Y + 1.0572252f * xyz.Z};
+    }
+
+    inline XYZ LinearSRGBToXYZ(const RGB &rgb) {
+        return {0.4124564f * rgb.r + 0.3575761f * rgb.g + 0.1804375f * rgb.b,
+                0.2126729f * rgb.r + 0.7151522f * rgb.g + 0.0721750f * rgb.b,
+                0.0193339f * rgb.r + 0.1191920f * rgb.g + 0.9503041f * rgb.b};
+    }
+
+    // Linear sRGB color of a blackbody emitter, normalized to a maximum
+    // component of one.
+    inline RGB BlackbodyRGB(float T) {
+        auto planck = [T](float lambdaNm) {
+            const double c = 299792458., h = 6.62606957e-34, kb = 1.3806488e-23;
+            double l = lambdaNm * 1e-9;
+            return float((2 * h * c * c) / (std::pow(l, 5) * (std::exp((h * c) / (l * kb * T)) - 1)));
+        };
+        RGB rgb(planck(610), planck(550), planck(465));
+        float m = std::max({rgb.r, rgb.g, rgb.b});
+        return m > 0 ? rgb / m : RGB(0, 0, 0);
+    }
+
+    // sRGB Inline Functions
+    inline float SRGBToLinear(float value) {
+        if (value <= 0.04045f)
+            return value * (1 / 12.92f);
+        return std::pow((value + 0.055f) * (1 / 1.055f), 2.4f);
+    }
+
+    inline float LinearToSRGB(float value) {
+        if (value <= 0.0031308f)
+            return 12.92f * value;
+        return 1.055f * std::pow(value, 1 / 2.4f) - 0.055f;
+    }
+
+    inline float SRGB8ToLinear(uint8_t value) {
+        static const std::array<float, 256> table = [] {
+            std::array<float, 256> t{};
+            for (int i = 0; i < 256; ++i)
+                t[i] = SRGBToLinear(i / 255.f);
+            return t;
+        }();
+        return table[value];
+    }
+
+    inline uint8_t LinearToSRGB8(float value) {
+        if (value <= 0)
+            return 0;
+        if (value >= 1)
+            return 255;
+        return uint8_t(Clamp(std::round(255.f * LinearToSRGB(value)), 0, 255));
+    }
+}
+
+#endif //JADEHARE_CORE_SPECTRUM_COLOR_H
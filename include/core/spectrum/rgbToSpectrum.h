@@ -0,0 +1,164 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_SPECTRUM_RGBTOSPECTRUM_H
+#define JADEHARE_CORE_SPECTRUM_RGBTOSPECTRUM_H
+
+#include "jadehare.h"
+#include "core/math/mathematics.h"
+#include "core/spectrum/color.h"
+#include "core/spectrum/sampledSpectrum.h"
+#include "util/check.h"
+#include "util/file.h"
+#include "util/span.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jadehare {
+
+    // RGBSigmoidPolynomial Definition
+    // Smooth spectrum S(c0 lambda^2 + c1 lambda + c2), with S the sigmoid
+    // x -> 1/2 + x / (2 sqrt(1 + x^2)), which keeps it in [0, 1]
+    // (Jakob and Hanika 2019).
+    class RGBSigmoidPolynomial {
+    public:
+        // RGBSigmoidPolynomial Public Methods
+        RGBSigmoidPolynomial() = default;
+
+        RGBSigmoidPolynomial(float c0, float c1, float c2) : c0(c0), c1(c1), c2(c2) {}
+
+        float operator()(float lambda) const { return S((c0 * lambda + c1) * lambda + c2); }
+
+        // Evaluates all wavelengths at once.
+        SampledSpectrum operator()(const SampledWavelengths &lambda) const {
+            SampledSpectrum l = lambda.Lambda();
+            // Clamping keeps x^2 finite for the infinite coefficients of
+            // pure black and white
+            SampledSpectrum x = Clamp((c0 * l + SampledSpectrum(c1)) * l + SampledSpectrum(c2), -1e10f, 1e10f);
+            return SampledSpectrum(0.5f) + x / (2 * Sqrt(SampledSpectrum(1.f) + x * x));
+        }
+
+        float MaxValue() const {
+            float result = std::max((*this)(Lambda_min), (*this)(Lambda_max));
+            float lambda = -c1 / (2 * c0);
+            if (lambda >= Lambda_min && lambda <= Lambda_max)
+                result = std::max(result, (*this)(lambda));
+            return result;
+        }
+
+    private:
+        // RGBSigmoidPolynomial Private Methods
+        static float S(float x) {
+            if (IsInf(x))
+                return x > 0 ? 1 : 0;
+            return .5f + x / (2 * std::sqrt(1 + x * x));
+        }
+
+        // RGBSigmoidPolynomial Private Members
+        float c0 = 0, c1 = 0, c2 = 0;
+    };
+
+#pragma region RGB To Spectrum Table File Format
+    // An RGB-to-spectrum table (".jrsp") holds sigmoid polynomial
+    // coefficients fitted to a 3 x res^3 grid of linear sRGB colors: the
+    // first index is the largest component, the next the largest
+    // component's value at the nonuniform zNodes, and the last two the
+    // ratios of the other two components to it. Arrays start 64-byte
+    // aligned so that a mapped file is used in place.
+
+    static constexpr char RGBToSpectrumMagic[8] = {'J', 'H', 'R', 'S', 'P', '\0', '\0', '\0'};
+    static constexpr uint32_t RGBToSpectrumVersion = 1;
+
+    struct RGBToSpectrumTableHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t resolution;
+        uint64_t zNodesOffset, coefficientsOffset;
+    };
+
+#pragma endregion RGB To Spectrum Table File Format
+
+    // RGBToSpectrumTable Definition
+    // Maps reflectances in [0,1]^3 to smooth spectra that reproduce them
+    // under an equal-energy illuminant, as seen through
+    // SpectralXYZToLinearSRGB(). Only rgb2spec uses it so far: the
+    // integrator still transports RGB, and nothing in the renderer opens a
+    // table yet.
+    class RGBToSpectrumTable {
+    public:
+        // RGBToSpectrumTable Public Methods
+        static constexpr int DefaultResolution = 64;
+
+        // Throws std::runtime_error if the file is missing or malformed.
+        static std::unique_ptr<RGBToSpectrumTable> Open(const std::string &filename);
+
+        // Fits the coefficients with Gauss-Newton iterations in CIELAB, in
+        // parallel; tens of seconds per core at the default resolution.
+        static std::unique_ptr<RGBToSpectrumTable> Generate(int res = DefaultResolution);
+
+        // Throws std::runtime_error on failure.
+        void Write(const std::string &filename) const;
+
+        RGBSigmoidPolynomial operator()(const RGB &rgb) const;
+
+        int Resolution() const { return res; }
+
+    private:
+        // RGBToSpectrumTable Private Methods
+        RGBToSpectrumTable() = default;
+
+        size_t CoefficientOffset(int maxc, int z, int y, int x) const {
+            return 3 * (((size_t(maxc) * res + z) * res + y) * res + x);
+        }
+
+        // RGBToSpectrumTable Private Members
+        int res = 0;
+        span<const float> zNodes, coefficients;
+        std::vector<float> storage;
+        std::unique_ptr<MappedFile> file;
+    };
+
+    // RGBAlbedoSpectrum Definition
+    // Reflectance spectrum of an RGB color in [0,1]^3.
+    class RGBAlbedoSpectrum {
+    public:
+        RGBAlbedoSpectrum(const RGBToSpectrumTable &table, const RGB &rgb)
+                : rsp(table(RGB(Clamp(rgb.r, 0, 1), Clamp(rgb.g, 0, 1), Clamp(rgb.b, 0, 1)))) {}
+
+        float operator()(float lambda) const { return rsp(lambda); }
+
+        SampledSpectrum Sample(const SampledWavelengths &lambda) const { return rsp(lambda); }
+
+        float MaxValue() const { return rsp.MaxValue(); }
+
+    private:
+        RGBSigmoidPolynomial rsp;
+    };
+
+    // RGBUnboundedSpectrum Definition
+    // Spectrum of an arbitrary nonnegative RGB value, such as an
+    // illuminant's: a scaled reflectance spectrum.
+    class RGBUnboundedSpectrum {
+    public:
+        RGBUnboundedSpectrum(const RGBToSpectrumTable &table, const RGB &rgb) {
+            float m = rgb.MaxComponentValue();
+            scale = 2 * m;
+            rsp = table(scale > 0 ? rgb / scale : RGB(0, 0, 0));
+        }
+
+        float operator()(float lambda) const { return scale * rsp(lambda); }
+
+        SampledSpectrum Sample(const SampledWavelengths &lambda) const { return scale * rsp(lambda); }
+
+        float MaxValue() const { return scale * rsp.MaxValue(); }
+
+    private:
+        float scale = 1;
+        RGBSigmoidPolynomial rsp;
+    };
+}
+
+#endif //JADEHARE_CORE_SPECTRUM_RGBTOSPECTRUM_H
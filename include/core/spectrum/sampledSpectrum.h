@@ -0,0 +1,381 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_SPECTRUM_SAMPLEDSPECTRUM_H
+#define JADEHARE_CORE_SPECTRUM_SAMPLEDSPECTRUM_H
+
+#include "jadehare.h"
+#include "core/math/mathematics.h"
+#include "core/sampling/sampling.h"
+#include "core/spectrum/color.h"
+#include "util/check.h"
+#include "util/span.h"
+
+#include <algorithm>
+
+// Number of wavelengths carried along each path. Multiples of four map
+// each group of four samples onto one 128-bit register.
+#ifndef JADEHARE_N_SPECTRUM_SAMPLES
+#define JADEHARE_N_SPECTRUM_SAMPLES 4
+#endif
+
+#if defined(__SSE__) && JADEHARE_N_SPECTRUM_SAMPLES % 4 == 0
+#define JADEHARE_SPECTRUM_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace jadehare {
+
+    static constexpr int NSpectrumSamples = JADEHARE_N_SPECTRUM_SAMPLES;
+
+    static constexpr float Lambda_min = 360, Lambda_max = 830;
+
+#pragma region CIE Matching Functions
+    // Multi-lobe piecewise Gaussian fit of the CIE 1931 2-degree color
+    // matching functions (Wyman et al. 2013); within a few percent of the
+    // tabulated curves, and cheap enough to evaluate per sample.
+
+    namespace detail {
+        inline float PiecewiseGaussian(float lambda, float mu, float sigma1, float sigma2) {
+            float t = (lambda - mu) / (lambda < mu ? sigma1 : sigma2);
+            return std::exp(-0.5f * t * t);
+        }
+    }
+
+    inline float CIE_X(float lambda) {
+        return 1.056f * detail::PiecewiseGaussian(lambda, 599.8f, 37.9f, 31.0f) +
+               0.362f * detail::PiecewiseGaussian(lambda, 442.0f, 16.0f, 26.7f) -
+               0.065f * detail::PiecewiseGaussian(lambda, 501.1f, 20.4f, 26.2f);
+    }
+
+    inline float CIE_Y(float lambda) {
+        return 0.821f * detail::PiecewiseGaussian(lambda, 568.8f, 46.9f, 40.5f) +
+               0.286f * detail::PiecewiseGaussian(lambda, 530.9f, 16.3f, 31.1f);
+    }
+
+    inline float CIE_Z(float lambda) {
+        return 1.217f * detail::PiecewiseGaussian(lambda, 437.0f, 11.8f, 36.0f) +
+               0.681f * detail::PiecewiseGaussian(lambda, 459.0f, 26.0f, 13.8f);
+    }
+
+    // Integral of CIE_Y() over [Lambda_min, Lambda_max].
+    static constexpr float CIE_Y_integral = 106.922075f;
+
+    // Linear sRGB of XYZ computed under an equal-energy illuminant,
+    // chromatically adapted (Bradford) to D65 so that a constant spectrum
+    // of one comes out as RGB (1, 1, 1).
+    inline RGB SpectralXYZToLinearSRGB(const XYZ &xyz) {
+        return {3.1478093f * xyz.X - 1.6628462f * xyz.Y - 0.4805744f * xyz.Z,
+                -0.9947474f * xyz.X + 1.9535710f * xyz.Y + 0.0397402f * xyz.Z,
+                0.0635155f * xyz.X - 0.2145109f * xyz.Y + 1.1515952f * xyz.Z};
+    }
+
+#pragma endregion CIE Matching Functions
+
+#pragma region SIMD Lane Operations
+
+    namespace detail {
+        // Each operation has a 128-bit form used for groups of four samples
+        // and a scalar form for builds without SSE.
+        struct SpectrumAdd {
+#if defined(JADEHARE_SPECTRUM_SSE)
+            __m128 operator()(__m128 a, __m128 b) const { return _mm_add_ps(a, b); }
+#endif
+            float operator()(float a, float b) const { return a + b; }
+        };
+
+        struct SpectrumSub {
+#if defined(JADEHARE_SPECTRUM_SSE)
+            __m128 operator()(__m128 a, __m128 b) const { return _mm_sub_ps(a, b); }
+#endif
+            float operator()(float a, float b) const { return a - b; }
+        };
+
+        struct SpectrumMul {
+#if defined(JADEHARE_SPECTRUM_SSE)
+            __m128 operator()(__m128 a, __m128 b) const { return _mm_mul_ps(a, b); }
+#endif
+            float operator()(float a, float b) const { return a * b; }
+        };
+
+        struct SpectrumDiv {
+#if defined(JADEHARE_SPECTRUM_SSE)
+            __m128 operator()(__m128 a, __m128 b) const { return _mm_div_ps(a, b); }
+#endif
+            float operator()(float a, float b) const { return a / b; }
+        };
+
+        // a / b, or zero where b is zero
+        struct SpectrumSafeDiv {
+#if defined(JADEHARE_SPECTRUM_SSE)
+            __m128 operator()(__m128 a, __m128 b) const {
+                return _mm_and_ps(_mm_div_ps(a, b), _mm_cmpneq_ps(b, _mm_setzero_ps()));
+            }
+#endif
+            float operator()(float a, float b) const { return b != 0 ? a / b : 0; }
+        };
+
+        struct SpectrumMin {
+#if defined(JADEHARE_SPECTRUM_SSE)
+            __m128 operator()(__m128 a, __m128 b) const { return _mm_min_ps(a, b); }
+#endif
+            float operator()(float a, float b) const { return std::min(a, b); }
+        };
+
+        struct SpectrumMax {
+#if defined(JADEHARE_SPECTRUM_SSE)
+            __m128 operator()(__m128 a, __m128 b) const { return _mm_max_ps(a, b); }
+#endif
+            float operator()(float a, float b) const { return std::max(a, b); }
+        };
+
+        struct SpectrumSqrt {
+#if defined(JADEHARE_SPECTRUM_SSE)
+            __m128 operator()(__m128 a) const { return _mm_sqrt_ps(a); }
+#endif
+            float operator()(float a) const { return std::sqrt(a); }
+        };
+    }
+
+#pragma endregion SIMD Lane Operations
+
+    // SampledSpectrum Definition
+    // Spectral quantity at the NSpectrumSamples wavelengths of a
+    // SampledWavelengths. Arithmetic is lane-wise; with SSE each group of
+    // four samples is one register load, operation and store.
+    class alignas(16) SampledSpectrum {
+    public:
+        // SampledSpectrum Public Methods
+        SampledSpectrum() = default;
+
+        explicit SampledSpectrum(float c) { std::fill(values, values + NSpectrumSamples, c); }
+
+        explicit SampledSpectrum(span<const float> v) {
+            DCHECK_EQ(v.size(), NSpectrumSamples);
+            std::copy(v.begin(), v.end(), values);
+        }
+
+        float operator[](int i) const {
+            DCHECK(i >= 0 && i < NSpectrumSamples);
+            return values[i];
+        }
+
+        float &operator[](int i) {
+            DCHECK(i >= 0 && i < NSpectrumSamples);
+            return values[i];
+        }
+
+        // True if any sample is nonzero.
+        explicit operator bool() const {
+#if defined(JADEHARE_SPECTRUM_SSE)
+            for (int i = 0; i < NSpectrumSamples; i += 4)
+                if (_mm_movemask_ps(_mm_cmpneq_ps(_mm_load_ps(&values[i]), _mm_setzero_ps())))
+                    return true;
+            return false;
+#else
+            for (int i = 0; i < NSpectrumSamples; ++i)
+                if (values[i] != 0)
+                    return true;
+            return false;
+#endif
+        }
+
+        SampledSpectrum &operator+=(const SampledSpectrum &s) { return Apply(s, detail::SpectrumAdd()); }
+
+        SampledSpectrum &operator-=(const SampledSpectrum &s) { return Apply(s, detail::SpectrumSub()); }
+
+        SampledSpectrum &operator*=(const SampledSpectrum &s) { return Apply(s, detail::SpectrumMul()); }
+
+        SampledSpectrum &operator/=(const SampledSpectrum &s) { return Apply(s, detail::SpectrumDiv()); }
+
+        SampledSpectrum &operator*=(float a) { return Apply(SampledSpectrum(a), detail::SpectrumMul()); }
+
+        SampledSpectrum &operator/=(float a) {
+            DCHECK_NE(a, 0);
+            return Apply(SampledSpectrum(1 / a), detail::SpectrumMul());
+        }
+
+        SampledSpectrum operator+(const SampledSpectrum &s) const { return SampledSpectrum(*this) += s; }
+
+        SampledSpectrum operator-(const SampledSpectrum &s) const { return SampledSpectrum(*this) -= s; }
+
+        SampledSpectrum operator*(const SampledSpectrum &s) const { return SampledSpectrum(*this) *= s; }
+
+        SampledSpectrum operator/(const SampledSpectrum &s) const { return SampledSpectrum(*this) /= s; }
+
+        SampledSpectrum operator*(float a) const { return SampledSpectrum(*this) *= a; }
+
+        SampledSpectrum operator/(float a) const { return SampledSpectrum(*this) /= a; }
+
+        SampledSpectrum operator-() const { return SampledSpectrum(0.f) - *this; }
+
+        bool operator==(const SampledSpectrum &s) const { return std::equal(values, values + NSpectrumSamples, s.values); }
+
+        bool operator!=(const SampledSpectrum &s) const { return !(*this == s); }
+
+        float MinComponentValue() const { return *std::min_element(values, values + NSpectrumSamples); }
+
+        float MaxComponentValue() const { return *std::max_element(values, values + NSpectrumSamples); }
+
+        float Average() const {
+            float sum = 0;
+            for (int i = 0; i < NSpectrumSamples; ++i)
+                sum += values[i];
+            return sum / NSpectrumSamples;
+        }
+
+        // Monte Carlo estimates over the sampled wavelengths.
+        XYZ ToXYZ(const SampledWavelengths &lambda) const;
+
+        float y(const SampledWavelengths &lambda) const;
+
+        RGB ToRGB(const SampledWavelengths &lambda) const { return SpectralXYZToLinearSRGB(ToXYZ(lambda)); }
+
+        // Lane-wise op(*this, s) in place, with op taking either __m128 or
+        // float arguments; see the detail:: operations above.
+        template<typename Op>
+        SampledSpectrum &Apply(const SampledSpectrum &s, Op op) {
+#if defined(JADEHARE_SPECTRUM_SSE)
+            for (int i = 0; i < NSpectrumSamples; i += 4)
+                _mm_store_ps(&values[i], op(_mm_load_ps(&values[i]), _mm_load_ps(&s.values[i])));
+#else
+            for (int i = 0; i < NSpectrumSamples; ++i)
+                values[i] = op(values[i], s.values[i]);
+#endif
+            return *this;
+        }
+
+        template<typename Op>
+        SampledSpectrum &Apply(Op op) {
+#if defined(JADEHARE_SPECTRUM_SSE)
+            for (int i = 0; i < NSpectrumSamples; i += 4)
+                _mm_store_ps(&values[i], op(_mm_load_ps(&values[i])));
+#else
+            for (int i = 0; i < NSpectrumSamples; ++i)
+                values[i] = op(values[i]);
+#endif
+            return *this;
+        }
+
+    private:
+        // SampledSpectrum Private Members
+        float values[NSpectrumSamples] = {};
+    };
+
+    // SampledSpectrum Inline Functions
+    inline SampledSpectrum operator*(float a, const SampledSpectrum &s) { return s * a; }
+
+    inline SampledSpectrum SafeDiv(SampledSpectrum a, const SampledSpectrum &b) {
+        return a.Apply(b, detail::SpectrumSafeDiv());
+    }
+
+    inline SampledSpectrum Sqrt(SampledSpectrum s) { return s.Apply(detail::SpectrumSqrt()); }
+
+    inline SampledSpectrum Clamp(SampledSpectrum s, float low, float high) {
+        return s.Apply(SampledSpectrum(low), detail::SpectrumMax()).Apply(SampledSpectrum(high), detail::SpectrumMin());
+    }
+
+    inline SampledSpectrum ClampZero(SampledSpectrum s) { return s.Apply(SampledSpectrum(0.f), detail::SpectrumMax()); }
+
+    inline SampledSpectrum Exp(const SampledSpectrum &s) {
+        SampledSpectrum e;
+        for (int i = 0; i < NSpectrumSamples; ++i)
+            e[i] = std::exp(s[i]);
+        return e;
+    }
+
+    inline SampledSpectrum Lerp(float t, const SampledSpectrum &s1, const SampledSpectrum &s2) {
+        return (1 - t) * s1 + t * s2;
+    }
+
+    // SampledWavelengths Definition
+    // The wavelengths a path carries and the densities they were sampled
+    // with. Dispersion keeps only the first wavelength, after which the
+    // others have zero density.
+    class SampledWavelengths {
+    public:
+        // SampledWavelengths Public Methods
+        // Stratified uniform wavelengths: u picks the first one and the rest
+        // are spaced evenly, wrapping around the range.
+        static SampledWavelengths SampleUniform(float u, float lambda_min = Lambda_min,
+                                                float lambda_max = Lambda_max) {
+            SampledWavelengths swl;
+            swl.lambda[0] = Lerp(u, lambda_min, lambda_max);
+            float delta = (lambda_max - lambda_min) / NSpectrumSamples;
+            for (int i = 1; i < NSpectrumSamples; ++i) {
+                swl.lambda[i] = swl.lambda[i - 1] + delta;
+                if (swl.lambda[i] > lambda_max)
+                    swl.lambda[i] = lambda_min + (swl.lambda[i] - lambda_max);
+            }
+            for (int i = 0; i < NSpectrumSamples; ++i)
+                swl.pdf[i] = 1 / (lambda_max - lambda_min);
+            return swl;
+        }
+
+        // Stratified wavelengths importance sampled by VisibleWavelengthsPDF().
+        static SampledWavelengths SampleVisible(float u) {
+            SampledWavelengths swl;
+            for (int i = 0; i < NSpectrumSamples; ++i) {
+                float up = u + float(i) / NSpectrumSamples;
+                if (up > 1)
+                    up -= 1;
+                swl.lambda[i] = SampleVisibleWavelengths(up);
+                swl.pdf[i] = VisibleWavelengthsPDF(swl.lambda[i]);
+            }
+            return swl;
+        }
+
+        float operator[](int i) const { return lambda[i]; }
+
+        float &operator[](int i) { return lambda[i]; }
+
+        // The wavelengths as a spectrum, for evaluating functions of
+        // wavelength lane-wise.
+        SampledSpectrum Lambda() const { return SampledSpectrum(lambda); }
+
+        SampledSpectrum PDF() const { return SampledSpectrum(pdf); }
+
+        void TerminateSecondary() {
+            if (SecondaryTerminated())
+                return;
+            for (int i = 1; i < NSpectrumSamples; ++i)
+                pdf[i] = 0;
+            pdf[0] /= NSpectrumSamples;
+        }
+
+        bool SecondaryTerminated() const {
+            for (int i = 1; i < NSpectrumSamples; ++i)
+                if (pdf[i] != 0)
+                    return false;
+            return true;
+        }
+
+    private:
+        // SampledWavelengths Private Members
+        alignas(16) float lambda[NSpectrumSamples] = {};
+        alignas(16) float pdf[NSpectrumSamples] = {};
+    };
+
+    // SampledSpectrum Inline Method Definitions
+    inline XYZ SampledSpectrum::ToXYZ(const SampledWavelengths &lambda) const {
+        SampledSpectrum X, Y, Z;
+        for (int i = 0; i < NSpectrumSamples; ++i) {
+            X[i] = CIE_X(lambda[i]);
+            Y[i] = CIE_Y(lambda[i]);
+            Z[i] = CIE_Z(lambda[i]);
+        }
+        SampledSpectrum s = SafeDiv(*this, lambda.PDF());
+        return {(X * s).Average() / CIE_Y_integral, (Y * s).Average() / CIE_Y_integral,
+                (Z * s).Average() / CIE_Y_integral};
+    }
+
+    inline float SampledSpectrum::y(const SampledWavelengths &lambda) const {
+        SampledSpectrum Y;
+        for (int i = 0; i < NSpectrumSamples; ++i)
+            Y[i] = CIE_Y(lambda[i]);
+        return (Y * SafeDiv(*this, lambda.PDF())).Average() / CIE_Y_integral;
+    }
+}
+
+#endif //JADEHARE_CORE_SPECTRUM_SAMPLEDSPECTRUM_H
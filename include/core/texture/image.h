@@ -0,0 +1,103 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_TEXTURE_IMAGE_H
+#define JADEHARE_CORE_TEXTURE_IMAGE_H
+
+#include "jadehare.h"
+#include "core/math/bounds.h"
+#include "core/math/point.h"
+#include "core/spectrum/color.h"
+#include "util/check.h"
+
+#include <string>
+#include <vector>
+
+namespace jadehare {
+
+    // TexelFormat Definition
+    enum class TexelFormat : uint8_t {
+        U256, Float
+    };
+
+    inline int TexelBytes(TexelFormat format) {
+        return format == TexelFormat::U256 ? 1 : 4;
+    }
+
+    // Image Definition
+    // A dense, in-memory image with 8-bit (optionally sRGB-encoded) or
+    // 32-bit float channels. Channel accessors always work in linear space.
+    class Image {
+    public:
+        // Image Public Methods
+        Image() = default;
+
+        Image(Point2i resolution, int nChannels, TexelFormat format = TexelFormat::Float, bool sRGB = false);
+
+        // Reads PNG, EXR or PFM files; throws std::runtime_error on failure.
+        static Image Read(const std::string &filename);
+
+        // Writes PNG (8-bit sRGB), EXR or PFM files according to the
+        // extension; throws std::runtime_error on failure.
+        void Write(const std::string &filename) const;
+
+        Point2i Resolution() const { return resolution; }
+
+        int NChannels() const { return nChannels; }
+
+        TexelFormat Format() const { return format; }
+
+        bool IsSRGB() const { return sRGB; }
+
+        size_t BytesUsed() const { return p8.size() + sizeof(float) * p32.size(); }
+
+        size_t PixelOffset(Point2i p) const {
+            DCHECK(Inside(p, Bounds2i(Point2i(0, 0), resolution)));
+            return nChannels * (size_t(p.y) * resolution.x + p.x);
+        }
+
+        float GetChannel(Point2i p, int c) const {
+            size_t offset = PixelOffset(p) + c;
+            if (format == TexelFormat::U256)
+                return sRGB ? SRGB8ToLinear(p8[offset]) : p8[offset] / 255.f;
+            return p32[offset];
+        }
+
+        void SetChannel(Point2i p, int c, float value) {
+            size_t offset = PixelOffset(p) + c;
+            if (format == TexelFormat::U256)
+                p8[offset] = sRGB ? LinearToSRGB8(value) : uint8_t(Clamp(std::round(value * 255.f), 0, 255));
+            else
+                p32[offset] = value;
+        }
+
+        RGB GetRGB(Point2i p) const {
+            return {GetChannel(p, 0), GetChannel(p, std::min(1, nChannels - 1)),
+                    GetChannel(p, std::min(2, nChannels - 1))};
+        }
+
+        const void *RawPointer(Point2i p) const {
+            if (format == TexelFormat::U256)
+                return p8.data() + PixelOffset(p);
+            return p32.data() + PixelOffset(p);
+        }
+
+        Image ConvertToFormat(TexelFormat newFormat, bool newSRGB) const;
+
+        // Returns the image followed by successively box-filtered halvings
+        // down to 1x1, all in float; filtering happens in linear space.
+        std::vector<Image> GeneratePyramid() const;
+
+    private:
+        // Image Private Members
+        Point2i resolution;
+        int nChannels = 0;
+        TexelFormat format = TexelFormat::Float;
+        bool sRGB = false;
+        std::vector<uint8_t> p8;
+        std::vector<float> p32;
+    };
+}
+
+#endif //JADEHARE_CORE_TEXTURE_IMAGE_H
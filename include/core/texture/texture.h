@@ -0,0 +1,99 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_TEXTURE_TEXTURE_H
+#define JADEHARE_CORE_TEXTURE_TEXTURE_H
+
+#include "jadehare.h"
+#include "core/math/mathematics.h"
+#include "core/math/normal.h"
+#include "core/math/point.h"
+#include "core/math/ray.h"
+#include "core/math/vector.h"
+#include "core/texture/textureCache.h"
+
+namespace jadehare {
+
+    // TextureEvalContext Definition
+    struct TextureEvalContext {
+        Point3f p;
+        Vector3f dpdx, dpdy;
+        Normal3f n;
+        Point2f uv;
+        float dudx = 0, dudy = 0, dvdx = 0, dvdy = 0;
+    };
+
+    // Estimates the screen-space derivatives of $(u,v)$ from those of the
+    // surface position, solving for them in the least-squares sense.
+    inline void ComputeDifferentials(const Vector3f &dpdx, const Vector3f &dpdy, const Vector3f &dpdu,
+                                     const Vector3f &dpdv, TextureEvalContext *ctx) {
+        ctx->dpdx = dpdx;
+        ctx->dpdy = dpdy;
+
+        // Estimate screen-space change in $(u,v)$
+        float ata00 = Dot(dpdu, dpdu), ata01 = Dot(dpdu, dpdv), ata11 = Dot(dpdv, dpdv);
+        float invDet = 1 / DifferenceOfProducts(ata00, ata11, ata01, ata01);
+        invDet = IsFinite(invDet) ? invDet : 0.f;
+        float atb0x = Dot(dpdu, ctx->dpdx), atb1x = Dot(dpdv, ctx->dpdx);
+        float atb0y = Dot(dpdu, ctx->dpdy), atb1y = Dot(dpdv, ctx->dpdy);
+        ctx->dudx = DifferenceOfProducts(ata11, atb0x, ata01, atb1x) * invDet;
+        ctx->dvdx = DifferenceOfProducts(ata00, atb1x, ata01, atb0x) * invDet;
+        ctx->dudy = DifferenceOfProducts(ata11, atb0y, ata01, atb1y) * invDet;
+        ctx->dvdy = DifferenceOfProducts(ata00, atb1y, ata01, atb0y) * invDet;
+
+        // Clamp derivatives of $u$ and $v$ to reasonable values
+        ctx->dudx = IsFinite(ctx->dudx) ? Clamp(ctx->dudx, -1e8f, 1e8f) : 0.f;
+        ctx->dvdx = IsFinite(ctx->dvdx) ? Clamp(ctx->dvdx, -1e8f, 1e8f) : 0.f;
+        ctx->dudy = IsFinite(ctx->dudy) ? Clamp(ctx->dudy, -1e8f, 1e8f) : 0.f;
+        ctx->dvdy = IsFinite(ctx->dvdy) ? Clamp(ctx->dvdy, -1e8f, 1e8f) : 0.f;
+    }
+
+    // Estimates the screen-space derivatives of the surface position and
+    // $(u,v)$ at _p_ by intersecting the offset rays of _ray_ with the
+    // tangent plane, then solving for $(u,v)$ in the least-squares sense.
+    inline void ComputeDifferentials(const RayDifferential &ray, const Point3f &p, const Normal3f &n,
+                                     const Vector3f &dpdu, const Vector3f &dpdv, TextureEvalContext *ctx) {
+        ctx->p = p;
+        ctx->n = n;
+        Vector3f nv(n), dpdx(0, 0, 0), dpdy(0, 0, 0);
+        if (ray.hasDifferentials && Dot(nv, ray.rxDirection) != 0 && Dot(nv, ray.ryDirection) != 0) {
+            // Estimate screen-space change in $\pt{}$ using ray differentials
+            float d = -Dot(nv, Vector3f(p));
+            float tx = (-Dot(nv, Vector3f(ray.rxOrigin)) - d) / Dot(nv, ray.rxDirection);
+            Point3f px = ray.rxOrigin + tx * ray.rxDirection;
+            float ty = (-Dot(nv, Vector3f(ray.ryOrigin)) - d) / Dot(nv, ray.ryDirection);
+            Point3f py = ray.ryOrigin + ty * ray.ryDirection;
+            dpdx = px - p;
+            dpdy = py - p;
+        }
+        ComputeDifferentials(dpdx, dpdy, dpdu, dpdv, ctx);
+    }
+
+    // ImageTexture Definition
+    // An RGB texture whose texels come from a TextureCache; only the tiles
+    // and MIP levels that lookups actually reach are ever loaded.
+    class ImageTexture {
+    public:
+        // ImageTexture Public Methods
+        ImageTexture(TextureCache *cache, int textureId, float scale = 1, bool invert = false)
+                : mipmap(cache, textureId), scale(scale), invert(invert) {}
+
+        RGB Evaluate(const TextureEvalContext &ctx) const {
+            // Flip $t$ so that $v=0$ is the bottom of the image, as in pbrt
+            Point2f st(ctx.uv.x, 1 - ctx.uv.y);
+            Vector2f dst0(ctx.dudx, -ctx.dvdx), dst1(ctx.dudy, -ctx.dvdy);
+            // Wrap $(s,t)$ into $[0,1)^2$ for repeating textures
+            st = Point2f(st.x - std::floor(st.x), st.y - std::floor(st.y));
+            RGB rgb = scale * mipmap.Filter(st, dst0, dst1);
+            return invert ? ClampZero(RGB(1, 1, 1) - rgb) : rgb;
+        }
+
+    private:
+        CachedMIPMap mipmap;
+        float scale;
+        bool invert;
+    };
+}
+
+#endif //JADEHARE_CORE_TEXTURE_TEXTURE_H
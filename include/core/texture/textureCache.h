@@ -0,0 +1,190 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_TEXTURE_TEXTURECACHE_H
+#define JADEHARE_CORE_TEXTURE_TEXTURECACHE_H
+
+#include "jadehare.h"
+#include "core/math/point.h"
+#include "core/spectrum/color.h"
+#include "core/texture/image.h"
+#include "util/check.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace jadehare {
+
+    // TiledTextureDesc Definition
+    // Describes a MIP pyramid stored as square tiles of _tileSize^2_
+    // texels; tiles on the right and bottom edges of a level are padded.
+    struct TiledTextureDesc {
+        std::string name;
+        std::vector<Point2i> levelResolution;
+        int nChannels = 3;
+        int tileSize = 64;
+        TexelFormat format = TexelFormat::U256;
+        // Whether U256 texels are sRGB-encoded.
+        bool sRGB = true;
+
+        // Reads tile _tile_ of MIP level _level_ into _dst_, which holds
+        // TileBytes() bytes. Called concurrently from render threads.
+        std::function<bool(int level, Point2i tile, void *dst)> loadTile;
+
+        int Levels() const { return int(levelResolution.size()); }
+
+        size_t TileBytes() const {
+            return size_t(tileSize) * tileSize * nChannels * TexelBytes(format);
+        }
+
+        Point2i TileCount(int level) const {
+            const Point2i &res = levelResolution[level];
+            return {(res.x + tileSize - 1) / tileSize, (res.y + tileSize - 1) / tileSize};
+        }
+    };
+
+    // TextureCache Definition
+    // A fixed-size pool of tile slots shared by all textures. Lookups hash
+    // the tile key to one of a set of independently locked shards, each
+    // of which owns a slice of the pool and evicts with the clock
+    // (second-chance) algorithm. Tiles are pinned while a caller reads
+    // from them, so eviction never pulls memory out from under a lookup.
+    class TextureCache {
+        struct TileSlot;
+    public:
+        // TileHandle Definition
+        class TileHandle {
+        public:
+            TileHandle() = default;
+
+            explicit TileHandle(TileSlot *slot) : slot(slot) {}
+
+            TileHandle(TileHandle &&h) noexcept : slot(h.slot) { h.slot = nullptr; }
+
+            TileHandle &operator=(TileHandle &&h) noexcept {
+                std::swap(slot, h.slot);
+                return *this;
+            }
+
+            TileHandle(const TileHandle &) = delete;
+
+            TileHandle &operator=(const TileHandle &) = delete;
+
+            ~TileHandle() {
+                if (slot)
+                    slot->pins.fetch_sub(1, std::memory_order_release);
+            }
+
+            explicit operator bool() const { return slot != nullptr; }
+
+            const uint8_t *Data() const { return slot->data; }
+
+            uint64_t Key() const { return slot->key; }
+
+        private:
+            TileSlot *slot = nullptr;
+        };
+
+        // TextureCache Public Methods
+        TextureCache(size_t maxBytes, size_t tileBytes = 64 * 64 * 4 * sizeof(float), int nShards = 64);
+
+        ~TextureCache();
+
+        TextureCache(const TextureCache &) = delete;
+
+        TextureCache &operator=(const TextureCache &) = delete;
+
+        // Textures must all be added before the first lookup: the texture
+        // table is read without locking, so AddTexture() may not run
+        // concurrently with any other method.
+        int AddTexture(TiledTextureDesc desc);
+
+        const TiledTextureDesc &Texture(int textureId) const { return *textures[textureId]; }
+
+        // Returns a pinned handle to the given tile, loading it (and
+        // evicting another one) if it isn't resident.
+        TileHandle Acquire(int textureId, int level, Point2i tile);
+
+        // Looks up texel _st_ (in texels) of the given level, with clamp addressing.
+        RGB Texel(int textureId, int level, Point2i st);
+
+        RGB Bilerp(int textureId, int level, Point2f st);
+
+        size_t MaxBytes() const { return nSlots * slotBytes; }
+
+        size_t ResidentTiles() const;
+
+        static uint64_t TileKey(int textureId, int level, Point2i tile) {
+            DCHECK(level < 64 && tile.x < (1 << 20) && tile.y < (1 << 20));
+            return (uint64_t(textureId) << 46) | (uint64_t(level) << 40) |
+                   (uint64_t(tile.y) << 20) | uint64_t(tile.x);
+        }
+
+    private:
+        // TextureCache Private Declarations
+        enum class SlotState : uint8_t {
+            Empty, Loading, Ready
+        };
+
+        struct TileSlot {
+            uint64_t key = 0;
+            uint8_t *data = nullptr;
+            std::atomic<int> pins{0};
+            std::atomic<bool> referenced{false};
+            std::atomic<SlotState> state{SlotState::Empty};
+        };
+
+        struct alignas(64) Shard {
+            std::mutex mutex;
+            std::unordered_map<uint64_t, TileSlot *> map;
+            TileSlot *slots = nullptr;
+            int nSlots = 0;
+            int clockHand = 0;
+        };
+
+        // TextureCache Private Methods
+        TileSlot *FindVictim(Shard &shard);
+
+        RGB DecodeTexel(const TiledTextureDesc &desc, const uint8_t *tileData, Point2i inTile) const;
+
+        // TextureCache Private Members
+        size_t slotBytes;
+        int nSlots;
+        std::vector<Shard> shards;
+        std::unique_ptr<TileSlot[]> slots;
+        uint8_t *pool = nullptr;
+        std::vector<std::unique_ptr<TiledTextureDesc>> textures;
+    };
+
+    // CachedMIPMap Definition
+    // Filtered lookups into a texture that lives in a TextureCache. The
+    // MIP level comes from the screen-space footprint of the lookup, so
+    // distant or minified surfaces only ever touch coarse levels.
+    class CachedMIPMap {
+    public:
+        // CachedMIPMap Public Methods
+        CachedMIPMap(TextureCache *cache, int textureId) : cache(cache), textureId(textureId) {}
+
+        int Levels() const { return cache->Texture(textureId).Levels(); }
+
+        // Returns the (continuous) MIP level for a filter footprint given
+        // by the $(s,t)$ derivatives in $[0,1]^2$ texture space.
+        float Level(Vector2f dst0, Vector2f dst1) const;
+
+        RGB Filter(Point2f st, Vector2f dst0, Vector2f dst1) const;
+
+        RGB Bilerp(int level, Point2f st) const;
+
+    private:
+        TextureCache *cache;
+        int textureId;
+    };
+}
+
+#endif //JADEHARE_CORE_TEXTURE_TEXTURECACHE_H
@@ -0,0 +1,114 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_TEXTURE_TILEDTEXTURE_H
+#define JADEHARE_CORE_TEXTURE_TILEDTEXTURE_H
+
+#include "jadehare.h"
+#include "core/math/point.h"
+#include "core/texture/image.h"
+#include "core/texture/textureCache.h"
+#include "util/file.h"
+
+#include <memory>
+#include <string>
+
+namespace jadehare {
+
+#pragma region Tiled Texture File Format
+    // A tiled texture file (".jtx") is a page-aligned, pre-filtered MIP
+    // pyramid that is used in place through mmap:
+    //
+    //   page 0       TiledTextureHeader
+    //   then         the tiles of level 0 in row-major order, then level 1, ...
+    //
+    // Every tile starts on a page boundary and occupies _tileStride_ bytes,
+    // so a tile read faults in exactly the pages holding its texels. Tiles
+    // on the right and bottom edges replicate the last texel into their
+    // padding. All values are little-endian.
+
+    static constexpr char TiledTextureMagic[8] = {'J', 'H', 'T', 'I', 'L', 'E', 'D', '\0'};
+    static constexpr uint32_t TiledTextureVersion = 1;
+    static constexpr int TiledTextureMaxLevels = 32;
+    static constexpr uint32_t TiledTexturePageSize = 4096;
+    static constexpr uint32_t TiledTextureMaxTileSize = 4096;
+
+    struct TiledTextureLevel {
+        int32_t width, height;
+        int32_t tilesX, tilesY;
+        uint64_t firstTileOffset;
+    };
+
+    struct TiledTextureHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t pageSize;
+        uint32_t nChannels;
+        uint32_t format;
+        uint32_t sRGB;
+        uint32_t tileSize;
+        uint32_t nLevels;
+        uint32_t reserved;
+        uint64_t tileStride;
+        TiledTextureLevel levels[TiledTextureMaxLevels];
+    };
+
+    static_assert(sizeof(TiledTextureHeader) <= TiledTexturePageSize, "Tiled texture header must fit in one page");
+
+#pragma endregion Tiled Texture File Format
+
+    // TiledTextureConversionOptions Definition
+    struct TiledTextureConversionOptions {
+        int tileSize = 64;
+        // U256 stores sRGB-encoded 8-bit texels; Float keeps full range.
+        TexelFormat format = TexelFormat::U256;
+        // Drop the alpha channel of RGBA images.
+        bool dropAlpha = true;
+    };
+
+    // Pre-filters _image_ into a MIP pyramid and writes it to _filename_ in
+    // the tiled format. Throws std::runtime_error on failure.
+    void WriteTiledTexture(const Image &image, const std::string &filename,
+                           const TiledTextureConversionOptions &options = {});
+
+    // Convenience wrapper: reads any format Image::Read() supports.
+    void ConvertToTiledTexture(const std::string &inFilename, const std::string &outFilename,
+                               const TiledTextureConversionOptions &options = {});
+
+    // TiledTextureFile Definition
+    // A memory-mapped tiled texture. Nothing is decoded at load time:
+    // opening the file only validates the header.
+    class TiledTextureFile {
+    public:
+        // TiledTextureFile Public Methods
+        static std::unique_ptr<TiledTextureFile> Open(const std::string &filename);
+
+        const TiledTextureHeader &Header() const { return *header; }
+
+        int Levels() const { return int(header->nLevels); }
+
+        Point2i LevelResolution(int level) const {
+            return {header->levels[level].width, header->levels[level].height};
+        }
+
+        // Returns a pointer to the texels of the given tile, directly in the mapping.
+        const uint8_t *Tile(int level, Point2i tile) const {
+            const TiledTextureLevel &l = header->levels[level];
+            DCHECK(tile.x >= 0 && tile.x < l.tilesX && tile.y >= 0 && tile.y < l.tilesY);
+            return file->Data() + l.firstTileOffset + (size_t(tile.y) * l.tilesX + tile.x) * header->tileStride;
+        }
+
+        // Describes the texture for a TextureCache; tile loads copy out of
+        // the mapping, so this object must outlive the cache entry.
+        TiledTextureDesc Desc() const;
+
+    private:
+        TiledTextureFile() = default;
+
+        std::unique_ptr<MappedFile> file;
+        const TiledTextureHeader *header = nullptr;
+    };
+}
+
+#endif //JADEHARE_CORE_TEXTURE_TILEDTEXTURE_H
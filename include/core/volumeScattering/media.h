@@ -0,0 +1,428 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_VOLUMESCATTERING_MEDIA_H
+#define JADEHARE_CORE_VOLUMESCATTERING_MEDIA_H
+
+#include "jadehare.h"
+#include "core/math/bounds.h"
+#include "core/math/ray.h"
+#include "core/math/transform.h"
+#include "core/sampling/sampling.h"
+#include "core/spectrum/color.h"
+#include "core/volumeScattering/medium.h"
+#include "util/check.h"
+#include "util/rng.h"
+#include "util/span.h"
+
+#include <optional>
+#include <variant>
+#include <vector>
+
+namespace jadehare {
+
+#pragma region Phase Function
+
+    // PhaseFunctionSample Definition
+    struct PhaseFunctionSample {
+        float p;
+        Vector3f wi;
+        float pdf;
+    };
+
+    // HGPhaseFunction Definition
+    class HGPhaseFunction {
+    public:
+        // HGPhaseFunction Public Methods
+        HGPhaseFunction() = default;
+
+        explicit HGPhaseFunction(float g) : g(g) {}
+
+        float p(const Vector3f &wo, const Vector3f &wi) const { return HenyeyGreenstein(Dot(wo, wi), g); }
+
+        // Sampling is exact, so the returned weight p / pdf is always one.
+        std::optional<PhaseFunctionSample> Sample_p(const Vector3f &wo, const Point2f &u) const {
+            float pdf;
+            Vector3f wi = SampleHenyeyGreenstein(wo, g, u, &pdf);
+            return PhaseFunctionSample{pdf, wi, pdf};
+        }
+
+        float PDF(const Vector3f &wo, const Vector3f &wi) const { return p(wo, wi); }
+
+    private:
+        // HGPhaseFunction Private Members
+        float g = 0;
+    };
+
+#pragma endregion Phase Function
+
+#pragma region Majorants
+
+    // MediumProperties Definition
+    struct MediumProperties {
+        RGB sigma_a, sigma_s;
+        HGPhaseFunction phase;
+        RGB Le;
+    };
+
+    // RayMajorantSegment Definition
+    // Ray interval over which sigma_maj bounds the medium's sigma_t.
+    struct RayMajorantSegment {
+        float tMin, tMax;
+        RGB sigma_maj;
+    };
+
+    // HomogeneousMajorantIterator Definition
+    // A single segment; default constructed it yields nothing, which is
+    // what a ray that misses a medium's bounds gets.
+    class HomogeneousMajorantIterator {
+    public:
+        // HomogeneousMajorantIterator Public Methods
+        HomogeneousMajorantIterator() : called(true) {}
+
+        HomogeneousMajorantIterator(float tMin, float tMax, const RGB &sigma_maj)
+                : seg{tMin, tMax, sigma_maj}, called(false) {}
+
+        std::optional<RayMajorantSegment> Next() {
+            if (called)
+                return {};
+            called = true;
+            return seg;
+        }
+
+    private:
+        // HomogeneousMajorantIterator Private Members
+        RayMajorantSegment seg;
+        bool called;
+    };
+
+    // SampledGrid Definition
+    // Values at the cell centers of an nx x ny x nz lattice over [0,1]^3,
+    // reconstructed trilinearly; zero outside. The values are a view, which
+    // may point into the scene cache.
+    class SampledGrid {
+    public:
+        // SampledGrid Public Methods
+        SampledGrid() = default;
+
+        SampledGrid(span<const float> values, int nx, int ny, int nz)
+                : values(values), nx(nx), ny(ny), nz(nz) {
+            DCHECK_EQ(values.size(), size_t(nx) * ny * nz);
+        }
+
+        float Lookup(int x, int y, int z) const {
+            if (x < 0 || x >= nx || y < 0 || y >= ny || z < 0 || z >= nz)
+                return 0;
+            return values[(size_t(z) * ny + y) * nx + x];
+        }
+
+        float Lookup(const Point3f &p) const {
+            // Compute the sample cell containing p and the offsets within it
+            float px = p.x * nx - .5f, py = p.y * ny - .5f, pz = p.z * nz - .5f;
+            int ix = int(std::floor(px)), iy = int(std::floor(py)), iz = int(std::floor(pz));
+            float dx = px - ix, dy = py - iy, dz = pz - iz;
+
+            // Trilinearly interpolate the eight neighboring samples
+            float d00 = Lerp(dx, Lookup(ix, iy, iz), Lookup(ix + 1, iy, iz));
+            float d10 = Lerp(dx, Lookup(ix, iy + 1, iz), Lookup(ix + 1, iy + 1, iz));
+            float d01 = Lerp(dx, Lookup(ix, iy, iz + 1), Lookup(ix + 1, iy, iz + 1));
+            float d11 = Lerp(dx, Lookup(ix, iy + 1, iz + 1), Lookup(ix + 1, iy + 1, iz + 1));
+            return Lerp(dz, Lerp(dy, d00, d10), Lerp(dy, d01, d11));
+        }
+
+        // Upper bound of Lookup() over the given region of [0,1]^3.
+        float MaxValue(const Bounds3f &bounds) const;
+
+    private:
+        // SampledGrid Private Members
+        span<const float> values;
+        int nx = 0, ny = 0, nz = 0;
+    };
+
+    // MajorantGrid Definition
+    // Coarse res^3 grid over a medium's bounds holding the maximum density
+    // in each voxel; rays walk it with a 3D DDA to get tight majorants.
+    class MajorantGrid {
+    public:
+        // MajorantGrid Public Methods
+        static constexpr int DefaultResolution = 16;
+
+        MajorantGrid() = default;
+
+        MajorantGrid(const Bounds3f &bounds, span<const float> voxels, int res)
+                : bounds(bounds), voxels(voxels), res(res) {
+            DCHECK_EQ(voxels.size(), size_t(res) * res * res);
+        }
+
+        // Computes the voxel values for a density grid, in parallel.
+        static std::vector<float> Compute(const SampledGrid &density, int res);
+
+        // Same for a sparse grid over the given medium-space bounds; uses
+        // the grid's node extrema, so empty space costs next to nothing.
+        static std::vector<float> Compute(const SparseGrid &density, const Bounds3f &bounds, int res);
+
+        float Lookup(int x, int y, int z) const { return voxels[(size_t(z) * res + y) * res + x]; }
+
+        const Bounds3f &Bounds() const { return bounds; }
+
+        int Resolution() const { return res; }
+
+    private:
+        // MajorantGrid Private Members
+        Bounds3f bounds;
+        span<const float> voxels;
+        int res = 0;
+    };
+
+    // DDAMajorantIterator Definition
+    // Steps through the majorant grid voxels pierced by a ray (Amanatides and
+    // Woo 1987), returning one segment per voxel.
+    class DDAMajorantIterator {
+    public:
+        // DDAMajorantIterator Public Methods
+        DDAMajorantIterator(const Ray &ray, float tMin, float tMax, const MajorantGrid *grid, const RGB &sigma_t)
+                : sigma_t(sigma_t), tMin(tMin), tMax(tMax), grid(grid) {
+            // Set up the ray in the grid's [0,1]^3 space
+            Vector3f diag = grid->Bounds().Diagonal();
+            Point3f o(grid->Bounds().Offset(ray.o));
+            Vector3f d(ray.d.x / diag.x, ray.d.y / diag.y, ray.d.z / diag.z);
+            Point3f gridIntersect = o + d * tMin;
+            int res = grid->Resolution();
+
+            for (int axis = 0; axis < 3; ++axis) {
+                // Initialize the stepping state for this axis
+                voxel[axis] = Clamp(int(gridIntersect[axis] * res), 0, res - 1);
+                deltaT[axis] = 1 / (std::abs(d[axis]) * res);
+                if (d[axis] == -0.f)
+                    d[axis] = 0.f;
+                if (d[axis] >= 0) {
+                    float nextVoxelPos = float(voxel[axis] + 1) / res;
+                    nextCrossingT[axis] = tMin + (nextVoxelPos - gridIntersect[axis]) / d[axis];
+                    step[axis] = 1;
+                    voxelLimit[axis] = res;
+                } else {
+                    float nextVoxelPos = float(voxel[axis]) / res;
+                    nextCrossingT[axis] = tMin + (nextVoxelPos - gridIntersect[axis]) / d[axis];
+                    step[axis] = -1;
+                    voxelLimit[axis] = -1;
+                }
+            }
+        }
+
+        std::optional<RayMajorantSegment> Next() {
+            if (tMin >= tMax)
+                return {};
+            // Find the axis whose voxel boundary the ray crosses first
+            int bits = ((nextCrossingT[0] < nextCrossingT[1]) << 2) +
+                       ((nextCrossingT[0] < nextCrossingT[2]) << 1) +
+                       ((nextCrossingT[1] < nextCrossingT[2]));
+            static const int cmpToAxis[8] = {2, 1, 2, 1, 2, 2, 0, 0};
+            int stepAxis = cmpToAxis[bits];
+            float tVoxelExit = std::min(tMax, nextCrossingT[stepAxis]);
+
+            // Return the segment for the current voxel and advance to the next
+            RGB sigma_maj = sigma_t * grid->Lookup(voxel[0], voxel[1], voxel[2]);
+            RayMajorantSegment seg{tMin, tVoxelExit, sigma_maj};
+            tMin = tVoxelExit;
+            if (nextCrossingT[stepAxis] > tMax)
+                tMin = tMax;
+            voxel[stepAxis] += step[stepAxis];
+            if (voxel[stepAxis] == voxelLimit[stepAxis])
+                tMin = tMax;
+            nextCrossingT[stepAxis] += deltaT[stepAxis];
+            return seg;
+        }
+
+    private:
+        // DDAMajorantIterator Private Members
+        RGB sigma_t;
+        float tMin, tMax;
+        const MajorantGrid *grid;
+        float nextCrossingT[3], deltaT[3];
+        int step[3], voxelLimit[3], voxel[3];
+    };
+
+    // RayMajorantIterator Definition
+    class RayMajorantIterator {
+    public:
+        // RayMajorantIterator Public Methods
+        RayMajorantIterator() = default;
+
+        RayMajorantIterator(const HomogeneousMajorantIterator &iter) : iter(iter) {}
+
+        RayMajorantIterator(const DDAMajorantIterator &iter) : iter(iter) {}
+
+        std::optional<RayMajorantSegment> Next() {
+            return std::visit([](auto &it) { return it.Next(); }, iter);
+        }
+
+    private:
+        // RayMajorantIterator Private Members
+        std::variant<HomogeneousMajorantIterator, DDAMajorantIterator> iter;
+    };
+
+#pragma endregion Majorants
+
+#pragma region Media
+
+    // HomogeneousMedium Definition
+    class HomogeneousMedium {
+    public:
+        // HomogeneousMedium Public Methods
+        HomogeneousMedium(const RGB &sigma_a, const RGB &sigma_s, float sigmaScale, const RGB &Le, float LeScale,
+                          float g)
+                : sigma_a(sigma_a * sigmaScale), sigma_s(sigma_s * sigmaScale), Le(Le * LeScale), phase(g) {}
+
+        bool IsEmissive() const { return Le.MaxComponentValue() > 0; }
+
+        MediumProperties SamplePoint(Point3f p) const { return {sigma_a, sigma_s, phase, Le}; }
+
+        RayMajorantIterator SampleRay(const Ray &ray, float tMax) const {
+            return HomogeneousMajorantIterator(0, tMax, sigma_a + sigma_s);
+        }
+
+    private:
+        // HomogeneousMedium Private Members
+        RGB sigma_a, sigma_s, Le;
+        HGPhaseFunction phase;
+    };
+
+    // GridMedium Definition
+    // Heterogeneous medium whose coefficients are scaled by a density grid
+    // spanning a box in medium space.
+    class GridMedium {
+    public:
+        // GridMedium Public Methods
+        GridMedium(const Bounds3f &bounds, const Transform &renderFromMedium, const RGB &sigma_a,
+                   const RGB &sigma_s, float sigmaScale, float g, const SampledGrid &density,
+                   const MajorantGrid &majorantGrid)
+                : bounds(bounds), renderFromMedium(renderFromMedium), sigma_a(sigma_a * sigmaScale),
+                  sigma_s(sigma_s * sigmaScale), phase(g), density(density), majorantGrid(majorantGrid) {}
+
+        bool IsEmissive() const { return false; }
+
+        MediumProperties SamplePoint(Point3f p) const {
+            p = renderFromMedium.ApplyInverse(p);
+            float d = density.Lookup(Point3f(bounds.Offset(p)));
+            return {sigma_a * d, sigma_s * d, phase, RGB()};
+        }
+
+        RayMajorantIterator SampleRay(const Ray &ray, float tMax) const;
+
+    private:
+        // GridMedium Private Members
+        Bounds3f bounds;
+        Transform renderFromMedium;
+        RGB sigma_a, sigma_s;
+        HGPhaseFunction phase;
+        SampledGrid density;
+        MajorantGrid majorantGrid;
+    };
+
+    // SparseGridMedium Definition
+    // Medium defined by the "density" and optional "temperature" grids of a
+    // memory-mapped sparse grid file; temperature drives blackbody emission.
+    class SparseGridMedium {
+    public:
+        // SparseGridMedium Public Methods
+        SparseGridMedium(const Transform &renderFromMedium, const RGB &sigma_a, const RGB &sigma_s,
+                         float sigmaScale, float g, const SparseGrid *density, const SparseGrid *temperature,
+                         float LeScale, float temperatureOffset, float temperatureScale,
+                         const MajorantGrid &majorantGrid)
+                : renderFromMedium(renderFromMedium), sigma_a(sigma_a * sigmaScale), sigma_s(sigma_s * sigmaScale),
+                  phase(g), density(density), temperature(temperature), LeScale(LeScale),
+                  temperatureOffset(temperatureOffset), temperatureScale(temperatureScale),
+                  majorantGrid(majorantGrid) {}
+
+        bool IsEmissive() const { return temperature && LeScale > 0; }
+
+        MediumProperties SamplePoint(Point3f p) const;
+
+        RayMajorantIterator SampleRay(const Ray &ray, float tMax) const;
+
+    private:
+        // SparseGridMedium Private Members
+        Transform renderFromMedium;
+        RGB sigma_a, sigma_s;
+        HGPhaseFunction phase;
+        const SparseGrid *density, *temperature;
+        float LeScale, temperatureOffset, temperatureScale;
+        MajorantGrid majorantGrid;
+    };
+
+    // MediumHandle Inline Methods
+    inline bool MediumHandle::IsEmissive() const {
+        return Dispatch([](auto medium) { return medium->IsEmissive(); });
+    }
+
+    inline MediumProperties MediumHandle::SamplePoint(Point3f p) const {
+        return Dispatch([&](auto medium) { return medium->SamplePoint(p); });
+    }
+
+    inline RayMajorantIterator MediumHandle::SampleRay(const Ray &ray, float tMax) const {
+        return Dispatch([&](auto medium) { return medium->SampleRay(ray, tMax); });
+    }
+
+#pragma endregion Media
+
+#pragma region Tracking
+
+    // Delta tracking along ray up to tMax through ray.medium: samples
+    // tentative collisions with density sigma_maj[0] * T_maj and hands each
+    // to callback(p, mediumProperties, sigma_maj, T_maj), which returns
+    // false to stop. T_maj is the majorant transmittance since the previous
+    // collision. Returns the majorant transmittance from the last collision
+    // to tMax, or (1,1,1) if the callback stopped early.
+    template<typename F>
+    RGB SampleT_maj(Ray ray, float tMax, float u, RNG &rng, F callback) {
+        // Normalize the ray direction so that t is a distance
+        tMax *= Length(ray.d);
+        ray.d = Normalize(ray.d);
+
+        RayMajorantIterator iter = ray.medium.SampleRay(ray, tMax);
+        RGB T_maj(1, 1, 1);
+        while (true) {
+            std::optional<RayMajorantSegment> seg = iter.Next();
+            if (!seg)
+                return T_maj;
+            // Segments with a zero majorant only attenuate the other channels
+            if (seg->sigma_maj[0] == 0) {
+                float dt = seg->tMax - seg->tMin;
+                if (std::isinf(dt))
+                    dt = std::numeric_limits<float>::max();
+                T_maj *= Exp(-dt * seg->sigma_maj);
+                continue;
+            }
+
+            // Sample collisions within the segment
+            float tMin = seg->tMin;
+            while (true) {
+                float t = tMin + SampleExponential(u, seg->sigma_maj[0]);
+                u = rng.Uniform<float>();
+                if (t < seg->tMax) {
+                    T_maj *= Exp(-(t - tMin) * seg->sigma_maj);
+                    Point3f p = ray(t);
+                    if (!callback(p, ray.medium.SamplePoint(p), seg->sigma_maj, T_maj))
+                        return RGB(1, 1, 1);
+                    T_maj = RGB(1, 1, 1);
+                    tMin = t;
+                } else {
+                    float dt = seg->tMax - tMin;
+                    if (std::isinf(dt))
+                        dt = std::numeric_limits<float>::max();
+                    T_maj *= Exp(-dt * seg->sigma_maj);
+                    break;
+                }
+            }
+        }
+    }
+
+    // Unbiased estimate of the transmittance along ray up to tMax using ratio
+    // tracking with Russian roulette; the ray must be in a medium.
+    RGB RatioTrackingTransmittance(const Ray &ray, float tMax, RNG &rng);
+
+#pragma endregion Tracking
+}
+
+#endif //JADEHARE_CORE_VOLUMESCATTERING_MEDIA_H
@@ -5,12 +5,42 @@
 #ifndef JADEHARE_CORE_MEDIUM_H
 #define JADEHARE_CORE_MEDIUM_H
 
+#include "jadehare.h"
+#include "util/taggedPointer.h"
+
 namespace jadehare {
-    class Medium {
+    // MediumHandle Definition
+    // Participating medium a ray travels through, or nullptr for vacuum.
+    // The media themselves are defined in media.h, along with these
+    // methods, which dispatch on the medium's type.
+    class MediumHandle : public TaggedPointer<HomogeneousMedium, GridMedium, SparseGridMedium> {
     public:
+        // MediumHandle Interface
+        using TaggedPointer::TaggedPointer;
+
+        bool IsEmissive() const;
+
+        // Scattering properties at a render-space point.
+        MediumProperties SamplePoint(Point3f p) const;
+
+        // Piecewise-constant majorants along the ray up to tMax, which is in
+        // units of the ray's (unnormalized) direction.
+        RayMajorantIterator SampleRay(const Ray &ray, float tMax) const;
     };
 
-    typedef Medium* MediumHandle;
+    // MediumInterface Definition
+    // Media on the two sides of a surface; nullptr is vacuum.
+    struct MediumInterface {
+        MediumInterface() = default;
+
+        explicit MediumInterface(MediumHandle medium) : inside(medium), outside(medium) {}
+
+        MediumInterface(MediumHandle inside, MediumHandle outside) : inside(inside), outside(outside) {}
+
+        bool IsMediumTransition() const { return inside != outside; }
+
+        MediumHandle inside = nullptr, outside = nullptr;
+    };
 }
 
 #endif //JADEHARE_CORE_MEDIUM_H
@@ -0,0 +1,228 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_CORE_VOLUMESCATTERING_SPARSEGRID_H
+#define JADEHARE_CORE_VOLUMESCATTERING_SPARSEGRID_H
+
+#include "jadehare.h"
+#include "core/math/bounds.h"
+#include "core/math/mathematics.h"
+#include "core/math/point.h"
+#include "core/math/vector.h"
+#include "util/check.h"
+#include "util/file.h"
+#include "util/span.h"
+
+#include <array>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace jadehare {
+
+#pragma region Sparse Grid File Format
+    // A sparse grid file (".jvdb") holds named scalar voxel grids, each a
+    // three-level tree in the spirit of NanoVDB:
+    //
+    //   root      sorted keys of the internal nodes that exist
+    //   internal  16^3 children, each an 8^3 leaf or a constant tile
+    //   leaf      8^3 voxel values
+    //
+    // Nodes refer to each other by array index rather than by pointer, and
+    // every array starts 64-byte aligned, so a mapped file is used in place.
+    // Each node records the range of the values below it, which bounds
+    // density lookups for majorant computation without visiting voxels.
+    // Voxel values sit at integer index coordinates; voxels that aren't
+    // stored read as the grid's background value. All values are
+    // little-endian.
+
+    static constexpr char SparseGridMagic[8] = {'J', 'H', 'V', 'D', 'B', '\0', '\0', '\0'};
+    static constexpr uint32_t SparseGridVersion = 1;
+    static constexpr int SparseGridMaxGrids = 8;
+    static constexpr int SparseGridMaxNameLength = 32;
+    static constexpr uint32_t SparseGridAlignment = 64;
+
+    // log2 of the node widths in voxels
+    static constexpr int SparseLeafLog2Dim = 3;
+    static constexpr int SparseInternalLog2Dim = 4;
+    static constexpr int SparseInternalLog2Span = SparseLeafLog2Dim + SparseInternalLog2Dim;
+
+    struct SparseGridFileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t nGrids;
+        uint64_t gridOffsets[SparseGridMaxGrids];
+    };
+
+    struct SparseGridHeader {
+        char name[SparseGridMaxNameLength];
+        // Medium-space position of voxel (i, j, k) is origin + voxelSize * (i, j, k).
+        float voxelSize[3], origin[3];
+        // Inclusive index-space bounds of the stored voxels
+        int32_t indexMin[3], indexMax[3];
+        float background, minValue, maxValue;
+        uint32_t nRoots, nInternalNodes, nLeaves;
+        uint64_t rootOffset, internalOffset, leafOffset;
+    };
+
+    struct SparseGridRoot {
+        uint64_t key;
+        uint32_t internalIndex;
+        uint32_t pad;
+    };
+
+    struct alignas(64) SparseGridLeaf {
+        int32_t origin[3];
+        float minValue, maxValue;
+        uint64_t activeMask[(1 << (3 * SparseLeafLog2Dim)) / 64];
+        float values[1 << (3 * SparseLeafLog2Dim)];
+    };
+
+    struct alignas(64) SparseGridInternal {
+        int32_t origin[3];
+        float minValue, maxValue;
+        uint64_t childMask[(1 << (3 * SparseInternalLog2Dim)) / 64];
+        // Leaf index if the child mask bit is set, otherwise the bits of the
+        // tile value.
+        uint32_t children[1 << (3 * SparseInternalLog2Dim)];
+    };
+
+#pragma endregion Sparse Grid File Format
+
+    // SparseGrid Definition
+    // Read-only view of one grid of a sparse grid file.
+    class SparseGrid {
+    public:
+        // SparseGrid Public Methods
+        SparseGrid(const uint8_t *base, const SparseGridHeader *header);
+
+        std::string_view Name() const;
+
+        float Background() const { return header->background; }
+
+        float MaxValue() const { return header->maxValue; }
+
+        float Lookup(int x, int y, int z) const {
+            const SparseGridLeaf *leaf;
+            return Find(x, y, z, &leaf);
+        }
+
+        // Trilinear interpolation at a continuous index-space point.
+        float Lookup(const Point3f &pIndex) const;
+
+        // Upper bound of the values in the inclusive index range; node
+        // extrema are used where a node is only partly covered.
+        float MaxValue(const int lo[3], const int hi[3]) const;
+
+        Point3f MediumToIndex(const Point3f &p) const {
+            return {(p.x - header->origin[0]) / header->voxelSize[0], (p.y - header->origin[1]) / header->voxelSize[1],
+                    (p.z - header->origin[2]) / header->voxelSize[2]};
+        }
+
+        Point3f IndexToMedium(const Point3f &p) const {
+            return {header->origin[0] + header->voxelSize[0] * p.x, header->origin[1] + header->voxelSize[1] * p.y,
+                    header->origin[2] + header->voxelSize[2] * p.z};
+        }
+
+        // Medium-space region where trilinear lookups may differ from the
+        // background value.
+        Bounds3f MediumBounds() const;
+
+        static uint64_t RootKey(int x, int y, int z) {
+            auto k = [](int v) { return uint64_t(uint32_t(v >> SparseInternalLog2Span)) & 0x1fffff; };
+            return (k(x) << 42) | (k(y) << 21) | k(z);
+        }
+
+        static int ChildIndex(int x, int y, int z) {
+            constexpr int mask = (1 << SparseInternalLog2Span) - 1;
+            return (((x & mask) >> SparseLeafLog2Dim) << (2 * SparseInternalLog2Dim)) |
+                   (((y & mask) >> SparseLeafLog2Dim) << SparseInternalLog2Dim) | ((z & mask) >> SparseLeafLog2Dim);
+        }
+
+        static int VoxelIndex(int x, int y, int z) {
+            constexpr int mask = (1 << SparseLeafLog2Dim) - 1;
+            return ((x & mask) << (2 * SparseLeafLog2Dim)) | ((y & mask) << SparseLeafLog2Dim) | (z & mask);
+        }
+
+    private:
+        // SparseGrid Private Methods
+        // Returns the value at (x, y, z) and the leaf holding it, or nullptr
+        // if the voxel lies in a tile or outside the tree.
+        float Find(int x, int y, int z, const SparseGridLeaf **leaf) const;
+
+        // SparseGrid Private Members
+        const SparseGridHeader *header;
+        span<const SparseGridRoot> roots;
+        span<const SparseGridInternal> internalNodes;
+        span<const SparseGridLeaf> leaves;
+    };
+
+    // SparseGridFile Definition
+    // A memory-mapped sparse grid file; opening it validates the headers
+    // and node counts but touches no voxel data.
+    class SparseGridFile {
+    public:
+        // SparseGridFile Public Methods
+        // Throws std::runtime_error if the file is missing or malformed.
+        static std::unique_ptr<SparseGridFile> Open(const std::string &filename);
+
+        // Returns nullptr if there's no grid with that name.
+        const SparseGrid *Grid(std::string_view name) const;
+
+        const std::vector<SparseGrid> &Grids() const { return grids; }
+
+    private:
+        SparseGridFile() = default;
+
+        std::unique_ptr<MappedFile> file;
+        std::vector<SparseGrid> grids;
+    };
+
+    // SparseGridBuilder Definition
+    // Accumulates voxels in memory for WriteSparseGrids(). Leaves whose
+    // voxels all have the same value are stored as tiles.
+    class SparseGridBuilder {
+    public:
+        // SparseGridBuilder Public Methods
+        explicit SparseGridBuilder(std::string name, float background = 0);
+
+        // Builds a grid from a dense x-fastest array covering [0,1]^3, with
+        // voxel centers placed like SampledGrid's samples. Values equal to
+        // the background aren't stored.
+        static SparseGridBuilder FromDense(std::string name, span<const float> values, int nx, int ny, int nz,
+                                           float background = 0);
+
+        void SetTransform(const Vector3f &voxelSize, const Point3f &origin) {
+            this->voxelSize = voxelSize;
+            this->origin = origin;
+        }
+
+        void Set(int x, int y, int z, float value);
+
+        const std::string &Name() const { return name; }
+
+    private:
+        friend void WriteSparseGrids(const std::string &filename, const std::vector<SparseGridBuilder> &grids);
+
+        struct LeafData {
+            int32_t origin[3];
+            std::array<uint64_t, 8> activeMask;
+            std::array<float, 512> values;
+        };
+
+        // SparseGridBuilder Private Members
+        std::string name;
+        float background;
+        Vector3f voxelSize = Vector3f(1, 1, 1);
+        Point3f origin = Point3f(0, 0, 0);
+        std::unordered_map<uint64_t, LeafData> leaves;
+    };
+
+    // Writes the grids to a sparse grid file. Throws std::runtime_error on failure.
+    void WriteSparseGrids(const std::string &filename, const std::vector<SparseGridBuilder> &grids);
+}
+
+#endif //JADEHARE_CORE_VOLUMESCATTERING_SPARSEGRID_H
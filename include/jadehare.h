@@ -35,6 +35,20 @@
 #define PBRT_GPU
 #endif
 
+#if defined(__GNUC__) || defined(__clang__)
+#define JADEHARE_NOINLINE __attribute__((noinline))
+#define JADEHARE_COLD __attribute__((cold))
+#define JADEHARE_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#elif defined(_MSC_VER)
+#define JADEHARE_NOINLINE __declspec(noinline)
+#define JADEHARE_COLD
+#define JADEHARE_UNLIKELY(x) (x)
+#else
+#define JADEHARE_NOINLINE
+#define JADEHARE_COLD
+#define JADEHARE_UNLIKELY(x) (x)
+#endif
+
 namespace jadehare {
 #pragma region Math
     using FloatBits = uint32_t;
@@ -82,11 +96,149 @@ namespace jadehare {
     template <typename T>
     class SOA;
 
+    class Transform;
+
+    class Ray;
+
+    class DirectionCone;
+
+    class OctahedralVector;
+
 #pragma endregion Math
 
+#pragma region Lights
+
+    struct LightSampleContext;
+
+    class LightHandle;
+
+    class PointLight;
+
+    class SpotLight;
+
+    class DistantLight;
+
+    class DiffuseAreaLight;
+
+    class EnvironmentLight;
+
+    class LightBounds;
+
+    class CompactLightBounds;
+
+    class BVHLightSampler;
+
+#pragma endregion Lights
+
+#pragma region Materials
+
+    struct MaterialEvalContext;
+
+    class MaterialHandle;
+
+    class DiffuseMaterial;
+
+    class DiffuseBxDF;
+
+    struct BSDFSample;
+
+#pragma endregion Materials
+
+#pragma region Sampling
+
+    class PiecewiseConstant1D;
+
+    class PiecewiseConstant2D;
+
+    class AliasTable;
+
+    class SobolSampler;
+
+    class ZSobolSampler;
+
+#pragma endregion Sampling
+
+#pragma region Scene
+
+    struct FileLoc;
+
+    class ParsedParameter;
+
+    struct SceneDirective;
+
+    class ParsedScene;
+
+    class PLYMesh;
+
+    class Scene;
+
+#pragma endregion Scene
+
+#pragma region Shapes
+
+    struct TriangleMesh;
+
+    class BVHAggregate;
+
+    struct ObjectInstance;
+
+#pragma endregion Shapes
+
+#pragma region Spectra
+
+    struct XYZ;
+
+    class SampledSpectrum;
+
+    class SampledWavelengths;
+
+    class RGBSigmoidPolynomial;
+
+    class RGBToSpectrumTable;
+
+#pragma endregion Spectra
+
+#pragma region Textures
+
+    class RGB;
+
+    struct TextureEvalContext;
+
+    class TextureCache;
+
+    class CachedMIPMap;
+
+    class ImageTexture;
+
+    class Image;
+
+    class TiledTextureFile;
+
+#pragma endregion Textures
+
 #pragma region Volume Scattering
 
-    class Medium;
+    class MediumHandle;
+
+    struct MediumInterface;
+
+    struct MediumProperties;
+
+    class RayMajorantIterator;
+
+    class SampledGrid;
+
+    class MajorantGrid;
+
+    class HomogeneousMedium;
+
+    class GridMedium;
+
+    class SparseGrid;
+
+    class SparseGridFile;
+
+    class SparseGridMedium;
 
 #pragma endregion Volume Scattering
 }
@@ -8,64 +8,91 @@
 
 #include <jadehare.h>
 
-//#include <pbrt/util/log.h>
-//#include <pbrt/util/stats.h>
-
-#include <functional>
+#include <sstream>
 #include <string>
-#include <vector>
+#include <type_traits>
+#include <utility>
 
 namespace jadehare
 {
 
-//    void PrintStackTrace();
-//
-//#ifdef PBRT_IS_GPU_CODE
-//#define CHECK(x) assert(x)
-//#define CHECK_IMPL(a, b, op) assert((a)op(b))
-//
-//#define CHECK_EQ(a, b) CHECK_IMPL(a, b, ==)
-//#define CHECK_NE(a, b) CHECK_IMPL(a, b, !=)
-//#define CHECK_GT(a, b) CHECK_IMPL(a, b, >)
-//#define CHECK_GE(a, b) CHECK_IMPL(a, b, >=)
-//#define CHECK_LT(a, b) CHECK_IMPL(a, b, <)
-//#define CHECK_LE(a, b) CHECK_IMPL(a, b, <=)
-//
-//#else
-//
-//// CHECK Macro Definitions
-//#define CHECK(x) (!(!(x) && (LOG_FATAL("Check failed: %s", #x), true)))
-//
-//#define CHECK_IMPL(a, b, op)                                                           \
-//    do {                                                                               \
-//        auto va = a;                                                                   \
-//        auto vb = b;                                                                   \
-//        if (!(va op vb)) {                                                             \
-//            LOG_FATAL("Check failed: %s " #op " %s with %s = %s, %s = %s", #a, #b, #a, \
-//                      va, #b, vb);                                                     \
-//        }                                                                              \
-//    } while (false) /* swallow semicolon */
-//
-//#define CHECK_EQ(a, b) CHECK_IMPL(a, b, ==)
-//#define CHECK_NE(a, b) CHECK_IMPL(a, b, !=)
-//#define CHECK_GT(a, b) CHECK_IMPL(a, b, >)
-//#define CHECK_GE(a, b) CHECK_IMPL(a, b, >=)
-//#define CHECK_LT(a, b) CHECK_IMPL(a, b, <)
-//#define CHECK_LE(a, b) CHECK_IMPL(a, b, <=)
-//
-//#endif  // PBRT_IS_GPU_CODE
+    // Check Function Declarations
+    // Prints the calling thread's stack to stderr, as far as the platform
+    // allows.
+    void PrintStackTrace();
 
-//#ifndef NDEBUG
-//
-//#define DCHECK(x) (CHECK(x))
-//#define DCHECK_EQ(a, b) CHECK_EQ(a, b)
-//#define DCHECK_NE(a, b) CHECK_NE(a, b)
-//#define DCHECK_GT(a, b) CHECK_GT(a, b)
-//#define DCHECK_GE(a, b) CHECK_GE(a, b)
-//#define DCHECK_LT(a, b) CHECK_LT(a, b)
-//#define DCHECK_LE(a, b) CHECK_LE(a, b)
-//
-//#else
+    // Failure handlers of the CHECK macros: log the failed condition as
+    // fatal, with a stack trace, and abort. Kept out of line and marked
+    // cold so that a check costs its hot path only a compare and a
+    // predicted branch.
+    [[noreturn]] JADEHARE_NOINLINE JADEHARE_COLD void CheckFailed(const char *file, int line, const char *expr);
+
+    namespace detail
+    {
+        template<typename T, typename = void>
+        struct IsStreamable : std::false_type {};
+
+        template<typename T>
+        struct IsStreamable<T, std::void_t<decltype(std::declval<std::ostream &>() << std::declval<const T &>())>>
+                : std::true_type {};
+
+        template<typename T>
+        std::string CheckValueString(const T &v) {
+            if constexpr (IsStreamable<T>::value) {
+                std::ostringstream s;
+                s << v;
+                return s.str();
+            } else
+                return "<unprintable>";
+        }
+    }
+
+    template<typename A, typename B>
+    [[noreturn]] JADEHARE_NOINLINE JADEHARE_COLD void CheckOpFailed(const char *file, int line, const char *expr,
+                                                                    const char *aName, const A &a,
+                                                                    const char *bName, const B &b) {
+        std::string message = std::string(expr) + " with " + aName + " = " + detail::CheckValueString(a) +
+                              ", " + bName + " = " + detail::CheckValueString(b);
+        CheckFailed(file, line, message.c_str());
+    }
+
+// CHECK Macro Definitions
+// Always evaluated; the DCHECK versions below only in checked builds.
+#define CHECK(x)                                                                         \
+    do {                                                                                 \
+        if (JADEHARE_UNLIKELY(!(x)))                                                     \
+            jadehare::CheckFailed(__FILE__, __LINE__, #x);                               \
+    } while (false) /* swallow semicolon */
+
+#define CHECK_IMPL(a, b, op)                                                             \
+    do {                                                                                 \
+        auto &&va = (a);                                                                 \
+        auto &&vb = (b);                                                                 \
+        if (JADEHARE_UNLIKELY(!(va op vb)))                                              \
+            jadehare::CheckOpFailed(__FILE__, __LINE__, #a " " #op " " #b, #a, va, #b, vb); \
+    } while (false) /* swallow semicolon */
+
+#define CHECK_EQ(a, b) CHECK_IMPL(a, b, ==)
+#define CHECK_NE(a, b) CHECK_IMPL(a, b, !=)
+#define CHECK_GT(a, b) CHECK_IMPL(a, b, >)
+#define CHECK_GE(a, b) CHECK_IMPL(a, b, >=)
+#define CHECK_LT(a, b) CHECK_IMPL(a, b, <)
+#define CHECK_LE(a, b) CHECK_IMPL(a, b, <=)
+
+// DCHECKs are on in debug builds and in optimized builds configured with
+// JADEHARE_CHECKED_BUILD; otherwise they expand to nothing, and their
+// arguments are not evaluated.
+#if !defined(NDEBUG) || defined(JADEHARE_CHECKED_BUILD)
+
+#define DCHECK(x) CHECK(x)
+#define DCHECK_EQ(a, b) CHECK_EQ(a, b)
+#define DCHECK_NE(a, b) CHECK_NE(a, b)
+#define DCHECK_GT(a, b) CHECK_GT(a, b)
+#define DCHECK_GE(a, b) CHECK_GE(a, b)
+#define DCHECK_LT(a, b) CHECK_LT(a, b)
+#define DCHECK_LE(a, b) CHECK_LE(a, b)
+
+#else
 
 #define DCHECK(x)
 #define DCHECK_EQ(a, b)
@@ -75,78 +102,8 @@ namespace jadehare
 #define DCHECK_LT(a, b)
 #define DCHECK_LE(a, b)
 
-//#endif
-//
-//#define CHECK_RARE_TO_STRING(x) #x
-//#define CHECK_RARE_EXPAND_AND_TO_STRING(x) CHECK_RARE_TO_STRING(x)
-//
-//#ifdef PBRT_IS_GPU_CODE
-//
-//#define CHECK_RARE(freq, condition)
-//#define DCHECK_RARE(freq, condition)
-//
-//#else
-//
-//#define CHECK_RARE(freq, condition)                                                     \
-//    static_assert(std::is_floating_point<decltype(freq)>::value,                        \
-//                  "Expected floating-point frequency as first argument to CHECK_RARE"); \
-//    static_assert(std::is_integral<decltype(condition)>::value,                         \
-//                  "Expected Boolean condition as second argument to CHECK_RARE");       \
-//    do {                                                                                \
-//        static thread_local int64_t numTrue, total;                                     \
-//        static StatRegisterer reg([](StatsAccumulator &accum) {                         \
-//            accum.ReportRareCheck(__FILE__ " " CHECK_RARE_EXPAND_AND_TO_STRING(         \
-//                                      __LINE__) ": CHECK_RARE failed: " #condition,     \
-//                                  freq, numTrue, total);                                \
-//            numTrue = total = 0;                                                        \
-//        });                                                                             \
-//        ++total;                                                                        \
-//        if (condition)                                                                  \
-//            ++numTrue;                                                                  \
-//    } while (0)
-//
-//#ifdef NDEBUG
-//#define DCHECK_RARE(freq, condition)
-//#else
-//#define DCHECK_RARE(freq, condition) CHECK_RARE(freq, condition)
-//#endif  // NDEBUG
-//
-//#endif  // PBRT_IS_GPU_CODE
-//
-//// CheckCallbackScope Definition
-//    class CheckCallbackScope
-//    {
-//    public:
-//        CheckCallbackScope(std::function<std::string(void)> callback);
-//
-//        ~CheckCallbackScope();
-//
-//        CheckCallbackScope(const CheckCallbackScope &) = delete;
-//
-//        CheckCallbackScope &operator=(const CheckCallbackScope &) = delete;
-//
-//        static void Fail();
-//
-//    private:
-//        static std::vector<std::function<std::string(void)>> callbacks;
-//    };
-//
-//#define CUDA_CHECK(EXPR)                                        \
-//    if (EXPR != cudaSuccess) {                                  \
-//        cudaError_t error = cudaGetLastError();                 \
-//        LOG_FATAL("CUDA error: %s", cudaGetErrorString(error)); \
-//    } else /* eat semicolon */
-//
-//#define CU_CHECK(EXPR)                                              \
-//    do {                                                            \
-//        CUresult result = EXPR;                                     \
-//        if (result != CUDA_SUCCESS) {                               \
-//            const char *str;                                        \
-//            CHECK_EQ(CUDA_SUCCESS, cuGetErrorString(result, &str)); \
-//            LOG_FATAL("CUDA error: %s", str);                       \
-//        }                                                           \
-//    } while (false) /* eat semicolon */
-//
+#endif
+
 }  // namespace jadehare
 
 #endif //JADEHARE_UTIL_CHECK_H
@@ -0,0 +1,61 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_UTIL_FILE_H
+#define JADEHARE_UTIL_FILE_H
+
+#include "jadehare.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace jadehare {
+
+    // MappedFile Definition
+    // Read-only memory mapping of a whole file. Pages are faulted in on
+    // first touch and shared through the OS page cache with every other
+    // process mapping the same file.
+    class MappedFile {
+    public:
+        enum class Access {
+            Normal, Sequential, Random
+        };
+
+        // Throws std::runtime_error if the file can't be opened or mapped.
+        static std::unique_ptr<MappedFile> Open(const std::string &filename, Access access = Access::Normal);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        const uint8_t *Data() const { return data; }
+
+        size_t Size() const { return size; }
+
+        std::string_view View() const { return {reinterpret_cast<const char *>(data), size}; }
+
+        const std::string &Filename() const { return filename; }
+
+        static size_t PageSize();
+
+    private:
+        MappedFile() = default;
+
+        std::string filename;
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+#ifdef _WIN32
+        void *fileHandle = nullptr, *mappingHandle = nullptr;
+#endif
+    };
+
+    bool FileExists(const std::string &filename);
+
+    std::string FileExtension(const std::string &filename);
+}
+
+#endif //JADEHARE_UTIL_FILE_H
@@ -0,0 +1,92 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_UTIL_LOG_H
+#define JADEHARE_UTIL_LOG_H
+
+#include "jadehare.h"
+
+#include <atomic>
+#include <string>
+
+namespace jadehare {
+
+    // LogLevel Definition
+    // Ordered as for --minloglevel.
+    enum class LogLevel {
+        Info, Warning, Error, Fatal
+    };
+
+    // LogConfig Definition
+    struct LogConfig {
+        LogLevel minLevel = LogLevel::Info;
+        // VLOG(n) messages are kept for n <= vlogLevel.
+        int vlogLevel = 0;
+        // Log files are written here; empty means the system temp directory.
+        std::string logDir;
+        // Also print every message to stderr; otherwise only warnings and
+        // worse go there.
+        bool logToStderr = false;
+    };
+
+    // Logging Function Declarations
+    // Starts the background thread that writes log records. Until then,
+    // and after ShutdownLogging(), warnings and worse go straight to
+    // stderr and other messages are dropped.
+    void InitLogging(const LogConfig &config);
+
+    // Writes out everything logged so far and stops the writer thread.
+    void ShutdownLogging();
+
+    // Blocks until every record logged before the call has been written.
+    void FlushLog();
+
+    // Formats the message straight into a slot of the lock-free record
+    // queue; never blocks, and drops the record if the writer has fallen
+    // too far behind. Use the LOG_* macros, which skip filtered levels
+    // without formatting.
+    void Log(LogLevel level, const char *file, int line, const char *fmt, ...)
+#ifdef __GNUC__
+    __attribute__((format(printf, 4, 5)))
+#endif
+    ;
+
+    // Flushes the log, writes the message synchronously, prints a stack
+    // trace and aborts.
+    [[noreturn]] void LogFatal(const char *file, int line, const char *fmt, ...)
+#ifdef __GNUC__
+    __attribute__((format(printf, 3, 4)))
+#endif
+    ;
+
+    namespace logging {
+        // Cached thresholds from LogConfig, read by the logging macros;
+        // vlogLevel is negative when info messages are filtered out.
+        // Atomic since they change while other threads may be logging.
+        extern std::atomic<int> minLevel;
+        extern std::atomic<int> vlogLevel;
+    }
+
+    // Logging Macros
+#define JADEHARE_LOG(level, ...)                                                           \
+    do {                                                                                   \
+        if (int(level) >= jadehare::logging::minLevel.load(std::memory_order_relaxed))     \
+            jadehare::Log(level, __FILE__, __LINE__, __VA_ARGS__);                         \
+    } while (false)
+
+#define LOG_INFO(...) JADEHARE_LOG(jadehare::LogLevel::Info, __VA_ARGS__)
+#define LOG_WARNING(...) JADEHARE_LOG(jadehare::LogLevel::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) JADEHARE_LOG(jadehare::LogLevel::Error, __VA_ARGS__)
+#define LOG_FATAL(...) jadehare::LogFatal(__FILE__, __LINE__, __VA_ARGS__)
+
+    // Verbose info messages; a disabled VLOG costs one compare of a cached
+    // integer.
+#define VLOG(verbosity, ...)                                                               \
+    do {                                                                                   \
+        if ((verbosity) <= jadehare::logging::vlogLevel.load(std::memory_order_relaxed))   \
+            jadehare::Log(jadehare::LogLevel::Info, __FILE__, __LINE__, __VA_ARGS__);      \
+    } while (false)
+}
+
+#endif //JADEHARE_UTIL_LOG_H
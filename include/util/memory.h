@@ -0,0 +1,116 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_UTIL_MEMORY_H
+#define JADEHARE_UTIL_MEMORY_H
+
+#include "jadehare.h"
+#include "util/check.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jadehare {
+
+    // Memory Function Declarations
+    // _alignment_ must be a power of two; memory must be released with
+    // FreeAligned().
+    void *AllocAligned(size_t size, size_t alignment);
+
+    void FreeAligned(void *ptr);
+
+    // ScratchBuffer Definition
+    // Monotonic arena for temporaries that live for one sample, such as
+    // BSDFs and interactions: allocation bumps an offset and nothing is
+    // freed until Reset(). Objects are never destroyed, so only trivially
+    // destructible types may be allocated. Not thread safe; each thread
+    // uses its own, see ThreadLocal.
+    class alignas(64) ScratchBuffer {
+    public:
+        // ScratchBuffer Public Methods
+        explicit ScratchBuffer(size_t size = 256) : bufferSize(size) {
+            buffer = static_cast<uint8_t *>(AllocAligned(size, align));
+        }
+
+        ~ScratchBuffer() {
+            Reset();
+            FreeAligned(buffer);
+        }
+
+        ScratchBuffer(const ScratchBuffer &) = delete;
+
+        ScratchBuffer &operator=(const ScratchBuffer &) = delete;
+
+        ScratchBuffer(ScratchBuffer &&b) noexcept {
+            std::swap(buffer, b.buffer);
+            std::swap(offset, b.offset);
+            std::swap(bufferSize, b.bufferSize);
+            std::swap(smallBuffers, b.smallBuffers);
+        }
+
+        void *Alloc(size_t size, size_t alignment) {
+            DCHECK(alignment <= align && (alignment & (alignment - 1)) == 0);
+            if ((offset % alignment) != 0)
+                offset += alignment - (offset % alignment);
+            if (offset + size > bufferSize)
+                Realloc(size);
+            void *ptr = buffer + offset;
+            offset += size;
+            return ptr;
+        }
+
+        template<typename T, typename... Args>
+        T *Alloc(Args &&... args) {
+            static_assert(std::is_trivially_destructible_v<T>, "ScratchBuffer never runs destructors");
+            return new(Alloc(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        // Default-constructed array of n values.
+        template<typename T>
+        T *AllocArray(size_t n) {
+            static_assert(std::is_trivially_destructible_v<T>, "ScratchBuffer never runs destructors");
+            T *ptr = static_cast<T *>(Alloc(n * sizeof(T), alignof(T)));
+            for (size_t i = 0; i < n; ++i)
+                new(&ptr[i]) T();
+            return ptr;
+        }
+
+        // Invalidates everything allocated so far. Buffers outgrown since
+        // the last reset are released, so after the first few samples the
+        // arena settles at a size where allocation never leaves the
+        // current buffer.
+        void Reset() {
+            for (const std::pair<uint8_t *, size_t> &buf : smallBuffers)
+                FreeAligned(buf.first);
+            smallBuffers.clear();
+            offset = 0;
+        }
+
+        size_t BytesAllocated() const { return bufferSize; }
+
+    private:
+        // ScratchBuffer Private Methods
+        void Realloc(size_t minSize) {
+            // Keep the current buffer alive until Reset(), since what was
+            // allocated from it is still in use
+            smallBuffers.emplace_back(buffer, bufferSize);
+            bufferSize = std::max(2 * minSize, bufferSize + minSize);
+            buffer = static_cast<uint8_t *>(AllocAligned(bufferSize, align));
+            offset = 0;
+        }
+
+        // ScratchBuffer Private Members
+        static constexpr int align = 64;
+        uint8_t *buffer = nullptr;
+        size_t offset = 0, bufferSize = 0;
+        std::vector<std::pair<uint8_t *, size_t>> smallBuffers;
+    };
+}
+
+#endif //JADEHARE_UTIL_MEMORY_H
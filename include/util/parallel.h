@@ -0,0 +1,181 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_UTIL_PARALLEL_H
+#define JADEHARE_UTIL_PARALLEL_H
+
+#include "jadehare.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace jadehare {
+
+    // Barrier Definition
+    // Blocks the first n - 1 threads that call Wait() until the n-th does.
+    class Barrier {
+    public:
+        explicit Barrier(int n) : numToBlock(n) {}
+
+        void Wait();
+
+    private:
+        std::mutex mutex;
+        std::condition_variable cv;
+        int numToBlock;
+    };
+
+    // ThreadPool Definition
+    // Runs ParallelFor() jobs on a fixed set of worker threads. The thread
+    // that submits a job works on it too, so nested ParallelFor() calls
+    // from inside a job make progress even when every worker is busy.
+    class ThreadPool {
+    public:
+        // ThreadPool Public Methods
+        // _nThreads_ counts the calling thread; nThreads - 1 workers are spawned.
+        explicit ThreadPool(int nThreads);
+
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        int Size() const { return int(threads.size()) + 1; }
+
+        // Calls func(chunkBegin, chunkEnd) over [begin, end) in chunks of
+        // _chunkSize_ and returns once all of them are done. The first
+        // exception thrown by _func_ is rethrown here.
+        void ParallelFor(int64_t begin, int64_t end, int64_t chunkSize,
+                         const std::function<void(int64_t, int64_t)> &func);
+
+        // Runs _func_ exactly once on every thread of the pool, including the
+        // caller. Must not be called from inside a job.
+        void ForEachThread(const std::function<void(void)> &func);
+
+    private:
+        // ThreadPool Private Declarations
+        struct Job {
+            const std::function<void(int64_t, int64_t)> *func;
+            int64_t begin, end, chunkSize;
+            int64_t nextChunk = 0, nChunks;
+            std::atomic<int64_t> remaining;
+            std::exception_ptr exception;
+        };
+
+        // ThreadPool Private Methods
+        void Worker();
+
+        // Claims the next chunk of the front job; must hold _mutex_.
+        bool ClaimChunk(Job **job, int64_t *chunk);
+
+        void RunChunk(Job *job, int64_t chunk);
+
+        // ThreadPool Private Members
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable workAvailable, jobFinished;
+        std::deque<Job *> jobs;
+        bool shutdown = false;
+    };
+
+    // Parallel Function Declarations
+    // Starts the global pool; _nThreads_ <= 0 uses every available core.
+    void ParallelInit(int nThreads = 0);
+
+    void ParallelCleanup();
+
+    int AvailableCores();
+
+    // Number of threads ParallelFor() spreads work over, counting the caller.
+    int RunningThreads();
+
+    void ParallelFor(int64_t start, int64_t end, std::function<void(int64_t, int64_t)> func);
+
+    // Runs _func_ once on each thread ParallelFor() uses, e.g. to gather
+    // per-thread statistics.
+    void ForEachThread(std::function<void(void)> func);
+
+    inline void ParallelFor(int64_t start, int64_t end, std::function<void(int64_t)> func) {
+        ParallelFor(start, end, [&func](int64_t b, int64_t e) {
+            for (int64_t i = b; i < e; ++i)
+                func(i);
+        });
+    }
+
+    // ThreadLocal Definition
+    // One T per thread, created by _create_ the first time the thread calls
+    // Get(). Values live in a fixed-size open-addressing table keyed by
+    // thread id, so references stay valid and later lookups only take a
+    // shared lock. Meant for per-thread state of ParallelFor() jobs, such
+    // as ScratchBuffers.
+    template<typename T>
+    class ThreadLocal {
+    public:
+        // ThreadLocal Public Methods
+        ThreadLocal() : ThreadLocal([]() { return T(); }) {}
+
+        explicit ThreadLocal(std::function<T(void)> create)
+                : hashTable(4 * size_t(RunningThreads())), create(std::move(create)) {}
+
+        T &Get() {
+            std::thread::id tid = std::this_thread::get_id();
+            size_t hash = std::hash<std::thread::id>()(tid) % hashTable.size();
+            {
+                std::shared_lock<std::shared_mutex> lock(mutex);
+                for (size_t i = 0; i < hashTable.size() && hashTable[hash]; ++i) {
+                    if (hashTable[hash]->tid == tid)
+                        return hashTable[hash]->value;
+                    hash = (hash + 1) % hashTable.size();
+                }
+            }
+
+            // First call from this thread: create the value outside of the
+            // lock, then claim a slot, which another thread may have taken
+            // in the meantime
+            T value = create();
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            for (size_t i = 0; i < hashTable.size(); ++i) {
+                if (!hashTable[hash]) {
+                    hashTable[hash].emplace(Entry{tid, std::move(value)});
+                    return hashTable[hash]->value;
+                }
+                hash = (hash + 1) % hashTable.size();
+            }
+            throw std::runtime_error("ThreadLocal: more threads than expected");
+        }
+
+        // Calls func(value) for the value of every thread; no thread may be
+        // calling Get() meanwhile.
+        template<typename F>
+        void ForAll(F &&func) {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            for (std::optional<Entry> &entry : hashTable)
+                if (entry)
+                    func(entry->value);
+        }
+
+    private:
+        // ThreadLocal Private Members
+        struct Entry {
+            std::thread::id tid;
+            T value;
+        };
+        std::shared_mutex mutex;
+        std::vector<std::optional<Entry>> hashTable;
+        std::function<T(void)> create;
+    };
+}
+
+#endif //JADEHARE_UTIL_PARALLEL_H
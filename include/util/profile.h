@@ -0,0 +1,78 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_UTIL_PROFILE_H
+#define JADEHARE_UTIL_PROFILE_H
+
+#include "jadehare.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace jadehare {
+
+    // Profiler Function Declarations
+    // Starts recording PROFILE_SCOPE()s; WriteTrace() writes them to
+    // _traceFilename_. Call before any thread records.
+    void InitProfiler(const std::string &traceFilename);
+
+    // Writes everything recorded as a Chrome trace-event JSON file, which
+    // Perfetto and chrome://tracing display as one timeline per thread, and
+    // stops recording. No other thread may be recording meanwhile. Throws
+    // std::runtime_error if the file can't be written.
+    void WriteTrace();
+
+    namespace profiling {
+        // Set by InitProfiler(); read by ProfileScope.
+        extern bool enabled;
+
+        // Appends a finished scope to the calling thread's ring buffer.
+        void Record(const char *name, int64_t arg, int64_t startNs, int64_t endNs);
+
+        inline int64_t NowNs() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    // ProfileScope Definition
+    // Records the time from construction to destruction under _name_, which
+    // must be a string literal, and an optional integer argument such as a
+    // tile index. Costs a predictable branch when profiling is off.
+    class ProfileScope {
+    public:
+        // ProfileScope Public Methods
+        explicit ProfileScope(const char *name, int64_t arg = -1) : name(name), arg(arg) {
+            if (JADEHARE_UNLIKELY(profiling::enabled))
+                startNs = profiling::NowNs();
+        }
+
+        ~ProfileScope() {
+            if (JADEHARE_UNLIKELY(startNs >= 0))
+                profiling::Record(name, arg, startNs, profiling::NowNs());
+        }
+
+        ProfileScope(const ProfileScope &) = delete;
+
+        ProfileScope &operator=(const ProfileScope &) = delete;
+
+    private:
+        // ProfileScope Private Members
+        const char *name;
+        int64_t arg;
+        int64_t startNs = -1;
+    };
+
+// Profiling Macros
+#define JADEHARE_PROFILE_CONCAT_INNER(a, b) a##b
+#define JADEHARE_PROFILE_CONCAT(a, b) JADEHARE_PROFILE_CONCAT_INNER(a, b)
+
+// Records the rest of the enclosing block; the optional second argument
+// is shown with the event.
+#define PROFILE_SCOPE(...) \
+    jadehare::ProfileScope JADEHARE_PROFILE_CONCAT(profileScope, __LINE__)(__VA_ARGS__)
+}
+
+#endif //JADEHARE_UTIL_PROFILE_H
@@ -0,0 +1,75 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_UTIL_RNG_H
+#define JADEHARE_UTIL_RNG_H
+
+#include "jadehare.h"
+#include "core/math/mathematics.h"
+#include "util/hash.h"
+
+#include <cstdint>
+
+namespace jadehare {
+
+#define PCG32_DEFAULT_STATE 0x853c49e6748fea9bULL
+#define PCG32_DEFAULT_STREAM 0xda3e39cb94b95bdbULL
+#define PCG32_MULT 0x5851f42d4c957f2dULL
+
+    // RNG Definition
+    // PCG32 (O'Neill 2014): small state and independent streams, for the
+    // places that need an unbounded number of random values per sample,
+    // such as delta tracking through participating media.
+    class RNG {
+    public:
+        // RNG Public Methods
+        RNG() : state(PCG32_DEFAULT_STATE), inc(PCG32_DEFAULT_STREAM) {}
+
+        RNG(uint64_t seqIndex, uint64_t offset) { SetSequence(seqIndex, offset); }
+
+        explicit RNG(uint64_t seqIndex) { SetSequence(seqIndex); }
+
+        void SetSequence(uint64_t sequenceIndex, uint64_t offset);
+
+        void SetSequence(uint64_t sequenceIndex) { SetSequence(sequenceIndex, MixBits(sequenceIndex)); }
+
+        template<typename T>
+        T Uniform();
+
+    private:
+        // RNG Private Members
+        uint64_t state, inc;
+    };
+
+    // RNG Inline Method Definitions
+    template<>
+    inline uint32_t RNG::Uniform<uint32_t>() {
+        uint64_t oldState = state;
+        state = oldState * PCG32_MULT + inc;
+        uint32_t xorShifted = uint32_t(((oldState >> 18u) ^ oldState) >> 27u);
+        uint32_t rot = uint32_t(oldState >> 59u);
+        return (xorShifted >> rot) | (xorShifted << ((~rot + 1u) & 31));
+    }
+
+    template<>
+    inline uint64_t RNG::Uniform<uint64_t>() {
+        uint64_t v0 = Uniform<uint32_t>(), v1 = Uniform<uint32_t>();
+        return (v0 << 32) | v1;
+    }
+
+    template<>
+    inline float RNG::Uniform<float>() {
+        return std::min<float>(OneMinusEpsilon, Uniform<uint32_t>() * 0x1p-32f);
+    }
+
+    inline void RNG::SetSequence(uint64_t sequenceIndex, uint64_t offset) {
+        state = 0u;
+        inc = (sequenceIndex << 1u) | 1u;
+        Uniform<uint32_t>();
+        state += offset;
+        Uniform<uint32_t>();
+    }
+}
+
+#endif //JADEHARE_UTIL_RNG_H
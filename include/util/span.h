@@ -0,0 +1,65 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_UTIL_SPAN_H
+#define JADEHARE_UTIL_SPAN_H
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace jadehare {
+
+    // span Definition
+    // Non-owning view of a contiguous array; a stand-in for C++20 std::span
+    // used to hand out arrays that live in memory-mapped files.
+    template<typename T>
+    class span {
+    public:
+        using value_type = std::remove_cv_t<T>;
+        using iterator = T *;
+
+        // span Public Methods
+        span() = default;
+
+        span(T *ptr, size_t n) : ptr(ptr), n(n) {}
+
+        template<size_t N>
+        span(T (&a)[N]) : ptr(a), n(N) {}
+
+        span(std::vector<value_type> &v) : ptr(v.data()), n(v.size()) {}
+
+        template<typename U = T, typename = std::enable_if_t<std::is_const_v<U>>>
+        span(const std::vector<value_type> &v) : ptr(v.data()), n(v.size()) {}
+
+        // Allows span<T> to convert to span<const T>
+        template<typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+        span(const span<U> &s) : ptr(s.data()), n(s.size()) {}
+
+        T *data() const { return ptr; }
+
+        size_t size() const { return n; }
+
+        bool empty() const { return n == 0; }
+
+        T &operator[](size_t i) const { return ptr[i]; }
+
+        T &front() const { return ptr[0]; }
+
+        T &back() const { return ptr[n - 1]; }
+
+        iterator begin() const { return ptr; }
+
+        iterator end() const { return ptr + n; }
+
+        span subspan(size_t offset, size_t count) const { return {ptr + offset, count}; }
+
+    private:
+        // span Private Members
+        T *ptr = nullptr;
+        size_t n = 0;
+    };
+}
+
+#endif //JADEHARE_UTIL_SPAN_H
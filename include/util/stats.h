@@ -0,0 +1,137 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_UTIL_STATS_H
+#define JADEHARE_UTIL_STATS_H
+
+#include "jadehare.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <map>
+#include <string>
+
+namespace jadehare {
+
+    // StatsAccumulator Definition
+    // Totals of every statistic over all threads. Each thread adds its
+    // values with ReportThreadStats(), which resets them.
+    class StatsAccumulator {
+    public:
+        // StatsAccumulator Public Methods
+        void ReportCounter(const char *name, int64_t val) { counters[name] += val; }
+
+        void ReportMemoryCounter(const char *name, int64_t val) { memoryCounters[name] += val; }
+
+        void ReportIntDistribution(const char *name, int64_t sum, int64_t count, int64_t min, int64_t max);
+
+        void ReportPercentage(const char *name, int64_t num, int64_t denom) {
+            percentages[name].first += num;
+            percentages[name].second += denom;
+        }
+
+        void ReportRatio(const char *name, int64_t num, int64_t denom) {
+            ratios[name].first += num;
+            ratios[name].second += denom;
+        }
+
+        // Counters are also reported per second of _seconds_, if given.
+        void Print(FILE *dest, double seconds) const;
+
+        void Clear();
+
+    private:
+        // StatsAccumulator Private Declarations
+        struct Distribution {
+            int64_t sum = 0, count = 0;
+            int64_t min = std::numeric_limits<int64_t>::max();
+            int64_t max = std::numeric_limits<int64_t>::lowest();
+        };
+
+        // StatsAccumulator Private Members
+        std::map<std::string, int64_t> counters, memoryCounters;
+        std::map<std::string, Distribution> intDistributions;
+        std::map<std::string, std::pair<int64_t, int64_t>> percentages, ratios;
+    };
+
+    // StatRegisterer Definition
+    // Adds the callback that reports a thread's values of one statistic to
+    // the list ReportThreadStats() runs. Created by the STAT_* macros
+    // during static initialization.
+    class StatRegisterer {
+    public:
+        explicit StatRegisterer(std::function<void(StatsAccumulator &)> func);
+    };
+
+    // Stats Function Declarations
+    // Adds the calling thread's statistics to the totals and resets them.
+    // Call it on every thread, e.g. with ForEachThread(), before the
+    // threads exit.
+    void ReportThreadStats();
+
+    // Prints the totals grouped by category; counters are also given per
+    // second of _seconds_, such as the render time, if it is positive.
+    void PrintStats(FILE *dest, double seconds = 0);
+
+    void ClearStats();
+
+    // Statistics Macros
+    // Each statistic is a set of thread_local variables that hot loops
+    // update with plain adds; they only meet in ReportThreadStats(). The
+    // title reads "Category/Description".
+#define STAT_COUNTER(title, var)                                             \
+    static thread_local int64_t var;                                         \
+    static jadehare::StatRegisterer STATS_REG##var([](jadehare::StatsAccumulator &accum) { \
+        accum.ReportCounter(title, var);                                     \
+        var = 0;                                                             \
+    })
+
+#define STAT_MEMORY_COUNTER(title, var)                                      \
+    static thread_local int64_t var;                                         \
+    static jadehare::StatRegisterer STATS_REG##var([](jadehare::StatsAccumulator &accum) { \
+        accum.ReportMemoryCounter(title, var);                               \
+        var = 0;                                                             \
+    })
+
+    // Values are added with ReportValue(var, value).
+#define STAT_INT_DISTRIBUTION(title, var)                                    \
+    static thread_local int64_t var##sum;                                    \
+    static thread_local int64_t var##count;                                  \
+    static thread_local int64_t var##min = std::numeric_limits<int64_t>::max(); \
+    static thread_local int64_t var##max = std::numeric_limits<int64_t>::lowest(); \
+    static jadehare::StatRegisterer STATS_REG##var([](jadehare::StatsAccumulator &accum) { \
+        accum.ReportIntDistribution(title, var##sum, var##count, var##min, var##max); \
+        var##sum = var##count = 0;                                           \
+        var##min = std::numeric_limits<int64_t>::max();                      \
+        var##max = std::numeric_limits<int64_t>::lowest();                   \
+    })
+
+#define STAT_PERCENT(title, numVar, denomVar)                                \
+    static thread_local int64_t numVar, denomVar;                            \
+    static jadehare::StatRegisterer STATS_REG##numVar([](jadehare::StatsAccumulator &accum) { \
+        accum.ReportPercentage(title, numVar, denomVar);                     \
+        numVar = denomVar = 0;                                               \
+    })
+
+#define STAT_RATIO(title, numVar, denomVar)                                  \
+    static thread_local int64_t numVar, denomVar;                            \
+    static jadehare::StatRegisterer STATS_REG##numVar([](jadehare::StatsAccumulator &accum) { \
+        accum.ReportRatio(title, numVar, denomVar);                          \
+        numVar = denomVar = 0;                                               \
+    })
+
+#define ReportValue(var, value)                                              \
+    do {                                                                     \
+        int64_t statValue = int64_t(value);                                  \
+        var##sum += statValue;                                               \
+        var##count += 1;                                                     \
+        var##min = std::min(var##min, statValue);                            \
+        var##max = std::max(var##max, statValue);                            \
+    } while (false)
+}
+
+#endif //JADEHARE_UTIL_STATS_H
@@ -0,0 +1,192 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_UTIL_TAGGEDPOINTER_H
+#define JADEHARE_UTIL_TAGGEDPOINTER_H
+
+#include "jadehare.h"
+#include "util/check.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+namespace jadehare {
+
+    namespace detail {
+        // Index of T in Ts, counting from one; zero if it isn't there.
+        template<typename T, typename... Ts>
+        struct TypeIndex;
+
+        template<typename T>
+        struct TypeIndex<T> {
+            static constexpr int value = 0;
+        };
+
+        template<typename T, typename... Ts>
+        struct TypeIndex<T, T, Ts...> {
+            static constexpr int value = 1;
+        };
+
+        template<typename T, typename U, typename... Ts>
+        struct TypeIndex<T, U, Ts...> {
+            static constexpr int value = TypeIndex<T, Ts...>::value == 0 ? 0 : 1 + TypeIndex<T, Ts...>::value;
+        };
+
+        // Calls func with ptr, a void * or const void *, cast to the I'th
+        // of Ts with the same constness.
+        template<int I, typename R, typename F, typename P, typename... Ts>
+        R DispatchCase(F &func, P ptr) {
+            using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+            if constexpr (std::is_const_v<std::remove_pointer_t<P>>)
+                return func(static_cast<const T *>(ptr));
+            else
+                return func(static_cast<T *>(ptr));
+        }
+
+        // Calls func with ptr cast to the index'th type: a switch over eight
+        // types at a time, starting at Base, which the compiler turns into a
+        // jump table or a few compares with func inlined into each case.
+        // Cases past the last type are never taken; they repeat it so that
+        // every case has a valid type.
+        template<int Base, typename R, typename F, typename P, typename... Ts>
+        R Dispatch(F &&func, P ptr, int index) {
+            constexpr int n = int(sizeof...(Ts));
+            static_assert(Base < n, "dispatch past the last type");
+            constexpr auto C = [](int i) { return Base + i < n ? Base + i : n - 1; };
+            switch (index - Base) {
+                case 0:
+                    return DispatchCase<C(0), R, F, P, Ts...>(func, ptr);
+                case 1:
+                    return DispatchCase<C(1), R, F, P, Ts...>(func, ptr);
+                case 2:
+                    return DispatchCase<C(2), R, F, P, Ts...>(func, ptr);
+                case 3:
+                    return DispatchCase<C(3), R, F, P, Ts...>(func, ptr);
+                case 4:
+                    return DispatchCase<C(4), R, F, P, Ts...>(func, ptr);
+                case 5:
+                    return DispatchCase<C(5), R, F, P, Ts...>(func, ptr);
+                case 6:
+                    return DispatchCase<C(6), R, F, P, Ts...>(func, ptr);
+                case 7:
+                    return DispatchCase<C(7), R, F, P, Ts...>(func, ptr);
+                default:
+                    if constexpr (Base + 8 < n)
+                        return Dispatch<Base + 8, R, F, P, Ts...>(std::forward<F>(func), ptr, index);
+                    else {
+                        DCHECK_LT(index, n);
+                        return DispatchCase<n - 1, R, F, P, Ts...>(func, ptr);
+                    }
+            }
+        }
+    }
+
+    // TaggedPointer Definition
+    // Pointer to one of a closed set of types, with the type's index kept in
+    // the upper bits that 64-bit address spaces leave unused. Dispatch()
+    // calls a generic function with the pointer cast to its concrete type,
+    // so families of related classes need no virtual functions: no vtable
+    // load, and each call site is a switch the compiler can see through.
+    // A tag of zero is nullptr.
+    template<typename... Ts>
+    class TaggedPointer {
+    public:
+        // TaggedPointer Public Methods
+        TaggedPointer() = default;
+
+        TaggedPointer(std::nullptr_t) {}
+
+        template<typename T>
+        TaggedPointer(T *ptr) {
+            uintptr_t iptr = reinterpret_cast<uintptr_t>(ptr);
+            DCHECK_EQ(iptr & ptrMask, iptr);
+            constexpr unsigned int type = TypeIndex<T>();
+            bits = iptr | (uintptr_t(type) << tagShift);
+        }
+
+        template<typename T>
+        static constexpr unsigned int TypeIndex() {
+            using Tp = std::remove_cv_t<T>;
+            constexpr int index = detail::TypeIndex<Tp, Ts...>::value;
+            static_assert(index != 0, "type is not one of the TaggedPointer's types");
+            return index;
+        }
+
+        unsigned int Tag() const { return (bits & tagMask) >> tagShift; }
+
+        template<typename T>
+        bool Is() const { return Tag() == TypeIndex<T>(); }
+
+        static constexpr unsigned int MaxTag() { return sizeof...(Ts); }
+
+        template<typename T>
+        T *Cast() {
+            DCHECK(Is<T>());
+            return reinterpret_cast<T *>(ptr());
+        }
+
+        template<typename T>
+        const T *Cast() const {
+            DCHECK(Is<T>());
+            return reinterpret_cast<const T *>(ptr());
+        }
+
+        template<typename T>
+        T *CastOrNullptr() { return Is<T>() ? reinterpret_cast<T *>(ptr()) : nullptr; }
+
+        template<typename T>
+        const T *CastOrNullptr() const { return Is<T>() ? reinterpret_cast<const T *>(ptr()) : nullptr; }
+
+        void *ptr() { return reinterpret_cast<void *>(bits & ptrMask); }
+
+        const void *ptr() const { return reinterpret_cast<const void *>(bits & ptrMask); }
+
+        explicit operator bool() const { return (bits & ptrMask) != 0; }
+
+        bool operator==(const TaggedPointer &tp) const { return bits == tp.bits; }
+
+        bool operator!=(const TaggedPointer &tp) const { return bits != tp.bits; }
+
+        // func must return the same type for every Ts; the pointer must not
+        // be null.
+        template<typename F>
+        decltype(auto) Dispatch(F &&func) {
+            DCHECK(ptr() != nullptr);
+            using R = std::invoke_result_t<F, FirstType *>;
+            static_assert((std::is_same_v<R, std::invoke_result_t<F, Ts *>> && ...),
+                          "Dispatch() needs the same return type for every type");
+            return detail::Dispatch<0, R, F, void *, Ts...>(std::forward<F>(func), ptr(), int(Tag()) - 1);
+        }
+
+        template<typename F>
+        decltype(auto) Dispatch(F &&func) const {
+            DCHECK(ptr() != nullptr);
+            using R = std::invoke_result_t<F, const FirstType *>;
+            static_assert((std::is_same_v<R, std::invoke_result_t<F, const Ts *>> && ...),
+                          "Dispatch() needs the same return type for every type");
+            return detail::Dispatch<0, R, F, const void *, Ts...>(std::forward<F>(func), ptr(), int(Tag()) - 1);
+        }
+
+    private:
+        // TaggedPointer Private Members
+        template<typename T, typename...>
+        struct First {
+            using type = T;
+        };
+        using FirstType = typename First<Ts...>::type;
+
+        static_assert(sizeof(uintptr_t) == 8, "TaggedPointer needs 64-bit pointers");
+        static constexpr int tagShift = 57;
+        static constexpr int tagBits = 64 - tagShift;
+        static constexpr uint64_t tagMask = ((uint64_t(1) << tagBits) - 1) << tagShift;
+        static constexpr uint64_t ptrMask = ~tagMask;
+        static_assert(sizeof...(Ts) < (1 << tagBits), "too many types for the tag bits");
+
+        uintptr_t bits = 0;
+    };
+}
+
+#endif //JADEHARE_UTIL_TAGGEDPOINTER_H
@@ -0,0 +1,171 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#ifndef JADEHARE_BENCH_BENCHMARK_H
+#define JADEHARE_BENCH_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace jadehare::bench {
+
+    // Keeps the compiler from optimizing away the computation of _value_.
+    template<typename T>
+    inline void DoNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static volatile const T *sink;
+        sink = &value;
+#endif
+    }
+
+    // BenchmarkResult Definition
+    // One measurement; _metrics_ holds named values such as "ns_per_op",
+    // for which lower or higher is better according to the name's suffix.
+    struct BenchmarkResult {
+        std::string name;
+        std::vector<std::pair<std::string, double>> metrics;
+
+        double Metric(const std::string &metric) const {
+            for (const auto &[n, v] : metrics)
+                if (n == metric)
+                    return v;
+            return NAN;
+        }
+    };
+
+    // Higher is better for rates; lower for times and sizes.
+    inline bool HigherIsBetter(const std::string &metric) {
+        return metric.find("per_s") != std::string::npos || metric.find("speedup") != std::string::npos;
+    }
+
+    // Times func(), which performs _opsPerCall_ operations, until at least
+    // _minSeconds_ have passed, several times over, and reports the best
+    // repetition, which is the least disturbed by the rest of the system.
+    template<typename F>
+    BenchmarkResult RunMicrobenchmark(const std::string &name, int64_t opsPerCall, double minSeconds, F &&func) {
+        using Clock = std::chrono::steady_clock;
+        // Warm up caches and find a call count that takes long enough
+        int64_t calls = 1;
+        while (true) {
+            Clock::time_point start = Clock::now();
+            for (int64_t i = 0; i < calls; ++i)
+                func();
+            double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            if (elapsed >= minSeconds / 5 || calls >= (int64_t(1) << 40))
+                break;
+            calls *= elapsed > 0 ? std::clamp<int64_t>(int64_t(minSeconds / 5 / elapsed) + 1, 2, 100) : 100;
+        }
+
+        constexpr int repetitions = 5;
+        double best = INFINITY;
+        for (int r = 0; r < repetitions; ++r) {
+            Clock::time_point start = Clock::now();
+            for (int64_t i = 0; i < calls; ++i)
+                func();
+            best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+        }
+        double nsPerOp = best * 1e9 / double(calls * opsPerCall);
+        return BenchmarkResult{name, {{"ns_per_op", nsPerOp}, {"mops_per_s", 1e3 / nsPerOp}}};
+    }
+
+    // Writes results as JSON, one benchmark per line so that files diff
+    // well and can be read back by ReadBenchmarkJSON().
+    inline void WriteBenchmarkJSON(const std::string &filename, const std::string &suite,
+                                   const std::vector<std::pair<std::string, std::string>> &context,
+                                   const std::vector<BenchmarkResult> &results) {
+        std::ostringstream out;
+        out.precision(6);
+        out << "{\n  \"suite\": \"" << suite << "\",\n  \"context\": {";
+        for (size_t i = 0; i < context.size(); ++i)
+            out << (i ? ", " : "") << "\"" << context[i].first << "\": \"" << context[i].second << "\"";
+        out << "},\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            out << "    {\"name\": \"" << results[i].name << "\"";
+            for (const auto &[metric, value] : results[i].metrics)
+                out << ", \"" << metric << "\": " << (std::isfinite(value) ? value : 0);
+            out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+
+        if (filename == "-") {
+            std::fputs(out.str().c_str(), stdout);
+            return;
+        }
+        std::ofstream f(filename);
+        if (!(f << out.str()))
+            throw std::runtime_error(filename + ": unable to write benchmark results");
+    }
+
+    // Reads the benchmarks of a file written by WriteBenchmarkJSON().
+    inline std::vector<BenchmarkResult> ReadBenchmarkJSON(const std::string &filename) {
+        std::ifstream f(filename);
+        if (!f)
+            throw std::runtime_error(filename + ": unable to open benchmark baseline");
+        std::vector<BenchmarkResult> results;
+        std::string line;
+        while (std::getline(f, line)) {
+            size_t pos = line.find("{\"name\": \"");
+            if (pos == std::string::npos)
+                continue;
+            BenchmarkResult r;
+            pos += 10;
+            size_t end = line.find('"', pos);
+            r.name = line.substr(pos, end - pos);
+            // Then "metric": value pairs
+            pos = end + 1;
+            while ((pos = line.find('"', pos)) != std::string::npos) {
+                end = line.find('"', pos + 1);
+                std::string metric = line.substr(pos + 1, end - pos - 1);
+                size_t colon = line.find(':', end);
+                if (colon == std::string::npos)
+                    break;
+                r.metrics.emplace_back(metric, std::strtod(line.c_str() + colon + 1, nullptr));
+                pos = line.find_first_of(",}", colon);
+            }
+            results.push_back(std::move(r));
+        }
+        return results;
+    }
+
+    // Prints the change of every metric relative to _baseline_ and returns
+    // the number that got worse by more than _threshold_ (e.g. 0.1 = 10%).
+    inline int CompareBenchmarks(const std::vector<BenchmarkResult> &baseline,
+                                 const std::vector<BenchmarkResult> &results, double threshold) {
+        std::map<std::string, const BenchmarkResult *> base;
+        for (const BenchmarkResult &r : baseline)
+            base[r.name] = &r;
+        int nRegressions = 0;
+        std::printf("%-36s %-20s %14s %14s %9s\n", "benchmark", "metric", "baseline", "current", "change");
+        for (const BenchmarkResult &r : results) {
+            auto iter = base.find(r.name);
+            if (iter == base.end())
+                continue;
+            for (const auto &[metric, value] : r.metrics) {
+                double old = iter->second->Metric(metric);
+                if (!std::isfinite(old) || old == 0)
+                    continue;
+                double change = value / old - 1;
+                double worse = HigherIsBetter(metric) ? -change : change;
+                bool regressed = worse > threshold;
+                nRegressions += regressed;
+                std::printf("%-36s %-20s %14.4g %14.4g %+8.1f%%%s\n", r.name.c_str(), metric.c_str(), old, value,
+                            100 * change, regressed ? "  REGRESSION" : "");
+            }
+        }
+        return nRegressions;
+    }
+}
+
+#endif //JADEHARE_BENCH_BENCHMARK_H
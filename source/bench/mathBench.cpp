@@ -0,0 +1,227 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include <array>
+#include <iostream>
+#include <random>
+#include <cxxopts.hpp>
+#include "jadehare.h"
+#include "bench/benchmark.h"
+#include "core/math/bounds.h"
+#include "core/math/normal.h"
+#include "core/math/point.h"
+#include "core/math/quaternion.h"
+#include "core/math/ray.h"
+#include "core/math/vector.h"
+
+using namespace jadehare;
+using namespace jadehare::bench;
+
+// BatchData Definition
+// Random inputs shaped like those of a renderer: unit directions, boxes
+// around the origin that about half of the rays hit, and intersection
+// points with small floating-point error bounds.
+struct BatchData {
+    explicit BatchData(size_t n) {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> u(0, 1), s(-1, 1);
+        auto direction = [&]() {
+            float z = 1 - 2 * u(rng), r = std::sqrt(std::max<float>(0, 1 - z * z)), phi = 2 * Pi * u(rng);
+            return Vector3f(r * std::cos(phi), r * std::sin(phi), z);
+        };
+        for (size_t i = 0; i < n; ++i) {
+            a.push_back(Vector3f(s(rng), s(rng), s(rng)) * 10.f);
+            b.push_back(Vector3f(s(rng), s(rng), s(rng)) * 10.f);
+            w.push_back(direction());
+            wb.push_back(direction());
+            n3.push_back(Normal3f(direction()));
+
+            Point3f c(s(rng) * 5, s(rng) * 5, s(rng) * 5);
+            Vector3f e(u(rng) + .1f, u(rng) + .1f, u(rng) + .1f);
+            boxes.push_back(Bounds3f(c - e, c + e));
+            Point3f origin = Point3f(0, 0, 0) + direction() * 20.f;
+            o.push_back(origin);
+            // Aim at a jittered box center, so that some rays miss
+            Vector3f d = Normalize((c + Vector3f(s(rng), s(rng), s(rng)) * 1.5f) - origin);
+            d.x = d.x == 0 ? 1e-6f : d.x;
+            this->d.push_back(d);
+            invDir.push_back(Vector3f(1 / d.x, 1 / d.y, 1 / d.z));
+            dirIsNeg.push_back({int(invDir.back().x < 0), int(invDir.back().y < 0), int(invDir.back().z < 0)});
+            p.push_back(Point3f(s(rng), s(rng), s(rng)) * 100.f);
+            pi.push_back(Point3fi(p.back(), Vector3f(1e-4f, 1e-4f, 1e-4f) * u(rng)));
+
+            Vector3f axis = direction();
+            float theta = Pi * u(rng);
+            q1.push_back(Quaternion(std::cos(theta / 2), axis.x * std::sin(theta / 2), axis.y * std::sin(theta / 2),
+                                    axis.z * std::sin(theta / 2)));
+            axis = direction();
+            theta = Pi * u(rng);
+            q2.push_back(Quaternion(std::cos(theta / 2), axis.x * std::sin(theta / 2), axis.y * std::sin(theta / 2),
+                                    axis.z * std::sin(theta / 2)));
+        }
+        f.resize(n);
+        v.resize(n);
+        v2.resize(n);
+        hit.resize(n);
+        pOut.resize(n);
+        bOut.resize(n);
+        qOut.resize(n);
+    }
+
+    size_t size() const { return a.size(); }
+
+    // Inputs
+    std::vector<Vector3f> a, b, w, wb;
+    std::vector<Normal3f> n3;
+    std::vector<Bounds3f> boxes;
+    std::vector<Point3f> o, p;
+    std::vector<Vector3f> d, invDir;
+    std::vector<std::array<int, 3>> dirIsNeg;
+    std::vector<Point3fi> pi;
+    std::vector<Quaternion> q1, q2;
+
+    // Outputs; results are stored so that kernels run at the throughput
+    // they would have inside a loop that uses them
+    std::vector<float> f;
+    std::vector<Vector3f> v, v2;
+    std::vector<uint8_t> hit;
+    std::vector<Point3f> pOut;
+    std::vector<Bounds3f> bOut;
+    std::vector<glm::quat> qOut;
+};
+
+int main(int argc, const char *argv[])
+{
+    cxxopts::Options options("bench", "Microbenchmarks of the core math kernels");
+    options.add_options()
+            ("h,help", "Print this help text.")
+            ("filter", "Only run benchmarks whose name contains this string.",
+             cxxopts::value<std::string>()->default_value(""))
+            ("batch", "Number of inputs each benchmark loops over.", cxxopts::value<int>()->default_value("4096"))
+            ("mintime", "Minimum seconds to time each repetition of a benchmark.",
+             cxxopts::value<double>()->default_value("0.05"))
+            ("o,outfile", "Write the results as JSON to this file, or - for stdout.", cxxopts::value<std::string>())
+            ("baseline", "Compare against results previously written with --outfile.",
+             cxxopts::value<std::string>())
+            ("threshold", "Relative slowdown against the baseline that counts as a regression.",
+             cxxopts::value<double>()->default_value("0.1"));
+
+    auto result = options.parse(argc, argv);
+    if (result.count("help"))
+    {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    BatchData data(size_t(std::max(1, result["batch"].as<int>())));
+    const size_t n = data.size();
+    const std::string filter = result["filter"].as<std::string>();
+    const double minTime = result["mintime"].as<double>();
+    std::vector<BenchmarkResult> results;
+
+    auto run = [&](const std::string &name, auto &&kernel) {
+        if (name.find(filter) == std::string::npos)
+            return;
+        results.push_back(RunMicrobenchmark(name, int64_t(n), minTime, [&]() {
+            kernel();
+            DoNotOptimize(data);
+        }));
+        std::printf("%-36s %10.3f ns/op %10.1f Mops/s\n", name.c_str(), results.back().Metric("ns_per_op"),
+                    results.back().Metric("mops_per_s"));
+    };
+
+    BatchData &D = data;
+    run("Dot(Vector3f)", [&]() {
+        for (size_t i = 0; i < n; ++i)
+            D.f[i] = Dot(D.a[i], D.b[i]);
+    });
+    run("Cross(Vector3f)", [&]() {
+        for (size_t i = 0; i < n; ++i)
+            D.v[i] = Cross(D.a[i], D.b[i]);
+    });
+    run("Normalize(Vector3f)", [&]() {
+        for (size_t i = 0; i < n; ++i)
+            D.v[i] = Normalize(D.a[i]);
+    });
+    run("CoordinateSystem(Vector3f)", [&]() {
+        for (size_t i = 0; i < n; ++i)
+            CoordinateSystem(D.w[i], &D.v[i], &D.v2[i]);
+    });
+    run("AngleBetween(Vector3f)", [&]() {
+        for (size_t i = 0; i < n; ++i)
+            D.f[i] = AngleBetween(D.w[i], D.wb[i]);
+    });
+    run("AngleBetween(Normal3f)", [&]() {
+        for (size_t i = 0; i < n; ++i)
+            D.f[i] = AngleBetween(D.n3[i], Normal3f(D.wb[i]));
+    });
+    run("Bounds3f::IntersectP(hitt)", [&]() {
+        for (size_t i = 0; i < n; ++i) {
+            float t0 = 0, t1 = 0;
+            D.hit[i] = D.boxes[i].IntersectP(D.o[i], D.d[i], Infinity, &t0, &t1);
+            D.f[i] = t0;
+        }
+    });
+    run("Bounds3f::IntersectP(invDir)", [&]() {
+        for (size_t i = 0; i < n; ++i)
+            D.hit[i] = D.boxes[i].IntersectP(D.o[i], D.d[i], Infinity, D.invDir[i], D.dirIsNeg[i].data());
+    });
+    run("Union(Bounds3f, Bounds3f)", [&]() {
+        for (size_t i = 0; i < n; ++i)
+            D.bOut[i] = Union(D.boxes[i], D.boxes[n - 1 - i]);
+    });
+    run("Union(Bounds3f, Point3f)", [&]() {
+        for (size_t i = 0; i < n; ++i)
+            D.bOut[i] = Union(D.boxes[i], D.p[i]);
+    });
+    run("OffsetRayOrigin", [&]() {
+        for (size_t i = 0; i < n; ++i)
+            D.pOut[i] = OffsetRayOrigin(D.pi[i], D.n3[i], D.w[i]);
+    });
+    run("Dot(Quaternion)", [&]() {
+        for (size_t i = 0; i < n; ++i)
+            D.f[i] = Dot(D.q1[i], D.q2[i]);
+    });
+    run("Normalize(Quaternion)", [&]() {
+        for (size_t i = 0; i < n; ++i)
+            D.qOut[i] = Normalize(D.q1[i] * 2.f);
+    });
+    run("AngleBetween(Quaternion)", [&]() {
+        for (size_t i = 0; i < n; ++i)
+            D.f[i] = AngleBetween(D.q1[i], D.q2[i]);
+    });
+    run("Quaternion product", [&]() {
+        for (size_t i = 0; i < n; ++i)
+            D.qOut[i] = static_cast<const glm::quat &>(D.q1[i]) * static_cast<const glm::quat &>(D.q2[i]);
+    });
+
+    try
+    {
+        std::vector<std::pair<std::string, std::string>> context = {{"batch", std::to_string(n)}};
+#if !defined(NDEBUG) || defined(JADEHARE_CHECKED_BUILD)
+        context.push_back({"dchecks", "on"});
+#else
+        context.push_back({"dchecks", "off"});
+#endif
+        if (result.count("outfile"))
+            WriteBenchmarkJSON(result["outfile"].as<std::string>(), "math", context, results);
+        if (result.count("baseline"))
+        {
+            std::cout << std::endl;
+            int nRegressions = CompareBenchmarks(ReadBenchmarkJSON(result["baseline"].as<std::string>()), results,
+                                                 result["threshold"].as<double>());
+            if (nRegressions > 0)
+            {
+                std::cout << nRegressions << " regression(s) against the baseline" << std::endl;
+                return 2;
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
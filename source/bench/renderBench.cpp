@@ -0,0 +1,560 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <cxxopts.hpp>
+#include "jadehare.h"
+#include "bench/benchmark.h"
+#include "core/camera/camera.h"
+#include "core/film/film.h"
+#include "core/film/tileOrder.h"
+#include "core/integrator/integrator.h"
+#include "core/scene/parser.h"
+#include "core/scene/scene.h"
+#include "core/texture/image.h"
+#include "core/texture/tiledTexture.h"
+#include "util/parallel.h"
+#include "util/profile.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+using namespace jadehare;
+using namespace jadehare::bench;
+
+#pragma region Memory Usage
+
+// Restarts the peak resident set size that PeakRSSMegabytes() reports,
+// where the platform allows it (Linux); elsewhere the peak is that of the
+// whole run so far.
+static void ResetPeakRSS() {
+#ifdef __linux__
+    if (FILE *f = std::fopen("/proc/self/clear_refs", "w")) {
+        std::fputs("5", f);
+        std::fclose(f);
+    }
+#endif
+}
+
+static double PeakRSSMegabytes() {
+#ifdef __linux__
+    if (FILE *f = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        long kb = -1;
+        while (std::fgets(line, sizeof(line), f))
+            if (std::sscanf(line, "VmHWM: %ld kB", &kb) == 1)
+                break;
+        std::fclose(f);
+        if (kb >= 0)
+            return kb / 1024.;
+    }
+#endif
+#if defined(__linux__) || defined(__APPLE__)
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024. * 1024.);
+#else
+    return usage.ru_maxrss / 1024.;
+#endif
+#else
+    return 0;
+#endif
+}
+
+#pragma endregion Memory Usage
+
+#pragma region Procedural Scenes
+
+// BenchSettings Definition
+struct BenchSettings {
+    int resolution = 256, spp = 4, maxDepth = 5;
+    // Quads per side of the terrain and trees per side of the forest
+    int meshResolution = 512, forestResolution = 64;
+    // Where the environment map of the HDRI scene is written
+    std::string tempDir;
+};
+
+// SceneWriter Definition
+// Accumulates the text of a scene description, in which z is up.
+class SceneWriter {
+public:
+    // SceneWriter Public Methods
+    SceneWriter(const BenchSettings &settings, const Point3f &from, const Point3f &to, float fov) {
+        out << "LookAt " << from.x << " " << from.y << " " << from.z << "  " << to.x << " " << to.y << " " << to.z
+            << "  0 0 1\n"
+            << "Camera \"perspective\" \"float fov\" [" << fov << "]\n"
+            << "Film \"rgb\" \"integer xresolution\" [" << settings.resolution << "] \"integer yresolution\" ["
+            << settings.resolution << "]\n"
+            << "Sampler \"zsobol\" \"integer pixelsamples\" [" << settings.spp << "]\n"
+            << "Integrator \"volpath\" \"integer maxdepth\" [" << settings.maxDepth << "]\n"
+            << "WorldBegin\n";
+    }
+
+    // Appends a directive, or anything else, verbatim.
+    SceneWriter &operator<<(const std::string &text) {
+        out << text;
+        return *this;
+    }
+
+    void Mesh(const std::vector<Point3f> &p, const std::vector<int> &indices) {
+        out << "Shape \"trianglemesh\" \"point3 P\" [";
+        for (const Point3f &v : p)
+            out << ' ' << v.x << ' ' << v.y << ' ' << v.z;
+        out << " ] \"integer indices\" [";
+        for (int i : indices)
+            out << ' ' << i;
+        out << " ]\n";
+    }
+
+    // Two triangles, facing the side from which the corners run counterclockwise.
+    void Quad(const Point3f &p0, const Point3f &p1, const Point3f &p2, const Point3f &p3) {
+        Mesh({p0, p1, p2, p3}, {0, 1, 2, 0, 2, 3});
+    }
+
+    // Axis-aligned box with outward-facing triangles.
+    void Box(const Point3f &pMin, const Point3f &pMax) {
+        std::vector<Point3f> p;
+        for (int i = 0; i < 8; ++i)
+            p.push_back(Point3f(i & 1 ? pMax.x : pMin.x, i & 2 ? pMax.y : pMin.y, i & 4 ? pMax.z : pMin.z));
+        const int faces[6][4] = {{0, 4, 6, 2}, {1, 3, 7, 5}, {0, 1, 5, 4},
+                                 {2, 6, 7, 3}, {0, 2, 3, 1}, {4, 5, 7, 6}};
+        std::vector<int> indices;
+        for (const int *f : faces)
+            indices.insert(indices.end(), {f[0], f[1], f[2], f[0], f[2], f[3]});
+        Mesh(p, indices);
+    }
+
+    // Tessellated surface of revolution around the z axis through _center_:
+    // radius(t) and z(t) for t in [0, 1], with nRings by nSegments quads.
+    void Revolve(const Point3f &center, int nRings, int nSegments, const std::function<float(float)> &radius,
+                 const std::function<float(float)> &z) {
+        std::vector<Point3f> p;
+        std::vector<int> indices;
+        for (int i = 0; i <= nRings; ++i) {
+            float t = float(i) / nRings;
+            for (int j = 0; j < nSegments; ++j) {
+                float phi = 2 * Pi * j / nSegments;
+                p.push_back(center + Vector3f(radius(t) * std::cos(phi), radius(t) * std::sin(phi), z(t)));
+            }
+        }
+        for (int i = 0; i < nRings; ++i)
+            for (int j = 0; j < nSegments; ++j) {
+                int v00 = i * nSegments + j, v01 = i * nSegments + (j + 1) % nSegments;
+                int v10 = v00 + nSegments, v11 = v01 + nSegments;
+                indices.insert(indices.end(), {v00, v01, v11, v00, v11, v10});
+            }
+        Mesh(p, indices);
+    }
+
+    void Sphere(const Point3f &center, float r, int nRings = 32, int nSegments = 64) {
+        Revolve(center, nRings, nSegments, [r](float t) { return r * std::sin(Pi * t); },
+                [r](float t) { return -r * std::cos(Pi * t); });
+    }
+
+    void Cone(const Point3f &base, float r, float height, int nSegments = 24) {
+        Revolve(base, 1, nSegments, [r](float t) { return r * (1 - t); }, [height](float t) { return height * t; });
+    }
+
+    std::string Text() const { return out.str(); }
+
+private:
+    // SceneWriter Private Members
+    std::ostringstream out;
+};
+
+// Rolling terrain of 2 * meshResolution^2 triangles under a sun and an
+// area light: one big mesh, so mostly a test of BVH traversal.
+static std::string MeshScene(const BenchSettings &settings) {
+    SceneWriter w(settings, Point3f(0, -14, 6), Point3f(0, 0, 0), 45);
+    w << "LightSource \"distant\" \"point3 from\" [1 -1 2] \"point3 to\" [0 0 0] \"rgb L\" [2.5 2.4 2.2]\n";
+    w << "AttributeBegin\n"
+         "AreaLightSource \"diffuse\" \"rgb L\" [6 6 6] \"bool twosided\" true\n";
+    w.Quad(Point3f(-1, -1, 6), Point3f(1, -1, 6), Point3f(1, 1, 6), Point3f(-1, 1, 6));
+    w << "AttributeEnd\n";
+
+    w << "Material \"diffuse\" \"rgb reflectance\" [0.4 0.5 0.3]\n";
+    int n = settings.meshResolution;
+    std::vector<Point3f> p;
+    std::vector<int> indices;
+    for (int y = 0; y <= n; ++y)
+        for (int x = 0; x <= n; ++x) {
+            float px = 20.f * x / n - 10, py = 20.f * y / n - 10;
+            float h = 0.6f * std::sin(0.7f * px) * std::cos(0.5f * py) + 0.25f * std::sin(2.3f * px + 1.7f * py) +
+                      0.08f * std::sin(7 * px) * std::cos(6 * py);
+            p.push_back(Point3f(px, py, h));
+        }
+    for (int y = 0; y < n; ++y)
+        for (int x = 0; x < n; ++x) {
+            int v = y * (n + 1) + x;
+            indices.insert(indices.end(), {v, v + 1, v + n + 2, v, v + n + 2, v + n + 1});
+        }
+    w.Mesh(p, indices);
+    return w.Text();
+}
+
+// forestResolution^2 instances of one tree on a ground plane under a sun
+// and a uniform sky: exercises instance traversal.
+static std::string ForestScene(const BenchSettings &settings) {
+    SceneWriter w(settings, Point3f(0, -45, 6), Point3f(0, 0, 1), 50);
+    w << "LightSource \"distant\" \"point3 from\" [-1 -2 3] \"point3 to\" [0 0 0] \"rgb L\" [2.5 2.4 2.2]\n"
+         "LightSource \"infinite\" \"rgb L\" [0.25 0.35 0.5]\n";
+    w << "ObjectBegin \"tree\"\n"
+         "Material \"diffuse\" \"rgb reflectance\" [0.3 0.2 0.1]\n";
+    w.Box(Point3f(-0.1f, -0.1f, 0), Point3f(0.1f, 0.1f, 1));
+    w << "Material \"diffuse\" \"rgb reflectance\" [0.1 0.35 0.1]\n";
+    w.Cone(Point3f(0, 0, 0.8f), 0.6f, 2);
+    w.Cone(Point3f(0, 0, 1.8f), 0.45f, 1.5f);
+    w << "ObjectEnd\n";
+
+    w << "Material \"diffuse\" \"rgb reflectance\" [0.35 0.3 0.25]\n";
+    w.Quad(Point3f(-60, -60, 0), Point3f(60, -60, 0), Point3f(60, 60, 0), Point3f(-60, 60, 0));
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> u(0, 1);
+    int n = settings.forestResolution;
+    for (int y = 0; y < n; ++y)
+        for (int x = 0; x < n; ++x) {
+            float px = 80.f * (x + u(rng)) / n - 40, py = 80.f * (y + u(rng)) / n - 40;
+            std::ostringstream instance;
+            instance << "AttributeBegin\nTranslate " << px << " " << py << " 0\nRotate " << 360 * u(rng)
+                     << " 0 0 1\nScale " << 0.7f + 0.6f * u(rng) << " " << 0.7f + 0.6f * u(rng) << " "
+                     << 0.7f + 0.6f * u(rng) << "\nObjectInstance \"tree\"\nAttributeEnd\n";
+            w << instance.str();
+        }
+    return w.Text();
+}
+
+// Sphere inside a box of scattering fog, lit by a spot light: media and
+// shadow rays through interface surfaces.
+static std::string VolumeScene(const BenchSettings &settings) {
+    SceneWriter w(settings, Point3f(0, -9, 3), Point3f(0, 0, 1.5f), 45);
+    w << "LightSource \"spot\" \"point3 from\" [4 -4 6] \"point3 to\" [0 0 1] \"rgb I\" [80 80 80] "
+         "\"float coneangle\" [35]\n"
+         "LightSource \"distant\" \"point3 from\" [-1 -1 2] \"point3 to\" [0 0 0] \"rgb L\" [0.3 0.3 0.35]\n"
+         "MakeNamedMedium \"fog\" \"string type\" \"homogeneous\" \"rgb sigma_a\" [0.05 0.05 0.05] "
+         "\"rgb sigma_s\" [0.4 0.45 0.5] \"float g\" [0.2]\n";
+    w << "Material \"diffuse\" \"rgb reflectance\" [0.5 0.5 0.5]\n";
+    w.Quad(Point3f(-10, -10, 0), Point3f(10, -10, 0), Point3f(10, 10, 0), Point3f(-10, 10, 0));
+    w.Quad(Point3f(-10, 6, 0), Point3f(10, 6, 0), Point3f(10, 6, 10), Point3f(-10, 6, 10));
+    w << "AttributeBegin\n"
+         "Material \"diffuse\" \"rgb reflectance\" [0.7 0.2 0.2]\n";
+    w.Sphere(Point3f(0, 0, 1.2f), 1);
+    w << "Material \"interface\"\n"
+         "MediumInterface \"fog\" \"\"\n";
+    w.Box(Point3f(-2.5f, -2.5f, 0.01f), Point3f(2.5f, 2.5f, 3.5f));
+    w << "AttributeEnd\n";
+    return w.Text();
+}
+
+// Spheres on a ground plane lit only by an environment map with a sun in
+// it: environment light importance sampling.
+static std::string HDRIScene(const BenchSettings &settings) {
+    // Sky gradient above the horizon, dark ground below and a small, very
+    // bright sun
+    Image sky(Point2i(512, 256), 3);
+    for (int y = 0; y < 256; ++y)
+        for (int x = 0; x < 512; ++x) {
+            float v = (y + 0.5f) / 256, su = (x + 0.5f) / 512 - 0.3f, sv = v - 0.25f;
+            RGB rgb = v < 0.5f ? RGB(0.3f, 0.5f, 0.9f) * (1.2f - v) : RGB(0.15f, 0.12f, 0.1f);
+            rgb += RGB(1, 0.9f, 0.7f) * (400 * std::exp(-(su * su + sv * sv) / 0.0002f));
+            for (int c = 0; c < 3; ++c)
+                sky.SetChannel(Point2i(x, y), c, rgb[c]);
+        }
+    std::string skyFilename = (std::filesystem::path(settings.tempDir) / "sky.pfm").string();
+    sky.Write(skyFilename);
+
+    SceneWriter w(settings, Point3f(0, -9, 3), Point3f(0, 0, 0.8f), 45);
+    w << "LightSource \"infinite\" \"string filename\" \"" + skyFilename + "\"\n";
+    w << "Material \"diffuse\" \"rgb reflectance\" [0.4 0.4 0.4]\n";
+    w.Quad(Point3f(-20, -20, 0), Point3f(20, -20, 0), Point3f(20, 20, 0), Point3f(-20, 20, 0));
+    for (int y = 0; y < 3; ++y)
+        for (int x = 0; x < 3; ++x) {
+            std::ostringstream material;
+            material << "Material \"diffuse\" \"rgb reflectance\" [" << 0.2f + 0.3f * x << " 0.4 "
+                     << 0.2f + 0.3f * y << "]\n";
+            w << material.str();
+            w.Sphere(Point3f(2.2f * (x - 1), 2.2f * (y - 1), 0.8f), 0.8f);
+        }
+    return w.Text();
+}
+
+// Textured walls and ground seen at grazing angles, so that lookups span
+// all MIP levels: tiled texture cache hits, tile loads and filtering.
+static std::string TextureScene(const BenchSettings &settings) {
+    // Checkerboard with a fine grid on it, so that every level has detail
+    const int res = 2048;
+    Image checks(Point2i(res, res), 3);
+    for (int y = 0; y < res; ++y)
+        for (int x = 0; x < res; ++x) {
+            bool odd = ((x / 128) + (y / 128)) & 1, line = x % 16 == 0 || y % 16 == 0;
+            RGB rgb = line ? RGB(0.05f, 0.05f, 0.05f) : odd ? RGB(0.7f, 0.25f, 0.15f) : RGB(0.8f, 0.8f, 0.7f);
+            for (int c = 0; c < 3; ++c)
+                checks.SetChannel(Point2i(x, y), c, rgb[c]);
+        }
+    std::string textureFilename = (std::filesystem::path(settings.tempDir) / "checks.jtx").string();
+    WriteTiledTexture(checks, textureFilename);
+
+    SceneWriter w(settings, Point3f(0, -9, 2), Point3f(0, 4, 1), 60);
+    w << "LightSource \"distant\" \"point3 from\" [1 -2 3] \"point3 to\" [0 0 0] \"rgb L\" [2.5 2.4 2.2]\n"
+      << "LightSource \"infinite\" \"rgb L\" [0.3 0.35 0.4]\n"
+      << "Texture \"checks\" \"spectrum\" \"imagemap\" \"string filename\" \"" + textureFilename + "\"\n"
+      << "Material \"diffuse\" \"texture reflectance\" \"checks\"\n";
+    const float quads[3][4][3] = {{{-10, -10, 0}, {10, -10, 0}, {10, 30, 0},  {-10, 30, 0}},
+                                  {{-6, -10, 0},  {-6, 30, 0},  {-6, 30, 8},  {-6, -10, 8}},
+                                  {{6, 30, 0},    {6, -10, 0},  {6, -10, 8},  {6, 30, 8}}};
+    for (const auto &q : quads) {
+        std::ostringstream shape;
+        shape << "Shape \"trianglemesh\" \"point3 P\" [";
+        for (const float *p : q)
+            shape << ' ' << p[0] << ' ' << p[1] << ' ' << p[2];
+        shape << " ] \"point2 uv\" [0 0 1 0 1 1 0 1] \"integer indices\" [0 1 2 0 2 3]\n";
+        w << shape.str();
+    }
+    return w.Text();
+}
+
+#pragma endregion Procedural Scenes
+
+#pragma region Shadow Rays
+
+// Shadow rays from where camera rays first hit the scene to random points in
+// its bounds, about half of them occluded in a typical scene.
+static std::vector<ShadowRay> MakeShadowRays(const Scene &scene, const PerspectiveCamera &camera, size_t n) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> u(0, 1);
+    Bounds3f bounds = scene.Bounds();
+    Point2i res = camera.Resolution();
+    std::vector<ShadowRay> rays;
+    for (size_t i = 0; i < 4 * n && rays.size() < n; ++i) {
+        Ray ray = camera.GenerateRay(Point2f(u(rng) * res.x, u(rng) * res.y));
+        std::optional<ShapeIntersection> si = scene.Aggregate().Intersect(ray);
+        if (!si)
+            continue;
+        Point3f p = ray(si->intr.t * 0.999f);
+        Point3f target(Lerp(u(rng), bounds.pMin.x, bounds.pMax.x), Lerp(u(rng), bounds.pMin.y, bounds.pMax.y),
+                       Lerp(u(rng), bounds.pMin.z, bounds.pMax.z));
+        rays.push_back(ShadowRay{Ray(p, target - p)});
+    }
+    return rays;
+}
+
+// Occlusion tests per second, single threaded, with closest-hit traversal,
+// any-hit traversal and the batched any-hit query.
+static BenchmarkResult ShadowRayBenchmark(const std::string &name, const Scene &scene,
+                                          const PerspectiveCamera &camera) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<ShadowRay> rays = MakeShadowRays(scene, camera, 256 * 1024);
+    const BVHAggregate &bvh = scene.Aggregate();
+    auto rate = [&](auto &&trace) {
+        Clock::time_point start = Clock::now();
+        size_t nOccluded = trace();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return std::make_pair(rays.size() / seconds / 1e6, nOccluded);
+    };
+    auto [closestHit, nClosest] = rate([&]() {
+        size_t n = 0;
+        for (const ShadowRay &r : rays)
+            n += bool(bvh.Intersect(r.ray, r.tMax));
+        return n;
+    });
+    auto [anyHit, nAny] = rate([&]() {
+        size_t n = 0;
+        for (const ShadowRay &r : rays)
+            n += bvh.IntersectP(r.ray, r.tMax);
+        return n;
+    });
+    auto [batched, nBatched] = rate([&]() {
+        bvh.IntersectP(span<ShadowRay>(rays));
+        return size_t(std::count_if(rays.begin(), rays.end(), [](const ShadowRay &r) { return r.occluded; }));
+    });
+    if (nAny != nClosest || nBatched != nClosest)
+        throw std::runtime_error(name + ": any-hit and closest-hit shadow rays disagree");
+    return BenchmarkResult{name + "/shadow", {{"closest_hit_mrays_per_s", closestHit},
+                                              {"any_hit_mrays_per_s", anyHit},
+                                              {"batched_mrays_per_s", batched}}};
+}
+
+#pragma endregion Shadow Rays
+
+int main(int argc, const char *argv[])
+{
+    cxxopts::Options options("renderbench", "End-to-end rendering benchmarks on procedural scenes");
+    options.add_options()
+            ("h,help", "Print this help text.")
+            ("filter", "Only run scenes whose name contains this string.",
+             cxxopts::value<std::string>()->default_value(""))
+            ("j,nthreads", "Measure thread scaling from 1 up to this many threads; 0 uses all cores.",
+             cxxopts::value<int>()->default_value("0"))
+            ("spp", "Samples per pixel.", cxxopts::value<int>()->default_value("4"))
+            ("resolution", "Width and height of the images.", cxxopts::value<int>()->default_value("256"))
+            ("maxdepth", "Maximum path length.", cxxopts::value<int>()->default_value("5"))
+            ("tileorder", "Tile order: hilbert, morton, spiral or rowmajor.",
+             cxxopts::value<std::string>()->default_value("hilbert"))
+            ("meshres", "Quads per side of the terrain of the mesh scene.",
+             cxxopts::value<int>()->default_value("512"))
+            ("forestres", "Trees per side of the forest scene.", cxxopts::value<int>()->default_value("64"))
+            ("texturecache", "Memory for decoded texture tiles, in MiB.",
+             cxxopts::value<int>()->default_value("256"))
+            ("trace", "Write a Chrome trace of all runs to this file.", cxxopts::value<std::string>())
+            ("imagedir", "Write the rendered images to this directory.", cxxopts::value<std::string>())
+            ("o,outfile", "Write the results as JSON to this file, or - for stdout.", cxxopts::value<std::string>())
+            ("baseline", "Compare against results previously written with --outfile.",
+             cxxopts::value<std::string>())
+            ("threshold", "Relative slowdown against the baseline that counts as a regression.",
+             cxxopts::value<double>()->default_value("0.1"));
+
+    auto result = options.parse(argc, argv);
+    if (result.count("help"))
+    {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    BenchSettings settings;
+    settings.resolution = std::max(1, result["resolution"].as<int>());
+    settings.spp = std::max(1, result["spp"].as<int>());
+    settings.maxDepth = std::max(1, result["maxdepth"].as<int>());
+    settings.meshResolution = std::max(1, result["meshres"].as<int>());
+    settings.forestResolution = std::max(1, result["forestres"].as<int>());
+    const std::string filter = result["filter"].as<std::string>();
+    SetTextureCacheSize(size_t(std::max(1, result["texturecache"].as<int>())) << 20);
+    int maxThreads = result["nthreads"].as<int>() > 0 ? result["nthreads"].as<int>() : AvailableCores();
+    // The full thread count runs first, so that time to first pixel is that
+    // of a cold start; then the scaling curve from one thread up
+    std::vector<int> threadCounts = {maxThreads};
+    for (int n = 1; n < maxThreads; n *= 2)
+        threadCounts.push_back(n);
+
+    std::vector<std::pair<const char *, std::function<std::string(const BenchSettings &)>>> scenes = {
+            {"mesh",    MeshScene},
+            {"forest",  ForestScene},
+            {"volume",  VolumeScene},
+            {"hdri",    HDRIScene},
+            {"texture", TextureScene}};
+
+    std::vector<BenchmarkResult> results;
+    try
+    {
+#if defined(__linux__) || defined(__APPLE__)
+        std::string pid = std::to_string(getpid());
+#else
+        std::string pid = "0";
+#endif
+        std::filesystem::path tempDir = std::filesystem::temp_directory_path() / ("jadehare-renderbench-" + pid);
+        std::filesystem::create_directories(tempDir);
+        settings.tempDir = tempDir.string();
+
+        if (result.count("trace"))
+            InitProfiler(result["trace"].as<std::string>());
+        std::printf("%-24s %12s %12s %12s %12s %10s\n", "benchmark", "primary", "secondary", "render", "first pixel",
+                    "peak RSS");
+        for (const auto &[name, generate] : scenes)
+        {
+            if (std::string(name).find(filter) == std::string::npos)
+                continue;
+            ParallelInit(maxThreads);
+            ResetPeakRSS();
+            std::string text = generate(settings);
+
+            using Clock = std::chrono::steady_clock;
+            Clock::time_point start = Clock::now();
+            std::unique_ptr<Scene> scene = Scene::Build(*ParseString(std::move(text)));
+            const CameraData &cameraData = scene->Camera();
+            PerspectiveCamera camera(cameraData.worldFromCamera, cameraData.fov,
+                                     Point2i(cameraData.xResolution, cameraData.yResolution),
+                                     scene->GetMedium(cameraData.mediumIndex), cameraData.shutterOpen,
+                                     cameraData.shutterClose);
+            PathIntegrator integrator(*scene, cameraData.maxDepth);
+            integrator.SetTileOrder(ParseTileOrder(result["tileorder"].as<std::string>()));
+            double buildSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            std::vector<std::pair<int, RenderStats>> runs;
+            for (int nThreads : threadCounts)
+            {
+                if (nThreads != RunningThreads())
+                {
+                    ParallelCleanup();
+                    ParallelInit(nThreads);
+                }
+                RGBFilm film(camera.Resolution());
+                runs.push_back({nThreads, integrator.Render(camera, cameraData.samplesPerPixel, film)});
+                if (runs.size() == 1 && result.count("imagedir"))
+                    film.WriteImage((std::filesystem::path(result["imagedir"].as<std::string>()) /
+                                     (std::string(name) + ".exr")).string());
+            }
+            ParallelCleanup();
+            double peakRSS = PeakRSSMegabytes();
+
+            double timeToFirstPixel = buildSeconds + runs[0].second.firstTileSeconds;
+            results.push_back(BenchmarkResult{name, {{"build_s", buildSeconds},
+                                                     {"time_to_first_pixel_s", timeToFirstPixel},
+                                                     {"peak_rss_mb", peakRSS}}});
+            std::printf("%-24s %12s %12s %11.3fs %11.3fs %7.1f MB   (%zu triangles, %zu instances)\n", name, "",
+                        "", buildSeconds, timeToFirstPixel, peakRSS, scene->NumTriangles(),
+                        scene->Instances().size());
+
+            std::sort(runs.begin(), runs.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+            double serialSeconds = runs[0].second.seconds;
+            for (const auto &[nThreads, stats] : runs)
+            {
+                BenchmarkResult r{std::string(name) + "/threads=" + std::to_string(nThreads),
+                                  {{"primary_mrays_per_s", stats.cameraRays / stats.seconds / 1e6},
+                                   {"secondary_mrays_per_s", stats.secondaryRays / stats.seconds / 1e6},
+                                   {"render_s", stats.seconds},
+                                   {"speedup", serialSeconds / stats.seconds}}};
+                std::printf("%-24s %6.2f Mr/s %6.2f Mr/s %11.3fs %11s %10s   %.2fx\n", r.name.c_str(),
+                            r.Metric("primary_mrays_per_s"), r.Metric("secondary_mrays_per_s"), stats.seconds, "",
+                            "", r.Metric("speedup"));
+                results.push_back(std::move(r));
+            }
+
+            BenchmarkResult shadow = ShadowRayBenchmark(name, *scene, camera);
+            std::printf("%-24s %6.2f Mr/s closest hit, %6.2f Mr/s any hit, %6.2f Mr/s batched\n",
+                        shadow.name.c_str(), shadow.Metric("closest_hit_mrays_per_s"),
+                        shadow.Metric("any_hit_mrays_per_s"), shadow.Metric("batched_mrays_per_s"));
+            results.push_back(std::move(shadow));
+        }
+        std::filesystem::remove_all(tempDir);
+        WriteTrace();
+
+        std::vector<std::pair<std::string, std::string>> context = {
+                {"resolution", std::to_string(settings.resolution)},
+                {"spp", std::to_string(settings.spp)},
+                {"maxdepth", std::to_string(settings.maxDepth)},
+                {"tile_order", result["tileorder"].as<std::string>()},
+                {"max_threads", std::to_string(maxThreads)}};
+#if !defined(NDEBUG) || defined(JADEHARE_CHECKED_BUILD)
+        context.push_back({"dchecks", "on"});
+#else
+        context.push_back({"dchecks", "off"});
+#endif
+        if (result.count("outfile"))
+            WriteBenchmarkJSON(result["outfile"].as<std::string>(), "render", context, results);
+        if (result.count("baseline"))
+        {
+            std::cout << std::endl;
+            int nRegressions = CompareBenchmarks(ReadBenchmarkJSON(result["baseline"].as<std::string>()), results,
+                                                 result["threshold"].as<double>());
+            if (nRegressions > 0)
+            {
+                std::cout << nRegressions << " regression(s) against the baseline" << std::endl;
+                return 2;
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
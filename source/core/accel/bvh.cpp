@@ -0,0 +1,765 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/accel/bvh.h"
+#include "util/parallel.h"
+#include "util/profile.h"
+#include "util/stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace jadehare {
+
+    STAT_COUNTER("Intersections/Rays traced", nRays);
+    STAT_RATIO("BVH/Nodes visited per ray", nNodesVisited, nNodeRays);
+    STAT_RATIO("BVH/Triangle tests per ray", nTriangleTests, nTriangleRays);
+    STAT_COUNTER("BVH/Instance traversals", nInstanceTraversals);
+    STAT_COUNTER("Intersections/Shadow rays traced", nShadowRays);
+    STAT_RATIO("BVH/Nodes visited per shadow ray", nShadowNodesVisited, nShadowNodeRays);
+    STAT_INT_DISTRIBUTION("BVH/Primitives per leaf", leafPrimitives);
+    STAT_COUNTER("BVH/Nodes refit", nNodesRefit);
+    STAT_MEMORY_COUNTER("Memory/BVH", bvhBytes);
+
+#pragma region BVH Construction
+
+    // BVHPrimitiveInfo Definition
+    struct BVHPrimitiveInfo {
+        Point3f Centroid() const { return (bounds.pMin + bounds.pMax) * 0.5f; }
+
+        BVHPrimitive primitive;
+        Bounds3f bounds;
+    };
+
+    // BVHBuildNode Definition
+    struct BVHBuildNode {
+        void InitLeaf(int first, int n, const Bounds3f &b) {
+            firstPrimOffset = first;
+            nPrimitives = n;
+            bounds = b;
+            children[0] = children[1] = nullptr;
+        }
+
+        void InitInterior(int axis, BVHBuildNode *c0, BVHBuildNode *c1) {
+            children[0] = c0;
+            children[1] = c1;
+            bounds = Union(c0->bounds, c1->bounds);
+            splitAxis = axis;
+            nPrimitives = 0;
+        }
+
+        Bounds3f bounds;
+        BVHBuildNode *children[2];
+        int splitAxis, firstPrimOffset, nPrimitives;
+    };
+
+    // BVHBuilder Definition
+    // Build nodes come out of a preallocated pool (a binary tree over n
+    // primitives has at most 2n - 1 nodes), so parallel subtree builds only
+    // share two atomic counters.
+    class BVHBuilder {
+    public:
+        BVHBuilder(std::vector<BVHPrimitiveInfo> &info, int maxPrimsInNode)
+                : maxPrimsInNode(std::min(255, maxPrimsInNode)), info(info),
+                  nodePool(std::max<size_t>(1, 2 * info.size())), orderedPrims(info.size()) {}
+
+        BVHBuildNode *Build() { return BuildRecursive(span<BVHPrimitiveInfo>(info)); }
+
+        void Flatten(BVHBuildNode *root, std::vector<LinearBVHNode> *nodes) {
+            nodes->resize(nextNode.load());
+            int offset = 0;
+            FlattenRecursive(root, nodes, &offset);
+        }
+
+        std::vector<BVHPrimitive> &OrderedPrimitives() { return orderedPrims; }
+
+    private:
+        BVHBuildNode *BuildRecursive(span<BVHPrimitiveInfo> prims);
+
+        BVHBuildNode *BuildChildren(span<BVHPrimitiveInfo> prims, size_t mid, int dim);
+
+        BVHBuildNode *MakeLeaf(span<BVHPrimitiveInfo> prims, const Bounds3f &bounds) {
+            BVHBuildNode *node = &nodePool[nextNode++];
+            int first = orderedPrimsOffset.fetch_add(int(prims.size()));
+            for (size_t i = 0; i < prims.size(); ++i)
+                orderedPrims[first + i] = prims[i].primitive;
+            node->InitLeaf(first, int(prims.size()), bounds);
+            return node;
+        }
+
+        int FlattenRecursive(BVHBuildNode *node, std::vector<LinearBVHNode> *nodes, int *offset) {
+            LinearBVHNode *linearNode = &(*nodes)[*offset];
+            linearNode->bounds = node->bounds;
+            int nodeOffset = (*offset)++;
+            if (node->nPrimitives > 0) {
+                linearNode->primitivesOffset = node->firstPrimOffset;
+                linearNode->nPrimitives = uint16_t(node->nPrimitives);
+            } else {
+                linearNode->axis = uint8_t(node->splitAxis);
+                linearNode->nPrimitives = 0;
+                FlattenRecursive(node->children[0], nodes, offset);
+                (*nodes)[nodeOffset].secondChildOffset = FlattenRecursive(node->children[1], nodes, offset);
+            }
+            return nodeOffset;
+        }
+
+        int maxPrimsInNode;
+        std::vector<BVHPrimitiveInfo> &info;
+        std::vector<BVHBuildNode> nodePool;
+        std::atomic<int> nextNode{0};
+        std::vector<BVHPrimitive> orderedPrims;
+        std::atomic<int> orderedPrimsOffset{0};
+    };
+
+    BVHBuildNode *BVHBuilder::BuildRecursive(span<BVHPrimitiveInfo> prims) {
+        Bounds3f bounds;
+        for (const BVHPrimitiveInfo &p : prims)
+            bounds = Union(bounds, p.bounds);
+        if (prims.size() == 1 || (bounds.SurfaceArea() == 0 && prims.size() <= size_t(maxPrimsInNode)))
+            return MakeLeaf(prims, bounds);
+
+        Bounds3f centroidBounds;
+        for (const BVHPrimitiveInfo &p : prims)
+            centroidBounds = Union(centroidBounds, p.Centroid());
+        int dim = centroidBounds.MaxDimension();
+        if (centroidBounds.pMax[dim] == centroidBounds.pMin[dim]) {
+            if (prims.size() <= size_t(maxPrimsInNode))
+                return MakeLeaf(prims, bounds);
+            // All centroids coincide; split in half so leaves stay small
+            size_t mid = prims.size() / 2;
+            return BuildChildren(prims, mid, dim);
+        }
+
+        size_t mid;
+        if (prims.size() <= 2) {
+            // Partition into equally sized subsets
+            mid = prims.size() / 2;
+            std::nth_element(prims.begin(), prims.begin() + mid, prims.end(),
+                             [dim](const BVHPrimitiveInfo &a, const BVHPrimitiveInfo &b) {
+                                 return a.Centroid()[dim] < b.Centroid()[dim];
+                             });
+        } else {
+            // Bin the centroids and evaluate the SAH at the bucket boundaries
+            constexpr int nBuckets = 12;
+            struct BVHSplitBucket {
+                int count = 0;
+                Bounds3f bounds;
+            } buckets[nBuckets];
+            auto bucketIndex = [&](const BVHPrimitiveInfo &p) {
+                int b = int(nBuckets * centroidBounds.Offset(p.Centroid())[dim]);
+                return std::min(b, nBuckets - 1);
+            };
+            for (const BVHPrimitiveInfo &p : prims) {
+                BVHSplitBucket &bucket = buckets[bucketIndex(p)];
+                ++bucket.count;
+                bucket.bounds = Union(bucket.bounds, p.bounds);
+            }
+
+            // Sweep forward for the below costs and backward for the above ones
+            constexpr int nSplits = nBuckets - 1;
+            float costs[nSplits] = {};
+            int countBelow = 0;
+            Bounds3f boundBelow;
+            for (int i = 0; i < nSplits; ++i) {
+                boundBelow = Union(boundBelow, buckets[i].bounds);
+                countBelow += buckets[i].count;
+                costs[i] += countBelow * boundBelow.SurfaceArea();
+            }
+            int countAbove = 0;
+            Bounds3f boundAbove;
+            for (int i = nSplits; i >= 1; --i) {
+                boundAbove = Union(boundAbove, buckets[i].bounds);
+                countAbove += buckets[i].count;
+                costs[i - 1] += countAbove * boundAbove.SurfaceArea();
+            }
+
+            int minCostSplitBucket = -1;
+            float minCost = Infinity;
+            for (int i = 0; i < nSplits; ++i)
+                if (costs[i] < minCost) {
+                    minCost = costs[i];
+                    minCostSplitBucket = i;
+                }
+            // Traversal is taken to cost half a triangle test
+            float leafCost = float(prims.size());
+            minCost = 1.f / 2.f + minCost / bounds.SurfaceArea();
+
+            if (prims.size() > size_t(maxPrimsInNode) || minCost < leafCost) {
+                auto midIter = std::partition(prims.begin(), prims.end(), [&](const BVHPrimitiveInfo &p) {
+                    return bucketIndex(p) <= minCostSplitBucket;
+                });
+                mid = midIter - prims.begin();
+                if (mid == 0 || mid == prims.size())
+                    mid = prims.size() / 2;
+            } else
+                return MakeLeaf(prims, bounds);
+        }
+        return BuildChildren(prims, mid, dim);
+    }
+
+    BVHBuildNode *BVHBuilder::BuildChildren(span<BVHPrimitiveInfo> prims, size_t mid, int dim) {
+        BVHBuildNode *node = &nodePool[nextNode++];
+        BVHBuildNode *children[2];
+        if (prims.size() > 128 * 1024) {
+            // Big enough to be worth building the two subtrees concurrently
+            ParallelFor(0, 2, [&](int64_t i) {
+                PROFILE_SCOPE("Build BVH subtree");
+                children[i] = i == 0 ? BuildRecursive(prims.subspan(0, mid))
+                                     : BuildRecursive(prims.subspan(mid, prims.size() - mid));
+            });
+        } else {
+            children[0] = BuildRecursive(prims.subspan(0, mid));
+            children[1] = BuildRecursive(prims.subspan(mid, prims.size() - mid));
+        }
+        node->InitInterior(dim, children[0], children[1]);
+        return node;
+    }
+
+    // BVHMotionPrimitiveInfo Definition
+    // A primitive with its bounds at the start and end of the time range of
+    // the node being built.
+    struct BVHMotionPrimitiveInfo {
+        Point3f Centroid() const {
+            return (bounds[0].pMin + bounds[0].pMax + bounds[1].pMin + bounds[1].pMax) * 0.25f;
+        }
+
+        BVHPrimitive primitive;
+        Bounds3f bounds[2];
+    };
+
+    // Surface area of linearly interpolated bounds averaged over time; it is
+    // quadratic in time, so Simpson's rule is exact.
+    static float MotionSurfaceArea(const Bounds3f &b0, const Bounds3f &b1) {
+        return (b0.SurfaceArea() + 4 * Lerp(0.5f, b0, b1).SurfaceArea() + b1.SurfaceArea()) / 6;
+    }
+
+    // MotionBVHBuilder Definition
+    // Builds motion BVHs, serially and straight into the flattened layout.
+    // Spatial splits use the binned SAH with time-averaged areas. Where the
+    // interpolated node bounds midway through the time range are much
+    // larger than what the primitives cover then, the range is split in
+    // half instead and each half gets a subtree over all the primitives,
+    // bounded over that half only.
+    class MotionBVHBuilder {
+    public:
+        using LinearBoundsFunction = std::function<void(const BVHPrimitive &, float, float, Bounds3f *, Bounds3f *)>;
+
+        MotionBVHBuilder(LinearBoundsFunction linearBounds, int maxPrimsInNode, int maxTemporalSplits)
+                : linearBounds(std::move(linearBounds)), maxPrimsInNode(std::min(255, maxPrimsInNode)),
+                  maxTemporalSplits(maxTemporalSplits) {}
+
+        void Build(std::vector<BVHMotionPrimitiveInfo> &info, float t0, float t1) {
+            BuildRecursive(span<BVHMotionPrimitiveInfo>(info), t0, t1, maxTemporalSplits);
+        }
+
+        std::vector<LinearBVHNode> nodes;
+        std::vector<LinearBVHNodeMotion> motionNodes;
+        std::vector<BVHPrimitive> orderedPrims;
+
+    private:
+        // Returns the index of the new node.
+        int BuildRecursive(span<BVHMotionPrimitiveInfo> prims, float t0, float t1, int splitsLeft);
+
+        int MakeLeaf(int nodeIndex, span<BVHMotionPrimitiveInfo> prims) {
+            nodes[nodeIndex].primitivesOffset = int(orderedPrims.size());
+            nodes[nodeIndex].nPrimitives = uint16_t(prims.size());
+            for (const BVHMotionPrimitiveInfo &p : prims)
+                orderedPrims.push_back(p.primitive);
+            return nodeIndex;
+        }
+
+        // Interior nodes are only this much larger midway than their
+        // primitives before a temporal split pays for the duplication.
+        static constexpr float TemporalSplitRatio = 2;
+
+        LinearBoundsFunction linearBounds;
+        int maxPrimsInNode, maxTemporalSplits;
+    };
+
+    int MotionBVHBuilder::BuildRecursive(span<BVHMotionPrimitiveInfo> prims, float t0, float t1, int splitsLeft) {
+        Bounds3f bounds[2];
+        for (const BVHMotionPrimitiveInfo &p : prims) {
+            bounds[0] = Union(bounds[0], p.bounds[0]);
+            bounds[1] = Union(bounds[1], p.bounds[1]);
+        }
+        int nodeIndex = int(nodes.size());
+        nodes.emplace_back();
+        nodes[nodeIndex].bounds = bounds[0];
+        motionNodes.push_back({bounds[1], t0, t1});
+        float area = MotionSurfaceArea(bounds[0], bounds[1]);
+        if (prims.size() == 1 || (area == 0 && prims.size() <= size_t(maxPrimsInNode)))
+            return MakeLeaf(nodeIndex, prims);
+
+        if (splitsLeft > 0) {
+            Bounds3f midBounds;
+            for (const BVHMotionPrimitiveInfo &p : prims)
+                midBounds = Union(midBounds, Lerp(0.5f, p.bounds[0], p.bounds[1]));
+            if (Lerp(0.5f, bounds[0], bounds[1]).SurfaceArea() > TemporalSplitRatio * midBounds.SurfaceArea()) {
+                // Rebound the primitives over each half of the time range
+                float tMid = (t0 + t1) / 2;
+                std::vector<BVHMotionPrimitiveInfo> early(prims.begin(), prims.end()), late = early;
+                for (size_t i = 0; i < prims.size(); ++i) {
+                    linearBounds(prims[i].primitive, t0, tMid, &early[i].bounds[0], &early[i].bounds[1]);
+                    linearBounds(prims[i].primitive, tMid, t1, &late[i].bounds[0], &late[i].bounds[1]);
+                }
+                nodes[nodeIndex].axis = LinearBVHNode::TemporalSplit;
+                nodes[nodeIndex].nPrimitives = 0;
+                BuildRecursive(span<BVHMotionPrimitiveInfo>(early), t0, tMid, splitsLeft - 1);
+                int second = BuildRecursive(span<BVHMotionPrimitiveInfo>(late), tMid, t1, splitsLeft - 1);
+                nodes[nodeIndex].secondChildOffset = second;
+                return nodeIndex;
+            }
+        }
+
+        Bounds3f centroidBounds;
+        for (const BVHMotionPrimitiveInfo &p : prims)
+            centroidBounds = Union(centroidBounds, p.Centroid());
+        int dim = centroidBounds.MaxDimension();
+        size_t mid = prims.size() / 2;
+        if (centroidBounds.pMax[dim] == centroidBounds.pMin[dim]) {
+            if (prims.size() <= size_t(maxPrimsInNode))
+                return MakeLeaf(nodeIndex, prims);
+        } else if (prims.size() <= 2) {
+            std::nth_element(prims.begin(), prims.begin() + mid, prims.end(),
+                             [dim](const BVHMotionPrimitiveInfo &a, const BVHMotionPrimitiveInfo &b) {
+                                 return a.Centroid()[dim] < b.Centroid()[dim];
+                             });
+        } else {
+            // Bin the centroids and evaluate the SAH at the bucket boundaries
+            constexpr int nBuckets = 12;
+            struct BVHSplitBucket {
+                int count = 0;
+                Bounds3f bounds[2];
+            } buckets[nBuckets];
+            auto bucketIndex = [&](const BVHMotionPrimitiveInfo &p) {
+                int b = int(nBuckets * centroidBounds.Offset(p.Centroid())[dim]);
+                return std::min(b, nBuckets - 1);
+            };
+            for (const BVHMotionPrimitiveInfo &p : prims) {
+                BVHSplitBucket &bucket = buckets[bucketIndex(p)];
+                ++bucket.count;
+                bucket.bounds[0] = Union(bucket.bounds[0], p.bounds[0]);
+                bucket.bounds[1] = Union(bucket.bounds[1], p.bounds[1]);
+            }
+
+            constexpr int nSplits = nBuckets - 1;
+            float costs[nSplits] = {};
+            int countBelow = 0;
+            Bounds3f boundBelow[2];
+            for (int i = 0; i < nSplits; ++i) {
+                boundBelow[0] = Union(boundBelow[0], buckets[i].bounds[0]);
+                boundBelow[1] = Union(boundBelow[1], buckets[i].bounds[1]);
+                countBelow += buckets[i].count;
+                costs[i] += countBelow * MotionSurfaceArea(boundBelow[0], boundBelow[1]);
+            }
+            int countAbove = 0;
+            Bounds3f boundAbove[2];
+            for (int i = nSplits; i >= 1; --i) {
+                boundAbove[0] = Union(boundAbove[0], buckets[i].bounds[0]);
+                boundAbove[1] = Union(boundAbove[1], buckets[i].bounds[1]);
+                countAbove += buckets[i].count;
+                costs[i - 1] += countAbove * MotionSurfaceArea(boundAbove[0], boundAbove[1]);
+            }
+
+            int minCostSplitBucket = -1;
+            float minCost = Infinity;
+            for (int i = 0; i < nSplits; ++i)
+                if (costs[i] < minCost) {
+                    minCost = costs[i];
+                    minCostSplitBucket = i;
+                }
+            float leafCost = float(prims.size());
+            minCost = 1.f / 2.f + minCost / area;
+
+            if (prims.size() <= size_t(maxPrimsInNode) && minCost >= leafCost)
+                return MakeLeaf(nodeIndex, prims);
+            auto midIter = std::partition(prims.begin(), prims.end(), [&](const BVHMotionPrimitiveInfo &p) {
+                return bucketIndex(p) <= minCostSplitBucket;
+            });
+            mid = midIter - prims.begin();
+            if (mid == 0 || mid == prims.size())
+                mid = prims.size() / 2;
+        }
+
+        nodes[nodeIndex].axis = uint8_t(dim);
+        nodes[nodeIndex].nPrimitives = 0;
+        BuildRecursive(prims.subspan(0, mid), t0, t1, splitsLeft);
+        int second = BuildRecursive(prims.subspan(mid, prims.size() - mid), t0, t1, splitsLeft);
+        nodes[nodeIndex].secondChildOffset = second;
+        return nodeIndex;
+    }
+
+    BVHAggregate::BVHAggregate(span<const TriangleMesh> meshes, span<const ObjectInstance> instances,
+                               span<const BVHAggregate> prototypes, span<const AnimatedTransform> instanceMotion,
+                               int maxPrimsInNode, int maxTemporalSplits)
+            : meshes(meshes), instances(instances), prototypes(prototypes), instanceMotion(instanceMotion) {
+        PROFILE_SCOPE("Build BVH");
+        if (std::any_of(instances.begin(), instances.end(),
+                        [](const ObjectInstance &instance) { return instance.motionIndex >= 0; }))
+            BuildMotion(maxPrimsInNode, maxTemporalSplits);
+        else
+            BuildStatic(maxPrimsInNode);
+        nodes = nodeStorage;
+        primitives = primitiveStorage;
+        motionNodes = motionNodeStorage;
+
+        for (const LinearBVHNode &node : nodes)
+            if (node.nPrimitives > 0)
+                ReportValue(leafPrimitives, node.nPrimitives);
+        bvhBytes += int64_t(nodes.size() * sizeof(LinearBVHNode) + primitives.size() * sizeof(BVHPrimitive) +
+                            motionNodes.size() * sizeof(LinearBVHNodeMotion));
+    }
+
+    void BVHAggregate::BuildStatic(int maxPrimsInNode) {
+        // Gather primitive bounds in parallel; instances go after the triangles
+        std::vector<size_t> firstTriangle(meshes.size() + 1, 0);
+        for (size_t m = 0; m < meshes.size(); ++m)
+            firstTriangle[m + 1] = firstTriangle[m] + meshes[m].NumTriangles();
+        std::vector<BVHPrimitiveInfo> info(firstTriangle.back() + instances.size());
+        if (info.empty())
+            return;
+        for (size_t i = 0; i < instances.size(); ++i)
+            info[firstTriangle.back() + i] = {BVHPrimitive{BVHPrimitive::InstanceMesh, uint32_t(i)},
+                                              instances[i].bounds};
+        ParallelFor(0, int64_t(meshes.size()), [&](int64_t m) {
+            ParallelFor(0, int64_t(meshes[m].NumTriangles()), [&](int64_t begin, int64_t end) {
+                for (int64_t t = begin; t < end; ++t)
+                    info[firstTriangle[m] + t] = {BVHPrimitive{uint32_t(m), uint32_t(t)},
+                                                  meshes[m].TriangleBounds(t)};
+            });
+        });
+
+        BVHBuilder builder(info, maxPrimsInNode);
+        BVHBuildNode *root = builder.Build();
+        builder.Flatten(root, &nodeStorage);
+        primitiveStorage = std::move(builder.OrderedPrimitives());
+    }
+
+    void BVHAggregate::BuildMotion(int maxPrimsInNode, int maxTemporalSplits) {
+        // Bound everything over the time range of all the motions
+        float t0 = Infinity, t1 = -Infinity;
+        for (const AnimatedTransform &motion : instanceMotion) {
+            t0 = std::min(t0, motion.StartTime());
+            t1 = std::max(t1, motion.EndTime());
+        }
+        std::vector<BVHMotionPrimitiveInfo> info;
+        auto addPrimitive = [&](const BVHPrimitive &prim) {
+            Bounds3f b0, b1;
+            PrimitiveLinearBounds(prim, t0, t1, &b0, &b1);
+            info.push_back({prim, {b0, b1}});
+        };
+        for (size_t m = 0; m < meshes.size(); ++m)
+            for (size_t t = 0; t < meshes[m].NumTriangles(); ++t)
+                addPrimitive(BVHPrimitive{uint32_t(m), uint32_t(t)});
+        for (size_t i = 0; i < instances.size(); ++i)
+            addPrimitive(BVHPrimitive{BVHPrimitive::InstanceMesh, uint32_t(i)});
+
+        MotionBVHBuilder builder([this](const BVHPrimitive &prim, float start, float end, Bounds3f *b0, Bounds3f *b1) {
+            PrimitiveLinearBounds(prim, start, end, b0, b1);
+        }, maxPrimsInNode, maxTemporalSplits);
+        builder.Build(info, t0, t1);
+        nodeStorage = std::move(builder.nodes);
+        motionNodeStorage = std::move(builder.motionNodes);
+        primitiveStorage = std::move(builder.orderedPrims);
+    }
+
+    void BVHAggregate::PrimitiveLinearBounds(const BVHPrimitive &prim, float t0, float t1, Bounds3f *b0,
+                                             Bounds3f *b1) const {
+        if (!prim.IsInstance()) {
+            *b0 = *b1 = meshes[prim.meshIndex].TriangleBounds(prim.triangleIndex);
+            return;
+        }
+        const ObjectInstance &instance = instances[prim.triangleIndex];
+        if (instance.motionIndex < 0) {
+            *b0 = *b1 = instance.bounds;
+            return;
+        }
+        instanceMotion[instance.motionIndex].LinearBounds(prototypes[instance.prototypeIndex].Bounds(), t0, t1,
+                                                          b0, b1);
+    }
+
+#pragma endregion BVH Construction
+
+#pragma region BVH Traversal
+
+    // Bounds of a motion BVH node at the given time.
+    static Bounds3f MotionNodeBounds(const LinearBVHNode &node, const LinearBVHNodeMotion &motion, float time) {
+        if (motion.timeEnd <= motion.timeStart)
+            return node.bounds;
+        float u = Clamp((time - motion.timeStart) / (motion.timeEnd - motion.timeStart), 0, 1);
+        return Lerp(u, node.bounds, motion.boundsEnd);
+    }
+
+    std::optional<ShapeIntersection> BVHAggregate::Intersect(const Ray &ray, float tMax) const {
+        ++nRays;
+        ++nNodeRays;
+        ++nTriangleRays;
+        return IntersectNodes(ray, tMax);
+    }
+
+    std::optional<ShapeIntersection> BVHAggregate::IntersectNodes(const Ray &ray, float tMax) const {
+        if (nodes.empty())
+            return {};
+        std::optional<ShapeIntersection> si;
+        // Counted locally and added to the statistics once per traversal
+        int64_t nodesVisited = 0, triangleTests = 0;
+        Vector3f invDir(1 / ray.d.x, 1 / ray.d.y, 1 / ray.d.z);
+        int dirIsNeg[3] = {int(invDir.x < 0), int(invDir.y < 0), int(invDir.z < 0)};
+        // Follow ray through BVH nodes to find primitive intersections
+        int toVisitOffset = 0, currentNodeIndex = 0;
+        int nodesToVisit[64];
+        while (true) {
+            const LinearBVHNode *node = &nodes[currentNodeIndex];
+            ++nodesVisited;
+            bool hitBounds = motionNodes.empty()
+                             ? node->bounds.IntersectP(ray.o, ray.d, tMax, invDir, dirIsNeg)
+                             : MotionNodeBounds(*node, motionNodes[currentNodeIndex], ray.time)
+                                     .IntersectP(ray.o, ray.d, tMax, invDir, dirIsNeg);
+            if (hitBounds) {
+                if (node->nPrimitives > 0) {
+                    for (int i = 0; i < node->nPrimitives; ++i) {
+                        const BVHPrimitive &prim = primitives[node->primitivesOffset + i];
+                        if (prim.IsInstance()) {
+                            // Trace the instance-space ray through the prototype;
+                            // t is the same in both spaces
+                            const ObjectInstance &instance = instances[prim.triangleIndex];
+                            Ray instanceRay = InstanceTransform(instance, instanceMotion, ray.time).ApplyInverse(ray);
+                            ++nInstanceTraversals;
+                            std::optional<ShapeIntersection> isi =
+                                    prototypes[instance.prototypeIndex].IntersectNodes(instanceRay, tMax);
+                            if (isi) {
+                                tMax = isi->intr.t;
+                                si = isi;
+                                si->instanceIndex = int(prim.triangleIndex);
+                            }
+                            continue;
+                        }
+                        const TriangleMesh &mesh = meshes[prim.meshIndex];
+                        const int *v = &mesh.indices[3 * prim.triangleIndex];
+                        ++triangleTests;
+                        std::optional<TriangleIntersection> ti =
+                                IntersectTriangle(ray, tMax, mesh.p[v[0]], mesh.p[v[1]], mesh.p[v[2]]);
+                        if (ti) {
+                            tMax = ti->t;
+                            si = ShapeIntersection{prim.meshIndex, prim.triangleIndex, *ti};
+                        }
+                    }
+                    if (toVisitOffset == 0)
+                        break;
+                    currentNodeIndex = nodesToVisit[--toVisitOffset];
+                } else if (node->axis == LinearBVHNode::TemporalSplit) {
+                    // Only the child whose time range holds the ray's time
+                    currentNodeIndex = ray.time < motionNodes[currentNodeIndex + 1].timeEnd
+                                       ? currentNodeIndex + 1 : node->secondChildOffset;
+                } else {
+                    // Visit the near child first
+                    if (dirIsNeg[node->axis]) {
+                        nodesToVisit[toVisitOffset++] = currentNodeIndex + 1;
+                        currentNodeIndex = node->secondChildOffset;
+                    } else {
+                        nodesToVisit[toVisitOffset++] = node->secondChildOffset;
+                        currentNodeIndex = currentNodeIndex + 1;
+                    }
+                }
+            } else {
+                if (toVisitOffset == 0)
+                    break;
+                currentNodeIndex = nodesToVisit[--toVisitOffset];
+            }
+        }
+        nNodesVisited += nodesVisited;
+        nTriangleTests += triangleTests;
+        return si;
+    }
+
+    bool BVHAggregate::IntersectP(const Ray &ray, float tMax) const {
+        int64_t nodesVisited = 0, triangleTests = 0;
+        bool hit = IntersectPNodes(ray, tMax, &nodesVisited, &triangleTests);
+        ++nRays;
+        ++nShadowRays;
+        ++nShadowNodeRays;
+        nShadowNodesVisited += nodesVisited;
+        ++nTriangleRays;
+        nTriangleTests += triangleTests;
+        return hit;
+    }
+
+    void BVHAggregate::IntersectP(span<ShadowRay> queue) const {
+        // Counted once for the whole queue
+        int64_t nodesVisited = 0, triangleTests = 0;
+        for (ShadowRay &r : queue)
+            r.occluded = IntersectPNodes(r.ray, r.tMax, &nodesVisited, &triangleTests);
+        nRays += int64_t(queue.size());
+        nShadowRays += int64_t(queue.size());
+        nShadowNodeRays += int64_t(queue.size());
+        nShadowNodesVisited += nodesVisited;
+        nTriangleRays += int64_t(queue.size());
+        nTriangleTests += triangleTests;
+    }
+
+    bool BVHAggregate::IntersectPNodes(const Ray &ray, float tMax, int64_t *nodesVisited,
+                                       int64_t *triangleTests) const {
+        if (nodes.empty())
+            return false;
+        Vector3f invDir(1 / ray.d.x, 1 / ray.d.y, 1 / ray.d.z);
+        int dirIsNeg[3] = {int(invDir.x < 0), int(invDir.y < 0), int(invDir.z < 0)};
+        // Any hit will do, so children are visited in layout order
+        int toVisitOffset = 0, currentNodeIndex = 0;
+        int nodesToVisit[64];
+        while (true) {
+            const LinearBVHNode *node = &nodes[currentNodeIndex];
+            ++*nodesVisited;
+            bool hitBounds = motionNodes.empty()
+                             ? node->bounds.IntersectP(ray.o, ray.d, tMax, invDir, dirIsNeg)
+                             : MotionNodeBounds(*node, motionNodes[currentNodeIndex], ray.time)
+                                     .IntersectP(ray.o, ray.d, tMax, invDir, dirIsNeg);
+            if (hitBounds) {
+                if (node->nPrimitives > 0) {
+                    for (int i = 0; i < node->nPrimitives; ++i) {
+                        const BVHPrimitive &prim = primitives[node->primitivesOffset + i];
+                        if (prim.IsInstance()) {
+                            const ObjectInstance &instance = instances[prim.triangleIndex];
+                            Ray instanceRay = InstanceTransform(instance, instanceMotion, ray.time).ApplyInverse(ray);
+                            ++nInstanceTraversals;
+                            if (prototypes[instance.prototypeIndex].IntersectPNodes(instanceRay, tMax, nodesVisited,
+                                                                                    triangleTests))
+                                return true;
+                            continue;
+                        }
+                        const TriangleMesh &mesh = meshes[prim.meshIndex];
+                        const int *v = &mesh.indices[3 * prim.triangleIndex];
+                        ++*triangleTests;
+                        if (IntersectTriangleP(ray, tMax, mesh.p[v[0]], mesh.p[v[1]], mesh.p[v[2]]))
+                            return true;
+                    }
+                    if (toVisitOffset == 0)
+                        break;
+                    currentNodeIndex = nodesToVisit[--toVisitOffset];
+                } else if (node->axis == LinearBVHNode::TemporalSplit)
+                    currentNodeIndex = ray.time < motionNodes[currentNodeIndex + 1].timeEnd
+                                       ? currentNodeIndex + 1 : node->secondChildOffset;
+                else {
+                    nodesToVisit[toVisitOffset++] = node->secondChildOffset;
+                    currentNodeIndex = currentNodeIndex + 1;
+                }
+            } else {
+                if (toVisitOffset == 0)
+                    break;
+                currentNodeIndex = nodesToVisit[--toVisitOffset];
+            }
+        }
+        return false;
+    }
+
+#pragma endregion BVH Traversal
+
+#pragma region BVH Refitting
+
+    void BVHAggregate::Refit(span<const ObjectInstance> newInstances, span<const uint32_t> changed) {
+        PROFILE_SCOPE("Refit BVH");
+        instances = newInstances;
+        if (nodes.empty() || changed.empty())
+            return;
+        // Nodes mapped from the scene cache are read-only
+        if (nodeStorage.data() != nodes.data()) {
+            nodeStorage.assign(nodes.begin(), nodes.end());
+            nodes = nodeStorage;
+        }
+        if (!motionNodes.empty() && motionNodeStorage.data() != motionNodes.data()) {
+            motionNodeStorage.assign(motionNodes.begin(), motionNodes.end());
+            motionNodes = motionNodeStorage;
+        }
+        if (parentNodes.empty()) {
+            parentNodes.assign(nodes.size(), -1);
+            std::vector<std::pair<uint32_t, int>> leaves;
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                const LinearBVHNode &node = nodes[i];
+                if (node.nPrimitives == 0) {
+                    parentNodes[i + 1] = int(i);
+                    parentNodes[node.secondChildOffset] = int(i);
+                } else
+                    for (int j = 0; j < node.nPrimitives; ++j) {
+                        const BVHPrimitive &prim = primitives[node.primitivesOffset + j];
+                        if (prim.IsInstance())
+                            leaves.push_back({prim.triangleIndex, int(i)});
+                    }
+            }
+            std::sort(leaves.begin(), leaves.end());
+            instanceLeafStart.assign(instances.size() + 1, 0);
+            for (const std::pair<uint32_t, int> &leaf : leaves) {
+                ++instanceLeafStart[leaf.first + 1];
+                instanceLeaves.push_back(leaf.second);
+            }
+            for (size_t i = 0; i < instances.size(); ++i)
+                instanceLeafStart[i + 1] += instanceLeafStart[i];
+        }
+
+        // Children follow their parents in the depth-first layout, so taking
+        // the highest node index first visits every changed child before its
+        // parent. A node queued by both children comes out twice in a row.
+        std::priority_queue<int> pending;
+        for (uint32_t i : changed)
+            for (int j = instanceLeafStart[i]; j < instanceLeafStart[i + 1]; ++j)
+                pending.push(instanceLeaves[j]);
+        int last = -1;
+        while (!pending.empty()) {
+            int n = pending.top();
+            pending.pop();
+            if (n == last)
+                continue;
+            last = n;
+
+            LinearBVHNode &node = nodeStorage[n];
+            ++nNodesRefit;
+            if (motionNodes.empty()) {
+                Bounds3f bounds;
+                if (node.nPrimitives == 0)
+                    bounds = Union(nodes[n + 1].bounds, nodes[node.secondChildOffset].bounds);
+                else
+                    for (int j = 0; j < node.nPrimitives; ++j) {
+                        const BVHPrimitive &prim = primitives[node.primitivesOffset + j];
+                        bounds = Union(bounds, prim.IsInstance()
+                                               ? instances[prim.triangleIndex].bounds
+                                               : meshes[prim.meshIndex].TriangleBounds(prim.triangleIndex));
+                    }
+                // Unchanged bounds leave the ancestors as they are
+                if (bounds == node.bounds)
+                    continue;
+                node.bounds = bounds;
+            } else {
+                // Motion BVH nodes are bounded at both ends of their time range
+                LinearBVHNodeMotion &motion = motionNodeStorage[n];
+                Bounds3f bounds[2];
+                if (node.nPrimitives > 0)
+                    for (int j = 0; j < node.nPrimitives; ++j) {
+                        Bounds3f b0, b1;
+                        PrimitiveLinearBounds(primitives[node.primitivesOffset + j], motion.timeStart,
+                                              motion.timeEnd, &b0, &b1);
+                        bounds[0] = Union(bounds[0], b0);
+                        bounds[1] = Union(bounds[1], b1);
+                    }
+                else {
+                    int c0 = n + 1, c1 = node.secondChildOffset;
+                    bounds[0] = Union(nodes[c0].bounds, nodes[c1].bounds);
+                    bounds[1] = Union(motionNodes[c0].boundsEnd, motionNodes[c1].boundsEnd);
+                    // The children of a temporal split each cover part of the
+                    // time range; bound all of them at both ends
+                    if (node.axis == LinearBVHNode::TemporalSplit)
+                        bounds[0] = bounds[1] = Union(bounds[0], bounds[1]);
+                }
+                if (bounds[0] == node.bounds && bounds[1] == motion.boundsEnd)
+                    continue;
+                node.bounds = bounds[0];
+                motion.boundsEnd = bounds[1];
+            }
+            if (parentNodes[n] >= 0)
+                pending.push(parentNodes[n]);
+        }
+    }
+
+#pragma endregion BVH Refitting
+}
@@ -0,0 +1,19 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/film/film.h"
+
+namespace jadehare {
+
+    Image RGBFilm::GetImage() const {
+        Image image(resolution, 3, TexelFormat::Float);
+        for (int y = 0; y < resolution.y; ++y)
+            for (int x = 0; x < resolution.x; ++x) {
+                RGB rgb = GetPixelRGB(Point2i(x, y));
+                for (int c = 0; c < 3; ++c)
+                    image.SetChannel(Point2i(x, y), c, rgb[c]);
+            }
+        return image;
+    }
+}
@@ -0,0 +1,87 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/film/tileOrder.h"
+#include "core/math/mathematics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace jadehare {
+
+    TileOrder ParseTileOrder(const std::string &name) {
+        if (name == "rowmajor")
+            return TileOrder::RowMajor;
+        if (name == "morton")
+            return TileOrder::Morton;
+        if (name == "hilbert")
+            return TileOrder::Hilbert;
+        if (name == "spiral")
+            return TileOrder::Spiral;
+        throw std::runtime_error("\"" + name + "\": unknown tile order; expected rowmajor, morton, hilbert or spiral");
+    }
+
+    // Distance along the Hilbert curve over an n x n grid, n a power of
+    // two, of the cell (x, y).
+    static uint64_t HilbertIndex(uint32_t n, uint32_t x, uint32_t y) {
+        uint64_t d = 0;
+        for (uint32_t s = n / 2; s > 0; s /= 2) {
+            uint32_t rx = (x & s) > 0, ry = (y & s) > 0;
+            d += uint64_t(s) * s * ((3 * rx) ^ ry);
+            // Rotate the quadrant so the curve's sub-curves connect
+            if (ry == 0) {
+                if (rx == 1) {
+                    x = n - 1 - x;
+                    y = n - 1 - y;
+                }
+                std::swap(x, y);
+            }
+        }
+        return d;
+    }
+
+    std::vector<Bounds2i> OrderedTiles(const Bounds2i &bounds, int tileSize, TileOrder order) {
+        Vector2i extent = bounds.Diagonal();
+        int nx = std::max(0, (extent.x + tileSize - 1) / tileSize);
+        int ny = std::max(0, (extent.y + tileSize - 1) / tileSize);
+        uint32_t hilbertSize = uint32_t(RoundUpPow2(std::max({nx, ny, 1})));
+
+        // Sort the tiles by their position along the order
+        std::vector<std::pair<double, int>> keys(size_t(nx) * size_t(ny));
+        for (int ty = 0; ty < ny; ++ty)
+            for (int tx = 0; tx < nx; ++tx) {
+                double key = 0;
+                switch (order) {
+                    case TileOrder::RowMajor:
+                        key = double(ty) * nx + tx;
+                        break;
+                    case TileOrder::Morton:
+                        key = double(EncodeMorton2(uint32_t(tx), uint32_t(ty)));
+                        break;
+                    case TileOrder::Hilbert:
+                        key = double(HilbertIndex(hilbertSize, uint32_t(tx), uint32_t(ty)));
+                        break;
+                    case TileOrder::Spiral: {
+                        // Square rings around the center, each swept by angle
+                        double dx = tx + 0.5 - nx / 2., dy = ty + 0.5 - ny / 2.;
+                        double ring = std::floor(std::max(std::abs(dx), std::abs(dy)));
+                        key = ring + (std::atan2(dy, dx) + Pi) / (2 * Pi + 1e-3);
+                        break;
+                    }
+                }
+                keys[size_t(ty) * nx + tx] = {key, ty * nx + tx};
+            }
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<Bounds2i> tiles;
+        tiles.reserve(keys.size());
+        for (const std::pair<double, int> &key : keys) {
+            Point2i pMin = bounds.pMin + Vector2i(key.second % nx, key.second / nx) * tileSize;
+            tiles.push_back(Bounds2i(pMin, Min(pMin + Vector2i(tileSize, tileSize), bounds.pMax)));
+        }
+        return tiles;
+    }
+}
@@ -0,0 +1,363 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/integrator/integrator.h"
+#include "core/light/lights.h"
+#include "core/material/materials.h"
+#include "core/sampling/sampling.h"
+#include "core/volumeScattering/media.h"
+#include "util/hash.h"
+#include "util/log.h"
+#include "util/parallel.h"
+#include "util/profile.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace jadehare {
+
+    PathIntegrator::PathIntegrator(const Scene &scene, int maxDepth)
+            : scene(scene), maxDepth(maxDepth), lightSampler(scene), samplerType(scene.Camera().sampler) {
+        span<const LightData> lights = scene.Lights();
+        for (size_t i = 0; i < lights.size(); ++i)
+            if (lights[i].type == LightType::Infinite)
+                infiniteLights.push_back(int(i));
+        for (const MaterialData &material : scene.Materials())
+            hasInterfaces |= material.type == MaterialType::Interface;
+    }
+
+    RenderStats PathIntegrator::Render(const PerspectiveCamera &camera, int spp, RGBFilm &film) const {
+        if (samplerType == SamplerType::ZSobol) {
+            // Its sample indices interleave pixels and samples by bits
+            if (!IsPowerOf2(spp)) {
+                LOG_WARNING("ZSobol sampler: rounding %d samples per pixel up to %d", spp, RoundUpPow2(spp));
+                spp = RoundUpPow2(spp);
+            }
+            return RenderTiles(camera, film, ZSobolSampler(spp, film.Resolution()));
+        }
+        return RenderTiles(camera, film, SobolSampler(spp));
+    }
+
+    template<typename Sampler>
+    RenderStats PathIntegrator::RenderTiles(const PerspectiveCamera &camera, RGBFilm &film,
+                                            const Sampler &prototype) const {
+        int spp = prototype.SamplesPerPixel();
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point start = Clock::now();
+        RenderStats stats;
+
+        std::vector<Bounds2i> tiles = OrderedTiles(Bounds2i(Point2i(0, 0), film.Resolution()), TileSize, tileOrder);
+        std::atomic<int64_t> cameraRays{0}, secondaryRays{0};
+        std::once_flag firstTile;
+        ThreadLocal<ScratchBuffer> scratchBuffers;
+        ParallelFor(0, int64_t(tiles.size()), [&](int64_t tile) {
+            PROFILE_SCOPE("Render tile", tile);
+            const Bounds2i &tileBounds = tiles[tile];
+            Sampler sampler = prototype;
+            ScratchBuffer &scratchBuffer = scratchBuffers.Get();
+            int64_t nRays = 0, nCameraRays = 0;
+            for (int y = tileBounds.pMin.y; y < tileBounds.pMax.y; ++y)
+                for (int x = tileBounds.pMin.x; x < tileBounds.pMax.x; ++x) {
+                    Point2i pPixel(x, y);
+                    for (int sampleIndex = 0; sampleIndex < spp; ++sampleIndex) {
+                        sampler.StartPixelSample(pPixel, sampleIndex);
+                        RNG rng(Hash(pPixel.x, pPixel.y, sampleIndex));
+                        Point2f u = sampler.GetPixel2D();
+                        Ray ray = camera.GenerateRay(Point2f(x + u.x, y + u.y), camera.SampleTime(sampler.Get1D()));
+                        RGB L = Li(ray, camera, sampler, scratchBuffer, rng, &nRays);
+                        scratchBuffer.Reset();
+                        // Keep a stray NaN or infinity from ruining the pixel
+                        if (!std::isfinite(L.r + L.g + L.b))
+                            L = RGB(0, 0, 0);
+                        film.AddSample(pPixel, L);
+                        ++nCameraRays;
+                    }
+                }
+            cameraRays += nCameraRays;
+            secondaryRays += nRays - nCameraRays;
+            std::call_once(firstTile, [&]() {
+                stats.firstTileSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+            });
+        });
+
+        stats.cameraRays = cameraRays;
+        stats.secondaryRays = secondaryRays;
+        stats.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return stats;
+    }
+
+    template<typename Sampler>
+    RGB PathIntegrator::Li(Ray ray, const PerspectiveCamera &camera, Sampler &sampler, ScratchBuffer &scratchBuffer,
+                           RNG &rng, int64_t *nRays) const {
+        RGB L(0, 0, 0), beta(1, 1, 1);
+        int depth = 0;
+        // Emission found by following the path is weighted against light
+        // sampling at the previous vertex, unless there was none
+        bool specularBounce = true;
+        float prevPdf = 0;
+        LightSampleContext prevCtx;
+        while (true) {
+            std::optional<ShapeIntersection> si = scene.Aggregate().Intersect(ray);
+            ++*nRays;
+
+            if (ray.medium) {
+                // Sample a scattering event along the ray, or pass through
+                bool scattered = false, terminated = false;
+                Point3f pMedium;
+                HGPhaseFunction phase;
+                RGB T_maj = SampleT_maj(ray, si ? si->intr.t : Infinity, sampler.Get1D(), rng,
+                                        [&](Point3f p, const MediumProperties &mp, const RGB &sigma_maj,
+                                            const RGB &T_maj) {
+                    // Collisions are sampled with density T_maj[0] * sigma_maj[0]
+                    if (T_maj[0] == 0) {
+                        terminated = true;
+                        return false;
+                    }
+                    if (depth < maxDepth && mp.Le.MaxComponentValue() > 0)
+                        L += beta * T_maj * mp.sigma_a * mp.Le / (T_maj[0] * sigma_maj[0]);
+
+                    // Choose absorption, scattering or a null collision
+                    // with channel 0's probabilities
+                    float pAbsorb = mp.sigma_a[0] / sigma_maj[0], pScatter = mp.sigma_s[0] / sigma_maj[0];
+                    float u = rng.Uniform<float>();
+                    if (u < pAbsorb) {
+                        terminated = true;
+                        return false;
+                    }
+                    if (u < pAbsorb + pScatter) {
+                        beta *= T_maj * mp.sigma_s / (T_maj[0] * mp.sigma_s[0]);
+                        scattered = true;
+                        pMedium = p;
+                        phase = mp.phase;
+                        return false;
+                    }
+                    RGB sigma_n = sigma_maj - mp.sigma_a - mp.sigma_s;
+                    for (int c = 0; c < 3; ++c)
+                        sigma_n[c] = std::max<float>(0, sigma_n[c]);
+                    if (sigma_n[0] == 0) {
+                        terminated = true;
+                        return false;
+                    }
+                    beta *= T_maj * sigma_n / (T_maj[0] * sigma_n[0]);
+                    return beta.MaxComponentValue() > 0;
+                });
+                if (terminated || beta.MaxComponentValue() == 0)
+                    return L;
+
+                if (scattered) {
+                    if (depth++ == maxDepth)
+                        return L;
+                    // Sample direct lighting and the phase function at the
+                    // scattering point
+                    Vector3f wo = -Normalize(ray.d);
+                    LightSampleContext ctx{pMedium};
+                    L += beta * SampleLd(ctx, Point3fi(pMedium), ray.time, ray.medium,
+                                         [&](const Vector3f &wi) { return RGB(1, 1, 1) * phase.p(wo, wi); },
+                                         [&](const Vector3f &wi) { return phase.PDF(wo, wi); },
+                                         sampler, rng, nRays);
+                    std::optional<PhaseFunctionSample> ps = phase.Sample_p(wo, sampler.Get2D());
+                    if (!ps || ps->pdf == 0)
+                        return L;
+                    beta *= ps->p / ps->pdf;
+                    specularBounce = false;
+                    prevPdf = ps->pdf;
+                    prevCtx = ctx;
+                    ray = Ray(pMedium, ps->wi, ray.time, ray.medium);
+                    continue;
+                }
+                if (T_maj[0] == 0)
+                    return L;
+                beta *= T_maj / T_maj[0];
+            }
+
+            if (!si) {
+                // Add the environment lights the ray escapes to
+                for (int lightIndex : infiniteLights) {
+                    RGB Le = scene.GetLight(lightIndex).Cast<EnvironmentLight>()->Le(ray.d);
+                    if (specularBounce)
+                        L += beta * Le;
+                    else {
+                        LightHandle light = scene.GetLight(lightIndex);
+                        float lightPdf = lightSampler.PMF(prevCtx, lightIndex) *
+                                         light.PDF_Li(prevCtx, Normalize(ray.d));
+                        L += beta * Le * PowerHeuristic(1, prevPdf, 1, lightPdf);
+                    }
+                }
+                return L;
+            }
+
+            SurfaceHit hit = GetSurfaceHit(*si, ray.time);
+            Vector3f wo = -Normalize(ray.d);
+            // Add emission of area lights; instanced meshes don't emit
+            if (hit.mesh->areaLightIndex >= 0 && si->instanceIndex < 0) {
+                int lightIndex = hit.mesh->areaLightIndex + int(si->triangleIndex);
+                LightHandle light = scene.GetLight(lightIndex);
+                RGB Le = light.Cast<DiffuseAreaLight>()->L(wo);
+                if (specularBounce)
+                    L += beta * Le;
+                else {
+                    float lightPdf = lightSampler.PMF(prevCtx, lightIndex) * light.PDF_Li(prevCtx, -wo);
+                    L += beta * Le * PowerHeuristic(1, prevPdf, 1, lightPdf);
+                }
+            }
+
+            // Interfaces only change the medium the ray travels through
+            MaterialHandle material = GetMaterial(*hit.mesh);
+            if (!material) {
+                MediumHandle medium = NextMedium(hit, ray.d, ray.medium);
+                ray = SpawnRay(hit.pi, hit.n, ray.time, ray.d);
+                ray.medium = medium;
+                continue;
+            }
+
+            if (depth++ == maxDepth)
+                return L;
+
+            // Scatter on the side the ray arrived from
+            MaterialEvalContext materialCtx = GetMaterialEvalContext(hit, wo, camera, sampler.SamplesPerPixel());
+            Normal3f ns = materialCtx.ns;
+            const DiffuseBxDF *bxdf = material.GetBxDF(materialCtx, scratchBuffer);
+            LightSampleContext ctx{Point3f(hit.pi), ns};
+            L += beta * SampleLd(ctx, hit.pi, ray.time, ray.medium,
+                                 [&](const Vector3f &wi) { return bxdf->f(wo, wi) * AbsDot(wi, ns); },
+                                 [&](const Vector3f &wi) { return bxdf->PDF(wo, wi); },
+                                 sampler, rng, nRays);
+
+            std::optional<BSDFSample> bs = bxdf->Sample_f(wo, sampler.Get2D());
+            if (!bs)
+                return L;
+            beta *= bs->f * AbsDot(bs->wi, ns) / bs->pdf;
+            specularBounce = false;
+            prevPdf = bs->pdf;
+            prevCtx = ctx;
+            MediumHandle medium = ray.medium;
+            ray = SpawnRay(hit.pi, hit.n, ray.time, bs->wi);
+            ray.medium = medium;
+
+            // Russian roulette once paths have a few bounces
+            if (beta.MaxComponentValue() < 1 && depth > 1) {
+                float q = std::max<float>(0, 1 - beta.MaxComponentValue());
+                if (sampler.Get1D() < q)
+                    return L;
+                beta *= 1 / (1 - q);
+            }
+        }
+    }
+
+    PathIntegrator::SurfaceHit PathIntegrator::GetSurfaceHit(const ShapeIntersection &si, float time) const {
+        const TriangleMesh &mesh = scene.GetMesh(si);
+        const int *v = &mesh.indices[3 * si.triangleIndex];
+        Point3f p[3] = {mesh.p[v[0]], mesh.p[v[1]], mesh.p[v[2]]};
+        Normal3f n = mesh.FaceNormal(si.triangleIndex);
+        if (si.instanceIndex >= 0) {
+            Transform renderFromInstance =
+                    InstanceTransform(scene.Instances()[si.instanceIndex], scene.InstanceMotion(), time);
+            for (Point3f &pv : p)
+                pv = renderFromInstance(pv);
+            n = Normalize(renderFromInstance(n));
+        }
+
+        // Interpolate the position; its error is bounded as in pbrt-v4, with
+        // the vertices already in render space
+        float b[3] = {si.intr.b0, si.intr.b1, si.intr.b2};
+        Point3f pHit(0, 0, 0);
+        Vector3f pAbsSum(0, 0, 0);
+        for (int i = 0; i < 3; ++i)
+            for (int c = 0; c < 3; ++c) {
+                pHit[c] += b[i] * p[i][c];
+                pAbsSum[c] += std::abs(b[i] * p[i][c]);
+            }
+
+        // Texture coordinates, pbrt's defaults for meshes without them, and
+        // the position's partial derivatives with respect to them
+        Point2f uv[3] = {Point2f(0, 0), Point2f(1, 0), Point2f(1, 1)};
+        if (!mesh.uv.empty())
+            for (int i = 0; i < 3; ++i)
+                uv[i] = mesh.uv[v[i]];
+        Point2f uvHit = Point2f(b[0] * uv[0].x + b[1] * uv[1].x + b[2] * uv[2].x,
+                                b[0] * uv[0].y + b[1] * uv[1].y + b[2] * uv[2].y);
+        Vector2f duv02 = uv[0] - uv[2], duv12 = uv[1] - uv[2];
+        Vector3f dp02 = p[0] - p[2], dp12 = p[1] - p[2];
+        float determinant = DifferenceOfProducts(duv02.x, duv12.y, duv02.y, duv12.x);
+        Vector3f dpdu(0, 0, 0), dpdv(0, 0, 0);
+        bool degenerateUV = std::abs(determinant) < 1e-9f;
+        if (!degenerateUV) {
+            float invDet = 1 / determinant;
+            dpdu = (duv12.y * dp02 - duv02.y * dp12) * invDet;
+            dpdv = (duv02.x * dp12 - duv12.x * dp02) * invDet;
+        }
+        if ((degenerateUV || LengthSquared(Cross(dpdu, dpdv)) == 0) && n != Normal3f(0, 0, 0))
+            CoordinateSystem(n, &dpdu, &dpdv);
+        return SurfaceHit{Point3fi(pHit, gamma(7) * pAbsSum), n, uvHit, dpdu, dpdv, &mesh};
+    }
+
+    MaterialEvalContext PathIntegrator::GetMaterialEvalContext(const SurfaceHit &hit, const Vector3f &wo,
+                                                               const PerspectiveCamera &camera,
+                                                               int samplesPerPixel) const {
+        MaterialEvalContext ctx;
+        ctx.p = Point3f(hit.pi);
+        ctx.n = hit.n;
+        ctx.uv = hit.uv;
+        ctx.wo = wo;
+        ctx.ns = FaceForward(hit.n, wo);
+        Vector3f dpdx, dpdy;
+        camera.Approximate_dp_dxy(ctx.p, hit.n, samplesPerPixel, &dpdx, &dpdy);
+        ComputeDifferentials(dpdx, dpdy, hit.dpdu, hit.dpdv, &ctx);
+        return ctx;
+    }
+
+    RGB PathIntegrator::Transmittance(const Point3fi &pFrom, const Normal3f &n, const Point3f &pTo, float time,
+                                      MediumHandle medium, RNG &rng, int64_t *nRays) const {
+        Ray ray = n == Normal3f(0, 0, 0) ? Ray(Point3f(pFrom), pTo - Point3f(pFrom), time)
+                                         : SpawnRayTo(pFrom, n, time, pTo);
+        ray.medium = medium;
+        // Without media or interfaces to pass through, any hit occludes
+        if (!ray.medium && !hasInterfaces) {
+            ++*nRays;
+            return scene.Aggregate().IntersectP(ray) ? RGB(0, 0, 0) : RGB(1, 1, 1);
+        }
+        RGB T(1, 1, 1);
+        while (true) {
+            std::optional<ShapeIntersection> si = scene.Aggregate().Intersect(ray, 1 - ShadowEpsilon);
+            ++*nRays;
+            if (si && GetMaterial(scene.GetMesh(*si)))
+                return RGB(0, 0, 0);
+            if (ray.medium)
+                T *= RatioTrackingTransmittance(ray, si ? si->intr.t : 1 - ShadowEpsilon, rng);
+            if (!si || T.MaxComponentValue() == 0)
+                return T;
+
+            // Continue on the far side of the interface
+            SurfaceHit hit = GetSurfaceHit(*si, time);
+            MediumHandle next = NextMedium(hit, ray.d, ray.medium);
+            ray = SpawnRayTo(hit.pi, hit.n, time, pTo);
+            ray.medium = next;
+        }
+    }
+
+    template<typename F, typename PDF, typename Sampler>
+    RGB PathIntegrator::SampleLd(const LightSampleContext &ctx, const Point3fi &pi, float time, MediumHandle medium,
+                                 F &&f, PDF &&pdf, Sampler &sampler, RNG &rng, int64_t *nRays) const {
+        float uLight = sampler.Get1D();
+        Point2f u = sampler.Get2D();
+        std::optional<SampledLight> sampledLight = lightSampler.Sample(ctx, uLight);
+        if (!sampledLight)
+            return RGB(0, 0, 0);
+        LightHandle light = scene.GetLight(sampledLight->lightIndex);
+        std::optional<LightLiSample> ls = light.SampleLi(ctx, u);
+        if (!ls || ls->pdf == 0 || ls->L.MaxComponentValue() == 0)
+            return RGB(0, 0, 0);
+        RGB fValue = f(ls->wi);
+        if (fValue.MaxComponentValue() == 0)
+            return RGB(0, 0, 0);
+        RGB T = Transmittance(pi, ctx.n, ls->pLight, time, medium, rng, nRays);
+        if (T.MaxComponentValue() == 0)
+            return RGB(0, 0, 0);
+
+        float lightPdf = sampledLight->p * ls->pdf;
+        float w = light.IsDelta() ? 1 : PowerHeuristic(1, lightPdf, 1, pdf(ls->wi));
+        return fValue * T * ls->L * (w / lightPdf);
+    }
+}
@@ -0,0 +1,427 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/integrator/renderServer.h"
+#include "core/camera/camera.h"
+#include "core/film/film.h"
+#include "core/scene/parser.h"
+#include "util/log.h"
+#include "util/profile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace jadehare {
+
+#pragma region Request Parsing
+
+    // Splits a request line at whitespace, keeping double-quoted runs
+    // together and dropping the quotes.
+    static std::vector<std::string> Tokenize(const std::string &line) {
+        std::vector<std::string> tokens;
+        std::string token;
+        bool inToken = false, inQuotes = false;
+        for (char c : line) {
+            if (c == '"') {
+                inQuotes = !inQuotes;
+                inToken = true;
+            } else if (!inQuotes && std::isspace((unsigned char) c)) {
+                if (inToken)
+                    tokens.push_back(std::move(token));
+                token.clear();
+                inToken = false;
+            } else {
+                token += c;
+                inToken = true;
+            }
+        }
+        if (inQuotes)
+            throw std::runtime_error("unterminated quoted value");
+        if (inToken)
+            tokens.push_back(std::move(token));
+        return tokens;
+    }
+
+    static int ParseInt(const std::string &key, const std::string &value) {
+        size_t end = 0;
+        int v = 0;
+        try {
+            v = std::stoi(value, &end);
+        } catch (const std::exception &) {
+            end = 0;
+        }
+        if (end == 0 || end != value.size())
+            throw std::runtime_error(key + ": expected an integer, got \"" + value + "\"");
+        return v;
+    }
+
+    static std::vector<float> ParseFloats(const std::string &key, const std::string &value) {
+        std::istringstream in(value);
+        std::vector<float> v;
+        float f;
+        while (in >> f)
+            v.push_back(f);
+        if (!in.eof())
+            throw std::runtime_error(key + ": expected numbers, got \"" + value + "\"");
+        return v;
+    }
+
+    RenderRequest RenderRequest::Parse(const std::string &line) {
+        std::vector<std::string> tokens = Tokenize(line);
+        if (tokens.empty())
+            throw std::runtime_error("empty request");
+
+        RenderRequest request;
+        const std::string &command = tokens[0];
+        if (command == "render")
+            request.command = Command::Render;
+        else if (command == "update")
+            request.command = Command::Update;
+        else if (command == "evict")
+            request.command = Command::Evict;
+        else if (command == "status")
+            request.command = Command::Status;
+        else if (command == "shutdown")
+            request.command = Command::Shutdown;
+        else
+            throw std::runtime_error("unknown command \"" + command + "\"");
+
+        for (size_t i = 1; i < tokens.size(); ++i) {
+            size_t eq = tokens[i].find('=');
+            if (eq == std::string::npos)
+                throw std::runtime_error("expected key=value, got \"" + tokens[i] + "\"");
+            std::string key = tokens[i].substr(0, eq), value = tokens[i].substr(eq + 1);
+            if (key == "scene")
+                request.sceneFiles.push_back(value);
+            else if (key == "outfile")
+                request.outFilename = value;
+            else if (key == "spp")
+                request.spp = ParseInt(key, value);
+            else if (key == "maxdepth")
+                request.maxDepth = ParseInt(key, value);
+            else if (key == "xresolution")
+                request.xResolution = ParseInt(key, value);
+            else if (key == "yresolution")
+                request.yResolution = ParseInt(key, value);
+            else if (key == "fov") {
+                std::vector<float> v = ParseFloats(key, value);
+                if (v.size() != 1)
+                    throw std::runtime_error("fov: expected one number");
+                request.fov = v[0];
+            } else if (key == "lookat") {
+                std::vector<float> v = ParseFloats(key, value);
+                if (v.size() != 9)
+                    throw std::runtime_error("lookat: expected 9 numbers, got " + std::to_string(v.size()));
+                std::array<float, 9> lookAt;
+                std::copy(v.begin(), v.end(), lookAt.begin());
+                request.lookAt = lookAt;
+            } else if (key == "instance")
+                request.instances.push_back(ParseInt(key, value));
+            else if (key == "transform") {
+                std::vector<float> v = ParseFloats(key, value);
+                if (v.size() != 16)
+                    throw std::runtime_error("transform: expected 16 numbers, got " + std::to_string(v.size()));
+                request.transforms.push_back(Transform::FromArray(v.data()));
+            } else
+                throw std::runtime_error("unknown key \"" + key + "\"");
+        }
+        return request;
+    }
+
+    // Value as it has to appear in a reply line to be read back by Tokenize().
+    static std::string QuoteValue(const std::string &value) {
+        bool hasSpace = std::any_of(value.begin(), value.end(), [](char c) {
+            return std::isspace((unsigned char) c);
+        });
+        return hasSpace || value.empty() ? "\"" + value + "\"" : value;
+    }
+
+#pragma endregion
+
+#pragma region RenderServer Method Definitions
+
+    RenderServer::RenderServer(const std::string &socketPath, int maxScenes, bool quiet)
+            : socketPath(socketPath), maxScenes(std::max(1, maxScenes)), quiet(quiet) {}
+
+    RenderServer::~RenderServer() {
+#ifndef _WIN32
+        if (listenFd >= 0) {
+            close(listenFd);
+            unlink(socketPath.c_str());
+        }
+#endif
+    }
+
+    std::string RenderServer::Handle(const std::string &line, bool *shutdown) {
+        PROFILE_SCOPE("Handle request");
+        try {
+            RenderRequest request = RenderRequest::Parse(line);
+            switch (request.command) {
+                case RenderRequest::Command::Render:
+                    return Render(request);
+                case RenderRequest::Command::Update:
+                    return Update(request);
+                case RenderRequest::Command::Evict: {
+                    size_t n = scenes.size();
+                    if (request.sceneFiles.empty())
+                        scenes.clear();
+                    else
+                        scenes.remove_if([&](const ResidentScene &s) { return s.sceneFiles == request.sceneFiles; });
+                    return "ok evicted=" + std::to_string(n - scenes.size());
+                }
+                case RenderRequest::Command::Status: {
+                    std::string reply = "ok scenes=" + std::to_string(scenes.size());
+                    for (const ResidentScene &s : scenes) {
+                        std::string files;
+                        for (const std::string &f : s.sceneFiles)
+                            files += (files.empty() ? "" : " ") + f;
+                        reply += " scene=" + QuoteValue(files);
+                    }
+                    return reply;
+                }
+                case RenderRequest::Command::Shutdown:
+                    *shutdown = true;
+                    return "ok";
+            }
+        } catch (const std::exception &e) {
+            // Replies are single lines
+            std::string message = e.what();
+            std::replace(message.begin(), message.end(), '\n', ' ');
+            LOG_ERROR("Request \"%s\" failed: %s", line.c_str(), message.c_str());
+            return "error " + message;
+        }
+        return "error unhandled command";
+    }
+
+    RenderServer::ResidentScene &RenderServer::GetScene(const std::vector<std::string> &sceneFiles, bool *built) {
+        auto iter = std::find_if(scenes.begin(), scenes.end(), [&](const ResidentScene &s) {
+            return s.sceneFiles == sceneFiles;
+        });
+        if (iter != scenes.end()) {
+            bool upToDate = std::all_of(iter->inputTimes.begin(), iter->inputTimes.end(), [](const auto &input) {
+                std::error_code ec;
+                std::filesystem::file_time_type t = std::filesystem::last_write_time(input.first, ec);
+                return !ec && t == input.second;
+            });
+            if (upToDate) {
+                scenes.splice(scenes.begin(), scenes, iter);
+                *built = false;
+                return scenes.front();
+            }
+            LOG_INFO("Rebuilding scene \"%s\": its inputs have changed", sceneFiles[0].c_str());
+            scenes.erase(iter);
+        }
+
+        ResidentScene resident;
+        resident.sceneFiles = sceneFiles;
+        // The scene files are timed before parsing, so that edits made while
+        // the scene is being built are picked up by the next request
+        auto addTimes = [&](const std::vector<std::string> &files) {
+            for (const std::string &f : files) {
+                std::error_code ec;
+                std::filesystem::file_time_type t = std::filesystem::last_write_time(f, ec);
+                if (ec)
+                    throw std::runtime_error(f + ": " + ec.message());
+                resident.inputTimes.emplace_back(f, t);
+            }
+        };
+        addTimes(sceneFiles);
+
+        std::unique_ptr<ParsedScene> parsed = ParseFiles(sceneFiles);
+        resident.scene = Scene::Build(*parsed);
+        parsed.reset();
+        addTimes(resident.scene->InputFiles());
+        resident.integrator = std::make_unique<PathIntegrator>(*resident.scene, resident.scene->Camera().maxDepth);
+
+        // Only evict once the new scene is built, so that a request naming
+        // a broken scene doesn't cost the resident ones
+        while (int(scenes.size()) >= maxScenes)
+            scenes.pop_back();
+        scenes.push_front(std::move(resident));
+        *built = true;
+        return scenes.front();
+    }
+
+    std::string RenderServer::Render(const RenderRequest &request) {
+        if (request.sceneFiles.empty())
+            throw std::runtime_error("render: no scene= given");
+        if (request.outFilename.empty())
+            throw std::runtime_error("render: no outfile= given");
+
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point start = Clock::now();
+        bool built = false;
+        ResidentScene &resident = GetScene(request.sceneFiles, &built);
+        std::chrono::duration<double> loadTime = Clock::now() - start;
+
+        // Apply the overrides to a copy of the scene's camera
+        CameraData cameraData = resident.scene->Camera();
+        if (request.lookAt) {
+            const std::array<float, 9> &v = *request.lookAt;
+            // Only the scene's LookAt is replaced; transformations around it,
+            // such as a mirroring Scale, still apply
+            Transform lookAt = LookAt(Point3f(v[0], v[1], v[2]), Point3f(v[3], v[4], v[5]), Vector3f(v[6], v[7], v[8]));
+            cameraData.worldFromCamera = Inverse(cameraData.cameraFromLookAt * lookAt * cameraData.lookAtFromWorld);
+        }
+        cameraData.fov = request.fov.value_or(cameraData.fov);
+        cameraData.xResolution = request.xResolution.value_or(cameraData.xResolution);
+        cameraData.yResolution = request.yResolution.value_or(cameraData.yResolution);
+        int spp = request.spp.value_or(cameraData.samplesPerPixel);
+        int maxDepth = request.maxDepth.value_or(cameraData.maxDepth);
+        if (spp <= 0)
+            throw std::runtime_error("spp: must be positive");
+        if (cameraData.xResolution <= 0 || cameraData.yResolution <= 0)
+            throw std::runtime_error("resolution: must be positive");
+        if (!(cameraData.fov > 0 && cameraData.fov < 180))
+            throw std::runtime_error("fov: must be between 0 and 180 degrees");
+        if (maxDepth < 0)
+            throw std::runtime_error("maxdepth: must not be negative");
+
+        PerspectiveCamera camera(cameraData.worldFromCamera, cameraData.fov,
+                                 Point2i(cameraData.xResolution, cameraData.yResolution),
+                                 resident.scene->GetMedium(cameraData.mediumIndex), cameraData.shutterOpen,
+                                 cameraData.shutterClose);
+        RGBFilm film(camera.Resolution());
+        resident.integrator->SetMaxDepth(maxDepth);
+        RenderStats stats = resident.integrator->Render(camera, spp, film);
+        film.WriteImage(request.outFilename);
+
+        double mraysPerSecond = (stats.cameraRays + stats.secondaryRays) / stats.seconds / 1e6;
+        LOG_INFO("Rendered %s at %d spp in %.3fs (scene %s in %.3fs)", request.outFilename.c_str(), spp,
+                 stats.seconds, built ? "built" : "resident", loadTime.count());
+        if (!quiet)
+            std::cout << "Rendered " << request.outFilename << " at " << spp << " spp in " << stats.seconds
+                      << "s; " << mraysPerSecond << " Mrays/s" << (built ? "" : " (resident scene)") << std::endl;
+
+        std::ostringstream reply;
+        reply << "ok outfile=" << QuoteValue(request.outFilename) << " spp=" << spp << " built=" << int(built)
+              << " load_s=" << loadTime.count() << " render_s=" << stats.seconds
+              << " mrays_per_s=" << mraysPerSecond;
+        return reply.str();
+    }
+
+    std::string RenderServer::Update(const RenderRequest &request) {
+        if (request.sceneFiles.empty())
+            throw std::runtime_error("update: no scene= given");
+        if (request.instances.size() != request.transforms.size())
+            throw std::runtime_error("update: every instance= needs a transform=");
+
+        bool built = false;
+        ResidentScene &resident = GetScene(request.sceneFiles, &built);
+        Scene &scene = *resident.scene;
+        for (int index : request.instances)
+            if (index < 0 || size_t(index) >= scene.Instances().size())
+                throw std::runtime_error("instance: " + std::to_string(index) + " is not an instance of the scene");
+
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < request.instances.size(); ++i)
+            scene.SetInstanceTransform(uint32_t(request.instances[i]), request.transforms[i]);
+        scene.CommitUpdates();
+        std::chrono::duration<double> refitTime = Clock::now() - start;
+
+        std::ostringstream reply;
+        reply << "ok moved=" << request.instances.size() << " built=" << int(built)
+              << " refit_s=" << refitTime.count();
+        return reply.str();
+    }
+
+#ifdef _WIN32
+    void RenderServer::Run() {
+        throw std::runtime_error(socketPath + ": Unix domain sockets are not supported on this platform");
+    }
+
+    void RenderServer::Serve(int, bool *) {}
+#else
+    void RenderServer::Run() {
+        // A client that goes away mid-reply must not take the server down
+        std::signal(SIGPIPE, SIG_IGN);
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path))
+            throw std::runtime_error(socketPath + ": socket path is empty or too long");
+        std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+        // Replace a socket left behind by a previous server
+        std::error_code ec;
+        if (std::filesystem::is_socket(socketPath, ec))
+            unlink(socketPath.c_str());
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0)
+            throw std::runtime_error(socketPath + ": " + std::strerror(errno));
+        if (bind(listenFd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0 ||
+            listen(listenFd, 16) != 0) {
+            std::string error = std::strerror(errno);
+            close(listenFd);
+            listenFd = -1;
+            throw std::runtime_error(socketPath + ": " + error);
+        }
+        if (!quiet)
+            std::cout << "Listening for render requests on " << socketPath << std::endl;
+        LOG_INFO("Listening for render requests on %s", socketPath.c_str());
+
+        bool shutdown = false;
+        while (!shutdown) {
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                throw std::runtime_error(socketPath + ": " + std::strerror(errno));
+            }
+            Serve(fd, &shutdown);
+            close(fd);
+        }
+    }
+
+    void RenderServer::Serve(int fd, bool *shutdown) {
+        std::string buffer;
+        char chunk[4096];
+        while (!*shutdown) {
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return;
+            buffer.append(chunk, size_t(n));
+
+            size_t lineEnd;
+            while (!*shutdown && (lineEnd = buffer.find('\n')) != std::string::npos) {
+                std::string line = buffer.substr(0, lineEnd);
+                buffer.erase(0, lineEnd + 1);
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                if (line.find_first_not_of(" \t") == std::string::npos)
+                    continue;
+
+                std::string reply = Handle(line, shutdown) + "\n";
+                for (size_t sent = 0; sent < reply.size();) {
+                    ssize_t m = send(fd, reply.data() + sent, reply.size() - sent, 0);
+                    if (m < 0 && errno == EINTR)
+                        continue;
+                    if (m < 0)
+                        return;
+                    sent += size_t(m);
+                }
+            }
+        }
+    }
+#endif
+
+#pragma endregion
+}
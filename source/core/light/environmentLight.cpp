@@ -0,0 +1,113 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/light/environmentLight.h"
+#include "core/math/mathematics.h"
+#include "util/parallel.h"
+
+namespace jadehare {
+
+    EnvironmentLight::EnvironmentLight(Image im, const Vector3f &w, float scale, const Bounds3f &sceneBounds)
+            : image(std::move(im)), z(Normalize(w)), scale(scale), sceneRadius(Length(sceneBounds.Diagonal()) / 2) {
+        CoordinateSystem(z, &x, &y);
+
+        // Sampling density over the image: luminance, times the sine of
+        // the latitude at the row's center, which is the area each pixel
+        // covers on the sphere
+        Point2i res = image.Resolution();
+        std::vector<float> d(size_t(res.x) * res.y);
+        ParallelFor(0, res.y, [&](int64_t v) {
+            float sinTheta = std::sin(Pi * (v + .5f) / res.y);
+            for (int u = 0; u < res.x; ++u)
+                d[v * res.x + u] = std::max<float>(image.GetRGB(Point2i(u, int(v))).Luminance(), 0) * sinTheta;
+        });
+        distribution = PiecewiseConstant2D(d, res.x, res.y);
+
+        // The alias tables sample the same density a row at a time
+        std::vector<float> rowWeights(res.y);
+        conditionalAlias.resize(res.y);
+        ParallelFor(0, res.y, [&](int64_t v) {
+            span<const float> row = span<const float>(d).subspan(v * res.x, res.x);
+            conditionalAlias[v] = AliasTable(row);
+            double sum = 0;
+            for (float f : row)
+                sum += f;
+            rowWeights[v] = float(sum);
+        });
+        marginalAlias = AliasTable(rowWeights);
+    }
+
+    RGB EnvironmentLight::LookupLight(const Vector3f &wLight) const {
+        Point2i res = image.Resolution();
+        int u = Clamp(int(SphericalPhi(wLight) * Inv2Pi * res.x), 0, res.x - 1);
+        int v = Clamp(int(SphericalTheta(wLight) * InvPi * res.y), 0, res.y - 1);
+        return scale * image.GetRGB(Point2i(u, v));
+    }
+
+    std::optional<LightLiSample> EnvironmentLight::MakeSample(const LightSampleContext &ctx, const Point2f &uv,
+                                                              float mapPDF) const {
+        if (mapPDF == 0)
+            return {};
+
+        // Map the image point to a direction; the density changes by the
+        // Jacobian of the equirectangular mapping
+        float theta = uv.y * Pi, phi = uv.x * 2 * Pi;
+        float cosTheta = std::cos(theta), sinTheta = std::sin(theta);
+        if (sinTheta == 0)
+            return {};
+        Vector3f wLight = SphericalDirection(sinTheta, cosTheta, phi);
+        float pdf = mapPDF / (2 * Pi * Pi * sinTheta);
+        Vector3f wi = RenderFromLight(wLight);
+        return LightLiSample{LookupLight(wLight), wi, pdf, ctx.p + wi * (2 * sceneRadius)};
+    }
+
+    std::optional<LightLiSample> EnvironmentLight::SampleLi(const LightSampleContext &ctx, const Point2f &u) const {
+        float mapPDF;
+        Point2f uv = distribution.Sample(u, &mapPDF);
+        return MakeSample(ctx, uv, mapPDF);
+    }
+
+    void EnvironmentLight::SampleLi(span<const LightSampleContext> ctx, span<const Point2f> u,
+                                    span<LightLiSample> samples) const {
+        DCHECK(ctx.size() == u.size() && samples.size() == u.size());
+        // A black map has nothing to sample, and its alias tables are
+        // uniform rather than empty
+        if (distribution.Integral() == 0) {
+            for (LightLiSample &s : samples)
+                s = LightLiSample{};
+            return;
+        }
+
+        Point2i res = image.Resolution();
+        constexpr size_t chunkSize = 64;
+        for (size_t start = 0; start < u.size(); start += chunkSize) {
+            size_t n = std::min(chunkSize, u.size() - start);
+
+            // Choose the rows of the whole chunk at once
+            float uRow[chunkSize], pmfRow[chunkSize], vRemapped[chunkSize];
+            int row[chunkSize];
+            for (size_t i = 0; i < n; ++i)
+                uRow[i] = u[start + i].y;
+            marginalAlias.Sample(span<const float>(uRow, n), span<int>(row, n), span<float>(pmfRow, n),
+                                 span<float>(vRemapped, n));
+
+            for (size_t i = 0; i < n; ++i) {
+                float pmfColumn, uRemapped;
+                int column = conditionalAlias[row[i]].Sample(u[start + i].x, &pmfColumn, &uRemapped);
+                Point2f uv((column + uRemapped) / res.x, (row[i] + vRemapped[i]) / res.y);
+                float mapPDF = pmfColumn * res.x * pmfRow[i] * res.y;
+                samples[start + i] = MakeSample(ctx[start + i], uv, mapPDF).value_or(LightLiSample{});
+            }
+        }
+    }
+
+    float EnvironmentLight::PDF_Li(const LightSampleContext &ctx, const Vector3f &wi) const {
+        Vector3f wLight = LightFromRender(Normalize(wi));
+        float theta = SphericalTheta(wLight), phi = SphericalPhi(wLight);
+        float sinTheta = std::sin(theta);
+        if (sinTheta == 0)
+            return 0;
+        return distribution.PDF(Point2f(phi * Inv2Pi, theta * InvPi)) / (2 * Pi * Pi * sinTheta);
+    }
+}
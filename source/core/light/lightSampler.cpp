@@ -0,0 +1,260 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/light/lightSampler.h"
+#include "core/scene/scene.h"
+#include "util/check.h"
+#include "util/parallel.h"
+#include "util/profile.h"
+
+#include <algorithm>
+
+namespace jadehare {
+
+    // Returns the bounds of a light that can be put in the BVH, or nothing
+    // for distant and infinite lights and degenerate triangles.
+    static std::optional<LightBounds> ComputeLightBounds(const Scene &scene, const LightData &light) {
+        switch (light.type) {
+            case LightType::Point: {
+                float phi = 4 * Pi * light.scale * light.L.MaxComponentValue();
+                return LightBounds(Bounds3f(light.p, light.p), Vector3f(0, 0, 1), phi, std::cos(Pi),
+                                   std::cos(Pi / 2), false);
+            }
+            case LightType::Spot: {
+                // phi is the power of the matching point light, which keeps
+                // spot and point lights comparable
+                float phi = 4 * Pi * light.scale * light.L.MaxComponentValue();
+                float cosTheta_e = std::cos(std::acos(light.cosFalloffEnd) - std::acos(light.cosFalloffStart));
+                return LightBounds(Bounds3f(light.p, light.p), light.w, phi, light.cosFalloffStart, cosTheta_e,
+                                   false);
+            }
+            case LightType::DiffuseArea: {
+                const TriangleMesh &mesh = scene.Meshes()[light.meshIndex];
+                float area = mesh.TriangleArea(light.triangleIndex);
+                if (area == 0)
+                    return {};
+
+                // Emission follows the surface normal as the renderer orients it
+                Vector3f n(mesh.FaceNormal(light.triangleIndex));
+                float phi = light.L.MaxComponentValue() * light.scale * area * Pi * (light.twoSided ? 2 : 1);
+                return LightBounds(mesh.TriangleBounds(light.triangleIndex), n, phi, std::cos(0.f),
+                                   std::cos(Pi / 2), light.twoSided);
+            }
+            default:
+                return {};
+        }
+    }
+
+    BVHLightSampler::BVHLightSampler(const Scene &scene) : lightToBitTrail(scene.Lights().size(), NotSampled) {
+        PROFILE_SCOPE("Build light BVH");
+        span<const LightData> lights = scene.Lights();
+        std::vector<std::optional<LightBounds>> bounds(lights.size());
+        ParallelFor(0, int64_t(lights.size()), [&](int64_t i) { bounds[i] = ComputeLightBounds(scene, lights[i]); });
+
+        // Split the lights between the BVH and the infinite lights
+        std::vector<std::pair<int, LightBounds>> bvhLights;
+        for (size_t i = 0; i < lights.size(); ++i) {
+            if (lights[i].type == LightType::Distant || lights[i].type == LightType::Infinite) {
+                infiniteLights.push_back(int(i));
+                lightToBitTrail[i] = InfiniteLight;
+            } else if (bounds[i] && bounds[i]->phi > 0) {
+                bvhLights.emplace_back(int(i), *bounds[i]);
+                allLightBounds = Union(allLightBounds, bounds[i]->bounds);
+            }
+        }
+
+        if (!bvhLights.empty()) {
+            nodes.reserve(2 * bvhLights.size() - 1);
+            BuildBVH(bvhLights, 0, bvhLights.size(), 0, 0);
+        }
+    }
+
+    std::pair<int, LightBounds> BVHLightSampler::BuildBVH(std::vector<std::pair<int, LightBounds>> &bvhLights,
+                                                          size_t start, size_t end, uint64_t bitTrail,
+                                                          int depth) {
+        DCHECK(start < end);
+        // Create a leaf for a single light
+        if (end - start == 1) {
+            int nodeIndex = int(nodes.size());
+            CompactLightBounds cb(bvhLights[start].second, allLightBounds);
+            int lightIndex = bvhLights[start].first;
+            nodes.push_back(LightBVHNode::MakeLeaf(lightIndex, cb));
+            lightToBitTrail[lightIndex] = bitTrail;
+            return {nodeIndex, bvhLights[start].second};
+        }
+
+        // Compute the bounds of the lights and of their centroids
+        Bounds3f bounds, centroidBounds;
+        for (size_t i = start; i < end; ++i) {
+            const LightBounds &lb = bvhLights[i].second;
+            bounds = Union(bounds, lb.bounds);
+            centroidBounds = Union(centroidBounds, lb.Centroid());
+        }
+
+        // Find the cheapest bucket split over all three dimensions
+        float minCost = Infinity;
+        int minCostSplitBucket = -1, minCostSplitDim = -1;
+        constexpr int nBuckets = 12;
+        // Past this depth, split at the median so the bit trails can't overflow
+        constexpr int maxSAHDepth = 40;
+        for (int dim = 0; dim < 3 && depth < maxSAHDepth; ++dim) {
+            if (centroidBounds.pMax[dim] == centroidBounds.pMin[dim])
+                continue;
+
+            LightBounds bucketLightBounds[nBuckets];
+            for (size_t i = start; i < end; ++i) {
+                Point3f pc = bvhLights[i].second.Centroid();
+                int b = std::min(int(nBuckets * centroidBounds.Offset(pc)[dim]), nBuckets - 1);
+                bucketLightBounds[b] = Union(bucketLightBounds[b], bvhLights[i].second);
+            }
+
+            // Cost of splitting after each bucket, from a forward and a
+            // backward sweep
+            float cost[nBuckets - 1];
+            LightBounds below;
+            for (int i = 0; i < nBuckets - 1; ++i) {
+                below = Union(below, bucketLightBounds[i]);
+                cost[i] = EvaluateCost(below, bounds, dim);
+            }
+            LightBounds above;
+            for (int i = nBuckets - 1; i >= 1; --i) {
+                above = Union(above, bucketLightBounds[i]);
+                cost[i - 1] += EvaluateCost(above, bounds, dim);
+            }
+
+            for (int i = 1; i < nBuckets - 1; ++i) {
+                if (cost[i] > 0 && cost[i] < minCost) {
+                    minCost = cost[i];
+                    minCostSplitBucket = i;
+                    minCostSplitDim = dim;
+                }
+            }
+        }
+
+        // Partition the lights, falling back to a median split
+        size_t mid;
+        if (minCostSplitDim == -1)
+            mid = end;
+        else {
+            auto pmid = std::partition(
+                    bvhLights.begin() + start, bvhLights.begin() + end, [=](const std::pair<int, LightBounds> &l) {
+                        int b = nBuckets * centroidBounds.Offset(l.second.Centroid())[minCostSplitDim];
+                        b = std::min(b, nBuckets - 1);
+                        return b <= minCostSplitBucket;
+                    });
+            mid = pmid - bvhLights.begin();
+        }
+        if (mid == start || mid == end) {
+            mid = (start + end) / 2;
+            int dim = centroidBounds.MaxDimension();
+            std::nth_element(bvhLights.begin() + start, bvhLights.begin() + mid, bvhLights.begin() + end,
+                             [dim](const std::pair<int, LightBounds> &a, const std::pair<int, LightBounds> &b) {
+                                 return a.second.Centroid()[dim] < b.second.Centroid()[dim];
+                             });
+        }
+
+        // Build the children; the first one follows its parent
+        int nodeIndex = int(nodes.size());
+        nodes.push_back(LightBVHNode());
+        DCHECK(depth < 64);
+        std::pair<int, LightBounds> child0 = BuildBVH(bvhLights, start, mid, bitTrail, depth + 1);
+        DCHECK(nodeIndex + 1 == child0.first);
+        std::pair<int, LightBounds> child1 = BuildBVH(bvhLights, mid, end, bitTrail | (uint64_t(1) << depth),
+                                                      depth + 1);
+
+        LightBounds lb = Union(child0.second, child1.second);
+        nodes[nodeIndex] = LightBVHNode::MakeInterior(child1.first, CompactLightBounds(lb, allLightBounds));
+        return {nodeIndex, lb};
+    }
+
+    // Split cost: power times the solid angle measure of the emission cone,
+    // times surface area, penalizing splits of thin dimensions.
+    float BVHLightSampler::EvaluateCost(const LightBounds &b, const Bounds3f &bounds, int dim) const {
+        float theta_o = std::acos(b.cosTheta_o), theta_e = std::acos(b.cosTheta_e);
+        float theta_w = std::min(theta_o + theta_e, Pi);
+        float sinTheta_o = SafeSqrt(1 - Sqr(b.cosTheta_o));
+        float M_omega = 2 * Pi * (1 - b.cosTheta_o) +
+                        Pi / 2 * (2 * theta_w * sinTheta_o - std::cos(theta_o - 2 * theta_w) -
+                                  2 * theta_o * sinTheta_o + b.cosTheta_o);
+        float Kr = MaxComponentValue(bounds.Diagonal()) / bounds.Diagonal()[dim];
+        return b.phi * M_omega * Kr * b.bounds.SurfaceArea();
+    }
+
+    std::optional<SampledLight> BVHLightSampler::Sample(const LightSampleContext &ctx, float u) const {
+        // Sample an infinite light with probability pInfinite
+        float pInfinite = InfiniteProbability();
+        if (u < pInfinite) {
+            u /= pInfinite;
+            int index = std::min(int(u * infiniteLights.size()), int(infiniteLights.size()) - 1);
+            return SampledLight{infiniteLights[index], pInfinite / infiniteLights.size()};
+        }
+        if (nodes.empty())
+            return {};
+
+        // Walk down the BVH, reusing u for each choice
+        u = std::min((u - pInfinite) / (1 - pInfinite), OneMinusEpsilon);
+        int nodeIndex = 0;
+        float pmf = 1 - pInfinite;
+        while (true) {
+            const LightBVHNode &node = nodes[nodeIndex];
+            if (!node.isLeaf) {
+                float ci[2] = {nodes[nodeIndex + 1].lightBounds.Importance(ctx.p, ctx.n, allLightBounds),
+                               nodes[node.childOrLightIndex].lightBounds.Importance(ctx.p, ctx.n, allLightBounds)};
+                if (ci[0] == 0 && ci[1] == 0)
+                    return {};
+
+                float p0 = ci[0] / (ci[0] + ci[1]);
+                if (u < p0) {
+                    u = std::min(u / p0, OneMinusEpsilon);
+                    pmf *= p0;
+                    nodeIndex = nodeIndex + 1;
+                } else {
+                    u = std::min((u - p0) / (1 - p0), OneMinusEpsilon);
+                    pmf *= ci[1] / (ci[0] + ci[1]);
+                    nodeIndex = node.childOrLightIndex;
+                }
+            } else {
+                // A lone root leaf hasn't had its importance checked yet
+                if (nodeIndex > 0 || node.lightBounds.Importance(ctx.p, ctx.n, allLightBounds) > 0) {
+                    DCHECK(std::abs(pmf - PMF(ctx, node.childOrLightIndex)) <= 1e-4f * pmf);
+                    return SampledLight{int(node.childOrLightIndex), pmf};
+                }
+                return {};
+            }
+        }
+    }
+
+    float BVHLightSampler::PMF(const LightSampleContext &ctx, int lightIndex) const {
+        uint64_t bitTrail = lightToBitTrail[lightIndex];
+        if (bitTrail == NotSampled)
+            return 0;
+        if (bitTrail == InfiniteLight)
+            return 1.f / (infiniteLights.size() + (nodes.empty() ? 0 : 1));
+
+        // Follow the light's bit trail, taking the same branch
+        // probabilities as Sample()
+        float pmf = 1 - InfiniteProbability();
+        int nodeIndex = 0;
+        while (true) {
+            const LightBVHNode &node = nodes[nodeIndex];
+            if (node.isLeaf) {
+                if (nodeIndex == 0 && node.lightBounds.Importance(ctx.p, ctx.n, allLightBounds) == 0)
+                    return 0;
+                return pmf;
+            }
+
+            float ci[2] = {nodes[nodeIndex + 1].lightBounds.Importance(ctx.p, ctx.n, allLightBounds),
+                           nodes[node.childOrLightIndex].lightBounds.Importance(ctx.p, ctx.n, allLightBounds)};
+            int child = int(bitTrail & 1);
+            if (ci[child] == 0)
+                return 0;
+            if (child == 0)
+                pmf *= ci[0] / (ci[0] + ci[1]);
+            else
+                pmf *= ci[1] / (ci[0] + ci[1]);
+            nodeIndex = child == 0 ? nodeIndex + 1 : node.childOrLightIndex;
+            bitTrail >>= 1;
+        }
+    }
+}
@@ -0,0 +1,48 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/light/lights.h"
+#include "core/sampling/sampling.h"
+
+namespace jadehare {
+
+    std::optional<LightLiSample> DiffuseAreaLight::SampleLi(const LightSampleContext &ctx, const Point2f &u) const {
+        if (area == 0)
+            return {};
+        const int *v = &mesh->indices[3 * triangleIndex];
+        const Point3f &p0 = mesh->p[v[0]], &p1 = mesh->p[v[1]], &p2 = mesh->p[v[2]];
+        float b[3];
+        SampleUniformTriangle(u, b);
+        Point3f pLight = b[0] * p0 + b[1] * p1 + b[2] * p2;
+
+        // Convert the area density to solid angle at the shading point
+        Vector3f wi = pLight - ctx.p;
+        float d2 = LengthSquared(wi);
+        if (d2 == 0)
+            return {};
+        wi = Normalize(wi);
+        float cosTheta = AbsDot(n, -wi);
+        if (cosTheta == 0)
+            return {};
+        RGB Le = L(-wi);
+        if (Le.IsBlack())
+            return {};
+        return LightLiSample{Le, wi, d2 / (area * cosTheta), pLight};
+    }
+
+    float DiffuseAreaLight::PDF_Li(const LightSampleContext &ctx, const Vector3f &wi) const {
+        if (area == 0)
+            return 0;
+        const int *v = &mesh->indices[3 * triangleIndex];
+        std::optional<TriangleIntersection> isect =
+                IntersectTriangle(Ray(ctx.p, wi), Infinity, mesh->p[v[0]], mesh->p[v[1]], mesh->p[v[2]]);
+        if (!isect)
+            return 0;
+        float d2 = LengthSquared(wi * isect->t);
+        float cosTheta = AbsDot(n, -Normalize(wi));
+        if (cosTheta == 0)
+            return 0;
+        return d2 / (area * cosTheta);
+    }
+}
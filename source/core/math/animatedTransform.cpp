@@ -0,0 +1,147 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/math/animatedTransform.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace jadehare {
+
+    // Rotation matrices and quaternions are converted with _r_ as a
+    // row-major 3x3 matrix.
+    static Quaternion QuaternionFromRotation(const float r[3][3]) {
+        float trace = r[0][0] + r[1][1] + r[2][2];
+        if (trace > 0) {
+            float s = std::sqrt(trace + 1);
+            float w = s / 2;
+            s = 0.5f / s;
+            return Quaternion(w, (r[2][1] - r[1][2]) * s, (r[0][2] - r[2][0]) * s, (r[1][0] - r[0][1]) * s);
+        }
+        // Compute from the largest diagonal entry for stability
+        int i = r[1][1] > r[0][0] ? 1 : 0;
+        if (r[2][2] > r[i][i])
+            i = 2;
+        int j = (i + 1) % 3, k = (j + 1) % 3;
+        float s = std::sqrt(r[i][i] - (r[j][j] + r[k][k]) + 1);
+        float q[3];
+        q[i] = s * 0.5f;
+        if (s != 0)
+            s = 0.5f / s;
+        q[j] = (r[j][i] + r[i][j]) * s;
+        q[k] = (r[k][i] + r[i][k]) * s;
+        return Quaternion((r[k][j] - r[j][k]) * s, q[0], q[1], q[2]);
+    }
+
+    static glm::mat4 RotationMatrix(const Quaternion &q) {
+        float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+        float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+        float wx = q.x * q.w, wy = q.y * q.w, wz = q.z * q.w;
+        float r[3][3] = {{1 - 2 * (yy + zz), 2 * (xy - wz),     2 * (xz + wy)},
+                         {2 * (xy + wz),     1 - 2 * (xx + zz), 2 * (yz - wx)},
+                         {2 * (xz - wy),     2 * (yz + wx),     1 - 2 * (xx + yy)}};
+        glm::mat4 m(1.f);
+        for (int row = 0; row < 3; ++row)
+            for (int col = 0; col < 3; ++col)
+                m[col][row] = r[row][col];
+        return m;
+    }
+
+    AnimatedTransform::AnimatedTransform(const Transform &startTransform, float startTime,
+                                         const Transform &endTransform, float endTime)
+            : startTransform(startTransform), endTransform(endTransform), startTime(startTime), endTime(endTime),
+              actuallyAnimated(startTransform != endTransform && endTime > startTime) {
+        if (!actuallyAnimated)
+            return;
+        Decompose(startTransform.GetMatrix(), &T[0], &R[0], &S[0]);
+        Decompose(endTransform.GetMatrix(), &T[1], &R[1], &S[1]);
+        // Take the shorter way around
+        if (Dot(R[0], R[1]) < 0)
+            R[1] = -R[1];
+    }
+
+    void AnimatedTransform::Decompose(const glm::mat4 &m, Vector3f *T, Quaternion *R, glm::mat4 *S) {
+        *T = Vector3f(m[3][0], m[3][1], m[3][2]);
+
+        // Polar decomposition of the upper 3x3: average the matrix with its
+        // inverse transpose until that converges to the rotation
+        glm::mat4 M(1.f);
+        for (int col = 0; col < 3; ++col)
+            for (int row = 0; row < 3; ++row)
+                M[col][row] = m[col][row];
+        glm::mat4 rot = M;
+        for (int count = 0; count < 100; ++count) {
+            glm::mat4 rit = glm::inverse(glm::transpose(rot)), next(1.f);
+            float norm = 0;
+            for (int row = 0; row < 3; ++row) {
+                float rowSum = 0;
+                for (int col = 0; col < 3; ++col) {
+                    next[col][row] = 0.5f * (rot[col][row] + rit[col][row]);
+                    rowSum += std::abs(rot[col][row] - next[col][row]);
+                }
+                norm = std::max(norm, rowSum);
+            }
+            rot = next;
+            if (norm <= .0001f)
+                break;
+        }
+
+        float r[3][3];
+        for (int row = 0; row < 3; ++row)
+            for (int col = 0; col < 3; ++col)
+                r[row][col] = rot[col][row];
+        *R = Normalize(QuaternionFromRotation(r));
+        *S = glm::inverse(rot) * M;
+    }
+
+    Transform AnimatedTransform::Interpolate(float time) const {
+        if (!actuallyAnimated || time <= startTime)
+            return startTransform;
+        if (time >= endTime)
+            return endTransform;
+        float dt = (time - startTime) / (endTime - startTime);
+
+        Vector3f trans = (1 - dt) * T[0] + dt * T[1];
+        Quaternion rotate = Slerp(dt, R[0], R[1]);
+        glm::mat4 scale(1.f);
+        for (int col = 0; col < 3; ++col)
+            for (int row = 0; row < 3; ++row)
+                scale[col][row] = Lerp(dt, S[0][col][row], S[1][col][row]);
+        return Translate(trans) * Transform(RotationMatrix(rotate) * scale);
+    }
+
+    void AnimatedTransform::LinearBounds(const Bounds3f &b, float t0, float t1, Bounds3f *b0, Bounds3f *b1) const {
+        *b0 = Interpolate(t0)(b);
+        *b1 = Interpolate(t1)(b);
+        if (!actuallyAnimated || t1 <= t0)
+            return;
+
+        // Grow both ends by how far the bounds at sampled times stick out of
+        // the interpolated ones; short of rounding, only rotations do
+        constexpr int nSamples = 32;
+        Vector3f below(0, 0, 0), above(0, 0, 0);
+        float maxStep = 0;
+        Bounds3f prev = *b0;
+        for (int i = 1; i <= nSamples + 1; ++i) {
+            float u = float(i) / float(nSamples + 1);
+            Bounds3f bt = i <= nSamples ? Interpolate(Lerp(u, t0, t1))(b) : *b1, lerped = Lerp(u, *b0, *b1);
+            for (int c = 0; c < 3; ++c) {
+                below[c] = std::max(below[c], lerped.pMin[c] - bt.pMin[c]);
+                above[c] = std::max(above[c], bt.pMax[c] - lerped.pMax[c]);
+                maxStep = std::max({maxStep, std::abs(bt.pMin[c] - prev.pMin[c]),
+                                    std::abs(bt.pMax[c] - prev.pMax[c])});
+            }
+            prev = bt;
+        }
+        // Between samples, a curved path strays from its chord by a fraction
+        // of the distance covered
+        float tolerance = 1e-5f * MaxComponentValue(Union(*b0, *b1).Diagonal());
+        bool curved = MaxComponentValue(below) > tolerance || MaxComponentValue(above) > tolerance;
+        Vector3f slack = curved ? Vector3f(maxStep / 4, maxStep / 4, maxStep / 4) : Vector3f(0, 0, 0);
+        for (Bounds3f *bounds : {b0, b1}) {
+            bounds->pMin = bounds->pMin - below - slack;
+            bounds->pMax = bounds->pMax + above + slack;
+        }
+    }
+}
@@ -0,0 +1,140 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/sampling/distributions.h"
+#include "util/parallel.h"
+
+#include <numeric>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace jadehare {
+
+    PiecewiseConstant1D::PiecewiseConstant1D(span<const float> f, float min, float max)
+            : func(f.begin(), f.end()), cdf(f.size() + 1), min(min), max(max) {
+        DCHECK(!f.empty() && max > min);
+        for (float &v : func)
+            v = std::abs(v);
+
+        // Integrate the step function and normalize the running sums
+        size_t n = func.size();
+        cdf[0] = 0;
+        for (size_t i = 1; i < n + 1; ++i)
+            cdf[i] = cdf[i - 1] + func[i - 1] * (max - min) / n;
+        funcInt = cdf[n];
+        if (funcInt == 0)
+            for (size_t i = 1; i < n + 1; ++i)
+                cdf[i] = float(i) / float(n);
+        else
+            for (size_t i = 1; i < n + 1; ++i)
+                cdf[i] /= funcInt;
+    }
+
+    PiecewiseConstant2D::PiecewiseConstant2D(span<const float> func, int nu, int nv, const Bounds2f &domain)
+            : domain(domain), pConditionalV(nv) {
+        DCHECK(func.size() == size_t(nu) * nv);
+        ParallelFor(0, nv, [&](int64_t v) {
+            pConditionalV[v] = PiecewiseConstant1D(func.subspan(v * nu, nu), domain.pMin.x, domain.pMax.x);
+        });
+
+        std::vector<float> marginalFunc(nv);
+        for (int v = 0; v < nv; ++v)
+            marginalFunc[v] = pConditionalV[v].Integral();
+        pMarginal = PiecewiseConstant1D(marginalFunc, domain.pMin.y, domain.pMax.y);
+    }
+
+    AliasTable::AliasTable(span<const float> weights) : bins(weights.size()) {
+        DCHECK(!weights.empty());
+        double sum = std::accumulate(weights.begin(), weights.end(), 0.);
+        for (size_t i = 0; i < bins.size(); ++i) {
+            DCHECK(weights[i] >= 0);
+            bins[i].p = sum > 0 ? float(weights[i] / sum) : 1.f / bins.size();
+        }
+
+        // Split the outcomes by whether they are below or above the
+        // average probability, then pair each one below with one above
+        struct Outcome {
+            double pHat;
+            int index;
+        };
+        std::vector<Outcome> under, over;
+        for (size_t i = 0; i < bins.size(); ++i) {
+            double pHat = sum > 0 ? weights[i] / sum * bins.size() : 1;
+            if (pHat < 1)
+                under.push_back(Outcome{pHat, int(i)});
+            else
+                over.push_back(Outcome{pHat, int(i)});
+        }
+        while (!under.empty() && !over.empty()) {
+            Outcome un = under.back(), ov = over.back();
+            under.pop_back();
+            over.pop_back();
+            bins[un.index].q = float(un.pHat);
+            bins[un.index].alias = ov.index;
+
+            // The rest of the larger outcome goes back in the lists
+            double pExcess = un.pHat + ov.pHat - 1;
+            if (pExcess < 1)
+                under.push_back(Outcome{pExcess, ov.index});
+            else
+                over.push_back(Outcome{pExcess, ov.index});
+        }
+
+        // Whatever is left over is one up to round-off
+        for (const Outcome &o : over) {
+            bins[o.index].q = 1;
+            bins[o.index].alias = -1;
+        }
+        for (const Outcome &o : under) {
+            bins[o.index].q = 1;
+            bins[o.index].alias = -1;
+        }
+    }
+
+    void AliasTable::Sample(span<const float> u, span<int> index, span<float> pmf, span<float> uRemapped) const {
+        DCHECK(index.size() == u.size());
+        DCHECK(pmf.empty() || pmf.size() == u.size());
+        DCHECK(uRemapped.empty() || uRemapped.size() == u.size());
+        size_t i = 0;
+#if defined(__SSE2__)
+        const __m128 n = _mm_set1_ps(float(bins.size()));
+        const __m128i nMinusOne = _mm_set1_epi32(int(bins.size()) - 1);
+        const __m128 oneMinusEpsilon = _mm_set1_ps(OneMinusEpsilon), one = _mm_set1_ps(1);
+        for (; i + 4 <= u.size(); i += 4) {
+            // Bin offsets and the fractional parts that choose within them
+            __m128 un = _mm_mul_ps(_mm_loadu_ps(&u[i]), n);
+            __m128i offset = _mm_cvttps_epi32(un);
+            __m128i past = _mm_cmpgt_epi32(offset, nMinusOne);
+            offset = _mm_or_si128(_mm_and_si128(past, nMinusOne), _mm_andnot_si128(past, offset));
+            __m128 up = _mm_min_ps(_mm_sub_ps(un, _mm_cvtepi32_ps(offset)), oneMinusEpsilon);
+
+            // Gather the bins
+            alignas(16) int o[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(o), offset);
+            const Bin *b[4] = {&bins[o[0]], &bins[o[1]], &bins[o[2]], &bins[o[3]]};
+            __m128 q = _mm_setr_ps(b[0]->q, b[1]->q, b[2]->q, b[3]->q);
+            __m128 useBin = _mm_cmplt_ps(up, q);
+            int mask = _mm_movemask_ps(useBin);
+            for (int lane = 0; lane < 4; ++lane) {
+                int chosen = (mask & (1 << lane)) ? o[lane] : b[lane]->alias;
+                index[i + lane] = chosen;
+                if (!pmf.empty())
+                    pmf[i + lane] = bins[chosen].p;
+            }
+
+            // Remap the fractional part to [0,1) within the chosen side;
+            // the lanes of the other side may divide by zero
+            if (!uRemapped.empty()) {
+                __m128 below = _mm_div_ps(up, q), above = _mm_div_ps(_mm_sub_ps(up, q), _mm_sub_ps(one, q));
+                __m128 remapped = _mm_or_ps(_mm_and_ps(useBin, below), _mm_andnot_ps(useBin, above));
+                _mm_storeu_ps(&uRemapped[i], _mm_min_ps(remapped, oneMinusEpsilon));
+            }
+        }
+#endif
+        for (; i < u.size(); ++i)
+            index[i] = Sample(u[i], pmf.empty() ? nullptr : &pmf[i], uRemapped.empty() ? nullptr : &uRemapped[i]);
+    }
+}
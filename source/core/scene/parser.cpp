@@ -0,0 +1,662 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/scene/parser.h"
+#include "util/log.h"
+#include "util/parallel.h"
+#include "util/profile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace jadehare {
+
+    [[noreturn]] static void ErrorExit(const FileLoc &loc, const std::string &message) {
+        throw std::runtime_error(loc.ToString() + ": " + message);
+    }
+
+    void Warning(const FileLoc &loc, const std::string &message) {
+        LOG_WARNING("%s: %s", loc.ToString().c_str(), message.c_str());
+    }
+
+    std::string FileLoc::ToString() const {
+        return std::string(filename) + ":" + std::to_string(line) + ":" + std::to_string(column);
+    }
+
+    static bool IsSpace(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+    }
+
+#pragma region Tokenizer
+
+    Tokenizer::Tokenizer(std::string_view contents, std::string_view filename)
+            : pos(contents.data()), end(contents.data() + contents.size()) {
+        loc.filename = filename;
+    }
+
+    void Tokenizer::SkipWhitespaceAndComments() {
+        while (pos < end) {
+            if (*pos == '\n') {
+                ++loc.line;
+                loc.column = 0;
+                ++pos;
+            } else if (IsSpace(*pos)) {
+                ++loc.column;
+                ++pos;
+            } else if (*pos == '#') {
+                const void *nl = std::memchr(pos, '\n', end - pos);
+                const char *eol = nl ? static_cast<const char *>(nl) : end;
+                loc.column += int(eol - pos);
+                pos = eol;
+            } else
+                break;
+        }
+    }
+
+    char Tokenizer::PeekChar() {
+        SkipWhitespaceAndComments();
+        return pos < end ? *pos : '\0';
+    }
+
+    std::optional<Token> Tokenizer::Next() {
+        SkipWhitespaceAndComments();
+        if (pos == end)
+            return {};
+
+        const char *start = pos;
+        FileLoc startLoc = loc;
+        if (*pos == '"') {
+            // Scan to the closing quote, skipping escaped characters
+            ++pos;
+            while (pos < end && *pos != '"') {
+                if (*pos == '\n')
+                    ErrorExit(startLoc, "unterminated string");
+                if (*pos == '\\' && pos + 1 < end)
+                    ++pos;
+                ++pos;
+            }
+            if (pos == end)
+                ErrorExit(startLoc, "premature end of file inside quoted string");
+            ++pos;
+        } else if (*pos == '[' || *pos == ']') {
+            ++pos;
+        } else {
+            while (pos < end && !IsSpace(*pos) && *pos != '"' && *pos != '[' && *pos != ']' && *pos != '#')
+                ++pos;
+        }
+        loc.column += int(pos - start);
+        return Token{std::string_view(start, pos - start), startLoc};
+    }
+
+    std::string_view Tokenizer::TakeUntilCloseBracket(const FileLoc &openLoc) {
+        const void *close = std::memchr(pos, ']', end - pos);
+        if (!close)
+            ErrorExit(openLoc, "unterminated '['");
+        std::string_view text(pos, static_cast<const char *>(close) - pos);
+
+        // Keep the line count right for later error messages
+        int64_t newlines = std::count(text.begin(), text.end(), '\n');
+        if (newlines > 0) {
+            loc.line += int(newlines);
+            loc.column = int(text.size() - text.find_last_of('\n') - 1);
+        } else
+            loc.column += int(text.size());
+        loc.column += 1;
+        pos = static_cast<const char *>(close) + 1;
+        return text;
+    }
+
+#pragma endregion Tokenizer
+
+    std::string ResolveFilename(std::string_view filename, std::string_view relativeTo) {
+        if (filename.empty() || filename[0] == '/' || (filename.size() > 1 && filename[1] == ':'))
+            return std::string(filename);
+        size_t slash = relativeTo.find_last_of("/\\");
+        if (slash == std::string_view::npos)
+            return std::string(filename);
+        return std::string(relativeTo.substr(0, slash + 1)) + std::string(filename);
+    }
+
+#pragma region Number Parsing
+
+    static float ParseFloat(std::string_view s, const FileLoc &loc) {
+        if (!s.empty() && s[0] == '+')
+            s.remove_prefix(1);
+        float value;
+#if defined(__cpp_lib_to_chars)
+        auto result = std::from_chars(s.data(), s.data() + s.size(), value);
+        if (result.ec != std::errc() || result.ptr != s.data() + s.size())
+            ErrorExit(loc, "\"" + std::string(s) + "\": expected a number");
+#else
+        char buf[64];
+        if (s.empty() || s.size() >= sizeof(buf))
+            ErrorExit(loc, "\"" + std::string(s) + "\": expected a number");
+        std::memcpy(buf, s.data(), s.size());
+        buf[s.size()] = '\0';
+        char *endp;
+        value = std::strtof(buf, &endp);
+        if (endp != buf + s.size())
+            ErrorExit(loc, "\"" + std::string(s) + "\": expected a number");
+#endif
+        return value;
+    }
+
+    static int ParseInt(std::string_view s, const FileLoc &loc) {
+        if (!s.empty() && s[0] == '+')
+            s.remove_prefix(1);
+        int value;
+        auto result = std::from_chars(s.data(), s.data() + s.size(), value);
+        if (result.ec != std::errc() || result.ptr != s.data() + s.size())
+            ErrorExit(loc, "\"" + std::string(s) + "\": expected an integer");
+        return value;
+    }
+
+    template<typename T>
+    static T ParseNumber(std::string_view s, const FileLoc &loc) {
+        if constexpr (std::is_same_v<T, int>)
+            return ParseInt(s, loc);
+        else
+            return ParseFloat(s, loc);
+    }
+
+    // Calls func(word) for each whitespace-separated word of _text_.
+    template<typename F>
+    static void ForEachWord(std::string_view text, F func) {
+        const char *p = text.data(), *end = text.data() + text.size();
+        while (true) {
+            while (p < end && IsSpace(*p))
+                ++p;
+            if (p == end)
+                return;
+            const char *start = p;
+            while (p < end && !IsSpace(*p))
+                ++p;
+            func(std::string_view(start, p - start));
+        }
+    }
+
+    // Parses the numbers in the body of a bracketed array. Big arrays (mesh
+    // positions and indices, mostly) are split at whitespace into chunks
+    // that are first counted and then parsed straight into place in
+    // parallel.
+    template<typename T>
+    static void ParseNumberArray(std::string_view text, const FileLoc &loc, std::vector<T> *values) {
+        constexpr size_t ParallelThreshold = 1 << 20;
+        bool hasComments = std::memchr(text.data(), '#', text.size()) != nullptr;
+        if (text.size() < ParallelThreshold || RunningThreads() == 1 || hasComments) {
+            if (hasComments) {
+                // Rare enough that running it through the tokenizer is fine
+                Tokenizer tokenizer(text, loc.filename);
+                while (std::optional<Token> t = tokenizer.Next())
+                    values->push_back(ParseNumber<T>(t->token, loc));
+            } else
+                ForEachWord(text, [&](std::string_view word) { values->push_back(ParseNumber<T>(word, loc)); });
+            return;
+        }
+
+        // Split _text_ into chunks that start and end on whitespace
+        int nChunks = 4 * RunningThreads();
+        std::vector<size_t> bounds(nChunks + 1, text.size());
+        bounds[0] = 0;
+        for (int i = 1; i < nChunks; ++i) {
+            size_t b = std::max(bounds[i - 1], text.size() * i / nChunks);
+            while (b < text.size() && !IsSpace(text[b]))
+                ++b;
+            bounds[i] = b;
+        }
+        auto chunk = [&](int64_t i) { return text.substr(bounds[i], bounds[i + 1] - bounds[i]); };
+
+        std::vector<size_t> offsets(nChunks + 1, 0);
+        ParallelFor(0, nChunks, [&](int64_t i) {
+            size_t n = 0;
+            ForEachWord(chunk(i), [&n](std::string_view) { ++n; });
+            offsets[i + 1] = n;
+        });
+        for (int i = 0; i < nChunks; ++i)
+            offsets[i + 1] += offsets[i];
+
+        size_t first = values->size();
+        values->resize(first + offsets[nChunks]);
+        T *out = values->data() + first;
+        ParallelFor(0, nChunks, [&](int64_t i) {
+            T *v = out + offsets[i];
+            ForEachWord(chunk(i), [&](std::string_view word) { *v++ = ParseNumber<T>(word, loc); });
+        });
+    }
+
+#pragma endregion Number Parsing
+
+#pragma region Directive Syntax
+
+    // DirectiveSyntax Definition
+    struct DirectiveSyntax {
+        std::string_view keyword;
+        // Number of quoted string arguments; -1 for MediumInterface's one or two.
+        int nStrings;
+        int nNumbers;
+        bool hasParameters;
+        // +1 for directives that open a block, -1 for ones that close it.
+        int blockDelta;
+        // ActiveTransform takes an unquoted word.
+        bool bareWord;
+    };
+
+    static const DirectiveSyntax directiveSyntax[] = {
+            {"Accelerator",        1,  0,  true,  0,  false},
+            {"ActiveTransform",    0,  0,  false, 0,  true},
+            {"AreaLightSource",    1,  0,  true,  0,  false},
+            {"Attribute",          1,  0,  true,  0,  false},
+            {"AttributeBegin",     0,  0,  false, 1,  false},
+            {"AttributeEnd",       0,  0,  false, -1, false},
+            {"Camera",             1,  0,  true,  0,  false},
+            {"ColorSpace",         1,  0,  false, 0,  false},
+            {"ConcatTransform",    0,  16, false, 0,  false},
+            {"CoordSysTransform",  1,  0,  false, 0,  false},
+            {"CoordinateSystem",   1,  0,  false, 0,  false},
+            {"Film",               1,  0,  true,  0,  false},
+            {"Identity",           0,  0,  false, 0,  false},
+            {"Import",             1,  0,  false, 0,  false},
+            {"Include",            1,  0,  false, 0,  false},
+            {"Integrator",         1,  0,  true,  0,  false},
+            {"LightSource",        1,  0,  true,  0,  false},
+            {"LookAt",             0,  9,  false, 0,  false},
+            {"MakeNamedMaterial",  1,  0,  true,  0,  false},
+            {"MakeNamedMedium",    1,  0,  true,  0,  false},
+            {"Material",           1,  0,  true,  0,  false},
+            {"MediumInterface",    -1, 0,  false, 0,  false},
+            {"NamedMaterial",      1,  0,  false, 0,  false},
+            {"ObjectBegin",        1,  0,  false, 1,  false},
+            {"ObjectEnd",          0,  0,  false, -1, false},
+            {"ObjectInstance",     1,  0,  false, 0,  false},
+            {"Option",             0,  0,  true,  0,  false},
+            {"PixelFilter",        1,  0,  true,  0,  false},
+            {"ReverseOrientation", 0,  0,  false, 0,  false},
+            {"Rotate",             0,  4,  false, 0,  false},
+            {"Sampler",            1,  0,  true,  0,  false},
+            {"Scale",              0,  3,  false, 0,  false},
+            {"Shape",              1,  0,  true,  0,  false},
+            {"Texture",            3,  0,  true,  0,  false},
+            {"Transform",          0,  16, false, 0,  false},
+            {"TransformBegin",     0,  0,  false, 1,  false},
+            {"TransformEnd",       0,  0,  false, -1, false},
+            {"TransformTimes",     0,  2,  false, 0,  false},
+            {"Translate",          0,  3,  false, 0,  false},
+            {"WorldBegin",         0,  0,  false, 0,  false}};
+
+    static const DirectiveSyntax *LookupDirective(std::string_view keyword) {
+        for (const DirectiveSyntax &syntax : directiveSyntax)
+            if (syntax.keyword == keyword)
+                return &syntax;
+        return nullptr;
+    }
+
+    enum class ParameterStorage {
+        Floats, Ints, Strings, Bools, FloatsOrStrings
+    };
+
+    static std::optional<ParameterStorage> StorageForType(std::string_view type) {
+        static const std::string_view floatTypes[] = {"float", "point2", "vector2", "point3", "vector3",
+                                                      "normal", "normal3", "point", "vector", "color",
+                                                      "rgb", "blackbody"};
+        for (std::string_view t : floatTypes)
+            if (type == t)
+                return ParameterStorage::Floats;
+        if (type == "integer")
+            return ParameterStorage::Ints;
+        if (type == "string" || type == "texture")
+            return ParameterStorage::Strings;
+        if (type == "bool")
+            return ParameterStorage::Bools;
+        if (type == "spectrum")
+            return ParameterStorage::FloatsOrStrings;
+        return {};
+    }
+
+#pragma endregion Directive Syntax
+
+#pragma region Parser
+
+    // SceneParser Definition
+    class SceneParser {
+    public:
+        explicit SceneParser(ParsedScene *scene) : scene(scene) {}
+
+        void ParseFile(const std::string &filename);
+
+        void ParseContents(std::string_view contents, std::string_view filename);
+
+    private:
+        // SceneParser Private Methods
+        Token NextToken(Tokenizer &tokenizer, const FileLoc &loc) {
+            std::optional<Token> t = tokenizer.Next();
+            if (!t)
+                ErrorExit(loc, "premature end of file");
+            return *t;
+        }
+
+        void ParseDirective(Tokenizer &tokenizer, const Token &keyword);
+
+        void ParseParameters(Tokenizer &tokenizer, SceneDirective *directive);
+
+        void ParseValue(Tokenizer &tokenizer, ParsedParameter *param, ParameterStorage storage);
+
+        void AddValue(const Token &t, ParsedParameter *param, ParameterStorage storage);
+
+        // SceneParser Private Members
+        ParsedScene *scene;
+    };
+
+    void SceneParser::ParseFile(const std::string &filename) {
+        // Scene files are read front to back exactly once.
+        scene->files.push_back(MappedFile::Open(filename, MappedFile::Access::Sequential));
+        const MappedFile &file = *scene->files.back();
+        ParseContents(file.View(), scene->Intern(filename));
+    }
+
+    void SceneParser::ParseContents(std::string_view contents, std::string_view filename) {
+        Tokenizer tokenizer(contents, filename);
+        while (std::optional<Token> t = tokenizer.Next()) {
+            if (t->IsQuoted() || t->token == "[" || t->token == "]")
+                ErrorExit(t->loc, "unexpected token \"" + std::string(t->token) + "\"");
+            ParseDirective(tokenizer, *t);
+        }
+    }
+
+    void SceneParser::ParseDirective(Tokenizer &tokenizer, const Token &keyword) {
+        const DirectiveSyntax *syntax = LookupDirective(keyword.token);
+        if (!syntax)
+            ErrorExit(keyword.loc, "unknown directive \"" + std::string(keyword.token) + "\"");
+
+        SceneDirective directive;
+        directive.keyword = syntax->keyword;
+        directive.loc = keyword.loc;
+
+        // Positional string arguments
+        if (syntax->bareWord)
+            directive.strings.push_back(NextToken(tokenizer, keyword.loc).token);
+        int nStrings = syntax->nStrings < 0 ? 1 : syntax->nStrings;
+        for (int i = 0; i < nStrings; ++i) {
+            Token t = NextToken(tokenizer, keyword.loc);
+            if (!t.IsQuoted())
+                ErrorExit(t.loc, std::string(keyword.token) + ": expected a quoted string");
+            directive.strings.push_back(t.Dequoted());
+        }
+        if (syntax->nStrings < 0 && tokenizer.PeekChar() == '"')
+            directive.strings.push_back(NextToken(tokenizer, keyword.loc).Dequoted());
+
+        // Numeric arguments, optionally bracketed
+        if (syntax->nNumbers > 0) {
+            bool bracketed = tokenizer.PeekChar() == '[';
+            if (bracketed)
+                NextToken(tokenizer, keyword.loc);
+            for (int i = 0; i < syntax->nNumbers; ++i) {
+                Token t = NextToken(tokenizer, keyword.loc);
+                directive.numbers.push_back(ParseFloat(t.token, t.loc));
+            }
+            if (bracketed && NextToken(tokenizer, keyword.loc).token != "]")
+                ErrorExit(keyword.loc, std::string(keyword.token) + ": expected ']'");
+        }
+
+        if (syntax->hasParameters)
+            ParseParameters(tokenizer, &directive);
+
+        if (directive.keyword == "Include" || directive.keyword == "Import") {
+            // Included files are spliced in place; the parsed scene is flat.
+            ParseFile(ResolveFilename(directive.strings[0], keyword.loc.filename));
+            return;
+        }
+        scene->directives.push_back(std::move(directive));
+    }
+
+    void SceneParser::ParseParameters(Tokenizer &tokenizer, SceneDirective *directive) {
+        while (tokenizer.PeekChar() == '"') {
+            Token decl = NextToken(tokenizer, directive->loc);
+            // The declaration is "type name", with any amount of whitespace
+            std::string_view d = decl.Dequoted();
+            size_t typeBegin = d.find_first_not_of(" \t");
+            size_t typeEnd = d.find_first_of(" \t", typeBegin);
+            size_t nameBegin = d.find_first_not_of(" \t", typeEnd);
+            if (typeBegin == std::string_view::npos || typeEnd == std::string_view::npos ||
+                nameBegin == std::string_view::npos)
+                ErrorExit(decl.loc, "\"" + std::string(d) + "\": expected \"type name\" parameter declaration");
+            size_t nameEnd = d.find_first_of(" \t", nameBegin);
+
+            ParsedParameter param;
+            param.type = d.substr(typeBegin, typeEnd - typeBegin);
+            param.name = d.substr(nameBegin, nameEnd == std::string_view::npos ? nameEnd : nameEnd - nameBegin);
+            param.loc = decl.loc;
+            std::optional<ParameterStorage> storage = StorageForType(param.type);
+            if (!storage)
+                ErrorExit(decl.loc, "\"" + std::string(param.type) + "\": unknown parameter type");
+
+            ParseValue(tokenizer, &param, *storage);
+            directive->parameters.push_back(std::move(param));
+        }
+    }
+
+    void SceneParser::ParseValue(Tokenizer &tokenizer, ParsedParameter *param, ParameterStorage storage) {
+        if (tokenizer.PeekChar() != '[') {
+            AddValue(NextToken(tokenizer, param->loc), param, storage);
+            return;
+        }
+
+        Token open = NextToken(tokenizer, param->loc);
+        if (storage == ParameterStorage::FloatsOrStrings)
+            storage = tokenizer.PeekChar() == '"' ? ParameterStorage::Strings : ParameterStorage::Floats;
+        if (storage == ParameterStorage::Floats) {
+            ParseNumberArray(tokenizer.TakeUntilCloseBracket(open.loc), open.loc, &param->floats);
+        } else if (storage == ParameterStorage::Ints) {
+            ParseNumberArray(tokenizer.TakeUntilCloseBracket(open.loc), open.loc, &param->ints);
+        } else {
+            while (true) {
+                Token t = NextToken(tokenizer, open.loc);
+                if (t.token == "]")
+                    break;
+                AddValue(t, param, storage);
+            }
+        }
+    }
+
+    void SceneParser::AddValue(const Token &t, ParsedParameter *param, ParameterStorage storage) {
+        switch (storage) {
+            case ParameterStorage::Floats:
+                param->floats.push_back(ParseFloat(t.token, t.loc));
+                break;
+            case ParameterStorage::Ints:
+                param->ints.push_back(ParseInt(t.token, t.loc));
+                break;
+            case ParameterStorage::Bools: {
+                std::string_view v = t.Dequoted();
+                if (v != "true" && v != "false")
+                    ErrorExit(t.loc, "\"" + std::string(t.token) + "\": expected a bool");
+                param->bools.push_back(v == "true");
+                break;
+            }
+            case ParameterStorage::Strings:
+                if (!t.IsQuoted())
+                    ErrorExit(t.loc, "\"" + std::string(t.token) + "\": expected a quoted string");
+                param->strings.push_back(t.Dequoted());
+                break;
+            case ParameterStorage::FloatsOrStrings:
+                AddValue(t, param, t.IsQuoted() ? ParameterStorage::Strings : ParameterStorage::Floats);
+                break;
+        }
+    }
+
+    std::unique_ptr<ParsedScene> ParseFiles(const std::vector<std::string> &filenames) {
+        PROFILE_SCOPE("Parse scene");
+        auto scene = std::make_unique<ParsedScene>();
+        SceneParser parser(scene.get());
+        for (const std::string &filename : filenames)
+            parser.ParseFile(filename);
+        return scene;
+    }
+
+    std::unique_ptr<ParsedScene> ParseString(std::string str) {
+        PROFILE_SCOPE("Parse scene");
+        auto scene = std::make_unique<ParsedScene>();
+        SceneParser parser(scene.get());
+        std::string_view contents = scene->Intern(std::move(str));
+        parser.ParseContents(contents, "(string)");
+        return scene;
+    }
+
+#pragma endregion Parser
+
+#pragma region ParsedScene
+
+    const ParsedParameter *SceneDirective::GetParameter(std::string_view name) const {
+        for (const ParsedParameter &p : parameters)
+            if (p.name == name)
+                return &p;
+        return nullptr;
+    }
+
+    std::string_view ParsedScene::Intern(std::string str) {
+        strings.push_back(std::move(str));
+        return strings.back();
+    }
+
+    // SceneWriter Definition
+    // Buffers output and formats numbers with std::to_chars, which keeps
+    // printing multi-gigabyte meshes I/O bound.
+    class SceneWriter {
+    public:
+        explicit SceneWriter(std::FILE *out) : out(out) { buf.reserve(BufferSize + 256); }
+
+        ~SceneWriter() { Flush(); }
+
+        void Write(std::string_view s) {
+            buf.append(s.data(), s.size());
+            if (buf.size() >= BufferSize)
+                Flush();
+        }
+
+        void Indent(int n) { buf.append(n, ' '); }
+
+        void Write(float v) {
+            char s[32];
+#if defined(__cpp_lib_to_chars)
+            // Shortest representation that round-trips
+            char *end = std::to_chars(s, s + sizeof(s), v).ptr;
+            Write(std::string_view(s, end - s));
+#else
+            int n = std::snprintf(s, sizeof(s), "%.9g", v);
+            Write(std::string_view(s, n));
+#endif
+        }
+
+        void Write(int v) {
+            char s[16];
+            char *end = std::to_chars(s, s + sizeof(s), v).ptr;
+            Write(std::string_view(s, end - s));
+        }
+
+        void Flush() {
+            std::fwrite(buf.data(), 1, buf.size(), out);
+            buf.clear();
+        }
+
+    private:
+        static constexpr size_t BufferSize = 1 << 20;
+        std::FILE *out;
+        std::string buf;
+    };
+
+    static int ValuesPerLine(std::string_view type) {
+        if (type == "point3" || type == "vector3" || type == "normal" || type == "normal3" ||
+            type == "point" || type == "vector" || type == "rgb" || type == "color")
+            return 12;
+        if (type == "point2" || type == "vector2")
+            return 8;
+        return 16;
+    }
+
+    template<typename T, typename F>
+    static void WriteValues(SceneWriter &w, const std::vector<T> &values, int perLine, int indent, F writeOne) {
+        if (values.size() <= size_t(perLine)) {
+            w.Write("[ ");
+            for (const T &v : values) {
+                writeOne(v);
+                w.Write(" ");
+            }
+            w.Write("]");
+            return;
+        }
+        w.Write("[\n");
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i % perLine == 0)
+                w.Indent(indent + 4);
+            writeOne(values[i]);
+            w.Write((i % perLine == size_t(perLine - 1) || i + 1 == values.size()) ? "\n" : " ");
+        }
+        w.Indent(indent);
+        w.Write("]");
+    }
+
+    void ParsedScene::Print(std::FILE *out) const {
+        SceneWriter w(out);
+        int indent = 0;
+        for (const SceneDirective &d : directives) {
+            const DirectiveSyntax *syntax = LookupDirective(d.keyword);
+            if (syntax->blockDelta < 0)
+                indent = std::max(0, indent - 4);
+            if (d.keyword == "WorldBegin")
+                w.Write("\n");
+
+            w.Indent(indent);
+            w.Write(d.keyword);
+            for (std::string_view s : d.strings) {
+                w.Write(syntax->bareWord ? " " : " \"");
+                w.Write(s);
+                if (!syntax->bareWord)
+                    w.Write("\"");
+            }
+            if (!d.numbers.empty()) {
+                bool bracket = d.numbers.size() == 16;
+                w.Write(bracket ? " [" : "");
+                for (float v : d.numbers) {
+                    w.Write(" ");
+                    w.Write(v);
+                }
+                w.Write(bracket ? " ]" : "");
+            }
+            w.Write("\n");
+
+            for (const ParsedParameter &p : d.parameters) {
+                w.Indent(indent + 4);
+                w.Write("\"");
+                w.Write(p.type);
+                w.Write(" ");
+                w.Write(p.name);
+                w.Write("\" ");
+                int perLine = ValuesPerLine(p.type);
+                if (!p.floats.empty())
+                    WriteValues(w, p.floats, perLine, indent + 4, [&w](float v) { w.Write(v); });
+                else if (!p.ints.empty())
+                    WriteValues(w, p.ints, perLine, indent + 4, [&w](int v) { w.Write(v); });
+                else if (!p.bools.empty())
+                    WriteValues(w, p.bools, perLine, indent + 4,
+                                [&w](uint8_t v) { w.Write(v ? "true" : "false"); });
+                else
+                    WriteValues(w, p.strings, 4, indent + 4, [&w](std::string_view v) {
+                        w.Write("\"");
+                        w.Write(v);
+                        w.Write("\"");
+                    });
+                w.Write("\n");
+            }
+
+            if (syntax->blockDelta > 0)
+                indent += 4;
+        }
+    }
+
+#pragma endregion ParsedScene
+}
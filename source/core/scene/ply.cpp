@@ -0,0 +1,491 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/scene/ply.h"
+#include "core/scene/parser.h"
+#include "util/parallel.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace jadehare {
+
+    static_assert(sizeof(Point3f) == 3 * sizeof(float) && sizeof(Normal3f) == 3 * sizeof(float) &&
+                  sizeof(Point2f) == 2 * sizeof(float), "PLY I/O assumes tightly packed points");
+
+#pragma region PLY Header
+
+    enum class PLYType {
+        Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64
+    };
+
+    static int PLYTypeSize(PLYType type) {
+        switch (type) {
+            case PLYType::Int8:
+            case PLYType::UInt8:
+                return 1;
+            case PLYType::Int16:
+            case PLYType::UInt16:
+                return 2;
+            case PLYType::Int32:
+            case PLYType::UInt32:
+            case PLYType::Float32:
+                return 4;
+            case PLYType::Float64:
+                return 8;
+        }
+        return 0;
+    }
+
+    static bool ParsePLYType(const std::string &name, PLYType *type) {
+        static const struct {
+            const char *name;
+            PLYType type;
+        } types[] = {{"char",   PLYType::Int8},    {"int8",    PLYType::Int8},
+                     {"uchar",  PLYType::UInt8},   {"uint8",   PLYType::UInt8},
+                     {"short",  PLYType::Int16},   {"int16",   PLYType::Int16},
+                     {"ushort", PLYType::UInt16},  {"uint16",  PLYType::UInt16},
+                     {"int",    PLYType::Int32},   {"int32",   PLYType::Int32},
+                     {"uint",   PLYType::UInt32},  {"uint32",  PLYType::UInt32},
+                     {"float",  PLYType::Float32}, {"float32", PLYType::Float32},
+                     {"double", PLYType::Float64}, {"float64", PLYType::Float64}};
+        for (const auto &t : types)
+            if (name == t.name) {
+                *type = t.type;
+                return true;
+            }
+        return false;
+    }
+
+    // Reads a little-endian value of the given type; _ptr_ need not be aligned.
+    template<typename T>
+    static T ReadPLYValue(const uint8_t *ptr, PLYType type) {
+        switch (type) {
+            case PLYType::Int8:
+                return T(int8_t(*ptr));
+            case PLYType::UInt8:
+                return T(*ptr);
+            case PLYType::Int16: {
+                int16_t v;
+                std::memcpy(&v, ptr, sizeof(v));
+                return T(v);
+            }
+            case PLYType::UInt16: {
+                uint16_t v;
+                std::memcpy(&v, ptr, sizeof(v));
+                return T(v);
+            }
+            case PLYType::Int32: {
+                int32_t v;
+                std::memcpy(&v, ptr, sizeof(v));
+                return T(v);
+            }
+            case PLYType::UInt32: {
+                uint32_t v;
+                std::memcpy(&v, ptr, sizeof(v));
+                return T(v);
+            }
+            case PLYType::Float32: {
+                float v;
+                std::memcpy(&v, ptr, sizeof(v));
+                return T(v);
+            }
+            case PLYType::Float64: {
+                double v;
+                std::memcpy(&v, ptr, sizeof(v));
+                return T(v);
+            }
+        }
+        return T(0);
+    }
+
+    struct PLYProperty {
+        std::string name;
+        PLYType type;
+        bool isList = false;
+        PLYType countType = PLYType::UInt8;
+        // Byte offset within the record; only meaningful up to the first list.
+        int offset = 0;
+    };
+
+    struct PLYElement {
+        // Size of the record if it has no list properties, otherwise -1.
+        int FixedRecordSize() const {
+            int size = 0;
+            for (const PLYProperty &p : properties) {
+                if (p.isList)
+                    return -1;
+                size += PLYTypeSize(p.type);
+            }
+            return size;
+        }
+
+        const PLYProperty *Find(const char *name) const {
+            for (const PLYProperty &p : properties)
+                if (p.name == name)
+                    return &p;
+            return nullptr;
+        }
+
+        // Size of the variable-length record starting at _ptr_, or 0 if the
+        // record doesn't end before _end_. Nothing at or past _end_ is read.
+        size_t RecordSize(const uint8_t *ptr, const uint8_t *end) const {
+            size_t size = 0, available = end - ptr;
+            for (const PLYProperty &p : properties) {
+                if (p.isList) {
+                    size_t countSize = PLYTypeSize(p.countType);
+                    if (countSize > available - size)
+                        return 0;
+                    uint32_t count = ReadPLYValue<uint32_t>(ptr + size, p.countType);
+                    size += countSize;
+                    if (size_t(count) > (available - size) / PLYTypeSize(p.type))
+                        return 0;
+                    size += size_t(count) * PLYTypeSize(p.type);
+                } else {
+                    if (size_t(PLYTypeSize(p.type)) > available - size)
+                        return 0;
+                    size += PLYTypeSize(p.type);
+                }
+            }
+            return size;
+        }
+
+        std::string name;
+        size_t count = 0;
+        std::vector<PLYProperty> properties;
+        size_t dataOffset = 0;
+    };
+
+    static std::vector<PLYElement> ReadPLYHeader(const MappedFile &file, size_t *dataOffset) {
+        const std::string &filename = file.Filename();
+        std::string_view contents = file.View();
+        size_t end = contents.find("end_header");
+        if (contents.substr(0, 3) != "ply" || end == std::string_view::npos)
+            throw std::runtime_error(filename + ": not a PLY file");
+        size_t nl = contents.find('\n', end);
+        if (nl == std::string_view::npos)
+            throw std::runtime_error(filename + ": truncated PLY header");
+        *dataOffset = nl + 1;
+
+        std::vector<PLYElement> elements;
+        std::istringstream header(std::string(contents.substr(0, end)));
+        std::string line;
+        std::getline(header, line);
+        while (std::getline(header, line)) {
+            std::istringstream words(line);
+            std::string keyword;
+            words >> keyword;
+            if (keyword == "format") {
+                std::string format;
+                words >> format;
+                if (format != "binary_little_endian")
+                    throw std::runtime_error(filename + ": PLY format \"" + format +
+                                             "\" unsupported; only binary_little_endian is handled");
+            } else if (keyword == "element") {
+                PLYElement element;
+                words >> element.name >> element.count;
+                elements.push_back(element);
+            } else if (keyword == "property") {
+                if (elements.empty())
+                    throw std::runtime_error(filename + ": PLY property outside of an element");
+                PLYProperty prop;
+                std::string type;
+                words >> type;
+                if (type == "list") {
+                    std::string countType;
+                    words >> countType >> type;
+                    prop.isList = true;
+                    if (!ParsePLYType(countType, &prop.countType))
+                        throw std::runtime_error(filename + ": unknown PLY type \"" + countType + "\"");
+                }
+                if (!ParsePLYType(type, &prop.type))
+                    throw std::runtime_error(filename + ": unknown PLY type \"" + type + "\"");
+                words >> prop.name;
+                std::vector<PLYProperty> &props = elements.back().properties;
+                prop.offset = props.empty() ? 0 : props.back().offset + PLYTypeSize(props.back().type);
+                props.push_back(prop);
+            }
+        }
+        return elements;
+    }
+
+#pragma endregion PLY Header
+
+#pragma region PLYMesh
+
+    std::unique_ptr<PLYMesh> PLYMesh::Read(const std::string &filename) {
+        auto mesh = std::make_unique<PLYMesh>();
+        mesh->file = MappedFile::Open(filename, MappedFile::Access::Sequential);
+        const MappedFile &file = *mesh->file;
+
+        size_t offset;
+        std::vector<PLYElement> elements = ReadPLYHeader(file, &offset);
+
+        // Find where each element's data starts; only elements with list
+        // properties need to be walked record by record.
+        const PLYElement *vertices = nullptr, *faces = nullptr;
+        const uint8_t *fileEnd = file.Data() + file.Size();
+        for (PLYElement &element : elements) {
+            element.dataOffset = offset;
+            int fixedSize = element.FixedRecordSize();
+            if (fixedSize >= 0) {
+                if (fixedSize > 0 && element.count > (file.Size() - offset) / size_t(fixedSize))
+                    throw std::runtime_error(filename + ": PLY file is truncated");
+                offset += element.count * size_t(fixedSize);
+            } else
+                for (size_t i = 0; i < element.count; ++i) {
+                    size_t size = element.RecordSize(file.Data() + offset, fileEnd);
+                    if (size == 0)
+                        throw std::runtime_error(filename + ": PLY file is truncated");
+                    offset += size;
+                }
+            if (element.name == "vertex")
+                vertices = &element;
+            else if (element.name == "face")
+                faces = &element;
+        }
+        if (!vertices || !faces)
+            throw std::runtime_error(filename + ": PLY file has no vertex or face element");
+
+        // Vertex attributes
+        int stride = vertices->FixedRecordSize();
+        if (stride < 0)
+            throw std::runtime_error(filename + ": list properties in PLY vertices are not supported");
+        const uint8_t *vertexData = file.Data() + vertices->dataOffset;
+        size_t nVertices = vertices->count;
+        auto findAll = [&](std::initializer_list<const char *> names, std::vector<const PLYProperty *> *props) {
+            props->clear();
+            for (const char *name : names)
+                props->push_back(vertices->Find(name));
+            for (const PLYProperty *p : *props)
+                if (!p)
+                    return false;
+            return true;
+        };
+        auto unpack = [&](const std::vector<const PLYProperty *> &props, float *out) {
+            size_t nc = props.size();
+            ParallelFor(0, int64_t(nVertices), [&](int64_t begin, int64_t end) {
+                for (int64_t i = begin; i < end; ++i)
+                    for (size_t c = 0; c < nc; ++c)
+                        out[i * nc + c] = ReadPLYValue<float>(vertexData + i * stride + props[c]->offset,
+                                                              props[c]->type);
+            });
+        };
+
+        std::vector<const PLYProperty *> props;
+        if (!findAll({"x", "y", "z"}, &props))
+            throw std::runtime_error(filename + ": PLY vertices have no x, y, z coordinates");
+        bool positionsInPlace = stride == int(sizeof(Point3f)) && props[0]->offset == 0 &&
+                                props[0]->type == PLYType::Float32 && props[1]->type == PLYType::Float32 &&
+                                props[2]->type == PLYType::Float32 &&
+                                reinterpret_cast<uintptr_t>(vertexData) % alignof(Point3f) == 0;
+        if (positionsInPlace)
+            mesh->p = span<const Point3f>(reinterpret_cast<const Point3f *>(vertexData), nVertices);
+        else {
+            mesh->pStorage.resize(nVertices);
+            unpack(props, reinterpret_cast<float *>(mesh->pStorage.data()));
+            mesh->p = mesh->pStorage;
+        }
+        if (findAll({"nx", "ny", "nz"}, &props)) {
+            mesh->nStorage.resize(nVertices);
+            unpack(props, reinterpret_cast<float *>(mesh->nStorage.data()));
+            mesh->n = mesh->nStorage;
+        }
+        if (findAll({"u", "v"}, &props) || findAll({"s", "t"}, &props) ||
+            findAll({"texture_u", "texture_v"}, &props) || findAll({"texture_s", "texture_t"}, &props)) {
+            mesh->uvStorage.resize(nVertices);
+            unpack(props, reinterpret_cast<float *>(mesh->uvStorage.data()));
+            mesh->uv = mesh->uvStorage;
+        }
+
+        // Face indices
+        const PLYProperty *vertexIndices = faces->Find("vertex_indices");
+        if (!vertexIndices || !vertexIndices->isList)
+            throw std::runtime_error(filename + ": PLY faces have no vertex_indices list");
+        const uint8_t *faceData = file.Data() + faces->dataOffset;
+        size_t nFaces = faces->count;
+        int countSize = PLYTypeSize(vertexIndices->countType), indexSize = PLYTypeSize(vertexIndices->type);
+
+        // Files where every face is a triangle and vertex_indices is the only
+        // property have fixed-size records, so those can be unpacked in parallel.
+        size_t triRecord = countSize + 3 * indexSize;
+        std::atomic<bool> allTriangles{faces->properties.size() == 1 &&
+                                       nFaces <= (file.Size() - faces->dataOffset) / triRecord};
+        if (allTriangles)
+            ParallelFor(0, int64_t(nFaces), [&](int64_t begin, int64_t end) {
+                for (int64_t i = begin; i < end && allTriangles.load(std::memory_order_relaxed); ++i)
+                    if (ReadPLYValue<int>(faceData + i * triRecord, vertexIndices->countType) != 3)
+                        allTriangles = false;
+            });
+
+        std::vector<int> &indices = mesh->indexStorage;
+        if (allTriangles) {
+            indices.resize(3 * nFaces);
+            ParallelFor(0, int64_t(nFaces), [&](int64_t begin, int64_t end) {
+                for (int64_t i = begin; i < end; ++i)
+                    for (int c = 0; c < 3; ++c)
+                        indices[3 * i + c] = ReadPLYValue<int>(faceData + i * triRecord + countSize + c * indexSize,
+                                                               vertexIndices->type);
+            });
+        } else {
+            const uint8_t *ptr = faceData;
+            for (size_t i = 0; i < nFaces; ++i) {
+                // The element walk above sized these records already, but
+                // make sure no face reads past the mapping regardless
+                if (faces->RecordSize(ptr, fileEnd) == 0)
+                    throw std::runtime_error(filename + ": PLY file is truncated");
+                for (const PLYProperty &prop : faces->properties) {
+                    if (&prop == vertexIndices) {
+                        int count = ReadPLYValue<int>(ptr, prop.countType);
+                        const uint8_t *v = ptr + countSize;
+                        auto index = [&](int c) { return ReadPLYValue<int>(v + c * indexSize, prop.type); };
+                        if (count == 3 || count == 4) {
+                            indices.insert(indices.end(), {index(0), index(1), index(2)});
+                            if (count == 4)
+                                indices.insert(indices.end(), {index(0), index(2), index(3)});
+                        } else
+                            throw std::runtime_error(filename + ": PLY face with " + std::to_string(count) +
+                                                     " vertices; only triangles and quads are supported");
+                        ptr += countSize + size_t(count) * indexSize;
+                    } else if (prop.isList)
+                        ptr += PLYTypeSize(prop.countType) +
+                               size_t(ReadPLYValue<uint32_t>(ptr, prop.countType)) * PLYTypeSize(prop.type);
+                    else
+                        ptr += PLYTypeSize(prop.type);
+                }
+            }
+        }
+        for (int index : indices)
+            if (index < 0 || size_t(index) >= nVertices)
+                throw std::runtime_error(filename + ": PLY vertex index " + std::to_string(index) + " out of range");
+        mesh->indices = indices;
+
+        return mesh;
+    }
+
+#pragma endregion PLYMesh
+
+#pragma region PLY Writing
+
+    void WritePLYMesh(const std::string &filename, span<const int> indices, span<const Point3f> p,
+                      span<const Normal3f> n, span<const Point2f> uv) {
+        if (indices.size() % 3 != 0)
+            throw std::runtime_error(filename + ": index count is not a multiple of 3");
+        if ((!n.empty() && n.size() != p.size()) || (!uv.empty() && uv.size() != p.size()))
+            throw std::runtime_error(filename + ": vertex attribute counts don't match");
+
+        std::string header = "ply\nformat binary_little_endian 1.0\n";
+        header += "element vertex " + std::to_string(p.size()) + "\n";
+        header += "property float x\nproperty float y\nproperty float z\n";
+        if (!n.empty())
+            header += "property float nx\nproperty float ny\nproperty float nz\n";
+        if (!uv.empty())
+            header += "property float u\nproperty float v\n";
+        header += "element face " + std::to_string(indices.size() / 3) + "\n";
+        header += "property list uchar int vertex_indices\n";
+        // Pad with a comment so that the binary data starts 16-byte aligned
+        constexpr std::string_view end = "end_header\n", comment = "comment \n";
+        size_t length = header.size() + comment.size() + end.size();
+        header += "comment ";
+        header.append((16 - length % 16) % 16, ' ');
+        header += "\n";
+        header += end;
+
+        std::FILE *f = std::fopen(filename.c_str(), "wb");
+        if (!f)
+            throw std::runtime_error(filename + ": " + std::strerror(errno));
+        std::vector<uint8_t> buf;
+        constexpr size_t BufferSize = 1 << 20;
+        buf.reserve(BufferSize + 64);
+        bool ok = std::fwrite(header.data(), 1, header.size(), f) == header.size();
+        auto append = [&](const void *data, size_t size) {
+            const uint8_t *bytes = static_cast<const uint8_t *>(data);
+            buf.insert(buf.end(), bytes, bytes + size);
+            if (buf.size() >= BufferSize) {
+                ok &= std::fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+                buf.clear();
+            }
+        };
+
+        if (n.empty() && uv.empty())
+            ok &= std::fwrite(p.data(), sizeof(Point3f), p.size(), f) == p.size();
+        else
+            for (size_t i = 0; i < p.size(); ++i) {
+                append(&p[i], sizeof(Point3f));
+                if (!n.empty())
+                    append(&n[i], sizeof(Normal3f));
+                if (!uv.empty())
+                    append(&uv[i], sizeof(Point2f));
+            }
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            uint8_t three = 3;
+            append(&three, 1);
+            append(&indices[i], 3 * sizeof(int));
+        }
+        ok &= std::fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+        ok &= std::fclose(f) == 0;
+        if (!ok)
+            throw std::runtime_error(filename + ": error writing PLY file");
+    }
+
+    void ConvertTriangleMeshesToPLY(ParsedScene *scene) {
+        std::vector<SceneDirective *> meshes;
+        for (SceneDirective &d : scene->directives)
+            if (d.keyword == "Shape" && d.strings[0] == "trianglemesh")
+                meshes.push_back(&d);
+
+        std::vector<std::string> filenames(meshes.size());
+        ParallelFor(0, int64_t(meshes.size()), [&](int64_t i) {
+            const SceneDirective &d = *meshes[i];
+            auto floats = [&](const char *name, size_t nc) -> span<const float> {
+                const ParsedParameter *param = d.GetParameter(name);
+                if (!param)
+                    return {};
+                if (param->floats.size() % nc != 0)
+                    throw std::runtime_error(param->loc.ToString() + ": \"" + name + "\" must have a multiple of " +
+                                             std::to_string(nc) + " values");
+                return param->floats;
+            };
+            span<const float> P = floats("P", 3), N = floats("N", 3), uv = floats("uv", 2);
+            if (P.empty())
+                throw std::runtime_error(d.loc.ToString() + ": trianglemesh has no \"P\"");
+            std::vector<int> defaultIndices = {0, 1, 2};
+            const ParsedParameter *indexParam = d.GetParameter("indices");
+            span<const int> indices = indexParam ? span<const int>(indexParam->ints) : span<const int>();
+            if (indices.empty() && P.size() == 9)
+                indices = defaultIndices;
+
+            char name[32];
+            std::snprintf(name, sizeof(name), "mesh_%05d.ply", int(i));
+            filenames[i] = name;
+            WritePLYMesh(filenames[i], indices,
+                         span<const Point3f>(reinterpret_cast<const Point3f *>(P.data()), P.size() / 3),
+                         span<const Normal3f>(reinterpret_cast<const Normal3f *>(N.data()), N.size() / 3),
+                         span<const Point2f>(reinterpret_cast<const Point2f *>(uv.data()), uv.size() / 2));
+        });
+
+        // Swap the geometry parameters for a reference to the PLY file
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            SceneDirective &d = *meshes[i];
+            d.strings[0] = "plymesh";
+            std::vector<ParsedParameter> parameters;
+            for (ParsedParameter &p : d.parameters)
+                if (p.name != "P" && p.name != "N" && p.name != "uv" && p.name != "indices")
+                    parameters.push_back(std::move(p));
+            ParsedParameter filename;
+            filename.type = "string";
+            filename.name = "filename";
+            filename.loc = d.loc;
+            filename.strings.push_back(scene->Intern(filenames[i]));
+            parameters.insert(parameters.begin(), std::move(filename));
+            d.parameters = std::move(parameters);
+        }
+    }
+
+#pragma endregion PLY Writing
+}
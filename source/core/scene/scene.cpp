@@ -0,0 +1,985 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/scene/scene.h"
+#include "core/light/lights.h"
+#include "core/material/materials.h"
+#include "core/scene/parser.h"
+#include "core/scene/ply.h"
+#include "core/volumeScattering/media.h"
+#include "util/log.h"
+#include "util/parallel.h"
+#include "util/profile.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace jadehare {
+
+#pragma region Parameter Lookup
+
+    static float GetFloat(const SceneDirective &d, std::string_view name, float def) {
+        const ParsedParameter *p = d.GetParameter(name);
+        if (!p)
+            return def;
+        if (!p->floats.empty())
+            return p->floats[0];
+        if (!p->ints.empty())
+            return float(p->ints[0]);
+        Warning(p->loc, "\"" + std::string(name) + "\": expected a float value");
+        return def;
+    }
+
+    static int GetInt(const SceneDirective &d, std::string_view name, int def) {
+        const ParsedParameter *p = d.GetParameter(name);
+        return p && !p->ints.empty() ? p->ints[0] : def;
+    }
+
+    static bool GetBool(const SceneDirective &d, std::string_view name, bool def) {
+        const ParsedParameter *p = d.GetParameter(name);
+        return p && !p->bools.empty() ? p->bools[0] != 0 : def;
+    }
+
+    static std::string_view GetString(const SceneDirective &d, std::string_view name, std::string_view def) {
+        const ParsedParameter *p = d.GetParameter(name);
+        return p && !p->strings.empty() ? p->strings[0] : def;
+    }
+
+    static Point3f GetPoint3(const SceneDirective &d, std::string_view name, const Point3f &def) {
+        const ParsedParameter *p = d.GetParameter(name);
+        if (!p)
+            return def;
+        if (p->floats.size() != 3)
+            throw std::runtime_error(p->loc.ToString() + ": \"" + std::string(name) + "\" needs three values");
+        return {p->floats[0], p->floats[1], p->floats[2]};
+    }
+
+    static RGB GetRGB(const SceneDirective &d, std::string_view name, const RGB &def) {
+        const ParsedParameter *p = d.GetParameter(name);
+        if (!p)
+            return def;
+        if ((p->type == "rgb" || p->type == "color") && p->floats.size() == 3)
+            return RGB(p->floats[0], p->floats[1], p->floats[2]);
+        if (p->type == "blackbody" && !p->floats.empty())
+            return BlackbodyRGB(p->floats[0]);
+        if (p->type == "float" && !p->floats.empty())
+            return RGB(p->floats[0], p->floats[0], p->floats[0]);
+        if (p->type == "spectrum" && p->floats.size() >= 2 && p->floats.size() % 2 == 0) {
+            // Piecewise-linear (lambda, value) pairs: use the mean value
+            float sum = 0;
+            for (size_t i = 1; i < p->floats.size(); i += 2)
+                sum += p->floats[i];
+            float v = sum / (p->floats.size() / 2);
+            return RGB(v, v, v);
+        }
+        if (p->type == "texture")
+            Warning(p->loc, "\"" + std::string(name) + "\": textures are not supported here yet; using a constant");
+        else
+            Warning(p->loc, "\"" + std::string(name) + "\": can't convert \"" + std::string(p->type) + "\" to RGB");
+        return def;
+    }
+
+#pragma endregion Parameter Lookup
+
+#pragma region SceneBuilder
+
+    // SceneBuilder Definition
+    // Walks the parsed directives with pbrt's graphics state semantics and
+    // accumulates flattened render-space geometry.
+    class SceneBuilder {
+    public:
+        explicit SceneBuilder(const ParsedScene &parsed) : parsed(parsed), scene(new Scene) {}
+
+        std::unique_ptr<Scene> Build();
+
+    private:
+        // GraphicsState Definition
+        // ctm and ctmEnd are the transformations at the start and end of the
+        // TransformTimes range; ActiveTransform picks which of them the
+        // transformation directives change.
+        struct GraphicsState {
+            Transform ctm, ctmEnd;
+            // ctm before the last LookAt and that LookAt, while no later
+            // directive has replaced the ctm outright.
+            std::optional<std::pair<Transform, Transform>> lookAt;
+            bool startActive = true, endActive = true;
+            int materialIndex = -1;
+            bool reverseOrientation = false;
+            std::optional<LightData> areaLight;
+            std::string insideMedium, outsideMedium;
+        };
+
+        // SceneBuilder Private Methods
+        void Directive(const SceneDirective &d);
+
+        // Replaces each active transformation t by f(t).
+        template <typename F>
+        void UpdateTransforms(F f) {
+            if (gs.startActive)
+                gs.ctm = f(gs.ctm);
+            if (gs.endActive)
+                gs.ctmEnd = f(gs.ctmEnd);
+        }
+
+        void Shape(const SceneDirective &d);
+
+        void AddMesh(const SceneDirective &d, span<const Point3f> p, span<const Normal3f> n,
+                     span<const Point2f> uv, span<const int> indices);
+
+        MaterialData MakeMaterial(const SceneDirective &d, std::string_view type);
+
+        void MakeTexture(const SceneDirective &d);
+
+        void Light(const SceneDirective &d);
+
+        void MakeMedium(const SceneDirective &d);
+
+        // Index of a named medium; the empty name is vacuum.
+        int MediumIndex(const FileLoc &loc, const std::string &name) const {
+            if (name.empty())
+                return -1;
+            auto iter = namedMedia.find(name);
+            if (iter == namedMedia.end())
+                throw std::runtime_error(loc.ToString() + ": medium \"" + name + "\" not defined");
+            return iter->second;
+        }
+
+        int MaterialIndex() {
+            if (gs.materialIndex >= 0)
+                return gs.materialIndex;
+            // Default diffuse material, created on first use
+            if (defaultMaterial < 0) {
+                defaultMaterial = int(scene->materialStorage.size());
+                scene->materialStorage.push_back(MaterialData());
+            }
+            return defaultMaterial;
+        }
+
+        int AddString(std::string_view s) {
+            scene->strings.emplace_back(s);
+            return int(scene->strings.size() - 1);
+        }
+
+        // SceneBuilder Private Members
+        const ParsedScene &parsed;
+        std::unique_ptr<Scene> scene;
+        GraphicsState gs;
+        std::vector<GraphicsState> pushedStates;
+        // Start and end transformations.
+        std::vector<std::pair<Transform, Transform>> pushedTransforms;
+        std::map<std::string, std::pair<Transform, Transform>, std::less<>> namedCoordinateSystems;
+        float transformStartTime = 0, transformEndTime = 1;
+        int maxTemporalSplits = 2;
+        std::map<std::string, int, std::less<>> namedMaterials;
+        int defaultMaterial = -1;
+        std::map<std::string, int, std::less<>> namedTextures;
+        std::map<std::string, int, std::less<>> namedMedia;
+        // The camera medium is resolved once all media are known.
+        std::string cameraMedium;
+        std::optional<FileLoc> cameraLoc;
+        // Object instancing: meshes of each ObjectBegin block go to their own
+        // record list, appended after the world meshes once parsing is done.
+        std::map<std::string, int, std::less<>> namedObjects;
+        std::vector<std::vector<Scene::MeshRecord>> prototypeRecords;
+        int currentPrototype = -1;
+    };
+
+    std::unique_ptr<Scene> SceneBuilder::Build() {
+        for (const std::unique_ptr<MappedFile> &file : parsed.files)
+            scene->inputFiles.push_back(file->Filename());
+        for (const SceneDirective &d : parsed.directives)
+            Directive(d);
+        if (cameraLoc)
+            scene->camera.mediumIndex = MediumIndex(*cameraLoc, cameraMedium);
+
+        Scene &s = *scene;
+        size_t nWorldMeshes = s.recordStorage.size();
+        s.prototypeStorage.resize(prototypeRecords.size());
+        for (size_t i = 0; i < prototypeRecords.size(); ++i) {
+            s.prototypeStorage[i].firstMesh = uint32_t(s.recordStorage.size());
+            s.prototypeStorage[i].nMeshes = uint32_t(prototypeRecords[i].size());
+            s.recordStorage.insert(s.recordStorage.end(), prototypeRecords[i].begin(), prototypeRecords[i].end());
+        }
+        s.SetArrays(s.recordStorage, s.positionStorage, s.normalStorage, s.uvStorage, s.indexStorage,
+                    s.materialStorage, s.lightStorage, s.prototypeStorage, s.instanceStorage,
+                    s.instanceMotionStorage);
+        s.SetMedia(s.mediumStorage, s.mediumDensityStorage, s.majorantStorage);
+        s.SetTextures(s.textureStorage);
+        s.SetMaterials();
+
+        // Build each prototype's BVH once, then pack them into shared arrays
+        // so built and cached scenes look the same
+        std::vector<BVHAggregate> prototypeBVHs(s.prototypeStorage.size());
+        ParallelFor(0, int64_t(prototypeBVHs.size()), [&](int64_t i) {
+            const ObjectPrototype &proto = s.prototypeStorage[i];
+            prototypeBVHs[i] = BVHAggregate(span<const TriangleMesh>(s.meshes.data() + proto.firstMesh, proto.nMeshes));
+        });
+        for (size_t i = 0; i < prototypeBVHs.size(); ++i) {
+            ObjectPrototype &proto = s.prototypeStorage[i];
+            span<const LinearBVHNode> nodes = prototypeBVHs[i].Nodes();
+            span<const BVHPrimitive> prims = prototypeBVHs[i].Primitives();
+            proto.firstNode = s.prototypeNodeStorage.size();
+            proto.nNodes = nodes.size();
+            proto.firstPrimitive = s.prototypePrimitiveStorage.size();
+            proto.nPrimitives = prims.size();
+            s.prototypeNodeStorage.insert(s.prototypeNodeStorage.end(), nodes.begin(), nodes.end());
+            s.prototypePrimitiveStorage.insert(s.prototypePrimitiveStorage.end(), prims.begin(), prims.end());
+        }
+        s.SetPrototypeBVHs(s.prototypeNodeStorage, s.prototypePrimitiveStorage);
+
+        for (ObjectInstance &instance : s.instanceStorage) {
+            Bounds3f bounds = s.prototypeBVHs[instance.prototypeIndex].Bounds();
+            instance.bounds = instance.motionIndex < 0 ? instance.renderFromInstance(bounds)
+                                                       : s.instanceMotion[instance.motionIndex].MotionBounds(bounds);
+        }
+        s.bvh = BVHAggregate(span<const TriangleMesh>(s.meshes.data(), nWorldMeshes), s.instances, s.prototypeBVHs,
+                             s.instanceMotion, 4, maxTemporalSplits);
+        s.SetLights();
+        s.CreateEntities();
+        return std::move(scene);
+    }
+
+    void SceneBuilder::Directive(const SceneDirective &d) {
+        std::string_view k = d.keyword;
+        const std::vector<float> &v = d.numbers;
+        // Transformations
+        if (k == "Identity") {
+            UpdateTransforms([](const Transform &) { return Transform(); });
+            gs.lookAt.reset();
+        }
+        else if (k == "Translate")
+            UpdateTransforms([&](const Transform &t) { return t * Translate(Vector3f(v[0], v[1], v[2])); });
+        else if (k == "Scale")
+            UpdateTransforms([&](const Transform &t) { return t * Scale(v[0], v[1], v[2]); });
+        else if (k == "Rotate")
+            UpdateTransforms([&](const Transform &t) { return t * Rotate(v[0], Vector3f(v[1], v[2], v[3])); });
+        else if (k == "LookAt") {
+            Transform lookAt = LookAt(Point3f(v[0], v[1], v[2]), Point3f(v[3], v[4], v[5]), Vector3f(v[6], v[7], v[8]));
+            if (gs.startActive)
+                gs.lookAt = std::make_pair(gs.ctm, lookAt);
+            UpdateTransforms([&](const Transform &t) { return t * lookAt; });
+        } else if (k == "Transform") {
+            UpdateTransforms([&](const Transform &) { return Transform::FromArray(v.data()); });
+            gs.lookAt.reset();
+        }
+        else if (k == "ConcatTransform")
+            UpdateTransforms([&](const Transform &t) { return t * Transform::FromArray(v.data()); });
+        else if (k == "CoordinateSystem")
+            namedCoordinateSystems[std::string(d.strings[0])] = {gs.ctm, gs.ctmEnd};
+        else if (k == "CoordSysTransform") {
+            auto iter = namedCoordinateSystems.find(d.strings[0]);
+            if (iter != namedCoordinateSystems.end()) {
+                std::tie(gs.ctm, gs.ctmEnd) = iter->second;
+                gs.lookAt.reset();
+            } else
+                Warning(d.loc, "couldn't find named coordinate system \"" + std::string(d.strings[0]) + "\"");
+        } else if (k == "ActiveTransform") {
+            std::string_view which = d.strings[0];
+            if (which == "StartTime" || which == "EndTime" || which == "All") {
+                gs.startActive = which != "EndTime";
+                gs.endActive = which != "StartTime";
+            } else
+                Warning(d.loc, "unknown ActiveTransform \"" + std::string(which) + "\"; ignored");
+        } else if (k == "TransformTimes") {
+            transformStartTime = v[0];
+            transformEndTime = v[1];
+        } else if (k == "ReverseOrientation")
+            gs.reverseOrientation = !gs.reverseOrientation;
+            // Block structure
+        else if (k == "AttributeBegin")
+            pushedStates.push_back(gs);
+        else if (k == "AttributeEnd") {
+            if (pushedStates.empty())
+                Warning(d.loc, "unmatched AttributeEnd ignored");
+            else {
+                gs = pushedStates.back();
+                pushedStates.pop_back();
+            }
+        } else if (k == "TransformBegin")
+            pushedTransforms.push_back({gs.ctm, gs.ctmEnd});
+        else if (k == "TransformEnd") {
+            if (pushedTransforms.empty())
+                Warning(d.loc, "unmatched TransformEnd ignored");
+            else {
+                std::tie(gs.ctm, gs.ctmEnd) = pushedTransforms.back();
+                pushedTransforms.pop_back();
+            }
+        } else if (k == "ObjectBegin") {
+            if (currentPrototype >= 0)
+                throw std::runtime_error(d.loc.ToString() + ": ObjectBegin called inside of instance definition");
+            if (namedObjects.count(d.strings[0]))
+                throw std::runtime_error(d.loc.ToString() + ": redefinition of object \"" +
+                                         std::string(d.strings[0]) + "\"");
+            pushedStates.push_back(gs);
+            currentPrototype = int(prototypeRecords.size());
+            namedObjects[std::string(d.strings[0])] = currentPrototype;
+            prototypeRecords.emplace_back();
+        } else if (k == "ObjectEnd") {
+            if (currentPrototype < 0)
+                Warning(d.loc, "ObjectEnd called outside of instance definition; ignored");
+            else {
+                currentPrototype = -1;
+                gs = pushedStates.back();
+                pushedStates.pop_back();
+            }
+        } else if (k == "ObjectInstance") {
+            auto iter = namedObjects.find(d.strings[0]);
+            if (currentPrototype >= 0)
+                throw std::runtime_error(d.loc.ToString() + ": ObjectInstance can't be called inside instance definition");
+            if (iter == namedObjects.end())
+                Warning(d.loc, "object \"" + std::string(d.strings[0]) + "\" not defined; ignored");
+            else if (!prototypeRecords[iter->second].empty()) {
+                ObjectInstance instance{gs.ctm, Bounds3f(), uint32_t(iter->second)};
+                if (gs.ctm != gs.ctmEnd) {
+                    instance.motionIndex = int32_t(scene->instanceMotionStorage.size());
+                    scene->instanceMotionStorage.emplace_back(gs.ctm, transformStartTime, gs.ctmEnd,
+                                                              transformEndTime);
+                }
+                scene->instanceStorage.push_back(instance);
+            }
+        } else if (k == "WorldBegin") {
+            gs.ctm = gs.ctmEnd = Transform();
+            gs.startActive = gs.endActive = true;
+            namedCoordinateSystems["world"] = {gs.ctm, gs.ctmEnd};
+        }
+            // Rendering options
+        else if (k == "Camera") {
+            if (d.strings[0] != "perspective")
+                Warning(d.loc, "\"" + std::string(d.strings[0]) + "\" camera unsupported; using \"perspective\"");
+            if (gs.ctm != gs.ctmEnd)
+                Warning(d.loc, "camera motion is not supported yet; using the start transformation");
+            namedCoordinateSystems["camera"] = {Inverse(gs.ctm), Inverse(gs.ctmEnd)};
+            scene->camera.worldFromCamera = Inverse(gs.ctm);
+            if (gs.lookAt) {
+                auto [cameraFromLookAt, lookAt] = *gs.lookAt;
+                scene->camera.cameraFromLookAt = cameraFromLookAt;
+                scene->camera.lookAtFromWorld = Inverse(cameraFromLookAt * lookAt) * gs.ctm;
+            }
+            scene->camera.fov = GetFloat(d, "fov", 90);
+            scene->camera.shutterOpen = GetFloat(d, "shutteropen", 0);
+            scene->camera.shutterClose = GetFloat(d, "shutterclose", 1);
+            cameraMedium = gs.outsideMedium;
+            cameraLoc = d.loc;
+        } else if (k == "Film") {
+            scene->camera.xResolution = GetInt(d, "xresolution", 1280);
+            scene->camera.yResolution = GetInt(d, "yresolution", 720);
+            scene->camera.filenameIndex = AddString(GetString(d, "filename", "jadehare.exr"));
+        } else if (k == "Sampler") {
+            scene->camera.samplesPerPixel = GetInt(d, "pixelsamples", 16);
+            if (d.strings[0] == "zsobol")
+                scene->camera.sampler = SamplerType::ZSobol;
+            else if (d.strings[0] != "sobol")
+                Warning(d.loc, "\"" + std::string(d.strings[0]) + "\" sampler unsupported; using \"sobol\"");
+        } else if (k == "Integrator")
+            scene->camera.maxDepth = GetInt(d, "maxdepth", 5);
+            // Scene contents
+        else if (k == "Shape")
+            Shape(d);
+        else if (k == "Texture")
+            MakeTexture(d);
+        else if (k == "Material") {
+            gs.materialIndex = int(scene->materialStorage.size());
+            scene->materialStorage.push_back(MakeMaterial(d, d.strings[0]));
+        } else if (k == "MakeNamedMaterial") {
+            namedMaterials[std::string(d.strings[0])] = int(scene->materialStorage.size());
+            scene->materialStorage.push_back(MakeMaterial(d, GetString(d, "type", "diffuse")));
+        } else if (k == "NamedMaterial") {
+            auto iter = namedMaterials.find(d.strings[0]);
+            if (iter == namedMaterials.end())
+                Warning(d.loc, "named material \"" + std::string(d.strings[0]) + "\" not defined");
+            else
+                gs.materialIndex = iter->second;
+        } else if (k == "MakeNamedMedium")
+            MakeMedium(d);
+        else if (k == "MediumInterface") {
+            gs.insideMedium = std::string(d.strings[0]);
+            gs.outsideMedium = std::string(d.strings.size() > 1 ? d.strings[1] : d.strings[0]);
+        } else if (k == "LightSource")
+            Light(d);
+        else if (k == "AreaLightSource") {
+            if (d.strings[0] != "diffuse")
+                Warning(d.loc, "\"" + std::string(d.strings[0]) + "\" area light unsupported; using \"diffuse\"");
+            LightData light;
+            light.type = LightType::DiffuseArea;
+            light.L = GetRGB(d, "L", RGB(1, 1, 1));
+            light.scale = GetFloat(d, "scale", 1);
+            light.twoSided = GetBool(d, "twosided", false);
+            gs.areaLight = light;
+        } else if (k == "Accelerator")
+            maxTemporalSplits = std::max(0, GetInt(d, "maxtimesplits", 2));
+        else if (k == "Option" || k == "ColorSpace" || k == "PixelFilter") {
+            // Nothing to do: these only affect things this renderer doesn't have
+        } else
+            Warning(d.loc, std::string(k) + " is not supported yet; ignored");
+    }
+
+    void SceneBuilder::Shape(const SceneDirective &d) {
+        std::string_view type = d.strings[0];
+        if (gs.ctm != gs.ctmEnd)
+            Warning(d.loc, "only object instances can move; using the start transformation");
+        if (type == "trianglemesh") {
+            auto floats = [&](const char *name, size_t nc) -> span<const float> {
+                const ParsedParameter *p = d.GetParameter(name);
+                if (!p)
+                    return {};
+                if (p->floats.size() % nc != 0)
+                    throw std::runtime_error(p->loc.ToString() + ": \"" + name + "\" must have a multiple of " +
+                                             std::to_string(nc) + " values");
+                return p->floats;
+            };
+            span<const float> P = floats("P", 3), N = floats("N", 3), uv = floats("uv", 2);
+            const ParsedParameter *indexParam = d.GetParameter("indices");
+            static const int defaultIndices[3] = {0, 1, 2};
+            span<const int> indices = indexParam ? span<const int>(indexParam->ints) : span<const int>();
+            if (indices.empty() && P.size() == 9)
+                indices = defaultIndices;
+            AddMesh(d, span<const Point3f>(reinterpret_cast<const Point3f *>(P.data()), P.size() / 3),
+                    span<const Normal3f>(reinterpret_cast<const Normal3f *>(N.data()), N.size() / 3),
+                    span<const Point2f>(reinterpret_cast<const Point2f *>(uv.data()), uv.size() / 2), indices);
+        } else if (type == "plymesh") {
+            std::string filename = ResolveFilename(GetString(d, "filename", ""), d.loc.filename);
+            std::unique_ptr<PLYMesh> mesh = PLYMesh::Read(filename);
+            scene->inputFiles.push_back(filename);
+            AddMesh(d, mesh->p, mesh->n, mesh->uv, mesh->indices);
+        } else
+            Warning(d.loc, "\"" + std::string(type) + "\" shape is not supported yet; ignored");
+    }
+
+    void SceneBuilder::AddMesh(const SceneDirective &d, span<const Point3f> p, span<const Normal3f> n,
+                               span<const Point2f> uv, span<const int> indices) {
+        if (p.empty() || indices.empty()) {
+            Warning(d.loc, "mesh has no vertices or indices; ignored");
+            return;
+        }
+        if (indices.size() % 3 != 0)
+            throw std::runtime_error(d.loc.ToString() + ": number of vertex indices is not a multiple of 3");
+        if ((!n.empty() && n.size() != p.size()) || (!uv.empty() && uv.size() != p.size()))
+            throw std::runtime_error(d.loc.ToString() + ": vertex attribute counts don't match");
+        for (int index : indices)
+            if (index < 0 || size_t(index) >= p.size())
+                throw std::runtime_error(d.loc.ToString() + ": vertex index " + std::to_string(index) +
+                                         " out of range");
+
+        Scene &s = *scene;
+        Scene::MeshRecord record;
+        record.nVertices = uint32_t(p.size());
+        record.nIndices = uint32_t(indices.size());
+        record.pOffset = s.positionStorage.size();
+        record.nOffset = n.empty() ? ~uint64_t(0) : s.normalStorage.size();
+        record.uvOffset = uv.empty() ? ~uint64_t(0) : s.uvStorage.size();
+        record.indexOffset = s.indexStorage.size();
+        record.materialIndex = MaterialIndex();
+        record.areaLightIndex = -1;
+        record.insideMedium = MediumIndex(d.loc, gs.insideMedium);
+        record.outsideMedium = MediumIndex(d.loc, gs.outsideMedium);
+        record.flags = (gs.reverseOrientation ? Scene::ReverseOrientation : 0) |
+                       (gs.ctm.SwapsHandedness() ? Scene::TransformSwapsHandedness : 0);
+
+        // Transform to render space in parallel
+        s.positionStorage.resize(s.positionStorage.size() + p.size());
+        Point3f *pOut = &s.positionStorage[record.pOffset];
+        Normal3f *nOut = nullptr;
+        if (!n.empty()) {
+            s.normalStorage.resize(s.normalStorage.size() + n.size());
+            nOut = &s.normalStorage[record.nOffset];
+        }
+        const Transform &ctm = gs.ctm;
+        bool flipNormals = gs.reverseOrientation;
+        ParallelFor(0, int64_t(p.size()), [&](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) {
+                pOut[i] = ctm(p[i]);
+                if (nOut) {
+                    nOut[i] = Normalize(ctm(n[i]));
+                    if (flipNormals)
+                        nOut[i] = -nOut[i];
+                }
+            }
+        });
+        s.uvStorage.insert(s.uvStorage.end(), uv.begin(), uv.end());
+        s.indexStorage.insert(s.indexStorage.end(), indices.begin(), indices.end());
+
+        if (currentPrototype >= 0) {
+            if (gs.areaLight)
+                Warning(d.loc, "area lights not supported with object instancing; ignored");
+            prototypeRecords[currentPrototype].push_back(record);
+            return;
+        }
+        if (gs.areaLight) {
+            record.areaLightIndex = int(s.lightStorage.size());
+            LightData light = *gs.areaLight;
+            light.meshIndex = int(s.recordStorage.size());
+            for (size_t t = 0; t < indices.size() / 3; ++t) {
+                light.triangleIndex = int(t);
+                s.lightStorage.push_back(light);
+            }
+        }
+        s.recordStorage.push_back(record);
+    }
+
+    MaterialData SceneBuilder::MakeMaterial(const SceneDirective &d, std::string_view type) {
+        MaterialData m;
+        float roughness = GetFloat(d, "roughness", GetFloat(d, "uroughness", 0));
+        // The reflectance may come from an image texture
+        auto reflectance = [&](const RGB &def) {
+            const ParsedParameter *p = d.GetParameter("reflectance");
+            if (!p || p->type != "texture" || p->strings.empty())
+                return GetRGB(d, "reflectance", def);
+            auto iter = namedTextures.find(p->strings[0]);
+            if (iter == namedTextures.end())
+                Warning(p->loc, "texture \"" + std::string(p->strings[0]) + "\" not defined; using a constant");
+            else
+                m.reflectanceTexture = iter->second;
+            return def;
+        };
+        if (type == "diffuse") {
+            m.type = MaterialType::Diffuse;
+            m.reflectance = reflectance(RGB(0.5f, 0.5f, 0.5f));
+        } else if (type == "conductor") {
+            m.type = MaterialType::Conductor;
+            // Copper-like default when no reflectance is given
+            m.reflectance = reflectance(RGB(0.955f, 0.638f, 0.538f));
+            m.roughness = roughness;
+        } else if (type == "dielectric" || type == "thindielectric") {
+            m.type = MaterialType::Dielectric;
+            const ParsedParameter *eta = d.GetParameter("eta");
+            m.eta = eta && !eta->floats.empty() && eta->type == "float" ? eta->floats[0] : 1.5f;
+            m.roughness = roughness;
+        } else if (type == "coateddiffuse") {
+            m.type = MaterialType::CoatedDiffuse;
+            m.reflectance = reflectance(RGB(0.5f, 0.5f, 0.5f));
+            m.roughness = roughness;
+        } else if (type == "diffusetransmission") {
+            m.type = MaterialType::DiffuseTransmission;
+            m.reflectance = reflectance(RGB(0.25f, 0.25f, 0.25f));
+            m.transmittance = GetRGB(d, "transmittance", RGB(0.25f, 0.25f, 0.25f));
+        } else if (type == "interface" || type == "") {
+            m.type = MaterialType::Interface;
+        } else
+            Warning(d.loc, "\"" + std::string(type) + "\" material is not supported yet; using \"diffuse\"");
+        return m;
+    }
+
+    void SceneBuilder::MakeTexture(const SceneDirective &d) {
+        std::string name(d.strings[0]);
+        std::string_view type = d.strings[1], texClass = d.strings[2];
+        if (type != "spectrum" && type != "color") {
+            Warning(d.loc, "\"" + std::string(type) + "\" textures are not supported yet; ignored");
+            return;
+        }
+        if (texClass != "imagemap") {
+            Warning(d.loc, "\"" + std::string(texClass) + "\" texture is not supported yet; ignored");
+            return;
+        }
+        if (namedTextures.count(name))
+            Warning(d.loc, "texture \"" + name + "\" redefined");
+
+        // Images are only ever read from tiled files; other formats need to
+        // have been converted with textureconv next to the original
+        std::string filename = ResolveFilename(GetString(d, "filename", ""), d.loc.filename);
+        std::filesystem::path path(filename);
+        if (path.extension() != ".jtx") {
+            std::string tiled = path.replace_extension(".jtx").string();
+            if (!FileExists(tiled)) {
+                Warning(d.loc, filename + ": convert the image to " + tiled +
+                               " with textureconv to use it; ignoring texture \"" + name + "\"");
+                return;
+            }
+            filename = tiled;
+        }
+        TextureData texture;
+        texture.filenameIndex = AddString(filename);
+        texture.scale = GetFloat(d, "scale", 1);
+        texture.invert = GetBool(d, "invert", false);
+        scene->inputFiles.push_back(filename);
+        namedTextures[name] = int(scene->textureStorage.size());
+        scene->textureStorage.push_back(texture);
+    }
+
+    void SceneBuilder::Light(const SceneDirective &d) {
+        std::string_view type = d.strings[0];
+        if (gs.ctm != gs.ctmEnd)
+            Warning(d.loc, "only object instances can move; using the start transformation");
+        LightData light;
+        light.scale = GetFloat(d, "scale", 1);
+        if (type == "point") {
+            light.type = LightType::Point;
+            light.L = GetRGB(d, "I", RGB(1, 1, 1));
+            light.p = gs.ctm(GetPoint3(d, "from", Point3f(0, 0, 0)));
+        } else if (type == "spot") {
+            light.type = LightType::Spot;
+            light.L = GetRGB(d, "I", RGB(1, 1, 1));
+            Point3f from = GetPoint3(d, "from", Point3f(0, 0, 0)), to = GetPoint3(d, "to", Point3f(0, 0, 1));
+            light.p = gs.ctm(from);
+            light.w = Normalize(gs.ctm(to - from));
+            float coneAngle = GetFloat(d, "coneangle", 30), coneDelta = GetFloat(d, "conedelta", 5);
+            light.cosFalloffEnd = std::cos(coneAngle * Pi / 180);
+            light.cosFalloffStart = std::cos((coneAngle - coneDelta) * Pi / 180);
+        } else if (type == "distant") {
+            light.type = LightType::Distant;
+            light.L = GetRGB(d, "L", RGB(1, 1, 1));
+            Point3f from = GetPoint3(d, "from", Point3f(0, 0, 0)), to = GetPoint3(d, "to", Point3f(0, 0, 1));
+            light.w = Normalize(gs.ctm(to - from));
+        } else if (type == "infinite") {
+            light.type = LightType::Infinite;
+            light.L = GetRGB(d, "L", RGB(1, 1, 1));
+            std::string_view filename = GetString(d, "filename", "");
+            if (!filename.empty()) {
+                std::string resolved = ResolveFilename(filename, d.loc.filename);
+                light.filenameIndex = AddString(resolved);
+                scene->inputFiles.push_back(resolved);
+            }
+            // Environment maps are looked up in light space
+            light.w = Normalize(gs.ctm(Vector3f(0, 0, 1)));
+        } else {
+            Warning(d.loc, "\"" + std::string(type) + "\" light is not supported yet; ignored");
+            return;
+        }
+        scene->lightStorage.push_back(light);
+    }
+
+    // Sparse grids are typically much finer than uniform grids, so give
+    // them a finer majorant grid.
+    static constexpr int SparseGridMajorantResolution = 64;
+
+    void SceneBuilder::MakeMedium(const SceneDirective &d) {
+        std::string name(d.strings[0]);
+        if (namedMedia.count(name))
+            throw std::runtime_error(d.loc.ToString() + ": named medium \"" + name + "\" redefined");
+        std::string_view type = GetString(d, "type", "");
+        MediumData medium;
+        medium.sigma_a = GetRGB(d, "sigma_a", RGB(1, 1, 1));
+        medium.sigma_s = GetRGB(d, "sigma_s", RGB(1, 1, 1));
+        medium.scale = GetFloat(d, "scale", 1);
+        medium.g = Clamp(GetFloat(d, "g", 0), -.99f, .99f);
+        if (type == "homogeneous") {
+            medium.type = MediumType::Homogeneous;
+            medium.Le = GetRGB(d, "Le", RGB(0, 0, 0));
+            medium.LeScale = GetFloat(d, "Lescale", 1);
+        } else if (type == "uniformgrid") {
+            medium.type = MediumType::UniformGrid;
+            medium.nx = GetInt(d, "nx", 1);
+            medium.ny = GetInt(d, "ny", 1);
+            medium.nz = GetInt(d, "nz", 1);
+            const ParsedParameter *density = d.GetParameter("density");
+            if (!density || density->floats.empty())
+                throw std::runtime_error(d.loc.ToString() + ": \"uniformgrid\" medium requires \"density\" values");
+            if (medium.nx <= 0 || medium.ny <= 0 || medium.nz <= 0 ||
+                density->floats.size() != size_t(medium.nx) * medium.ny * medium.nz)
+                throw std::runtime_error(density->loc.ToString() + ": \"density\" has " +
+                                         std::to_string(density->floats.size()) + " values but nx*ny*nz = " +
+                                         std::to_string(int64_t(medium.nx) * medium.ny * medium.nz));
+            if (d.GetParameter("Le"))
+                Warning(d.loc, "emissive grid media are not supported yet; ignoring \"Le\"");
+            medium.renderFromMedium = gs.ctm;
+            medium.bounds = Bounds3f(GetPoint3(d, "p0", Point3f(0, 0, 0)), GetPoint3(d, "p1", Point3f(1, 1, 1)));
+
+            // Store the density samples and compute the majorant grid for them
+            Scene &s = *scene;
+            medium.densityOffset = s.mediumDensityStorage.size();
+            s.mediumDensityStorage.insert(s.mediumDensityStorage.end(), density->floats.begin(),
+                                          density->floats.end());
+            SampledGrid grid(density->floats, medium.nx, medium.ny, medium.nz);
+            std::vector<float> majorants = MajorantGrid::Compute(grid, MajorantGrid::DefaultResolution);
+            medium.majorantResolution = MajorantGrid::DefaultResolution;
+            medium.majorantOffset = s.majorantStorage.size();
+            s.majorantStorage.insert(s.majorantStorage.end(), majorants.begin(), majorants.end());
+        } else if (type == "sparsegrid") {
+            medium.type = MediumType::SparseGrid;
+            std::string filename = ResolveFilename(GetString(d, "filename", ""), d.loc.filename);
+            medium.filenameIndex = AddString(filename);
+            medium.LeScale = GetFloat(d, "Lescale", 1);
+            medium.temperatureOffset = GetFloat(d, "temperatureoffset", GetFloat(d, "temperaturecutoff", 0));
+            medium.temperatureScale = GetFloat(d, "temperaturescale", 1);
+            medium.renderFromMedium = gs.ctm;
+
+            // Majorants come from the grid's node extrema, so this only
+            // touches the internal nodes and the leaves near their borders
+            std::unique_ptr<SparseGridFile> file = SparseGridFile::Open(filename);
+            scene->inputFiles.push_back(filename);
+            const SparseGrid *density = file->Grid("density");
+            if (!density)
+                throw std::runtime_error(d.loc.ToString() + ": " + filename + ": no \"density\" grid");
+            medium.bounds = density->MediumBounds();
+            Scene &s = *scene;
+            std::vector<float> majorants = MajorantGrid::Compute(*density, medium.bounds, SparseGridMajorantResolution);
+            medium.majorantResolution = SparseGridMajorantResolution;
+            medium.majorantOffset = s.majorantStorage.size();
+            s.majorantStorage.insert(s.majorantStorage.end(), majorants.begin(), majorants.end());
+        } else {
+            Warning(d.loc, "\"" + std::string(type) + "\" medium is not supported yet; using \"homogeneous\"");
+            medium.type = MediumType::Homogeneous;
+        }
+        namedMedia[name] = int(scene->mediumStorage.size());
+        scene->mediumStorage.push_back(medium);
+    }
+
+#pragma endregion SceneBuilder
+
+#pragma region Scene
+
+    std::unique_ptr<Scene> Scene::Build(const ParsedScene &parsed) {
+        PROFILE_SCOPE("Build scene");
+        return SceneBuilder(parsed).Build();
+    }
+
+    void Scene::SetArrays(span<const MeshRecord> records, span<const Point3f> p, span<const Normal3f> n,
+                          span<const Point2f> uv, span<const int> idx, span<const MaterialData> mtls,
+                          span<const LightData> lts, span<const ObjectPrototype> protos,
+                          span<const ObjectInstance> insts, span<const AnimatedTransform> motions) {
+        meshRecords = records;
+        positions = p;
+        normals = n;
+        uvs = uv;
+        indices = idx;
+        materials = mtls;
+        lights = lts;
+        prototypes = protos;
+        instances = insts;
+        instanceMotion = motions;
+
+        meshes.resize(records.size());
+        for (size_t i = 0; i < records.size(); ++i) {
+            const MeshRecord &r = records[i];
+            TriangleMesh &mesh = meshes[i];
+            mesh.p = positions.subspan(r.pOffset, r.nVertices);
+            if (r.nOffset != ~uint64_t(0))
+                mesh.n = normals.subspan(r.nOffset, r.nVertices);
+            if (r.uvOffset != ~uint64_t(0))
+                mesh.uv = uvs.subspan(r.uvOffset, r.nVertices);
+            mesh.indices = indices.subspan(r.indexOffset, r.nIndices);
+            mesh.materialIndex = r.materialIndex;
+            mesh.areaLightIndex = r.areaLightIndex;
+            mesh.insideMedium = r.insideMedium;
+            mesh.outsideMedium = r.outsideMedium;
+            mesh.reverseOrientation = r.flags & ReverseOrientation;
+            mesh.transformSwapsHandedness = r.flags & TransformSwapsHandedness;
+        }
+    }
+
+    Scene::~Scene() {
+        for (MediumHandle medium : media)
+            medium.Dispatch([](auto m) { delete m; });
+        for (LightHandle light : lightHandles)
+            light.Dispatch([](auto l) { delete l; });
+        for (MaterialHandle material : materialHandles)
+            if (material)
+                material.Dispatch([](auto m) { delete m; });
+        if (defaultMaterial)
+            defaultMaterial.Dispatch([](auto m) { delete m; });
+    }
+
+    void Scene::SetMedia(span<const MediumData> records, span<const float> densities,
+                         span<const float> majorants) {
+        mediumRecords = records;
+        mediumDensities = densities;
+        majorantVoxels = majorants;
+
+        DCHECK(media.empty() && gridFiles.empty());
+        for (const MediumData &m : records) {
+            int res = m.majorantResolution;
+            if (m.type == MediumType::Homogeneous)
+                media.emplace_back(new HomogeneousMedium(m.sigma_a, m.sigma_s, m.scale, m.Le, m.LeScale, m.g));
+            else if (m.type == MediumType::SparseGrid) {
+                gridFiles.push_back(SparseGridFile::Open(strings[m.filenameIndex]));
+                const SparseGrid *density = gridFiles.back()->Grid("density");
+                if (!density)
+                    throw std::runtime_error(strings[m.filenameIndex] + ": no \"density\" grid");
+                MajorantGrid majorantGrid(m.bounds, majorants.subspan(m.majorantOffset, size_t(res) * res * res), res);
+                media.emplace_back(new SparseGridMedium(m.renderFromMedium, m.sigma_a, m.sigma_s, m.scale, m.g, density,
+                                                        gridFiles.back()->Grid("temperature"), m.LeScale,
+                                                        m.temperatureOffset, m.temperatureScale, majorantGrid));
+            } else {
+                SampledGrid density(densities.subspan(m.densityOffset, size_t(m.nx) * m.ny * m.nz), m.nx, m.ny, m.nz);
+                MajorantGrid majorantGrid(m.bounds, majorants.subspan(m.majorantOffset, size_t(res) * res * res), res);
+                media.emplace_back(new GridMedium(m.bounds, m.renderFromMedium, m.sigma_a, m.sigma_s, m.scale, m.g,
+                                                  density, majorantGrid));
+            }
+        }
+    }
+
+    // Memory for the decoded texture tiles of a scene; tiles beyond it are
+    // evicted and loaded again from the mapped files when needed.
+    static size_t textureCacheBytes = size_t(256) << 20;
+
+    void SetTextureCacheSize(size_t bytes) {
+        textureCacheBytes = bytes;
+    }
+
+    void Scene::SetTextures(span<const TextureData> records) {
+        textures = records;
+        DCHECK(textureFiles.empty() && !textureCache);
+        if (records.empty())
+            return;
+        for (const TextureData &t : records)
+            textureFiles.push_back(TiledTextureFile::Open(strings[t.filenameIndex]));
+
+        // Give the cache slots that fit the largest tiles
+        size_t tileBytes = 0;
+        for (const std::unique_ptr<TiledTextureFile> &file : textureFiles)
+            tileBytes = std::max(tileBytes, file->Desc().TileBytes());
+        textureCache = std::make_unique<TextureCache>(textureCacheBytes, tileBytes);
+        for (size_t i = 0; i < records.size(); ++i) {
+            int textureId = textureCache->AddTexture(textureFiles[i]->Desc());
+            imageTextures.emplace_back(textureCache.get(), textureId, records[i].scale, records[i].invert != 0);
+        }
+    }
+
+    void Scene::SetMaterials() {
+        DCHECK(materialHandles.empty() && !defaultMaterial);
+        uint32_t warned = 0;
+        for (const MaterialData &m : materials) {
+            const ImageTexture *texture = m.reflectanceTexture >= 0 ? &imageTextures[m.reflectanceTexture] : nullptr;
+            switch (m.type) {
+                case MaterialType::Diffuse:
+                    materialHandles.emplace_back(new DiffuseMaterial(m.reflectance, texture));
+                    break;
+                case MaterialType::Conductor:
+                case MaterialType::Dielectric:
+                case MaterialType::CoatedDiffuse:
+                case MaterialType::DiffuseTransmission: {
+                    // There are no BxDFs for these yet
+                    static const char *names[] = {"diffuse", "conductor", "dielectric", "coateddiffuse",
+                                                  "diffusetransmission"};
+                    if (!(warned & (1u << uint32_t(m.type)))) {
+                        LOG_WARNING("\"%s\" material is not supported yet; rendering it as \"diffuse\"",
+                                    names[uint32_t(m.type)]);
+                        warned |= 1u << uint32_t(m.type);
+                    }
+                    materialHandles.emplace_back(new DiffuseMaterial(m.reflectance, texture));
+                    break;
+                }
+                case MaterialType::Interface:
+                    materialHandles.emplace_back(nullptr);
+                    break;
+            }
+        }
+        defaultMaterial = new DiffuseMaterial(MaterialData().reflectance, nullptr);
+    }
+
+    void Scene::SetLights() {
+        DCHECK(lightHandles.empty());
+        for (const LightData &light : lights) {
+            switch (light.type) {
+                case LightType::Point:
+                    lightHandles.emplace_back(new PointLight(light.p, light.L, light.scale));
+                    break;
+                case LightType::Spot:
+                    lightHandles.emplace_back(new SpotLight(light.p, light.w, light.L, light.scale,
+                                                            light.cosFalloffStart, light.cosFalloffEnd));
+                    break;
+                case LightType::Distant:
+                    lightHandles.emplace_back(new DistantLight(light.w, light.L, light.scale, Bounds()));
+                    break;
+                case LightType::DiffuseArea:
+                    lightHandles.emplace_back(new DiffuseAreaLight(&meshes[light.meshIndex], light.triangleIndex,
+                                                                   light.L, light.scale, light.twoSided));
+                    break;
+                case LightType::Infinite: {
+                    // Without a map the light is uniform, which is a 1x1 map
+                    Image image;
+                    if (light.filenameIndex >= 0)
+                        image = Image::Read(strings[light.filenameIndex]);
+                    else {
+                        image = Image(Point2i(1, 1), 3);
+                        for (int c = 0; c < 3; ++c)
+                            image.SetChannel(Point2i(0, 0), c, light.L[c]);
+                    }
+                    lightHandles.emplace_back(new EnvironmentLight(std::move(image), light.w, light.scale, Bounds()));
+                    break;
+                }
+            }
+        }
+    }
+
+    void Scene::SetPrototypeBVHs(span<const LinearBVHNode> nodes, span<const BVHPrimitive> primitives) {
+        prototypeNodes = nodes;
+        prototypePrimitives = primitives;
+        prototypeBVHs.clear();
+        prototypeBVHs.reserve(prototypes.size());
+        for (const ObjectPrototype &proto : prototypes)
+            prototypeBVHs.emplace_back(span<const TriangleMesh>(meshes.data() + proto.firstMesh, proto.nMeshes),
+                                       nodes.subspan(proto.firstNode, proto.nNodes),
+                                       primitives.subspan(proto.firstPrimitive, proto.nPrimitives));
+    }
+
+    size_t Scene::NumTriangles() const {
+        size_t n = 0;
+        for (const TriangleMesh &mesh : meshes)
+            n += mesh.NumTriangles();
+        return n;
+    }
+
+    void Scene::CreateEntities() {
+        std::vector<entt::entity> materialEntities(materials.size());
+        for (size_t i = 0; i < materials.size(); ++i) {
+            materialEntities[i] = registry.create();
+            registry.emplace<MaterialComponent>(materialEntities[i], int32_t(i));
+        }
+        entt::entity defaultMaterialEntity = registry.create();
+        registry.emplace<MaterialComponent>(defaultMaterialEntity, -1);
+
+        std::vector<entt::entity> meshEntities(meshes.size());
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            int materialIndex = meshRecords[i].materialIndex;
+            meshEntities[i] = registry.create();
+            registry.emplace<MeshComponent>(meshEntities[i], uint32_t(i),
+                                            materialIndex < 0 ? defaultMaterialEntity : materialEntities[materialIndex]);
+        }
+
+        std::vector<entt::entity> prototypeEntities(prototypes.size());
+        for (size_t i = 0; i < prototypes.size(); ++i) {
+            const ObjectPrototype &proto = prototypes[i];
+            prototypeEntities[i] = registry.create();
+            registry.emplace<PrototypeComponent>(
+                    prototypeEntities[i], uint32_t(i),
+                    std::vector<entt::entity>(meshEntities.begin() + proto.firstMesh,
+                                              meshEntities.begin() + proto.firstMesh + proto.nMeshes));
+        }
+
+        // Emplacing doesn't count as an update, so nothing starts out moved
+        instanceEntities.resize(instances.size());
+        for (size_t i = 0; i < instances.size(); ++i) {
+            entt::entity entity = registry.create();
+            registry.emplace<InstanceComponent>(entity, uint32_t(i), prototypeEntities[instances[i].prototypeIndex]);
+            registry.emplace<TransformComponent>(entity, instances[i].renderFromInstance);
+            instanceEntities[i] = entity;
+        }
+    }
+
+    void Scene::SetInstanceTransform(uint32_t index, const Transform &renderFromInstance) {
+        CHECK_LT(index, instances.size());
+        registry.patch<TransformComponent>(instanceEntities[index], [&](TransformComponent &transform) {
+            transform.renderFromInstance = renderFromInstance;
+        });
+    }
+
+    void Scene::CommitUpdates() {
+        if (movedInstances.empty())
+            return;
+        // Instances mapped from the scene cache are read-only
+        if (instanceStorage.data() != instances.data()) {
+            instanceStorage.assign(instances.begin(), instances.end());
+            instances = instanceStorage;
+        }
+        std::vector<uint32_t> moved;
+        moved.reserve(movedInstances.size());
+        movedInstances.each([&](entt::entity entity) {
+            uint32_t index = registry.get<InstanceComponent>(entity).instanceIndex;
+            const Transform &renderFromInstance = registry.get<TransformComponent>(entity).renderFromInstance;
+            ObjectInstance &instance = instanceStorage[index];
+            instance.renderFromInstance = renderFromInstance;
+            instance.motionIndex = -1;
+            instance.bounds = renderFromInstance(prototypeBVHs[instance.prototypeIndex].Bounds());
+            moved.push_back(index);
+        });
+        bvh.Refit(instances, moved);
+    }
+
+#pragma endregion Scene
+}
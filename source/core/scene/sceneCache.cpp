@@ -0,0 +1,371 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/scene/scene.h"
+#include "util/hash.h"
+#include "util/parallel.h"
+#include "util/profile.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace jadehare {
+
+    // The scene cache is a header followed by 64-byte aligned sections
+    // holding the Scene arrays exactly as they are laid out in memory, so a
+    // mapped cache is used in place. Bump SceneCacheVersion whenever the
+    // layout of any cached type changes.
+    static constexpr char SceneCacheMagic[8] = "JHSCENE";
+    static constexpr uint32_t SceneCacheVersion = 8;
+    static constexpr size_t SceneCacheAlignment = 64;
+
+    enum SceneCacheSectionId {
+        InputsSection, StringsSection, CameraSection, MeshRecordsSection, PositionsSection, NormalsSection,
+        UVsSection, IndicesSection, MaterialsSection, LightsSection, BVHNodesSection, BVHPrimitivesSection,
+        PrototypesSection, InstancesSection, PrototypeNodesSection, PrototypePrimitivesSection, MediaSection,
+        MediumDensitiesSection, MajorantsSection, InstanceMotionSection, BVHMotionNodesSection, TexturesSection,
+        NumSceneCacheSections
+    };
+
+    // SceneCacheSection Definition
+    struct SceneCacheSection {
+        uint64_t offset, size;
+    };
+
+    // SceneCacheHeader Definition
+    struct SceneCacheHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t nSections;
+        // Hash of the scene file names and the contents of every input file.
+        uint64_t contentHash;
+        SceneCacheSection sections[NumSceneCacheSections];
+    };
+
+    // Hashes a file's contents in parallel, one block per task.
+    static uint64_t HashFileContents(const MappedFile &file) {
+        constexpr size_t BlockSize = 4 * 1024 * 1024;
+        size_t nBlocks = (file.Size() + BlockSize - 1) / BlockSize;
+        std::vector<uint64_t> blockHashes(nBlocks);
+        ParallelFor(0, int64_t(nBlocks), [&](int64_t b) {
+            size_t size = std::min(BlockSize, file.Size() - b * BlockSize);
+            blockHashes[b] = HashBuffer(file.Data() + b * BlockSize, size, uint64_t(b));
+        });
+        return HashBuffer(blockHashes.data(), blockHashes.size() * sizeof(uint64_t), file.Size());
+    }
+
+    // Returns false if an input file can no longer be read.
+    static bool HashInputs(const std::vector<std::string> &sceneFiles, const std::vector<std::string> &inputFiles,
+                           uint64_t *hash) {
+        uint64_t h = Hash(SceneCacheVersion);
+        for (const std::string &f : sceneFiles)
+            h = HashBuffer(f.data(), f.size(), h);
+        for (const std::string &f : inputFiles) {
+            if (!FileExists(f))
+                return false;
+            std::unique_ptr<MappedFile> file = MappedFile::Open(f, MappedFile::Access::Sequential);
+            h = HashBuffer(f.data(), f.size(), h);
+            h = MixBits(h ^ HashFileContents(*file));
+        }
+        *hash = h;
+        return true;
+    }
+
+    // Strings are stored back to back, each followed by a NUL.
+    static std::string JoinStrings(const std::vector<std::string> &strings) {
+        std::string joined;
+        for (const std::string &s : strings) {
+            joined += s;
+            joined += '\0';
+        }
+        return joined;
+    }
+
+    static std::vector<std::string> SplitStrings(const char *data, size_t size) {
+        std::vector<std::string> strings;
+        const char *end = data + size;
+        while (data < end) {
+            size_t length = strnlen(data, end - data);
+            strings.emplace_back(data, length);
+            data += length + 1;
+        }
+        return strings;
+    }
+
+    void Scene::WriteCache(const std::string &cacheFilename, const std::vector<std::string> &sceneFiles) const {
+        PROFILE_SCOPE("Write scene cache");
+        SceneCacheHeader header = {};
+        std::memcpy(header.magic, SceneCacheMagic, sizeof(header.magic));
+        header.version = SceneCacheVersion;
+        header.nSections = NumSceneCacheSections;
+        if (!HashInputs(sceneFiles, inputFiles, &header.contentHash))
+            throw std::runtime_error(cacheFilename + ": scene inputs changed while building the cache");
+
+        std::string inputs = JoinStrings(inputFiles), strs = JoinStrings(strings);
+        struct {
+            const void *data;
+            size_t size;
+        } sections[NumSceneCacheSections] = {
+                {inputs.data(),               inputs.size()},
+                {strs.data(),                 strs.size()},
+                {&camera,                     sizeof(camera)},
+                {meshRecords.data(),          meshRecords.size() * sizeof(MeshRecord)},
+                {positions.data(),            positions.size() * sizeof(Point3f)},
+                {normals.data(),              normals.size() * sizeof(Normal3f)},
+                {uvs.data(),                  uvs.size() * sizeof(Point2f)},
+                {indices.data(),              indices.size() * sizeof(int)},
+                {materials.data(),            materials.size() * sizeof(MaterialData)},
+                {lights.data(),               lights.size() * sizeof(LightData)},
+                {bvh.Nodes().data(),          bvh.Nodes().size() * sizeof(LinearBVHNode)},
+                {bvh.Primitives().data(),     bvh.Primitives().size() * sizeof(BVHPrimitive)},
+                {prototypes.data(),           prototypes.size() * sizeof(ObjectPrototype)},
+                {instances.data(),            instances.size() * sizeof(ObjectInstance)},
+                {prototypeNodes.data(),       prototypeNodes.size() * sizeof(LinearBVHNode)},
+                {prototypePrimitives.data(),  prototypePrimitives.size() * sizeof(BVHPrimitive)},
+                {mediumRecords.data(),        mediumRecords.size() * sizeof(MediumData)},
+                {mediumDensities.data(),      mediumDensities.size() * sizeof(float)},
+                {majorantVoxels.data(),       majorantVoxels.size() * sizeof(float)},
+                {instanceMotion.data(),       instanceMotion.size() * sizeof(AnimatedTransform)},
+                {bvh.MotionNodes().data(),    bvh.MotionNodes().size() * sizeof(LinearBVHNodeMotion)},
+                {textures.data(),             textures.size() * sizeof(TextureData)}};
+
+        // Write to a temporary file and rename it into place, so a concurrent
+        // render never maps a partially written cache.
+        std::string tempFilename = cacheFilename + ".tmp";
+        std::FILE *f = std::fopen(tempFilename.c_str(), "wb");
+        if (!f)
+            throw std::runtime_error(tempFilename + ": " + std::strerror(errno));
+        bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+        uint64_t offset = sizeof(header);
+        static const char zeros[SceneCacheAlignment] = {};
+        for (int i = 0; i < NumSceneCacheSections; ++i) {
+            size_t pad = (SceneCacheAlignment - offset % SceneCacheAlignment) % SceneCacheAlignment;
+            ok &= std::fwrite(zeros, 1, pad, f) == pad;
+            offset += pad;
+            header.sections[i] = {offset, sections[i].size};
+            if (sections[i].size > 0)
+                ok &= std::fwrite(sections[i].data, 1, sections[i].size, f) == sections[i].size;
+            offset += sections[i].size;
+        }
+        ok &= std::fseek(f, 0, SEEK_SET) == 0;
+        ok &= std::fwrite(&header, sizeof(header), 1, f) == 1;
+        ok &= std::fclose(f) == 0;
+        if (!ok || std::rename(tempFilename.c_str(), cacheFilename.c_str()) != 0) {
+            std::remove(tempFilename.c_str());
+            throw std::runtime_error(cacheFilename + ": error writing scene cache");
+        }
+    }
+
+    // Whether _nodes_ hold one tree in the depth-first layout BVHAggregate
+    // traverses, shallow enough for its 64-entry traversal stack, with
+    // leaves inside the _nPrimitives_ primitives. Nodes are checked in the
+    // order a depth-first walk reaches them, so every node is visited once.
+    static bool ValidBVHNodes(span<const LinearBVHNode> nodes, size_t nPrimitives, bool motion) {
+        constexpr int MaxDepth = 64;
+        size_t next = 0;
+        std::vector<std::pair<size_t, int>> toVisit;
+        if (!nodes.empty())
+            toVisit.push_back({0, 1});
+        while (!toVisit.empty()) {
+            auto [index, depth] = toVisit.back();
+            toVisit.pop_back();
+            if (index != next || index >= nodes.size() || depth > MaxDepth)
+                return false;
+            ++next;
+            const LinearBVHNode &node = nodes[index];
+            if (node.nPrimitives > 0) {
+                if (node.primitivesOffset < 0 || size_t(node.primitivesOffset) + node.nPrimitives > nPrimitives)
+                    return false;
+            } else {
+                if (node.axis > 2 && !(motion && node.axis == LinearBVHNode::TemporalSplit))
+                    return false;
+                if (node.secondChildOffset <= int64_t(index) + 1)
+                    return false;
+                // Traversal picks one child of a temporal split without
+                // pushing the other
+                int childDepth = node.axis == LinearBVHNode::TemporalSplit ? depth : depth + 1;
+                toVisit.push_back({size_t(node.secondChildOffset), childDepth});
+                toVisit.push_back({index + 1, childDepth});
+            }
+        }
+        return next == nodes.size();
+    }
+
+    std::unique_ptr<Scene> Scene::ReadCache(const std::string &cacheFilename,
+                                            const std::vector<std::string> &sceneFiles) {
+        PROFILE_SCOPE("Read scene cache");
+        if (!FileExists(cacheFilename))
+            return nullptr;
+        std::unique_ptr<MappedFile> file = MappedFile::Open(cacheFilename, MappedFile::Access::Random);
+
+        // Validate the header and section table
+        SceneCacheHeader header;
+        if (file->Size() < sizeof(header))
+            return nullptr;
+        std::memcpy(&header, file->Data(), sizeof(header));
+        if (std::memcmp(header.magic, SceneCacheMagic, sizeof(header.magic)) != 0 ||
+            header.version != SceneCacheVersion || header.nSections != NumSceneCacheSections)
+            return nullptr;
+        for (const SceneCacheSection &s : header.sections)
+            if (s.offset % SceneCacheAlignment != 0 || s.offset > file->Size() || s.size > file->Size() - s.offset)
+                return nullptr;
+        auto section = [&](SceneCacheSectionId id, size_t elementSize, size_t *count) {
+            const SceneCacheSection &s = header.sections[id];
+            *count = s.size / elementSize;
+            return file->Data() + s.offset;
+        };
+
+        // Make sure the inputs haven't changed since the cache was written
+        size_t n;
+        const char *inputData = reinterpret_cast<const char *>(section(InputsSection, 1, &n));
+        std::vector<std::string> inputFiles = SplitStrings(inputData, n);
+        uint64_t contentHash;
+        if (!HashInputs(sceneFiles, inputFiles, &contentHash) || contentHash != header.contentHash)
+            return nullptr;
+        if (header.sections[CameraSection].size != sizeof(CameraData))
+            return nullptr;
+
+        std::unique_ptr<Scene> scene(new Scene);
+        scene->inputFiles = std::move(inputFiles);
+        const char *stringData = reinterpret_cast<const char *>(section(StringsSection, 1, &n));
+        scene->strings = SplitStrings(stringData, n);
+        std::memcpy(&scene->camera, section(CameraSection, 1, &n), sizeof(CameraData));
+
+        // Point the scene at the mapped arrays
+        size_t nRecords, nP, nN, nUV, nIndices, nMaterials, nLights, nNodes, nPrims;
+        auto records = reinterpret_cast<const MeshRecord *>(section(MeshRecordsSection, sizeof(MeshRecord), &nRecords));
+        auto p = reinterpret_cast<const Point3f *>(section(PositionsSection, sizeof(Point3f), &nP));
+        auto nrm = reinterpret_cast<const Normal3f *>(section(NormalsSection, sizeof(Normal3f), &nN));
+        auto uv = reinterpret_cast<const Point2f *>(section(UVsSection, sizeof(Point2f), &nUV));
+        auto idx = reinterpret_cast<const int *>(section(IndicesSection, sizeof(int), &nIndices));
+        auto mtls = reinterpret_cast<const MaterialData *>(section(MaterialsSection, sizeof(MaterialData), &nMaterials));
+        auto lts = reinterpret_cast<const LightData *>(section(LightsSection, sizeof(LightData), &nLights));
+        auto nodes = reinterpret_cast<const LinearBVHNode *>(section(BVHNodesSection, sizeof(LinearBVHNode), &nNodes));
+        auto prims = reinterpret_cast<const BVHPrimitive *>(section(BVHPrimitivesSection, sizeof(BVHPrimitive), &nPrims));
+        size_t nProtos, nInstances, nProtoNodes, nProtoPrims;
+        auto protos = reinterpret_cast<const ObjectPrototype *>(
+                section(PrototypesSection, sizeof(ObjectPrototype), &nProtos));
+        auto insts = reinterpret_cast<const ObjectInstance *>(
+                section(InstancesSection, sizeof(ObjectInstance), &nInstances));
+        auto protoNodes = reinterpret_cast<const LinearBVHNode *>(
+                section(PrototypeNodesSection, sizeof(LinearBVHNode), &nProtoNodes));
+        auto protoPrims = reinterpret_cast<const BVHPrimitive *>(
+                section(PrototypePrimitivesSection, sizeof(BVHPrimitive), &nProtoPrims));
+        size_t nMedia, nDensities, nMajorants;
+        auto mediumRecords = reinterpret_cast<const MediumData *>(section(MediaSection, sizeof(MediumData), &nMedia));
+        auto densities = reinterpret_cast<const float *>(section(MediumDensitiesSection, sizeof(float), &nDensities));
+        auto majorants = reinterpret_cast<const float *>(section(MajorantsSection, sizeof(float), &nMajorants));
+        size_t nMotions, nMotionNodes;
+        auto motions = reinterpret_cast<const AnimatedTransform *>(
+                section(InstanceMotionSection, sizeof(AnimatedTransform), &nMotions));
+        auto motionNodes = reinterpret_cast<const LinearBVHNodeMotion *>(
+                section(BVHMotionNodesSection, sizeof(LinearBVHNodeMotion), &nMotionNodes));
+        size_t nTextures;
+        auto texs = reinterpret_cast<const TextureData *>(section(TexturesSection, sizeof(TextureData), &nTextures));
+
+        for (size_t i = 0; i < nRecords; ++i) {
+            const MeshRecord &r = records[i];
+            bool inRange = r.pOffset + r.nVertices <= nP && r.indexOffset + r.nIndices <= nIndices &&
+                           (r.nOffset == ~uint64_t(0) || r.nOffset + r.nVertices <= nN) &&
+                           (r.uvOffset == ~uint64_t(0) || r.uvOffset + r.nVertices <= nUV) &&
+                           r.insideMedium < int64_t(nMedia) && r.outsideMedium < int64_t(nMedia);
+            if (!inRange)
+                return nullptr;
+        }
+        // Triangles index vertices of their own mesh only
+        std::atomic<bool> indicesInRange{true};
+        ParallelFor(0, int64_t(nRecords), [&](int64_t i) {
+            const MeshRecord &r = records[i];
+            if (r.nIndices % 3 != 0) {
+                indicesInRange = false;
+                return;
+            }
+            for (uint32_t j = 0; j < r.nIndices; ++j)
+                if (uint32_t(idx[r.indexOffset + j]) >= r.nVertices) {
+                    indicesInRange = false;
+                    return;
+                }
+        });
+        if (!indicesInRange)
+            return nullptr;
+
+        // BVH primitives name a mesh and one of its triangles, or an instance
+        auto validPrimitives = [&](span<const BVHPrimitive> bvhPrims, size_t firstMesh, size_t nMeshes,
+                                   bool instancesAllowed) {
+            for (const BVHPrimitive &prim : bvhPrims) {
+                if (prim.IsInstance()) {
+                    if (!instancesAllowed || prim.triangleIndex >= nInstances)
+                        return false;
+                } else if (prim.meshIndex >= nMeshes ||
+                           prim.triangleIndex >= records[firstMesh + prim.meshIndex].nIndices / 3)
+                    return false;
+            }
+            return true;
+        };
+        for (size_t i = 0; i < nProtos; ++i) {
+            const ObjectPrototype &p = protos[i];
+            if (p.firstMesh + p.nMeshes > nRecords || p.firstNode + p.nNodes > nProtoNodes ||
+                p.firstPrimitive + p.nPrimitives > nProtoPrims)
+                return nullptr;
+            if (!ValidBVHNodes({protoNodes + p.firstNode, p.nNodes}, p.nPrimitives, false) ||
+                !validPrimitives({protoPrims + p.firstPrimitive, p.nPrimitives}, p.firstMesh, p.nMeshes, false))
+                return nullptr;
+        }
+        for (size_t i = 0; i < nInstances; ++i)
+            if (insts[i].prototypeIndex >= nProtos || insts[i].motionIndex >= int64_t(nMotions))
+                return nullptr;
+        if (nMotionNodes != 0 && nMotionNodes != nNodes)
+            return nullptr;
+        size_t nWorldMeshes = nProtos == 0 ? nRecords : protos[0].firstMesh;
+        if (!ValidBVHNodes({nodes, nNodes}, nPrims, nMotionNodes != 0) ||
+            !validPrimitives({prims, nPrims}, 0, nWorldMeshes, true))
+            return nullptr;
+        for (size_t i = 0; i < nMaterials; ++i)
+            if (mtls[i].type > MaterialType::Interface || mtls[i].reflectanceTexture >= int64_t(nTextures))
+                return nullptr;
+        for (size_t i = 0; i < nTextures; ++i)
+            if (texs[i].filenameIndex < 0 || size_t(texs[i].filenameIndex) >= scene->strings.size())
+                return nullptr;
+        for (size_t i = 0; i < nLights; ++i) {
+            const LightData &l = lts[i];
+            if (l.type == LightType::Infinite && l.filenameIndex >= int64_t(scene->strings.size()))
+                return nullptr;
+            if (l.type == LightType::DiffuseArea &&
+                (l.meshIndex < 0 || size_t(l.meshIndex) >= nRecords || l.triangleIndex < 0 ||
+                 size_t(l.triangleIndex) >= records[l.meshIndex].nIndices / 3))
+                return nullptr;
+        }
+        for (size_t i = 0; i < nMedia; ++i) {
+            const MediumData &m = mediumRecords[i];
+            size_t res = m.majorantResolution;
+            if (m.type == MediumType::UniformGrid &&
+                (m.densityOffset + uint64_t(m.nx) * m.ny * m.nz > nDensities ||
+                 m.majorantOffset + res * res * res > nMajorants))
+                return nullptr;
+            if (m.type == MediumType::SparseGrid &&
+                (m.filenameIndex < 0 || size_t(m.filenameIndex) >= scene->strings.size() ||
+                 m.majorantOffset + res * res * res > nMajorants))
+                return nullptr;
+        }
+        if (scene->camera.mediumIndex >= int64_t(nMedia) || scene->camera.sampler > SamplerType::ZSobol)
+            return nullptr;
+
+        scene->SetArrays({records, nRecords}, {p, nP}, {nrm, nN}, {uv, nUV}, {idx, nIndices}, {mtls, nMaterials},
+                         {lts, nLights}, {protos, nProtos}, {insts, nInstances}, {motions, nMotions});
+        scene->SetMedia({mediumRecords, nMedia}, {densities, nDensities}, {majorants, nMajorants});
+        scene->SetTextures({texs, nTextures});
+        scene->SetMaterials();
+        scene->SetPrototypeBVHs({protoNodes, nProtoNodes}, {protoPrims, nProtoPrims});
+        scene->bvh = BVHAggregate(span<const TriangleMesh>(scene->meshes.data(), scene->NumWorldMeshes()),
+                                  {nodes, nNodes}, {prims, nPrims}, scene->instances, scene->prototypeBVHs,
+                                  scene->instanceMotion, {motionNodes, nMotionNodes});
+        scene->SetLights();
+        scene->CreateEntities();
+        scene->cacheFile = std::move(file);
+        return scene;
+    }
+}
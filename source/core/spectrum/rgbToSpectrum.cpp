@@ -0,0 +1,304 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/spectrum/rgbToSpectrum.h"
+#include "util/parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace jadehare {
+
+#pragma region Coefficient Fitting
+    // Follows rgb2spec_opt (Jakob and Hanika 2019): for each target color,
+    // Gauss-Newton iterations on the CIELAB difference between the target
+    // and the color of the sigmoid spectrum. Wavelengths are normalized to
+    // [0,1] while fitting.
+
+    static constexpr int FitSamples = 95;
+
+    // Quadrature weights that turn a spectrum sampled at FitSamples evenly
+    // spaced wavelengths into linear sRGB, as SampledSpectrum::ToRGB() does.
+    struct FitTables {
+        FitTables() {
+            // Composite Simpson's rule over [Lambda_min, Lambda_max]
+            float h = (Lambda_max - Lambda_min) / (FitSamples - 1);
+            double ySum = 0;
+            std::array<XYZ, FitSamples> xyz;
+            for (int i = 0; i < FitSamples; ++i) {
+                float lambda = Lambda_min + i * h;
+                float weight = h / 3 * (i == 0 || i == FitSamples - 1 ? 1 : (i % 2 ? 4 : 2));
+                lambdaNormalized[i] = float(i) / (FitSamples - 1);
+                xyz[i] = XYZ(CIE_X(lambda) * weight, CIE_Y(lambda) * weight, CIE_Z(lambda) * weight);
+                ySum += xyz[i].Y;
+            }
+            for (int i = 0; i < FitSamples; ++i) {
+                RGB rgb = SpectralXYZToLinearSRGB(XYZ(xyz[i].X / ySum, xyz[i].Y / ySum, xyz[i].Z / ySum));
+                for (int c = 0; c < 3; ++c)
+                    rgbWeights[c][i] = rgb[c];
+            }
+        }
+
+        float lambdaNormalized[FitSamples];
+        float rgbWeights[3][FitSamples];
+    };
+
+    static const FitTables &GetFitTables() {
+        static const FitTables tables;
+        return tables;
+    }
+
+    static std::array<double, 3> LinearSRGBToLab(const std::array<double, 3> &rgb) {
+        XYZ xyz = LinearSRGBToXYZ(RGB(float(rgb[0]), float(rgb[1]), float(rgb[2])));
+        auto f = [](double t) {
+            const double delta = 6. / 29.;
+            return t > delta * delta * delta ? std::cbrt(t) : t / (3 * delta * delta) + 4. / 29.;
+        };
+        // D65 white point
+        double fx = f(xyz.X / 0.95047), fy = f(xyz.Y), fz = f(xyz.Z / 1.08883);
+        return {116 * fy - 16, 500 * (fx - fy), 200 * (fy - fz)};
+    }
+
+    static std::array<double, 3> FitResidual(const double coeffs[3], const std::array<double, 3> &targetLab) {
+        const FitTables &tables = GetFitTables();
+        std::array<double, 3> rgb = {0, 0, 0};
+        for (int i = 0; i < FitSamples; ++i) {
+            double lambda = tables.lambdaNormalized[i];
+            double x = (coeffs[0] * lambda + coeffs[1]) * lambda + coeffs[2];
+            double s = .5 + x / (2 * std::sqrt(1 + x * x));
+            for (int c = 0; c < 3; ++c)
+                rgb[c] += tables.rgbWeights[c][i] * s;
+        }
+        std::array<double, 3> lab = LinearSRGBToLab(rgb);
+        return {targetLab[0] - lab[0], targetLab[1] - lab[1], targetLab[2] - lab[2]};
+    }
+
+    // Solves the 3x3 system a x = b with Cramer's rule; false if singular.
+    static bool Solve3x3(const double a[3][3], const std::array<double, 3> &b, double x[3]) {
+        auto det = [](const double m[3][3]) {
+            return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+                   m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+                   m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+        };
+        double d = det(a);
+        if (std::abs(d) < 1e-15)
+            return false;
+        for (int col = 0; col < 3; ++col) {
+            double m[3][3];
+            for (int r = 0; r < 3; ++r)
+                for (int c = 0; c < 3; ++c)
+                    m[r][c] = c == col ? b[r] : a[r][c];
+            x[col] = det(m) / d;
+        }
+        return true;
+    }
+
+    static double SquaredNorm(const std::array<double, 3> &v) { return v[0] * v[0] + v[1] * v[1] + v[2] * v[2]; }
+
+    // Refines coeffs toward rgb and returns the squared CIELAB error left.
+    static double GaussNewton(const std::array<double, 3> &rgb, double coeffs[3]) {
+        std::array<double, 3> targetLab = LinearSRGBToLab(rgb);
+        std::array<double, 3> residual = FitResidual(coeffs, targetLab);
+        double r2 = SquaredNorm(residual);
+        for (int iteration = 0; iteration < 50 && r2 >= 1e-12; ++iteration) {
+            // Central-difference Jacobian of the residual
+            double jacobian[3][3];
+            const double eps = 1e-5;
+            for (int i = 0; i < 3; ++i) {
+                double c0[3] = {coeffs[0], coeffs[1], coeffs[2]}, c1[3] = {coeffs[0], coeffs[1], coeffs[2]};
+                c0[i] -= eps;
+                c1[i] += eps;
+                std::array<double, 3> r0 = FitResidual(c0, targetLab), r1 = FitResidual(c1, targetLab);
+                for (int j = 0; j < 3; ++j)
+                    jacobian[j][i] = (r1[j] - r0[j]) / (2 * eps);
+            }
+
+            double step[3];
+            if (!Solve3x3(jacobian, residual, step))
+                break;
+
+            // Halve the step until the error goes down; full steps from a
+            // poor starting guess can overshoot into the sigmoid's flat tails
+            bool improved = false;
+            for (double t = 1; t > 1e-3 && !improved; t /= 2) {
+                double next[3];
+                for (int i = 0; i < 3; ++i)
+                    next[i] = coeffs[i] - t * step[i];
+
+                // Keep saturated colors, which no reflectance reaches, from
+                // running off to infinity
+                double maxCoeff = std::max({next[0], next[1], next[2]});
+                if (maxCoeff > 200)
+                    for (int i = 0; i < 3; ++i)
+                        next[i] *= 200 / maxCoeff;
+
+                std::array<double, 3> nextResidual = FitResidual(next, targetLab);
+                double nextR2 = SquaredNorm(nextResidual);
+                if (nextR2 < r2) {
+                    std::copy(next, next + 3, coeffs);
+                    residual = nextResidual;
+                    r2 = nextR2;
+                    improved = true;
+                }
+            }
+            if (!improved)
+                break;
+        }
+        return r2;
+    }
+
+#pragma endregion Coefficient Fitting
+
+    std::unique_ptr<RGBToSpectrumTable> RGBToSpectrumTable::Generate(int res) {
+        if (res < 2)
+            throw std::runtime_error("RGB to spectrum table resolution must be at least 2");
+        std::unique_ptr<RGBToSpectrumTable> table(new RGBToSpectrumTable);
+        table->res = res;
+        table->storage.resize(res + 3 * size_t(res) * res * res * 3);
+
+        // Nodes along the largest component bunch up toward both ends, where
+        // the coefficients change fastest
+        float *zNodes = table->storage.data();
+        auto smoothStep = [](float x) { return x * x * (3 - 2 * x); };
+        for (int i = 0; i < res; ++i)
+            zNodes[i] = smoothStep(smoothStep(float(i) / (res - 1)));
+        float *coefficients = zNodes + res;
+
+        // Each job fits one row of colors; along z the fit of the previous
+        // node is the starting guess, going up and down from a node with an
+        // easy fit.
+        ParallelFor(0, 3 * res, [&](int64_t job) {
+            int maxc = int(job / res), y = int(job % res);
+            for (int x = 0; x < res; ++x) {
+                auto fit = [&](int zStart, int zEnd, int zStep) {
+                    double coeffs[3] = {0, 0, 0};
+                    for (int z = zStart; z != zEnd; z += zStep) {
+                        std::array<double, 3> rgb;
+                        double b = zNodes[z];
+                        rgb[maxc] = b;
+                        rgb[(maxc + 1) % 3] = double(x) / (res - 1) * b;
+                        rgb[(maxc + 2) % 3] = double(y) / (res - 1) * b;
+                        // A chain that has wandered off restarts from the
+                        // flat spectrum, whichever fits better is kept
+                        double r2 = GaussNewton(rgb, coeffs);
+                        if (r2 > 1e-6) {
+                            double flat[3] = {0, 0, 0};
+                            if (GaussNewton(rgb, flat) < r2)
+                                std::copy(flat, flat + 3, coeffs);
+                        }
+
+                        // Convert from normalized wavelengths to nanometers
+                        double c0 = Lambda_min, c1 = 1. / (Lambda_max - Lambda_min);
+                        double A = coeffs[0], B = coeffs[1], C = coeffs[2];
+                        float *out = coefficients + table->CoefficientOffset(maxc, z, y, x);
+                        out[0] = float(A * c1 * c1);
+                        out[1] = float(B * c1 - 2 * A * c0 * c1 * c1);
+                        out[2] = float(C - B * c0 * c1 + A * c0 * c0 * c1 * c1);
+                    }
+                };
+                int start = res / 5;
+                fit(start, res, 1);
+                fit(start, -1, -1);
+            }
+        });
+
+        table->zNodes = span<const float>(zNodes, res);
+        table->coefficients = span<const float>(coefficients, 3 * size_t(res) * res * res * 3);
+        return table;
+    }
+
+    static uint64_t AlignRGBToSpectrumOffset(uint64_t offset) { return (offset + 63) & ~uint64_t(63); }
+
+    std::unique_ptr<RGBToSpectrumTable> RGBToSpectrumTable::Open(const std::string &filename) {
+        std::unique_ptr<RGBToSpectrumTable> table(new RGBToSpectrumTable);
+        table->file = MappedFile::Open(filename);
+        const uint8_t *base = table->file->Data();
+        size_t size = table->file->Size();
+
+        if (size < sizeof(RGBToSpectrumTableHeader) ||
+            std::memcmp(base, RGBToSpectrumMagic, sizeof(RGBToSpectrumMagic)) != 0)
+            throw std::runtime_error(filename + ": not an RGB to spectrum table");
+        RGBToSpectrumTableHeader header;
+        std::memcpy(&header, base, sizeof(header));
+        if (header.version != RGBToSpectrumVersion)
+            throw std::runtime_error(filename + ": unsupported RGB to spectrum table version " +
+                                     std::to_string(header.version));
+        if (header.resolution < 2 || header.resolution > 1024)
+            throw std::runtime_error(filename + ": corrupt RGB to spectrum table header");
+
+        size_t nCoefficients = 3 * size_t(header.resolution) * header.resolution * header.resolution * 3;
+        auto inBounds = [&](uint64_t offset, size_t count) {
+            return offset % 64 == 0 && offset <= size && count <= (size - offset) / sizeof(float);
+        };
+        if (!inBounds(header.zNodesOffset, header.resolution) ||
+            !inBounds(header.coefficientsOffset, nCoefficients))
+            throw std::runtime_error(filename + ": truncated RGB to spectrum table");
+
+        table->res = int(header.resolution);
+        table->zNodes = span<const float>(reinterpret_cast<const float *>(base + header.zNodesOffset),
+                                          header.resolution);
+        table->coefficients = span<const float>(reinterpret_cast<const float *>(base + header.coefficientsOffset),
+                                                nCoefficients);
+        return table;
+    }
+
+    void RGBToSpectrumTable::Write(const std::string &filename) const {
+        RGBToSpectrumTableHeader header = {};
+        std::memcpy(header.magic, RGBToSpectrumMagic, sizeof(RGBToSpectrumMagic));
+        header.version = RGBToSpectrumVersion;
+        header.resolution = uint32_t(res);
+        header.zNodesOffset = AlignRGBToSpectrumOffset(sizeof(header));
+        header.coefficientsOffset = AlignRGBToSpectrumOffset(header.zNodesOffset + zNodes.size() * sizeof(float));
+
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        if (!out)
+            throw std::runtime_error(filename + ": unable to open for writing");
+        uint64_t offset = 0;
+        auto write = [&](const void *data, size_t size) {
+            out.write(reinterpret_cast<const char *>(data), std::streamsize(size));
+            offset += size;
+        };
+        auto padTo = [&](uint64_t to) {
+            static const char zeros[64] = {};
+            write(zeros, to - offset);
+        };
+        write(&header, sizeof(header));
+        padTo(header.zNodesOffset);
+        write(zNodes.data(), zNodes.size() * sizeof(float));
+        padTo(header.coefficientsOffset);
+        write(coefficients.data(), coefficients.size() * sizeof(float));
+        if (!out)
+            throw std::runtime_error(filename + ": error writing RGB to spectrum table");
+    }
+
+    RGBSigmoidPolynomial RGBToSpectrumTable::operator()(const RGB &rgb) const {
+        DCHECK(rgb.r >= 0 && rgb.r <= 1 && rgb.g >= 0 && rgb.g <= 1 && rgb.b >= 0 && rgb.b <= 1);
+        // Grays have a constant spectrum
+        if (rgb.r == rgb.g && rgb.g == rgb.b)
+            return RGBSigmoidPolynomial(0, 0, (rgb.r - .5f) / std::sqrt(rgb.r * (1 - rgb.r)));
+
+        // Find the cell holding rgb, relative to its largest component
+        int maxc = (rgb.r > rgb.g) ? ((rgb.r > rgb.b) ? 0 : 2) : ((rgb.g > rgb.b) ? 1 : 2);
+        float z = rgb[maxc];
+        float x = rgb[(maxc + 1) % 3] * (res - 1) / z;
+        float y = rgb[(maxc + 2) % 3] * (res - 1) / z;
+        int xi = std::min(int(x), res - 2), yi = std::min(int(y), res - 2);
+        int zi = Clamp(int(std::upper_bound(zNodes.begin(), zNodes.end(), z) - zNodes.begin()) - 1, 0, res - 2);
+        float dx = x - xi, dy = y - yi, dz = (z - zNodes[zi]) / (zNodes[zi + 1] - zNodes[zi]);
+
+        // Trilinearly interpolate the coefficients
+        float c[3];
+        for (int i = 0; i < 3; ++i) {
+            auto co = [&](int ox, int oy, int oz) {
+                return coefficients[CoefficientOffset(maxc, zi + oz, yi + oy, xi + ox) + i];
+            };
+            c[i] = Lerp(dz, Lerp(dy, Lerp(dx, co(0, 0, 0), co(1, 0, 0)), Lerp(dx, co(0, 1, 0), co(1, 1, 0))),
+                        Lerp(dy, Lerp(dx, co(0, 0, 1), co(1, 0, 1)), Lerp(dx, co(0, 1, 1), co(1, 1, 1))));
+        }
+        return RGBSigmoidPolynomial(c[0], c[1], c[2]);
+    }
+}
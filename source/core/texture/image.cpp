@@ -0,0 +1,249 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/texture/image.h"
+#include "util/file.h"
+#include "util/profile.h"
+
+#include <png.h>
+
+#define TINYEXR_USE_MINIZ 0
+#include <zlib.h>
+#define TINYEXR_IMPLEMENTATION
+#include <tinyexr.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace jadehare {
+
+#pragma region Image File Readers
+
+    static Image ReadPNG(const std::string &filename) {
+        png_image png;
+        std::memset(&png, 0, sizeof(png));
+        png.version = PNG_IMAGE_VERSION;
+        if (!png_image_begin_read_from_file(&png, filename.c_str()))
+            throw std::runtime_error(filename + ": " + png.message);
+
+        bool hasAlpha = png.format & PNG_FORMAT_FLAG_ALPHA;
+        bool isColor = png.format & PNG_FORMAT_FLAG_COLOR;
+        png.format = isColor ? (hasAlpha ? PNG_FORMAT_RGBA : PNG_FORMAT_RGB)
+                             : (hasAlpha ? PNG_FORMAT_GA : PNG_FORMAT_GRAY);
+        int nChannels = PNG_IMAGE_SAMPLE_CHANNELS(png.format);
+
+        // PNGs are stored sRGB-encoded; keep them that way at 8 bits.
+        Image image(Point2i(int(png.width), int(png.height)), nChannels, TexelFormat::U256, true);
+        if (!png_image_finish_read(&png, nullptr, const_cast<void *>(image.RawPointer(Point2i(0, 0))), 0, nullptr)) {
+            png_image_free(&png);
+            throw std::runtime_error(filename + ": " + png.message);
+        }
+        return image;
+    }
+
+    static Image ReadEXR(const std::string &filename) {
+        float *rgba = nullptr;
+        int width, height;
+        const char *err = nullptr;
+        if (LoadEXR(&rgba, &width, &height, filename.c_str(), &err) != TINYEXR_SUCCESS) {
+            std::string message = filename + ": " + (err ? err : "unable to read EXR");
+            FreeEXRErrorMessage(err);
+            throw std::runtime_error(message);
+        }
+
+        Image image(Point2i(width, height), 4, TexelFormat::Float);
+        std::memcpy(const_cast<void *>(image.RawPointer(Point2i(0, 0))), rgba,
+                    sizeof(float) * 4 * size_t(width) * height);
+        std::free(rgba);
+        return image;
+    }
+
+    static Image ReadPFM(const std::string &filename) {
+        std::unique_ptr<MappedFile> file = MappedFile::Open(filename, MappedFile::Access::Sequential);
+        std::string_view contents = file->View();
+
+        // Read the three whitespace-separated header words
+        std::string words[4];
+        size_t pos = 0;
+        for (int i = 0; i < 4; ++i) {
+            while (pos < contents.size() && std::isspace((unsigned char) contents[pos]))
+                ++pos;
+            while (pos < contents.size() && !std::isspace((unsigned char) contents[pos]))
+                words[i] += contents[pos++];
+        }
+        // Exactly one whitespace character separates the header from the data
+        ++pos;
+
+        int nChannels;
+        if (words[0] == "PF")
+            nChannels = 3;
+        else if (words[0] == "Pf")
+            nChannels = 1;
+        else
+            throw std::runtime_error(filename + ": not a PFM file");
+        int width = std::atoi(words[1].c_str()), height = std::atoi(words[2].c_str());
+        float scale = float(std::atof(words[3].c_str()));
+        bool fileLittleEndian = scale < 0;
+        const bool hostLittleEndian = [] {
+            uint32_t v = 1;
+            uint8_t b;
+            std::memcpy(&b, &v, 1);
+            return b == 1;
+        }();
+
+        size_t nFloats = size_t(nChannels) * width * height;
+        if (width <= 0 || height <= 0 || pos + 4 * nFloats > contents.size())
+            throw std::runtime_error(filename + ": truncated PFM file");
+
+        Image image(Point2i(width, height), nChannels, TexelFormat::Float);
+        const uint8_t *data = file->Data() + pos;
+        float absScale = std::abs(scale);
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x)
+                for (int c = 0; c < nChannels; ++c) {
+                    uint32_t bits;
+                    // PFM scanlines are stored bottom-to-top.
+                    std::memcpy(&bits, data + 4 * ((size_t(height - 1 - y) * width + x) * nChannels + c), 4);
+                    if (fileLittleEndian != hostLittleEndian)
+                        bits = (bits >> 24) | ((bits >> 8) & 0xff00) | ((bits << 8) & 0xff0000) | (bits << 24);
+                    image.SetChannel(Point2i(x, y), c, BitsToFloat(bits) * absScale);
+                }
+        return image;
+    }
+
+#pragma endregion Image File Readers
+
+#pragma region Image File Writers
+
+    static void WritePNG(const Image &image, const std::string &filename) {
+        // PNGs hold sRGB-encoded 8-bit values; Write() converts to that first.
+        png_image png;
+        std::memset(&png, 0, sizeof(png));
+        png.version = PNG_IMAGE_VERSION;
+        png.width = image.Resolution().x;
+        png.height = image.Resolution().y;
+        png.format = image.NChannels() == 1 ? PNG_FORMAT_GRAY
+                                            : image.NChannels() == 2 ? PNG_FORMAT_GA
+                                                                     : image.NChannels() == 3 ? PNG_FORMAT_RGB
+                                                                                              : PNG_FORMAT_RGBA;
+        if (!png_image_write_to_file(&png, filename.c_str(), 0, image.RawPointer(Point2i(0, 0)), 0, nullptr))
+            throw std::runtime_error(filename + ": " + png.message);
+    }
+
+    static void WriteEXR(const Image &image, const std::string &filename) {
+        const char *err = nullptr;
+        if (SaveEXR(static_cast<const float *>(image.RawPointer(Point2i(0, 0))), image.Resolution().x,
+                    image.Resolution().y, image.NChannels(), 0, filename.c_str(), &err) != TINYEXR_SUCCESS) {
+            std::string message = filename + ": " + (err ? err : "unable to write EXR");
+            FreeEXRErrorMessage(err);
+            throw std::runtime_error(message);
+        }
+    }
+
+    static void WritePFM(const Image &image, const std::string &filename) {
+        FILE *f = std::fopen(filename.c_str(), "wb");
+        if (!f)
+            throw std::runtime_error(filename + ": " + std::strerror(errno));
+        // PFM only has one and three channel variants; the sign of the scale
+        // gives the byte order, for which the host's is used.
+        int nChannels = image.NChannels() == 1 ? 1 : 3;
+        Point2i res = image.Resolution();
+        uint32_t one = 1;
+        uint8_t lowByte;
+        std::memcpy(&lowByte, &one, 1);
+        std::fprintf(f, "%s\n%d %d\n%s\n", nChannels == 1 ? "Pf" : "PF", res.x, res.y, lowByte ? "-1" : "1");
+        std::vector<float> scanline(size_t(nChannels) * res.x);
+        bool ok = true;
+        for (int y = res.y - 1; y >= 0 && ok; --y) {
+            for (int x = 0; x < res.x; ++x)
+                for (int c = 0; c < nChannels; ++c)
+                    scanline[size_t(x) * nChannels + c] =
+                            image.GetChannel(Point2i(x, y), std::min(c, image.NChannels() - 1));
+            ok = std::fwrite(scanline.data(), sizeof(float), scanline.size(), f) == scanline.size();
+        }
+        if (std::fclose(f) != 0 || !ok)
+            throw std::runtime_error(filename + ": unable to write PFM file");
+    }
+
+#pragma endregion Image File Writers
+
+#pragma region Image
+
+    Image::Image(Point2i resolution, int nChannels, TexelFormat format, bool sRGB)
+            : resolution(resolution), nChannels(nChannels), format(format),
+              sRGB(format == TexelFormat::U256 && sRGB) {
+        size_t n = size_t(nChannels) * resolution.x * resolution.y;
+        if (format == TexelFormat::U256)
+            p8.resize(n);
+        else
+            p32.resize(n);
+    }
+
+    Image Image::Read(const std::string &filename) {
+        PROFILE_SCOPE("Read image");
+        std::string ext = FileExtension(filename);
+        if (ext == "png")
+            return ReadPNG(filename);
+        else if (ext == "exr")
+            return ReadEXR(filename);
+        else if (ext == "pfm")
+            return ReadPFM(filename);
+        throw std::runtime_error(filename + ": unsupported image file format");
+    }
+
+    void Image::Write(const std::string &filename) const {
+        PROFILE_SCOPE("Write image");
+        std::string ext = FileExtension(filename);
+        if (ext == "png")
+            WritePNG(ConvertToFormat(TexelFormat::U256, true), filename);
+        else if (ext == "exr")
+            WriteEXR(ConvertToFormat(TexelFormat::Float, false), filename);
+        else if (ext == "pfm")
+            WritePFM(*this, filename);
+        else
+            throw std::runtime_error(filename + ": unsupported image file format");
+    }
+
+    Image Image::ConvertToFormat(TexelFormat newFormat, bool newSRGB) const {
+        if (newFormat == format && (newFormat == TexelFormat::Float || newSRGB == sRGB))
+            return *this;
+        Image image(resolution, nChannels, newFormat, newSRGB);
+        for (int y = 0; y < resolution.y; ++y)
+            for (int x = 0; x < resolution.x; ++x)
+                for (int c = 0; c < nChannels; ++c)
+                    image.SetChannel(Point2i(x, y), c, GetChannel(Point2i(x, y), c));
+        return image;
+    }
+
+    std::vector<Image> Image::GeneratePyramid() const {
+        std::vector<Image> levels;
+        levels.push_back(ConvertToFormat(TexelFormat::Float, false));
+        while (levels.back().resolution.x > 1 || levels.back().resolution.y > 1) {
+            const Image &prev = levels.back();
+            Point2i res(std::max(1, (prev.resolution.x + 1) / 2), std::max(1, (prev.resolution.y + 1) / 2));
+            Image next(res, nChannels, TexelFormat::Float);
+            // 2x2 box filter; the last row and column of odd-sized levels
+            // are clamped, i.e. averaged with themselves.
+            for (int y = 0; y < res.y; ++y)
+                for (int x = 0; x < res.x; ++x) {
+                    int x0 = 2 * x, x1 = std::min(2 * x + 1, prev.resolution.x - 1);
+                    int y0 = 2 * y, y1 = std::min(2 * y + 1, prev.resolution.y - 1);
+                    for (int c = 0; c < nChannels; ++c)
+                        next.SetChannel(Point2i(x, y), c,
+                                        0.25f * (prev.GetChannel(Point2i(x0, y0), c) +
+                                                 prev.GetChannel(Point2i(x1, y0), c) +
+                                                 prev.GetChannel(Point2i(x0, y1), c) +
+                                                 prev.GetChannel(Point2i(x1, y1), c)));
+                }
+            levels.push_back(std::move(next));
+        }
+        return levels;
+    }
+
+#pragma endregion Image
+}
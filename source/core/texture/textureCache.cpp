@@ -0,0 +1,229 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/texture/textureCache.h"
+#include "util/hash.h"
+#include "util/log.h"
+#include "util/profile.h"
+#include "util/stats.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace jadehare {
+
+    STAT_PERCENT("Texture/Tile cache hits", nTileHits, nTileLookups);
+    STAT_COUNTER("Texture/Tiles loaded", nTilesLoaded);
+    STAT_MEMORY_COUNTER("Memory/Texture tile cache", tileCacheBytes);
+
+#pragma region TextureCache
+
+    TextureCache::TextureCache(size_t maxBytes, size_t tileBytes, int nShards)
+            : slotBytes(tileBytes), shards(nShards) {
+        DCHECK(IsPowerOf2(nShards));
+        // Each shard needs a few slots so that pinned tiles can't starve it.
+        nSlots = std::max<int>(int(maxBytes / slotBytes), 4 * nShards);
+        slots.reset(new TileSlot[nSlots]);
+        pool = static_cast<uint8_t *>(std::malloc(size_t(nSlots) * slotBytes));
+        if (!pool)
+            throw std::runtime_error("TextureCache: unable to allocate tile pool");
+        tileCacheBytes += int64_t(nSlots) * slotBytes;
+
+        int first = 0;
+        for (int i = 0; i < nShards; ++i) {
+            int last = int((int64_t(nSlots) * (i + 1)) / nShards);
+            Shard &shard = shards[i];
+            shard.slots = &slots[first];
+            shard.nSlots = last - first;
+            shard.map.reserve(shard.nSlots);
+            for (int j = first; j < last; ++j)
+                slots[j].data = pool + size_t(j) * slotBytes;
+            first = last;
+        }
+    }
+
+    TextureCache::~TextureCache() {
+        std::free(pool);
+    }
+
+    int TextureCache::AddTexture(TiledTextureDesc desc) {
+        if (desc.TileBytes() > slotBytes)
+            throw std::runtime_error(desc.name + ": texture tiles are larger than the cache's tile slots");
+        if (desc.Levels() == 0 || !desc.loadTile)
+            throw std::runtime_error(desc.name + ": incomplete tiled texture description");
+
+        textures.push_back(std::make_unique<TiledTextureDesc>(std::move(desc)));
+        return int(textures.size()) - 1;
+    }
+
+    TextureCache::TileSlot *TextureCache::FindVictim(Shard &shard) {
+        // Sweep the clock hand at most twice around the shard: the first
+        // pass clears reference bits, the second is then guaranteed to
+        // find any slot that isn't pinned.
+        for (int i = 0; i < 2 * shard.nSlots; ++i) {
+            TileSlot *slot = &shard.slots[shard.clockHand];
+            shard.clockHand = (shard.clockHand + 1) % shard.nSlots;
+
+            if (slot->pins.load(std::memory_order_acquire) > 0)
+                continue;
+            if (slot->referenced.exchange(false, std::memory_order_relaxed))
+                continue;
+            return slot;
+        }
+        return nullptr;
+    }
+
+    TextureCache::TileHandle TextureCache::Acquire(int textureId, int level, Point2i tile) {
+        uint64_t key = TileKey(textureId, level, tile);
+        Shard &shard = shards[MixBits(key) & (shards.size() - 1)];
+
+        TileSlot *slot = nullptr;
+        bool mustLoad = false;
+        ++nTileLookups;
+        while (!slot) {
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            auto iter = shard.map.find(key);
+            if (iter != shard.map.end()) {
+                slot = iter->second;
+                slot->pins.fetch_add(1, std::memory_order_acquire);
+                slot->referenced.store(true, std::memory_order_relaxed);
+                ++nTileHits;
+                break;
+            }
+
+            // Tile miss; recycle the slot chosen by the clock.
+            slot = FindVictim(shard);
+            if (!slot) {
+                // Every tile in the shard is pinned right now; let the
+                // other readers finish.
+                lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+            if (slot->state.load(std::memory_order_relaxed) != SlotState::Empty)
+                shard.map.erase(slot->key);
+            slot->key = key;
+            slot->pins.store(1, std::memory_order_relaxed);
+            slot->referenced.store(true, std::memory_order_relaxed);
+            slot->state.store(SlotState::Loading, std::memory_order_relaxed);
+            shard.map[key] = slot;
+            mustLoad = true;
+        }
+
+        if (mustLoad) {
+            // Load outside the shard lock so that I/O only ever blocks
+            // threads that want this very tile.
+            PROFILE_SCOPE("Load texture tile", textureId);
+            const TiledTextureDesc &desc = Texture(textureId);
+            ++nTilesLoaded;
+            if (!desc.loadTile(level, tile, slot->data)) {
+                LOG_ERROR("%s: failed to load tile (%d, %d) of level %d", desc.name.c_str(), tile.x, tile.y,
+                          level);
+                std::memset(slot->data, 0, desc.TileBytes());
+            }
+            slot->state.store(SlotState::Ready, std::memory_order_release);
+        } else {
+            while (slot->state.load(std::memory_order_acquire) != SlotState::Ready)
+                std::this_thread::yield();
+        }
+
+        return TileHandle(slot);
+    }
+
+    RGB TextureCache::DecodeTexel(const TiledTextureDesc &desc, const uint8_t *tileData, Point2i inTile) const {
+        size_t offset = (size_t(inTile.y) * desc.tileSize + inTile.x) * desc.nChannels;
+        float v[3];
+        for (int c = 0; c < 3; ++c) {
+            int ch = std::min(c, desc.nChannels - 1);
+            if (desc.format == TexelFormat::U256) {
+                uint8_t u = tileData[offset + ch];
+                v[c] = desc.sRGB ? SRGB8ToLinear(u) : u / 255.f;
+            } else {
+                std::memcpy(&v[c], tileData + 4 * (offset + ch), sizeof(float));
+            }
+        }
+        return {v[0], v[1], v[2]};
+    }
+
+    RGB TextureCache::Texel(int textureId, int level, Point2i st) {
+        const TiledTextureDesc &desc = Texture(textureId);
+        const Point2i &res = desc.levelResolution[level];
+        st = Point2i(Clamp(st.x, 0, res.x - 1), Clamp(st.y, 0, res.y - 1));
+
+        Point2i tile(st.x / desc.tileSize, st.y / desc.tileSize);
+        TileHandle handle = Acquire(textureId, level, tile);
+        return DecodeTexel(desc, handle.Data(), Point2i(st.x % desc.tileSize, st.y % desc.tileSize));
+    }
+
+    RGB TextureCache::Bilerp(int textureId, int level, Point2f st) {
+        const TiledTextureDesc &desc = Texture(textureId);
+        const Point2i &res = desc.levelResolution[level];
+        float x = st.x * res.x - 0.5f, y = st.y * res.y - 0.5f;
+        int xi = int(std::floor(x)), yi = int(std::floor(y));
+        float dx = x - xi, dy = y - yi;
+
+        // Fetch the four texels, reusing the tile handle when they share a tile
+        RGB v[4];
+        TileHandle handle;
+        Point2i heldTile(-1, -1);
+        for (int i = 0; i < 4; ++i) {
+            Point2i p(Clamp(xi + (i & 1), 0, res.x - 1), Clamp(yi + (i >> 1), 0, res.y - 1));
+            Point2i tile(p.x / desc.tileSize, p.y / desc.tileSize);
+            if (tile != heldTile) {
+                // Unpin the previous tile first; threads that each held one
+                // pin while waiting for a slot in a fully pinned shard would
+                // otherwise wait on each other forever
+                handle = TileHandle();
+                handle = Acquire(textureId, level, tile);
+                heldTile = tile;
+            }
+            v[i] = DecodeTexel(desc, handle.Data(), Point2i(p.x % desc.tileSize, p.y % desc.tileSize));
+        }
+        return ((1 - dx) * (1 - dy)) * v[0] + (dx * (1 - dy)) * v[1] +
+               ((1 - dx) * dy) * v[2] + (dx * dy) * v[3];
+    }
+
+    size_t TextureCache::ResidentTiles() const {
+        size_t n = 0;
+        for (int i = 0; i < nSlots; ++i)
+            if (slots[i].state.load(std::memory_order_relaxed) == SlotState::Ready)
+                ++n;
+        return n;
+    }
+
+#pragma endregion TextureCache
+
+#pragma region CachedMIPMap
+
+    float CachedMIPMap::Level(Vector2f dst0, Vector2f dst1) const {
+        // Compute MIP Map level for _width_ and handle very wide filter
+        float width = 2 * std::max({std::abs(dst0.x), std::abs(dst0.y),
+                                    std::abs(dst1.x), std::abs(dst1.y)});
+        // Levels are counted from the finest one, whose footprint is
+        // 1 / max(resolution) in $[0,1]$ texture space.
+        const Point2i &res = cache->Texture(textureId).levelResolution[0];
+        return std::max(0.f, Log2(std::max(width, 1e-8f) * std::max(res.x, res.y)));
+    }
+
+    RGB CachedMIPMap::Filter(Point2f st, Vector2f dst0, Vector2f dst1) const {
+        int nLevels = Levels();
+        float level = Level(dst0, dst1);
+        if (level >= nLevels - 1)
+            return Bilerp(nLevels - 1, st);
+
+        int iLevel = int(std::floor(level));
+        float delta = level - iLevel;
+        if (delta == 0)
+            return Bilerp(iLevel, st);
+        // Trilinear filtering between the two nearest levels
+        return Lerp(delta, Bilerp(iLevel, st), Bilerp(iLevel + 1, st));
+    }
+
+    RGB CachedMIPMap::Bilerp(int level, Point2f st) const {
+        return cache->Bilerp(textureId, level, st);
+    }
+
+#pragma endregion CachedMIPMap
+}
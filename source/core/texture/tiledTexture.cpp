@@ -0,0 +1,151 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/texture/tiledTexture.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace jadehare {
+
+    static uint64_t RoundUpToPage(uint64_t offset) {
+        return (offset + TiledTexturePageSize - 1) & ~uint64_t(TiledTexturePageSize - 1);
+    }
+
+    void WriteTiledTexture(const Image &image, const std::string &filename,
+                           const TiledTextureConversionOptions &options) {
+        if (!IsPowerOf2(options.tileSize) || options.tileSize > int(TiledTextureMaxTileSize))
+            throw std::runtime_error(filename + ": tile size must be a power of two no larger than " +
+                                     std::to_string(TiledTextureMaxTileSize));
+
+        int nChannels = image.NChannels();
+        if (options.dropAlpha && nChannels == 4)
+            nChannels = 3;
+        std::vector<Image> pyramid = image.GeneratePyramid();
+        if (pyramid.size() > TiledTextureMaxLevels)
+            throw std::runtime_error(filename + ": image is too large");
+
+        // Lay out the header and the page-aligned tiles of each level
+        TiledTextureHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, TiledTextureMagic, sizeof(header.magic));
+        header.version = TiledTextureVersion;
+        header.pageSize = TiledTexturePageSize;
+        header.nChannels = nChannels;
+        header.format = uint32_t(options.format);
+        header.sRGB = options.format == TexelFormat::U256;
+        header.tileSize = options.tileSize;
+        header.nLevels = uint32_t(pyramid.size());
+        size_t tileBytes = size_t(options.tileSize) * options.tileSize * nChannels * TexelBytes(options.format);
+        header.tileStride = RoundUpToPage(tileBytes);
+
+        uint64_t offset = TiledTexturePageSize;
+        for (size_t level = 0; level < pyramid.size(); ++level) {
+            TiledTextureLevel &l = header.levels[level];
+            Point2i res = pyramid[level].Resolution();
+            l.width = res.x;
+            l.height = res.y;
+            l.tilesX = (res.x + options.tileSize - 1) / options.tileSize;
+            l.tilesY = (res.y + options.tileSize - 1) / options.tileSize;
+            l.firstTileOffset = offset;
+            offset += uint64_t(l.tilesX) * l.tilesY * header.tileStride;
+        }
+
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        if (!out)
+            throw std::runtime_error(filename + ": unable to open for writing");
+        std::vector<uint8_t> page(TiledTexturePageSize, 0);
+        std::memcpy(page.data(), &header, sizeof(header));
+        out.write(reinterpret_cast<const char *>(page.data()), page.size());
+
+        // Quantize each tile into a zero-padded buffer and write it out
+        std::vector<uint8_t> tile(header.tileStride);
+        for (size_t level = 0; level < pyramid.size(); ++level) {
+            const Image &img = pyramid[level];
+            const TiledTextureLevel &l = header.levels[level];
+            for (int ty = 0; ty < l.tilesY; ++ty)
+                for (int tx = 0; tx < l.tilesX; ++tx) {
+                    std::fill(tile.begin(), tile.end(), 0);
+                    for (int y = 0; y < options.tileSize; ++y)
+                        for (int x = 0; x < options.tileSize; ++x) {
+                            Point2i p(std::min(tx * options.tileSize + x, l.width - 1),
+                                      std::min(ty * options.tileSize + y, l.height - 1));
+                            size_t texel = (size_t(y) * options.tileSize + x) * nChannels;
+                            for (int c = 0; c < nChannels; ++c) {
+                                float v = img.GetChannel(p, c);
+                                if (options.format == TexelFormat::U256)
+                                    tile[texel + c] = LinearToSRGB8(v);
+                                else
+                                    std::memcpy(&tile[4 * (texel + c)], &v, sizeof(float));
+                            }
+                        }
+                    out.write(reinterpret_cast<const char *>(tile.data()), tile.size());
+                }
+        }
+        if (!out)
+            throw std::runtime_error(filename + ": error writing tiled texture");
+    }
+
+    void ConvertToTiledTexture(const std::string &inFilename, const std::string &outFilename,
+                               const TiledTextureConversionOptions &options) {
+        WriteTiledTexture(Image::Read(inFilename), outFilename, options);
+    }
+
+    std::unique_ptr<TiledTextureFile> TiledTextureFile::Open(const std::string &filename) {
+        std::unique_ptr<TiledTextureFile> tex(new TiledTextureFile);
+        // Lookups are scattered, so don't let the kernel read ahead.
+        tex->file = MappedFile::Open(filename, MappedFile::Access::Random);
+        if (tex->file->Size() < TiledTexturePageSize)
+            throw std::runtime_error(filename + ": not a tiled texture");
+        tex->header = reinterpret_cast<const TiledTextureHeader *>(tex->file->Data());
+
+        const TiledTextureHeader &h = *tex->header;
+        if (std::memcmp(h.magic, TiledTextureMagic, sizeof(h.magic)) != 0)
+            throw std::runtime_error(filename + ": not a tiled texture");
+        if (h.version != TiledTextureVersion)
+            throw std::runtime_error(filename + ": unsupported tiled texture version " + std::to_string(h.version));
+        if (h.nLevels == 0 || h.nLevels > TiledTextureMaxLevels || h.nChannels == 0 || h.nChannels > 4 ||
+            !IsPowerOf2(h.tileSize) || h.tileSize > TiledTextureMaxTileSize || h.format > uint32_t(TexelFormat::Float))
+            throw std::runtime_error(filename + ": corrupt tiled texture header");
+        uint64_t tileBytes = uint64_t(h.tileSize) * h.tileSize * h.nChannels * TexelBytes(TexelFormat(h.format));
+        if (h.tileStride < tileBytes)
+            throw std::runtime_error(filename + ": corrupt tiled texture header");
+
+        // Every tile of every level must lie inside the mapping; the cache
+        // derives the tile counts from the level resolutions, so those must
+        // agree with the stored ones as well
+        uint64_t size = tex->file->Size();
+        for (uint32_t level = 0; level < h.nLevels; ++level) {
+            const TiledTextureLevel &l = h.levels[level];
+            if (l.width <= 0 || l.height <= 0 ||
+                l.tilesX != (int64_t(l.width) + h.tileSize - 1) / h.tileSize ||
+                l.tilesY != (int64_t(l.height) + h.tileSize - 1) / h.tileSize)
+                throw std::runtime_error(filename + ": corrupt tiled texture level " + std::to_string(level));
+            uint64_t nTiles = uint64_t(l.tilesX) * uint64_t(l.tilesY);
+            if (l.firstTileOffset < TiledTexturePageSize || l.firstTileOffset > size ||
+                nTiles > (size - l.firstTileOffset) / h.tileStride)
+                throw std::runtime_error(filename + ": truncated tiled texture");
+        }
+        return tex;
+    }
+
+    TiledTextureDesc TiledTextureFile::Desc() const {
+        TiledTextureDesc desc;
+        desc.name = file->Filename();
+        for (int level = 0; level < Levels(); ++level)
+            desc.levelResolution.push_back(LevelResolution(level));
+        desc.nChannels = int(header->nChannels);
+        desc.tileSize = int(header->tileSize);
+        desc.format = TexelFormat(header->format);
+        desc.sRGB = header->sRGB != 0;
+        size_t tileBytes = desc.TileBytes();
+        desc.loadTile = [this, tileBytes](int level, Point2i tile, void *dst) {
+            std::memcpy(dst, Tile(level, tile), tileBytes);
+            return true;
+        };
+        return desc;
+    }
+}
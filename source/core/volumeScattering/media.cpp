@@ -0,0 +1,119 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/volumeScattering/media.h"
+#include "core/volumeScattering/sparseGrid.h"
+#include "util/parallel.h"
+
+namespace jadehare {
+
+    float SampledGrid::MaxValue(const Bounds3f &bounds) const {
+        // Find the range of samples that contribute to lookups inside bounds
+        float p0[3] = {bounds.pMin.x * nx - .5f, bounds.pMin.y * ny - .5f, bounds.pMin.z * nz - .5f};
+        float p1[3] = {bounds.pMax.x * nx - .5f, bounds.pMax.y * ny - .5f, bounds.pMax.z * nz - .5f};
+        int n[3] = {nx, ny, nz}, lo[3], hi[3];
+        for (int i = 0; i < 3; ++i) {
+            lo[i] = std::max(int(std::floor(p0[i])), 0);
+            hi[i] = std::min(int(std::floor(p1[i])) + 1, n[i] - 1);
+        }
+
+        float maxValue = Lookup(lo[0], lo[1], lo[2]);
+        for (int z = lo[2]; z <= hi[2]; ++z)
+            for (int y = lo[1]; y <= hi[1]; ++y)
+                for (int x = lo[0]; x <= hi[0]; ++x)
+                    maxValue = std::max(maxValue, Lookup(x, y, z));
+        return maxValue;
+    }
+
+    std::vector<float> MajorantGrid::Compute(const SampledGrid &density, int res) {
+        std::vector<float> voxels(size_t(res) * res * res);
+        ParallelFor(0, res, [&](int64_t z) {
+            for (int y = 0; y < res; ++y)
+                for (int x = 0; x < res; ++x) {
+                    Bounds3f bounds(Point3f(float(x) / res, float(y) / res, float(z) / res),
+                                    Point3f(float(x + 1) / res, float(y + 1) / res, float(z + 1) / res));
+                    voxels[(size_t(z) * res + y) * res + x] = density.MaxValue(bounds);
+                }
+        });
+        return voxels;
+    }
+
+    std::vector<float> MajorantGrid::Compute(const SparseGrid &density, const Bounds3f &bounds, int res) {
+        std::vector<float> voxels(size_t(res) * res * res);
+        ParallelFor(0, res, [&](int64_t z) {
+            for (int y = 0; y < res; ++y)
+                for (int x = 0; x < res; ++x) {
+                    // Find the index-space voxels trilinear lookups in this
+                    // voxel may touch
+                    Point3f p0 = density.MediumToIndex(bounds.Lerp(Point3f(float(x) / res, float(y) / res,
+                                                                             float(z) / res)));
+                    Point3f p1 = density.MediumToIndex(bounds.Lerp(Point3f(float(x + 1) / res, float(y + 1) / res,
+                                                                             float(z + 1) / res)));
+                    int lo[3], hi[3];
+                    for (int a = 0; a < 3; ++a) {
+                        lo[a] = int(std::floor(std::min(p0[a], p1[a])));
+                        hi[a] = int(std::floor(std::max(p0[a], p1[a]))) + 1;
+                    }
+                    voxels[(size_t(z) * res + y) * res + x] = density.MaxValue(lo, hi);
+                }
+        });
+        return voxels;
+    }
+
+    RayMajorantIterator GridMedium::SampleRay(const Ray &r, float raytMax) const {
+        // Clip the medium-space ray to the grid's bounds
+        Ray ray = renderFromMedium.ApplyInverse(r);
+        float tMin, tMax;
+        if (!bounds.IntersectP(ray.o, ray.d, raytMax, &tMin, &tMax))
+            return HomogeneousMajorantIterator();
+        return DDAMajorantIterator(ray, tMin, tMax, &majorantGrid, sigma_a + sigma_s);
+    }
+
+    MediumProperties SparseGridMedium::SamplePoint(Point3f p) const {
+        p = renderFromMedium.ApplyInverse(p);
+        float d = density->Lookup(density->MediumToIndex(p));
+        RGB Le;
+        if (temperature && LeScale > 0) {
+            float temp = (temperature->Lookup(temperature->MediumToIndex(p)) - temperatureOffset) * temperatureScale;
+            if (temp > 100.f)
+                Le = LeScale * BlackbodyRGB(temp);
+        }
+        return {sigma_a * d, sigma_s * d, phase, Le};
+    }
+
+    RayMajorantIterator SparseGridMedium::SampleRay(const Ray &r, float raytMax) const {
+        Ray ray = renderFromMedium.ApplyInverse(r);
+        float tMin, tMax;
+        if (!majorantGrid.Bounds().IntersectP(ray.o, ray.d, raytMax, &tMin, &tMax))
+            return HomogeneousMajorantIterator();
+        return DDAMajorantIterator(ray, tMin, tMax, &majorantGrid, sigma_a + sigma_s);
+    }
+
+    RGB RatioTrackingTransmittance(const Ray &ray, float tMax, RNG &rng) {
+        RGB T_ray(1, 1, 1);
+        RGB T_maj = SampleT_maj(ray, tMax, rng.Uniform<float>(), rng,
+                                [&](const Point3f &p, const MediumProperties &mp, const RGB &sigma_maj,
+                                    const RGB &T_maj) {
+                                    // Weight by the probability of a null collision
+                                    RGB sigma_n = ClampZero(sigma_maj - mp.sigma_a - mp.sigma_s);
+                                    float pdf = T_maj[0] * sigma_maj[0];
+                                    T_ray *= T_maj * sigma_n / pdf;
+                                    if (T_ray.IsBlack())
+                                        return false;
+
+                                    // Russian roulette once the estimate gets small
+                                    if (T_ray.MaxComponentValue() < 0.05f) {
+                                        if (rng.Uniform<float>() < 0.75f) {
+                                            T_ray = RGB(0, 0, 0);
+                                            return false;
+                                        }
+                                        T_ray *= 1 / 0.25f;
+                                    }
+                                    return true;
+                                });
+        if (T_ray.IsBlack())
+            return T_ray;
+        return T_ray * T_maj / T_maj[0];
+    }
+}
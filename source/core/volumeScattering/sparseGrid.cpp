@@ -0,0 +1,419 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "core/volumeScattering/sparseGrid.h"
+#include "util/parallel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace jadehare {
+
+#pragma region SparseGrid
+
+    static constexpr int SparseLeafDim = 1 << SparseLeafLog2Dim;
+    static constexpr int SparseInternalSpan = 1 << SparseInternalLog2Span;
+
+    SparseGrid::SparseGrid(const uint8_t *base, const SparseGridHeader *header)
+            : header(header),
+              roots(reinterpret_cast<const SparseGridRoot *>(base + header->rootOffset), header->nRoots),
+              internalNodes(reinterpret_cast<const SparseGridInternal *>(base + header->internalOffset),
+                            header->nInternalNodes),
+              leaves(reinterpret_cast<const SparseGridLeaf *>(base + header->leafOffset), header->nLeaves) {}
+
+    std::string_view SparseGrid::Name() const {
+        return {header->name, strnlen(header->name, SparseGridMaxNameLength)};
+    }
+
+    float SparseGrid::Find(int x, int y, int z, const SparseGridLeaf **leaf) const {
+        *leaf = nullptr;
+        uint64_t key = RootKey(x, y, z);
+        const SparseGridRoot *root = std::lower_bound(roots.begin(), roots.end(), key,
+                                                      [](const SparseGridRoot &r, uint64_t k) { return r.key < k; });
+        if (root == roots.end() || root->key != key)
+            return header->background;
+
+        const SparseGridInternal &node = internalNodes[root->internalIndex];
+        int n = ChildIndex(x, y, z);
+        if (!((node.childMask[n >> 6] >> (n & 63)) & 1))
+            return BitsToFloat(node.children[n]);
+        *leaf = &leaves[node.children[n]];
+        return (*leaf)->values[VoxelIndex(x, y, z)];
+    }
+
+    float SparseGrid::Lookup(const Point3f &pIndex) const {
+        float fx = std::floor(pIndex.x), fy = std::floor(pIndex.y), fz = std::floor(pIndex.z);
+        int ix = int(fx), iy = int(fy), iz = int(fz);
+        float dx = pIndex.x - fx, dy = pIndex.y - fy, dz = pIndex.z - fz;
+
+        // Gather the eight samples, indexed by their (x, y, z) offset bits
+        float v[8];
+        constexpr int last = SparseLeafDim - 1;
+        if ((ix & last) != last && (iy & last) != last && (iz & last) != last) {
+            // All samples are in the same leaf or tile
+            const SparseGridLeaf *leaf;
+            float v0 = Find(ix, iy, iz, &leaf);
+            if (!leaf)
+                return v0;
+            const float *values = leaf->values + VoxelIndex(ix, iy, iz);
+            constexpr int dy1 = SparseLeafDim, dx1 = SparseLeafDim * SparseLeafDim;
+            v[0] = values[0];
+            v[1] = values[1];
+            v[2] = values[dy1];
+            v[3] = values[dy1 + 1];
+            v[4] = values[dx1];
+            v[5] = values[dx1 + 1];
+            v[6] = values[dx1 + dy1];
+            v[7] = values[dx1 + dy1 + 1];
+        } else {
+            // Straddles nodes; remember the last leaf found since most
+            // samples still share one
+            const SparseGridLeaf *cached = nullptr;
+            for (int i = 0; i < 8; ++i) {
+                int x = ix + (i >> 2), y = iy + ((i >> 1) & 1), z = iz + (i & 1);
+                if (cached && cached->origin[0] == (x & ~last) && cached->origin[1] == (y & ~last) &&
+                    cached->origin[2] == (z & ~last))
+                    v[i] = cached->values[VoxelIndex(x, y, z)];
+                else {
+                    const SparseGridLeaf *leaf;
+                    v[i] = Find(x, y, z, &leaf);
+                    if (leaf)
+                        cached = leaf;
+                }
+            }
+        }
+
+        float v00 = Lerp(dz, v[0], v[1]), v01 = Lerp(dz, v[2], v[3]);
+        float v10 = Lerp(dz, v[4], v[5]), v11 = Lerp(dz, v[6], v[7]);
+        return Lerp(dx, Lerp(dy, v00, v01), Lerp(dy, v10, v11));
+    }
+
+    float SparseGrid::MaxValue(const int lo[3], const int hi[3]) const {
+        // Anything not covered by a node reads as the background
+        float maxValue = header->background;
+        for (const SparseGridRoot &root : roots) {
+            const SparseGridInternal &node = internalNodes[root.internalIndex];
+            if (node.maxValue <= maxValue)
+                continue;
+            int nlo[3], nhi[3];
+            bool overlaps = true, covered = true;
+            for (int a = 0; a < 3; ++a) {
+                int o = node.origin[a], e = o + SparseInternalSpan - 1;
+                nlo[a] = std::max(lo[a], o) - o;
+                nhi[a] = std::min(hi[a], e) - o;
+                overlaps &= nlo[a] <= nhi[a];
+                covered &= lo[a] <= o && hi[a] >= e;
+            }
+            if (!overlaps)
+                continue;
+            if (covered) {
+                maxValue = node.maxValue;
+                continue;
+            }
+
+            // Visit the children that overlap the range
+            for (int cx = nlo[0] >> SparseLeafLog2Dim; cx <= nhi[0] >> SparseLeafLog2Dim; ++cx)
+                for (int cy = nlo[1] >> SparseLeafLog2Dim; cy <= nhi[1] >> SparseLeafLog2Dim; ++cy)
+                    for (int cz = nlo[2] >> SparseLeafLog2Dim; cz <= nhi[2] >> SparseLeafLog2Dim; ++cz) {
+                        int n = (cx << (2 * SparseInternalLog2Dim)) | (cy << SparseInternalLog2Dim) | cz;
+                        if ((node.childMask[n >> 6] >> (n & 63)) & 1)
+                            maxValue = std::max(maxValue, leaves[node.children[n]].maxValue);
+                        else
+                            maxValue = std::max(maxValue, BitsToFloat(node.children[n]));
+                    }
+        }
+        return maxValue;
+    }
+
+    Bounds3f SparseGrid::MediumBounds() const {
+        const int32_t *lo = header->indexMin, *hi = header->indexMax;
+        if (lo[0] > hi[0] || lo[1] > hi[1] || lo[2] > hi[2])
+            return {};
+        // Trilinear lookups ramp up within one voxel of the stored ones
+        return {IndexToMedium(Point3f(lo[0] - 1, lo[1] - 1, lo[2] - 1)),
+                IndexToMedium(Point3f(hi[0] + 1, hi[1] + 1, hi[2] + 1))};
+    }
+
+#pragma endregion SparseGrid
+
+#pragma region SparseGridFile
+
+    std::unique_ptr<SparseGridFile> SparseGridFile::Open(const std::string &filename) {
+        std::unique_ptr<SparseGridFile> grids(new SparseGridFile);
+        grids->file = MappedFile::Open(filename, MappedFile::Access::Random);
+        const uint8_t *base = grids->file->Data();
+        size_t size = grids->file->Size();
+
+        if (size < sizeof(SparseGridFileHeader) || std::memcmp(base, SparseGridMagic, sizeof(SparseGridMagic)) != 0)
+            throw std::runtime_error(filename + ": not a sparse grid file");
+        const SparseGridFileHeader &h = *reinterpret_cast<const SparseGridFileHeader *>(base);
+        if (h.version != SparseGridVersion)
+            throw std::runtime_error(filename + ": unsupported sparse grid version " + std::to_string(h.version));
+        if (h.nGrids > SparseGridMaxGrids)
+            throw std::runtime_error(filename + ": corrupt sparse grid file header");
+
+        auto inRange = [&](uint64_t offset, uint64_t count, size_t elementSize) {
+            return offset % SparseGridAlignment == 0 && offset <= size && count <= (size - offset) / elementSize;
+        };
+        for (uint32_t i = 0; i < h.nGrids; ++i) {
+            if (!inRange(h.gridOffsets[i], 1, sizeof(SparseGridHeader)))
+                throw std::runtime_error(filename + ": truncated sparse grid file");
+            auto gh = reinterpret_cast<const SparseGridHeader *>(base + h.gridOffsets[i]);
+            if (!inRange(gh->rootOffset, gh->nRoots, sizeof(SparseGridRoot)) ||
+                !inRange(gh->internalOffset, gh->nInternalNodes, sizeof(SparseGridInternal)) ||
+                !inRange(gh->leafOffset, gh->nLeaves, sizeof(SparseGridLeaf)))
+                throw std::runtime_error(filename + ": truncated sparse grid file");
+            if (gh->voxelSize[0] <= 0 || gh->voxelSize[1] <= 0 || gh->voxelSize[2] <= 0)
+                throw std::runtime_error(filename + ": grid has a degenerate voxel size");
+
+            // Lookups follow the node indices without checking them
+            auto roots = reinterpret_cast<const SparseGridRoot *>(base + gh->rootOffset);
+            for (uint32_t r = 0; r < gh->nRoots; ++r)
+                if (roots[r].internalIndex >= gh->nInternalNodes)
+                    throw std::runtime_error(filename + ": sparse grid node index out of range");
+            auto internalNodes = reinterpret_cast<const SparseGridInternal *>(base + gh->internalOffset);
+            for (uint32_t n = 0; n < gh->nInternalNodes; ++n) {
+                const SparseGridInternal &node = internalNodes[n];
+                for (int c = 0; c < int(std::size(node.children)); ++c)
+                    if (((node.childMask[c >> 6] >> (c & 63)) & 1) && node.children[c] >= gh->nLeaves)
+                        throw std::runtime_error(filename + ": sparse grid leaf index out of range");
+            }
+            grids->grids.emplace_back(base, gh);
+        }
+        return grids;
+    }
+
+    const SparseGrid *SparseGridFile::Grid(std::string_view name) const {
+        for (const SparseGrid &grid : grids)
+            if (grid.Name() == name)
+                return &grid;
+        return nullptr;
+    }
+
+#pragma endregion SparseGridFile
+
+#pragma region SparseGridBuilder
+
+    static uint64_t LeafKey(int x, int y, int z) {
+        auto k = [](int v) { return uint64_t(uint32_t(v >> SparseLeafLog2Dim)) & 0x1fffff; };
+        return (k(x) << 42) | (k(y) << 21) | k(z);
+    }
+
+    SparseGridBuilder::SparseGridBuilder(std::string name, float background)
+            : name(std::move(name)), background(background) {
+        if (this->name.size() >= SparseGridMaxNameLength)
+            throw std::runtime_error("\"" + this->name + "\": sparse grid name too long");
+    }
+
+    SparseGridBuilder SparseGridBuilder::FromDense(std::string name, span<const float> values, int nx, int ny,
+                                                   int nz, float background) {
+        if (values.size() != size_t(nx) * ny * nz)
+            throw std::runtime_error("\"" + name + "\": dense grid has the wrong number of values");
+        SparseGridBuilder builder(std::move(name), background);
+        builder.SetTransform(Vector3f(1.f / nx, 1.f / ny, 1.f / nz), Point3f(.5f / nx, .5f / ny, .5f / nz));
+        for (int z = 0; z < nz; ++z)
+            for (int y = 0; y < ny; ++y)
+                for (int x = 0; x < nx; ++x) {
+                    float v = values[(size_t(z) * ny + y) * nx + x];
+                    if (v != background)
+                        builder.Set(x, y, z, v);
+                }
+        return builder;
+    }
+
+    void SparseGridBuilder::Set(int x, int y, int z, float value) {
+        auto iter = leaves.find(LeafKey(x, y, z));
+        if (iter == leaves.end()) {
+            LeafData leaf;
+            constexpr int mask = ~(SparseLeafDim - 1);
+            leaf.origin[0] = x & mask;
+            leaf.origin[1] = y & mask;
+            leaf.origin[2] = z & mask;
+            leaf.activeMask.fill(0);
+            leaf.values.fill(background);
+            iter = leaves.emplace(LeafKey(x, y, z), leaf).first;
+        }
+        int v = SparseGrid::VoxelIndex(x, y, z);
+        iter->second.values[v] = value;
+        iter->second.activeMask[v >> 6] |= uint64_t(1) << (v & 63);
+    }
+
+    static uint64_t AlignSparseGridOffset(uint64_t offset) {
+        return (offset + SparseGridAlignment - 1) & ~uint64_t(SparseGridAlignment - 1);
+    }
+
+    void WriteSparseGrids(const std::string &filename, const std::vector<SparseGridBuilder> &builders) {
+        if (builders.size() > SparseGridMaxGrids)
+            throw std::runtime_error(filename + ": too many grids");
+
+        SparseGridFileHeader fileHeader;
+        std::memset(&fileHeader, 0, sizeof(fileHeader));
+        std::memcpy(fileHeader.magic, SparseGridMagic, sizeof(fileHeader.magic));
+        fileHeader.version = SparseGridVersion;
+        fileHeader.nGrids = uint32_t(builders.size());
+
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        if (!out)
+            throw std::runtime_error(filename + ": unable to open for writing");
+        uint64_t offset = 0;
+        auto pad = [&](uint64_t to) {
+            static const char zeros[SparseGridAlignment] = {};
+            out.write(zeros, std::streamsize(to - offset));
+            offset = to;
+        };
+        auto write = [&](const void *data, size_t size) {
+            out.write(reinterpret_cast<const char *>(data), std::streamsize(size));
+            offset += size;
+        };
+        // The file header is rewritten once the grid offsets are known
+        write(&fileHeader, sizeof(fileHeader));
+
+        for (size_t g = 0; g < builders.size(); ++g) {
+            const SparseGridBuilder &b = builders[g];
+            using LeafData = SparseGridBuilder::LeafData;
+
+            // Sort the leaves by internal node, then by child index
+            std::vector<const LeafData *> sorted;
+            sorted.reserve(b.leaves.size());
+            for (const auto &entry : b.leaves)
+                sorted.push_back(&entry.second);
+            auto sortKey = [](const LeafData *l) {
+                const int32_t *o = l->origin;
+                return std::make_pair(SparseGrid::RootKey(o[0], o[1], o[2]), SparseGrid::ChildIndex(o[0], o[1], o[2]));
+            };
+            std::sort(sorted.begin(), sorted.end(),
+                      [&](const LeafData *a, const LeafData *c) { return sortKey(a) < sortKey(c); });
+
+            // Compute each leaf's value range and active bounds in parallel
+            struct LeafStats {
+                float minValue, maxValue;
+                int32_t activeMin[3], activeMax[3];
+            };
+            std::vector<LeafStats> stats(sorted.size());
+            ParallelFor(0, int64_t(sorted.size()), [&](int64_t i) {
+                const LeafData &leaf = *sorted[i];
+                LeafStats &s = stats[i];
+                s.minValue = *std::min_element(leaf.values.begin(), leaf.values.end());
+                s.maxValue = *std::max_element(leaf.values.begin(), leaf.values.end());
+                for (int a = 0; a < 3; ++a) {
+                    s.activeMin[a] = std::numeric_limits<int32_t>::max();
+                    s.activeMax[a] = std::numeric_limits<int32_t>::lowest();
+                }
+                for (int v = 0; v < SparseLeafDim * SparseLeafDim * SparseLeafDim; ++v)
+                    if ((leaf.activeMask[v >> 6] >> (v & 63)) & 1) {
+                        int p[3] = {leaf.origin[0] + (v >> (2 * SparseLeafLog2Dim)),
+                                    leaf.origin[1] + ((v >> SparseLeafLog2Dim) & (SparseLeafDim - 1)),
+                                    leaf.origin[2] + (v & (SparseLeafDim - 1))};
+                        for (int a = 0; a < 3; ++a) {
+                            s.activeMin[a] = std::min(s.activeMin[a], p[a]);
+                            s.activeMax[a] = std::max(s.activeMax[a], p[a]);
+                        }
+                    }
+            });
+
+            // Build the root entries and internal nodes; uniform leaves become tiles
+            SparseGridHeader header;
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.name, b.name.data(), b.name.size());
+            for (int a = 0; a < 3; ++a) {
+                header.voxelSize[a] = b.voxelSize[a];
+                header.origin[a] = b.origin[a];
+                header.indexMin[a] = std::numeric_limits<int32_t>::max();
+                header.indexMax[a] = std::numeric_limits<int32_t>::lowest();
+            }
+            header.background = b.background;
+            header.minValue = header.maxValue = b.background;
+
+            std::vector<SparseGridRoot> roots;
+            std::vector<SparseGridInternal> internalNodes;
+            std::vector<uint32_t> storedLeaves;  // indices into sorted of the leaves that aren't tiles
+            std::vector<int> nChildren;
+            for (size_t i = 0; i < sorted.size(); ++i) {
+                const LeafData &leaf = *sorted[i];
+                const LeafStats &s = stats[i];
+                uint64_t key = SparseGrid::RootKey(leaf.origin[0], leaf.origin[1], leaf.origin[2]);
+                if (roots.empty() || roots.back().key != key) {
+                    roots.push_back({key, uint32_t(internalNodes.size()), 0});
+                    internalNodes.emplace_back();
+                    SparseGridInternal &node = internalNodes.back();
+                    std::memset(&node, 0, sizeof(node));
+                    for (int a = 0; a < 3; ++a)
+                        node.origin[a] = leaf.origin[a] & ~(SparseInternalSpan - 1);
+                    node.minValue = std::numeric_limits<float>::max();
+                    node.maxValue = std::numeric_limits<float>::lowest();
+                    std::fill(std::begin(node.children), std::end(node.children), FloatToBits(b.background));
+                    nChildren.push_back(0);
+                }
+                SparseGridInternal &node = internalNodes.back();
+                int n = SparseGrid::ChildIndex(leaf.origin[0], leaf.origin[1], leaf.origin[2]);
+                if (s.minValue == s.maxValue)
+                    node.children[n] = FloatToBits(s.minValue);
+                else {
+                    node.childMask[n >> 6] |= uint64_t(1) << (n & 63);
+                    node.children[n] = uint32_t(storedLeaves.size());
+                    storedLeaves.push_back(uint32_t(i));
+                }
+                ++nChildren.back();
+                node.minValue = std::min(node.minValue, s.minValue);
+                node.maxValue = std::max(node.maxValue, s.maxValue);
+                for (int a = 0; a < 3; ++a) {
+                    header.indexMin[a] = std::min(header.indexMin[a], s.activeMin[a]);
+                    header.indexMax[a] = std::max(header.indexMax[a], s.activeMax[a]);
+                }
+            }
+            for (size_t i = 0; i < internalNodes.size(); ++i) {
+                SparseGridInternal &node = internalNodes[i];
+                // Children that were never set are background tiles
+                if (nChildren[i] < int(std::size(node.children))) {
+                    node.minValue = std::min(node.minValue, b.background);
+                    node.maxValue = std::max(node.maxValue, b.background);
+                }
+                header.minValue = std::min(header.minValue, node.minValue);
+                header.maxValue = std::max(header.maxValue, node.maxValue);
+            }
+            if (roots.empty())
+                for (int a = 0; a < 3; ++a) {
+                    header.indexMin[a] = 0;
+                    header.indexMax[a] = -1;
+                }
+
+            // Lay out and write the grid: header, roots, internal nodes, leaves
+            header.nRoots = uint32_t(roots.size());
+            header.nInternalNodes = uint32_t(internalNodes.size());
+            header.nLeaves = uint32_t(storedLeaves.size());
+            fileHeader.gridOffsets[g] = AlignSparseGridOffset(offset);
+            header.rootOffset = AlignSparseGridOffset(fileHeader.gridOffsets[g] + sizeof(header));
+            header.internalOffset = AlignSparseGridOffset(header.rootOffset + roots.size() * sizeof(SparseGridRoot));
+            header.leafOffset = AlignSparseGridOffset(header.internalOffset +
+                                                      internalNodes.size() * sizeof(SparseGridInternal));
+            pad(fileHeader.gridOffsets[g]);
+            write(&header, sizeof(header));
+            pad(header.rootOffset);
+            write(roots.data(), roots.size() * sizeof(SparseGridRoot));
+            pad(header.internalOffset);
+            write(internalNodes.data(), internalNodes.size() * sizeof(SparseGridInternal));
+            pad(header.leafOffset);
+            SparseGridLeaf node;
+            for (uint32_t i : storedLeaves) {
+                const LeafData &leaf = *sorted[i];
+                std::memset(&node, 0, sizeof(node));
+                std::memcpy(node.origin, leaf.origin, sizeof(node.origin));
+                node.minValue = stats[i].minValue;
+                node.maxValue = stats[i].maxValue;
+                std::memcpy(node.activeMask, leaf.activeMask.data(), sizeof(node.activeMask));
+                std::memcpy(node.values, leaf.values.data(), sizeof(node.values));
+                write(&node, sizeof(node));
+            }
+        }
+
+        out.seekp(0);
+        out.write(reinterpret_cast<const char *>(&fileHeader), sizeof(fileHeader));
+        if (!out)
+            throw std::runtime_error(filename + ": error writing sparse grid file");
+    }
+
+#pragma endregion SparseGridBuilder
+}
@@ -1,10 +1,23 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <exception>
 #include <iostream>
 #include <cxxopts.hpp>
-#include <glm/glm.hpp>
 #include <entt/entt.hpp>
 #include "jadehare.h"
-#include "core/math/vector.h"
-#include "core/math/quaternion.h"
+#include "core/camera/camera.h"
+#include "core/film/film.h"
+#include "core/film/tileOrder.h"
+#include "core/integrator/integrator.h"
+#include "core/integrator/renderServer.h"
+#include "core/scene/parser.h"
+#include "core/scene/ply.h"
+#include "core/scene/scene.h"
+#include "util/log.h"
+#include "util/parallel.h"
+#include "util/profile.h"
+#include "util/stats.h"
 
 int main(int argc, const char *argv[])
 {
@@ -16,18 +29,38 @@ int main(int argc, const char *argv[])
     // Rendering options
     options.add_options("Rendering options")
             ("cropwindow", "Specify an image crop window.", cxxopts::value<std::vector<float>>(), "x0,x1,y0,y1")
-            ("j,nthreads", "Use specified number of threads for rendering.", cxxopts::value<int>()->default_value("1"))
+            ("maxscenes", "Keep at most this many scenes resident in server mode.",
+             cxxopts::value<int>()->default_value("1"))
+            ("j,nthreads", "Use specified number of threads for rendering.", cxxopts::value<int>()->default_value("0"))
             ("o,outfile", "Write the final image to the given filename.", cxxopts::value<std::string>())
             ("quick", "Automatically reduce a number of quality settings to render more quickly.",
              cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
             ("quiet", "Suppress all text output other than error messages.",
+             cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+            ("server", "Instead of rendering the given files, listen on the given Unix socket for render "
+                       "requests and keep the scenes they use resident between requests.",
+             cxxopts::value<std::string>(), "socket")
+            ("scenecache", "Load the built scene from the given cache file if it is up to date with the inputs; "
+                           "otherwise build the scene and write the cache.",
+             cxxopts::value<std::string>(), "filename")
+            ("spp", "Override the number of pixel samples specified in the scene description.",
+             cxxopts::value<int>())
+            ("texturecache", "Memory for decoded image texture tiles, in MiB; tiles beyond it are loaded again "
+                             "from the mapped .jtx files when needed. Each scene gets its own cache, so in "
+                             "server mode the budget applies to every resident scene.",
+             cxxopts::value<int>()->default_value("256"), "MiB")
+            ("tileorder", "Order in which image tiles are rendered: hilbert, morton, spiral (center out) or "
+                          "rowmajor.", cxxopts::value<std::string>()->default_value("hilbert"), "order")
+            ("trace", "Write a timeline of the run's phases and per-thread work as a Chrome trace, viewable "
+                      "in Perfetto.", cxxopts::value<std::string>(), "filename")
+            ("stats", "Print statistics about the run, such as rays per second and BVH nodes visited per ray.",
              cxxopts::value<bool>()->default_value("false")->implicit_value("true"));
 
     // Logging options
     options.add_options("Logging options")
             ("logdir", "Specify directory that log files should be written to.\n "
                        "Default: system temp directory (e.g. $TMPDIR or /tmp).",
-             cxxopts::value<std::string>()->default_value("tmp"))
+             cxxopts::value<std::string>())
             ("logtostderr", "Print all logging messages to stderr.",
              cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
             ("minloglevel", "Log messages at or above this level (0 -> INFO, 1 -> WARNING, 2 -> ERROR, 3-> FATAL).",
@@ -42,39 +75,124 @@ int main(int argc, const char *argv[])
              "Print a reformatted version of the input file(s) to standard output and convert all triangle meshes to PLY files. Does not render an image.",
              cxxopts::value<bool>()->default_value("false")->implicit_value("true"));
 
+    options.add_options()
+            ("filenames", "Scene description files.", cxxopts::value<std::vector<std::string>>());
+    options.parse_positional({"filenames"});
+    options.positional_help("<filename.pbrt...>");
+
     options.help({"", "Rendering options", "Logging options", "Reformatting options"});
 
     auto result = options.parse(argc, argv);
 
-//    if (argc <= 1 || result.count("help"))
-//    {
-//        std::cout << options.help() << std::endl;
-//        exit(0);
-//    }
+    if (argc <= 1 || result.count("help"))
+    {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
 
     entt::registry registry;
 
-    jadehare::Vector3f vector3;
+    std::vector<std::string> filenames;
+    if (result.count("filenames"))
+        filenames = result["filenames"].as<std::vector<std::string>>();
+
+    jadehare::LogConfig logConfig;
+    logConfig.minLevel = jadehare::LogLevel(std::min<int>(result["minloglevel"].as<uint8_t>(), 3));
+    if (result.count("verbosity"))
+        logConfig.vlogLevel = result["verbosity"].as<int>();
+    if (result.count("logdir"))
+        logConfig.logDir = result["logdir"].as<std::string>();
+    logConfig.logToStderr = result["logtostderr"].as<bool>();
+    try {
+        jadehare::InitLogging(logConfig);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    if (result.count("trace"))
+        jadehare::InitProfiler(result["trace"].as<std::string>());
+    jadehare::ParallelInit(result["nthreads"].as<int>());
+    jadehare::SetTextureCacheSize(size_t(std::max(1, result["texturecache"].as<int>())) << 20);
+    // The trace holds the events of threads that have exited, so it is
+    // written once the pool is gone
+    auto shutdown = [&]() {
+        jadehare::ParallelCleanup();
+        try {
+            jadehare::WriteTrace();
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+        }
+        jadehare::ShutdownLogging();
+    };
+    // Counters are reported per second of rendering, not of the whole run
+    double renderSeconds = 0;
 
-    glm::vec2 vew23 {1.3, 3.6};
-    glm::vec3 ve222;
-    glm::vec3 wqe;
-    jadehare::Vector3f vector3F;
-    jadehare::Vector3f ve231(1.0f, 1.0f, 1.0f);
-    vector3 += vector3F + vector3;
+    try {
+        if (result.count("server")) {
+            jadehare::RenderServer server(result["server"].as<std::string>(), result["maxscenes"].as<int>(),
+                                          result["quiet"].as<bool>());
+            server.Run();
+        } else if (result["toply"].as<bool>() || result["cat"].as<bool>()) {
+            std::unique_ptr<jadehare::ParsedScene> parsed = jadehare::ParseFiles(filenames);
+            if (result["toply"].as<bool>())
+                jadehare::ConvertTriangleMeshesToPLY(parsed.get());
+            parsed->Print(stdout);
+        } else {
+            auto start = std::chrono::steady_clock::now();
+            std::string cacheFilename = result.count("scenecache") ? result["scenecache"].as<std::string>() : "";
+            std::unique_ptr<jadehare::Scene> scene;
+            bool fromCache = false;
+            if (!cacheFilename.empty())
+                fromCache = bool(scene = jadehare::Scene::ReadCache(cacheFilename, filenames));
+            if (!scene) {
+                std::unique_ptr<jadehare::ParsedScene> parsed = jadehare::ParseFiles(filenames);
+                scene = jadehare::Scene::Build(*parsed);
+                if (!cacheFilename.empty())
+                    scene->WriteCache(cacheFilename, filenames);
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (!result["quiet"].as<bool>())
+                std::cout << "Scene: " << scene->Meshes().size() << " meshes, " << scene->NumTriangles()
+                          << " triangles, " << scene->Instances().size() << " instances, " << scene->Lights().size() << " lights, "
+                          << scene->Aggregate().Nodes().size() << " BVH nodes; ready in " << elapsed.count()
+                          << "s" << (fromCache ? " (from scene cache)" : "") << std::endl;
 
-    auto xx = ve231 * 3;
-    xx /= 2;
+            const jadehare::CameraData &cameraData = scene->Camera();
+            int spp = result.count("spp") ? result["spp"].as<int>() : cameraData.samplesPerPixel;
+            if (result["quick"].as<bool>())
+                spp = std::max(1, spp / 4);
+            jadehare::PerspectiveCamera camera(cameraData.worldFromCamera, cameraData.fov,
+                                               jadehare::Point2i(cameraData.xResolution, cameraData.yResolution),
+                                               scene->GetMedium(cameraData.mediumIndex), cameraData.shutterOpen,
+                                               cameraData.shutterClose);
+            jadehare::RGBFilm film(camera.Resolution());
+            jadehare::PathIntegrator integrator(*scene, cameraData.maxDepth);
+            integrator.SetTileOrder(jadehare::ParseTileOrder(result["tileorder"].as<std::string>()));
+            jadehare::RenderStats renderStats = integrator.Render(camera, spp, film);
+            renderSeconds = renderStats.seconds;
 
-    jadehare::Quaternion quaternion;
-    jadehare::Quaternion xqweqsqe;
-    glm::quat we;
-    glm::quat wx {1, 2, 3, 4};
-    we = wx + we;
+            std::string outFilename = result.count("outfile") ? result["outfile"].as<std::string>()
+                                      : cameraData.filenameIndex >= 0 ? scene->Strings()[cameraData.filenameIndex]
+                                                                      : "jadehare.exr";
+            film.WriteImage(outFilename);
+            if (!result["quiet"].as<bool>())
+                std::cout << "Rendered " << outFilename << " at " << spp << " spp in " << renderStats.seconds
+                          << "s; " << (renderStats.cameraRays + renderStats.secondaryRays) / renderStats.seconds / 1e6
+                          << " Mrays/s" << std::endl;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        shutdown();
+        return 1;
+    }
 
-    ve231[2] = 12;
-    vector3 = ve231;
+    if (result["stats"].as<bool>()) {
+        // Gather the per-thread values while the pool's threads still exist
+        jadehare::ForEachThread(jadehare::ReportThreadStats);
+        jadehare::PrintStats(stdout, renderSeconds);
+    }
 
-    std::cout << "Hello, World!" << std::endl;
+    shutdown();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,144 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <random>
+#include <sstream>
+#include <vector>
+#include "jadehare.h"
+#include "core/light/lightSampler.h"
+#include "core/scene/parser.h"
+#include "core/scene/scene.h"
+#include "util/parallel.h"
+
+using namespace jadehare;
+
+static int nFailures = 0;
+
+#define EXPECT(condition, ...)                                                  \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            ++nFailures;                                                        \
+            std::fprintf(stderr, "%s:%d: EXPECT(%s) failed: ", __FILE__, __LINE__, #condition); \
+            std::fprintf(stderr, __VA_ARGS__);                                  \
+            std::fputc('\n', stderr);                                           \
+        }                                                                       \
+    } while (false)
+
+// A ceiling of one-sided emitters facing down, a two-sided emitter, point
+// and spot lights and a distant light, all above the z = 0 floor.
+static std::string LightScene() {
+    std::ostringstream s;
+    s << "WorldBegin\n"
+      << "LightSource \"distant\" \"point3 from\" [1 -1 3] \"point3 to\" [0 0 0] \"rgb L\" [0.5 0.5 0.5]\n"
+      << "LightSource \"point\" \"point3 from\" [-3 2 2] \"rgb I\" [4 4 4]\n"
+      << "LightSource \"point\" \"point3 from\" [4 -1 1] \"rgb I\" [1 2 3]\n"
+      << "LightSource \"spot\" \"point3 from\" [0 0 5] \"point3 to\" [1 0 0] \"rgb I\" [20 20 20] "
+         "\"float coneangle\" [25]\n";
+    for (int y = 0; y < 6; ++y)
+        for (int x = 0; x < 6; ++x) {
+            float x0 = -6 + 2 * x, y0 = -6 + 2 * y, z = 4 + 0.1f * ((x + y) % 3);
+            s << "AttributeBegin\nAreaLightSource \"diffuse\" \"rgb L\" [" << 1 + x << " " << 1 + y << " 2]\n"
+              << "Shape \"trianglemesh\" \"point3 P\" [" << x0 << " " << y0 << " " << z << " " << x0 << " "
+              << y0 + 1.5f << " " << z << " " << x0 + 1.5f << " " << y0 + 1.5f << " " << z << " " << x0 + 1.5f
+              << " " << y0 << " " << z << "] \"integer indices\" [0 1 2 0 2 3]\nAttributeEnd\n";
+        }
+    s << "AttributeBegin\nAreaLightSource \"diffuse\" \"rgb L\" [3 3 3] \"bool twosided\" true\n"
+      << "Shape \"trianglemesh\" \"point3 P\" [2 2 1 3 2 1 3 2 2] \"integer indices\" [0 1 2]\nAttributeEnd\n";
+    return s.str();
+}
+
+// Shading points on the floor facing up toward the lights, and points in
+// the space between, which have no normal.
+static std::vector<LightSampleContext> MakeContexts(int n) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> u(-7, 7);
+    std::vector<LightSampleContext> contexts;
+    for (int i = 0; i < n; ++i) {
+        LightSampleContext ctx;
+        if (i % 2 == 0) {
+            ctx.p = Point3f(u(rng), u(rng), 0);
+            ctx.n = Normal3f(0, 0, 1);
+        } else
+            ctx.p = Point3f(u(rng), u(rng), 0.2f * (u(rng) + 7));
+        contexts.push_back(ctx);
+    }
+    return contexts;
+}
+
+// Sample() reports the probability that PMF() gives for the chosen light.
+static void TestSampleMatchesPMF(const BVHLightSampler &sampler, const std::vector<LightSampleContext> &contexts) {
+    for (const LightSampleContext &ctx : contexts)
+        for (int i = 0; i < 64; ++i) {
+            float u = (i + 0.5f) / 64;
+            std::optional<SampledLight> sampled = sampler.Sample(ctx, u);
+            EXPECT(sampled.has_value(), "no light sampled at (%f, %f, %f), u = %f", ctx.p.x, ctx.p.y, ctx.p.z, u);
+            if (!sampled)
+                continue;
+            float pmf = sampler.PMF(ctx, sampled->lightIndex);
+            EXPECT(sampled->p > 0 && std::abs(sampled->p - pmf) <= 1e-4f * pmf,
+                   "light %d at (%f, %f, %f): Sample() p = %g, PMF() = %g", sampled->lightIndex, ctx.p.x, ctx.p.y,
+                   ctx.p.z, sampled->p, pmf);
+        }
+}
+
+// Over all lights, the PMF is a distribution.
+static void TestPMFSumsToOne(const BVHLightSampler &sampler, const std::vector<LightSampleContext> &contexts,
+                             int nLights) {
+    for (const LightSampleContext &ctx : contexts) {
+        double sum = 0;
+        for (int i = 0; i < nLights; ++i)
+            sum += sampler.PMF(ctx, i);
+        EXPECT(std::abs(sum - 1) < 1e-4, "PMF at (%f, %f, %f) sums to %.7f", ctx.p.x, ctx.p.y, ctx.p.z, sum);
+    }
+}
+
+// Lights are chosen as often as the PMF says.
+static void TestSampleFrequencies(const BVHLightSampler &sampler, const std::vector<LightSampleContext> &contexts,
+                                  int nLights) {
+    const int nSamples = 200000;
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> u(0, 1);
+    for (const LightSampleContext &ctx : contexts) {
+        std::vector<int> counts(nLights, 0);
+        for (int i = 0; i < nSamples; ++i)
+            if (std::optional<SampledLight> sampled = sampler.Sample(ctx, u(rng)))
+                ++counts[sampled->lightIndex];
+        for (int i = 0; i < nLights; ++i) {
+            double p = sampler.PMF(ctx, i), frequency = double(counts[i]) / nSamples;
+            // Six standard deviations of the binomial count, plus some slack
+            // for float rounding of the sample values
+            double tolerance = 6 * std::sqrt(p * (1 - p) / nSamples) + 1e-4;
+            EXPECT(std::abs(frequency - p) <= tolerance, "light %d at (%f, %f, %f): frequency %g, PMF %g", i,
+                   ctx.p.x, ctx.p.y, ctx.p.z, frequency, p);
+        }
+    }
+}
+
+int main() {
+    ParallelInit(1);
+    try {
+        std::unique_ptr<Scene> scene = Scene::Build(*ParseString(LightScene()));
+        BVHLightSampler sampler(*scene);
+        int nLights = int(scene->Lights().size());
+        std::vector<LightSampleContext> contexts = MakeContexts(200);
+
+        TestSampleMatchesPMF(sampler, contexts);
+        TestPMFSumsToOne(sampler, contexts, nLights);
+        TestSampleFrequencies(sampler, {contexts.begin(), contexts.begin() + 8}, nLights);
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        ++nFailures;
+    }
+    ParallelCleanup();
+
+    if (nFailures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", nFailures);
+        return 1;
+    }
+    std::printf("All light sampler checks passed\n");
+    return 0;
+}
@@ -0,0 +1,45 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include <iostream>
+#include <cxxopts.hpp>
+#include "jadehare.h"
+#include "core/spectrum/rgbToSpectrum.h"
+#include "util/parallel.h"
+
+int main(int argc, const char *argv[])
+{
+    cxxopts::Options options("rgb2spec",
+                             "Fit the memory-mappable RGB to spectrum coefficient table (.jrsp)");
+    options.add_options()
+            ("h,help", "Print this help text.")
+            ("res", "Table resolution along each axis.",
+             cxxopts::value<int>()->default_value(std::to_string(jadehare::RGBToSpectrumTable::DefaultResolution)))
+            ("j,nthreads", "Use specified number of threads.", cxxopts::value<int>()->default_value("0"))
+            ("output", "Output table.", cxxopts::value<std::string>());
+    options.parse_positional({"output"});
+    options.positional_help("<output.jrsp>");
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help") || !result.count("output"))
+    {
+        std::cout << options.help() << std::endl;
+        return result.count("help") ? 0 : 1;
+    }
+
+    jadehare::ParallelInit(result["nthreads"].as<int>());
+    int status = 0;
+    try
+    {
+        jadehare::RGBToSpectrumTable::Generate(result["res"].as<int>())->Write(result["output"].as<std::string>());
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        status = 1;
+    }
+    jadehare::ParallelCleanup();
+    return status;
+}
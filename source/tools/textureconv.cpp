@@ -0,0 +1,51 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include <iostream>
+#include <cxxopts.hpp>
+#include "jadehare.h"
+#include "core/texture/tiledTexture.h"
+
+int main(int argc, const char *argv[])
+{
+    cxxopts::Options options("textureconv",
+                             "Convert PNG/EXR/PFM images to memory-mappable tiled MIP pyramids (.jtx)");
+    options.add_options()
+            ("h,help", "Print this help text.")
+            ("tilesize", "Tile width and height in texels (power of two).",
+             cxxopts::value<int>()->default_value("64"))
+            ("float", "Store 32-bit float texels instead of sRGB-encoded 8-bit ones.",
+             cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+            ("keepalpha", "Keep the alpha channel of RGBA images.",
+             cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+            ("input", "Input image.", cxxopts::value<std::string>())
+            ("output", "Output tiled texture.", cxxopts::value<std::string>());
+    options.parse_positional({"input", "output"});
+    options.positional_help("<input image> <output.jtx>");
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help") || !result.count("input") || !result.count("output"))
+    {
+        std::cout << options.help() << std::endl;
+        return result.count("help") ? 0 : 1;
+    }
+
+    jadehare::TiledTextureConversionOptions convert;
+    convert.tileSize = result["tilesize"].as<int>();
+    convert.format = result["float"].as<bool>() ? jadehare::TexelFormat::Float : jadehare::TexelFormat::U256;
+    convert.dropAlpha = !result["keepalpha"].as<bool>();
+
+    try
+    {
+        jadehare::ConvertToTiledTexture(result["input"].as<std::string>(), result["output"].as<std::string>(),
+                                        convert);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
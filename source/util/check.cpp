@@ -0,0 +1,56 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "util/check.h"
+#include "util/log.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <cxxabi.h>
+#include <execinfo.h>
+#define JADEHARE_HAVE_BACKTRACE
+#endif
+
+namespace jadehare {
+
+    void PrintStackTrace() {
+#ifdef JADEHARE_HAVE_BACKTRACE
+        void *frames[64];
+        int nFrames = backtrace(frames, 64);
+        char **symbols = backtrace_symbols(frames, nFrames);
+        if (!symbols) {
+            backtrace_symbols_fd(frames, nFrames, 2);
+            return;
+        }
+        std::fprintf(stderr, "Stack trace:\n");
+        // Skip this function's own frame
+        for (int i = 1; i < nFrames; ++i) {
+            // glibc writes "module(mangled+offset) [address]"; demangle the
+            // name if it's there
+            char *begin = std::strchr(symbols[i], '('), *plus = begin ? std::strchr(begin, '+') : nullptr;
+            char *demangled = nullptr;
+            if (begin && plus && plus > begin + 1) {
+                std::string mangled(begin + 1, plus);
+                int status;
+                demangled = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+            }
+            if (demangled)
+                std::fprintf(stderr, "  %2d %.*s(%s%s\n", i, int(begin - symbols[i]), symbols[i], demangled, plus);
+            else
+                std::fprintf(stderr, "  %2d %s\n", i, symbols[i]);
+            std::free(demangled);
+        }
+        std::free(symbols);
+#else
+        std::fprintf(stderr, "Stack trace not available on this platform\n");
+#endif
+    }
+
+    void CheckFailed(const char *file, int line, const char *expr) {
+        LogFatal(file, line, "Check failed: %s", expr);
+    }
+}
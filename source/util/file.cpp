@@ -0,0 +1,113 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "util/file.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace jadehare {
+
+    std::unique_ptr<MappedFile> MappedFile::Open(const std::string &filename, Access access) {
+        std::unique_ptr<MappedFile> file(new MappedFile);
+        file->filename = filename;
+#ifdef _WIN32
+        HANDLE fh = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                access == Access::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN :
+                                access == Access::Random ? FILE_FLAG_RANDOM_ACCESS : FILE_ATTRIBUTE_NORMAL,
+                                nullptr);
+        if (fh == INVALID_HANDLE_VALUE)
+            throw std::runtime_error(filename + ": unable to open file");
+        file->fileHandle = fh;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(fh, &size))
+            throw std::runtime_error(filename + ": unable to get file size");
+        file->size = size_t(size.QuadPart);
+        if (file->size == 0)
+            return file;
+        HANDLE mh = CreateFileMappingA(fh, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mh)
+            throw std::runtime_error(filename + ": unable to create file mapping");
+        file->mappingHandle = mh;
+        file->data = static_cast<const uint8_t *>(MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0));
+        if (!file->data)
+            throw std::runtime_error(filename + ": unable to map file");
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd == -1)
+            throw std::runtime_error(filename + ": unable to open file");
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error(filename + ": unable to stat file");
+        }
+        file->size = size_t(st.st_size);
+        if (file->size == 0) {
+            close(fd);
+            return file;
+        }
+        void *ptr = mmap(nullptr, file->size, PROT_READ, MAP_SHARED, fd, 0);
+        // The mapping keeps its own reference to the file.
+        close(fd);
+        if (ptr == MAP_FAILED)
+            throw std::runtime_error(filename + ": unable to map file");
+        file->data = static_cast<const uint8_t *>(ptr);
+        if (access != Access::Normal)
+            madvise(ptr, file->size, access == Access::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+#endif
+        return file;
+    }
+
+    MappedFile::~MappedFile() {
+#ifdef _WIN32
+        if (data)
+            UnmapViewOfFile(data);
+        if (mappingHandle)
+            CloseHandle(mappingHandle);
+        if (fileHandle)
+            CloseHandle(fileHandle);
+#else
+        if (data)
+            munmap(const_cast<uint8_t *>(data), size);
+#endif
+    }
+
+    size_t MappedFile::PageSize() {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwAllocationGranularity;
+#else
+        return size_t(sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    bool FileExists(const std::string &filename) {
+        std::ifstream ifs(filename);
+        return bool(ifs);
+    }
+
+    std::string FileExtension(const std::string &filename) {
+        size_t dot = filename.find_last_of('.');
+        if (dot == std::string::npos || filename.find_first_of("/\\", dot) != std::string::npos)
+            return "";
+        std::string ext = filename.substr(dot + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+        return ext;
+    }
+}
@@ -0,0 +1,381 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "util/log.h"
+#include "util/check.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace jadehare {
+
+    namespace logging {
+        std::atomic<int> minLevel{int(LogLevel::Warning)};
+        std::atomic<int> vlogLevel{-1};
+    }
+
+    // LogRecord Definition
+    // Fixed-size, so that records can be formatted in place in the queue;
+    // longer messages are truncated.
+    struct LogRecord {
+        LogLevel level;
+        int line;
+        int threadIndex;
+        const char *file;
+        double time;
+        char message[480];
+    };
+
+    static const char *LevelName(LogLevel level) {
+        switch (level) {
+            case LogLevel::Info:
+                return "I";
+            case LogLevel::Warning:
+                return "W";
+            case LogLevel::Error:
+                return "E";
+            default:
+                return "F";
+        }
+    }
+
+    static const char *Basename(const char *file) {
+        const char *slash = std::strrchr(file, '/');
+#ifdef _WIN32
+        const char *backslash = std::strrchr(file, '\\');
+        if (backslash && (!slash || backslash > slash))
+            slash = backslash;
+#endif
+        return slash ? slash + 1 : file;
+    }
+
+    static int ThreadIndex() {
+        static std::atomic<int> nextIndex{0};
+        thread_local int index = nextIndex++;
+        return index;
+    }
+
+    static void FormatMessage(char *dest, size_t size, const char *fmt, va_list args) {
+        int n = std::vsnprintf(dest, size, fmt, args);
+        if (n >= int(size))
+            std::memcpy(dest + size - 4, "...", 4);
+    }
+
+    static void WriteRecord(FILE *f, const LogRecord &r) {
+        std::fprintf(f, "[ tid %d %10.4fs %s %s:%d ] %s\n", r.threadIndex, r.time, LevelName(r.level),
+                     Basename(r.file), r.line, r.message);
+    }
+
+#pragma region LogQueue
+
+    // LogQueue Definition
+    // Bounded lock-free multi-producer, single-consumer ring buffer of log
+    // records, after Vyukov's bounded queue: each cell's sequence number
+    // says whether it is free for the producer at a given position or
+    // holds a record for the consumer. Producers claim a position with a
+    // CAS and fill the cell in place; they never wait for the consumer.
+    class LogQueue {
+    public:
+        // LogQueue Public Methods
+        // _capacity_ must be a power of two.
+        explicit LogQueue(size_t capacity) : cells(new Cell[capacity]), mask(capacity - 1) {
+            for (size_t i = 0; i < capacity; ++i)
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        // Returns the cell to fill at position *pos, or nullptr if the
+        // queue is full. The record is published with Publish().
+        LogRecord *Claim(size_t *pos) {
+            size_t p = enqueuePos.load(std::memory_order_relaxed);
+            while (true) {
+                Cell &cell = cells[p & mask];
+                size_t seq = cell.sequence.load(std::memory_order_acquire);
+                intptr_t diff = intptr_t(seq) - intptr_t(p);
+                if (diff == 0) {
+                    if (enqueuePos.compare_exchange_weak(p, p + 1, std::memory_order_relaxed)) {
+                        *pos = p;
+                        return &cell.record;
+                    }
+                } else if (diff < 0)
+                    return nullptr;
+                else
+                    p = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        void Publish(size_t pos) { cells[pos & mask].sequence.store(pos + 1, std::memory_order_release); }
+
+        // Consumer side: the oldest record, if it has been published.
+        const LogRecord *Front() const {
+            const Cell &cell = cells[dequeuePos & mask];
+            if (cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+                return nullptr;
+            return &cell.record;
+        }
+
+        void Pop() {
+            cells[dequeuePos & mask].sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+            ++dequeuePos;
+        }
+
+        size_t EnqueuePosition() const { return enqueuePos.load(std::memory_order_acquire); }
+
+        size_t DequeuePosition() const { return dequeuePos; }
+
+    private:
+        // LogQueue Private Members
+        struct alignas(64) Cell {
+            std::atomic<size_t> sequence;
+            LogRecord record;
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        size_t mask;
+        alignas(64) std::atomic<size_t> enqueuePos{0};
+        alignas(64) size_t dequeuePos = 0;
+    };
+
+#pragma endregion LogQueue
+
+#pragma region Logger
+
+    // Logger Definition
+    // Owns the queue and the thread that drains it to the log file.
+    class Logger {
+    public:
+        // Logger Public Methods
+        explicit Logger(const LogConfig &config);
+
+        ~Logger();
+
+        void Push(LogLevel level, const char *file, int line, const char *fmt, va_list args);
+
+        void Flush();
+
+        // Writes a record straight to the outputs, bypassing the queue.
+        void WriteNow(const LogRecord &r);
+
+        double Time() const {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+    private:
+        // Logger Private Methods
+        void WriterLoop();
+
+        void Output(const LogRecord &r);
+
+        // Logger Private Members
+        static constexpr size_t queueCapacity = 4096;
+        LogQueue queue{queueCapacity};
+        std::atomic<int64_t> nDropped{0};
+        bool logToStderr;
+        FILE *file = nullptr;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        // Guards the outputs and the writer's progress
+        std::mutex mutex;
+        std::condition_variable wakeWriter, progress;
+        size_t nWritten = 0;
+        bool flushRequested = false, shutdown = false;
+        std::thread writer;
+    };
+
+    Logger::Logger(const LogConfig &config) : logToStderr(config.logToStderr) {
+        std::filesystem::path dir = config.logDir;
+        if (dir.empty())
+            dir = std::filesystem::temp_directory_path();
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        std::string filename = (dir / ("jadehare." + std::to_string(getpid()) + ".log")).string();
+        file = std::fopen(filename.c_str(), "a");
+        if (!file)
+            throw std::runtime_error(filename + ": unable to open log file");
+        writer = std::thread(&Logger::WriterLoop, this);
+    }
+
+    Logger::~Logger() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            shutdown = true;
+        }
+        wakeWriter.notify_one();
+        writer.join();
+        std::fclose(file);
+    }
+
+    void Logger::Push(LogLevel level, const char *file, int line, const char *fmt, va_list args) {
+        size_t pos;
+        LogRecord *r = queue.Claim(&pos);
+        if (!r) {
+            nDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        r->level = level;
+        r->file = file;
+        r->line = line;
+        r->threadIndex = ThreadIndex();
+        r->time = Time();
+        FormatMessage(r->message, sizeof(r->message), fmt, args);
+        queue.Publish(pos);
+    }
+
+    void Logger::Output(const LogRecord &r) {
+        WriteRecord(file, r);
+        if (logToStderr || r.level >= LogLevel::Warning)
+            WriteRecord(stderr, r);
+    }
+
+    void Logger::WriterLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            bool wrote = false;
+            while (const LogRecord *r = queue.Front()) {
+                Output(*r);
+                queue.Pop();
+                wrote = true;
+            }
+            if (int64_t dropped = nDropped.exchange(0, std::memory_order_relaxed)) {
+                LogRecord r{LogLevel::Warning, __LINE__, ThreadIndex(), __FILE__, Time(), ""};
+                std::snprintf(r.message, sizeof(r.message), "%lld log messages dropped; the queue was full",
+                              (long long) dropped);
+                Output(r);
+                wrote = true;
+            }
+            if (wrote)
+                std::fflush(file);
+            nWritten = queue.DequeuePosition();
+            progress.notify_all();
+
+            if (shutdown && !queue.Front())
+                return;
+            // Producers don't signal new records, which would cost them a
+            // lock; poll for them instead, more often while they're busy
+            wakeWriter.wait_for(lock, std::chrono::milliseconds(wrote ? 1 : 10),
+                                [this] { return shutdown || flushRequested; });
+            flushRequested = false;
+        }
+    }
+
+    void Logger::Flush() {
+        size_t target = queue.EnqueuePosition();
+        std::unique_lock<std::mutex> lock(mutex);
+        flushRequested = true;
+        wakeWriter.notify_one();
+        progress.wait(lock, [&] { return nWritten >= target; });
+    }
+
+    void Logger::WriteNow(const LogRecord &r) {
+        std::lock_guard<std::mutex> lock(mutex);
+        WriteRecord(file, r);
+        std::fflush(file);
+        WriteRecord(stderr, r);
+    }
+
+#pragma endregion Logger
+
+#pragma region Logging Functions
+
+    static std::atomic<Logger *> logger{nullptr};
+    // Threads between loading _logger_ and being done with it. Shutdown
+    // unpublishes the logger first and waits for these to finish before
+    // deleting it; the sequentially consistent accesses ensure that a
+    // thread either is counted or sees nullptr.
+    static std::atomic<int> nLoggerUsers{0};
+
+    // LoggerUse Definition
+    // The current logger, if any, kept alive for the object's lifetime.
+    class LoggerUse {
+    public:
+        LoggerUse() {
+            nLoggerUsers.fetch_add(1);
+            l = logger.load();
+        }
+
+        ~LoggerUse() { nLoggerUsers.fetch_sub(1); }
+
+        LoggerUse(const LoggerUse &) = delete;
+
+        LoggerUse &operator=(const LoggerUse &) = delete;
+
+        Logger *Get() const { return l; }
+
+    private:
+        Logger *l;
+    };
+
+    void InitLogging(const LogConfig &config) {
+        ShutdownLogging();
+        logger.store(new Logger(config), std::memory_order_release);
+        logging::minLevel = int(config.minLevel);
+        logging::vlogLevel = config.minLevel <= LogLevel::Info ? config.vlogLevel : -1;
+    }
+
+    void ShutdownLogging() {
+        logging::minLevel = int(LogLevel::Warning);
+        logging::vlogLevel = -1;
+        Logger *l = logger.exchange(nullptr);
+        while (nLoggerUsers.load() > 0)
+            std::this_thread::yield();
+        delete l;
+    }
+
+    void FlushLog() {
+        LoggerUse use;
+        if (Logger *l = use.Get())
+            l->Flush();
+    }
+
+    void Log(LogLevel level, const char *file, int line, const char *fmt, ...) {
+        va_list args;
+        va_start(args, fmt);
+        LoggerUse use;
+        if (Logger *l = use.Get())
+            l->Push(level, file, line, fmt, args);
+        else if (level >= LogLevel::Warning) {
+            LogRecord r{level, line, ThreadIndex(), file, 0, ""};
+            FormatMessage(r.message, sizeof(r.message), fmt, args);
+            WriteRecord(stderr, r);
+        }
+        va_end(args);
+    }
+
+    void LogFatal(const char *file, int line, const char *fmt, ...) {
+        LogRecord r{LogLevel::Fatal, line, ThreadIndex(), file, 0, ""};
+        va_list args;
+        va_start(args, fmt);
+        FormatMessage(r.message, sizeof(r.message), fmt, args);
+        va_end(args);
+
+        // Never released: the process aborts
+        LoggerUse use;
+        if (Logger *l = use.Get()) {
+            r.time = l->Time();
+            l->Flush();
+            l->WriteNow(r);
+        } else
+            WriteRecord(stderr, r);
+        PrintStackTrace();
+        std::abort();
+    }
+
+#pragma endregion Logging Functions
+}
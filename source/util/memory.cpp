@@ -0,0 +1,34 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "util/memory.h"
+
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace jadehare {
+
+    void *AllocAligned(size_t size, size_t alignment) {
+#ifdef _WIN32
+        void *ptr = _aligned_malloc(size, alignment);
+#else
+        // aligned_alloc() wants a multiple of the alignment
+        void *ptr = std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+#endif
+        if (!ptr)
+            throw std::bad_alloc();
+        return ptr;
+    }
+
+    void FreeAligned(void *ptr) {
+#ifdef _WIN32
+        _aligned_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+}
@@ -0,0 +1,176 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "util/parallel.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace jadehare {
+
+#pragma region Barrier
+
+    void Barrier::Wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (--numToBlock == 0)
+            cv.notify_all();
+        else
+            cv.wait(lock, [this] { return numToBlock == 0; });
+    }
+
+#pragma endregion Barrier
+
+#pragma region ThreadPool
+
+    ThreadPool::ThreadPool(int nThreads) {
+        for (int i = 0; i < nThreads - 1; ++i)
+            threads.emplace_back(&ThreadPool::Worker, this);
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            shutdown = true;
+        }
+        workAvailable.notify_all();
+        for (std::thread &thread : threads)
+            thread.join();
+    }
+
+    bool ThreadPool::ClaimChunk(Job **job, int64_t *chunk) {
+        if (jobs.empty())
+            return false;
+        *job = jobs.front();
+        *chunk = (*job)->nextChunk++;
+        // Once its last chunk is handed out, a job is only waited on.
+        if ((*job)->nextChunk == (*job)->nChunks)
+            jobs.pop_front();
+        return true;
+    }
+
+    void ThreadPool::RunChunk(Job *job, int64_t chunk) {
+        int64_t b = job->begin + chunk * job->chunkSize;
+        int64_t e = std::min(job->end, b + job->chunkSize);
+        try {
+            (*job->func)(b, e);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!job->exception)
+                job->exception = std::current_exception();
+        }
+        // The submitting thread may destroy _job_ as soon as this reaches
+        // zero, so don't touch it afterwards.
+        if (job->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobFinished.notify_all();
+        }
+    }
+
+    void ThreadPool::Worker() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            workAvailable.wait(lock, [this] { return shutdown || !jobs.empty(); });
+            if (shutdown)
+                return;
+            Job *job;
+            int64_t chunk;
+            if (ClaimChunk(&job, &chunk)) {
+                lock.unlock();
+                RunChunk(job, chunk);
+                lock.lock();
+            }
+        }
+    }
+
+    void ThreadPool::ParallelFor(int64_t begin, int64_t end, int64_t chunkSize,
+                                 const std::function<void(int64_t, int64_t)> &func) {
+        if (begin >= end)
+            return;
+        chunkSize = std::max<int64_t>(1, chunkSize);
+
+        Job job;
+        job.func = &func;
+        job.begin = begin;
+        job.end = end;
+        job.chunkSize = chunkSize;
+        job.nChunks = (end - begin + chunkSize - 1) / chunkSize;
+        job.remaining = job.nChunks;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        jobs.push_back(&job);
+        if (job.nChunks > 1)
+            workAvailable.notify_all();
+
+        // Work on our own job until all of its chunks have been claimed.
+        while (job.nextChunk < job.nChunks) {
+            int64_t chunk = job.nextChunk++;
+            if (job.nextChunk == job.nChunks)
+                jobs.erase(std::find(jobs.begin(), jobs.end(), &job));
+            lock.unlock();
+            RunChunk(&job, chunk);
+            lock.lock();
+        }
+        jobFinished.wait(lock, [&job] { return job.remaining.load(std::memory_order_acquire) == 0; });
+        lock.unlock();
+
+        if (job.exception)
+            std::rethrow_exception(job.exception);
+    }
+
+    void ThreadPool::ForEachThread(const std::function<void(void)> &func) {
+        // One chunk per thread; a thread that finished its chunk waits at the
+        // barrier and so can't claim another
+        Barrier barrier(Size());
+        ParallelFor(0, Size(), 1, [&](int64_t, int64_t) {
+            try {
+                func();
+            } catch (...) {
+                barrier.Wait();
+                throw;
+            }
+            barrier.Wait();
+        });
+    }
+
+#pragma endregion ThreadPool
+
+#pragma region Parallel Functions
+
+    static std::unique_ptr<ThreadPool> threadPool;
+
+    int AvailableCores() {
+        return std::max<int>(1, int(std::thread::hardware_concurrency()));
+    }
+
+    void ParallelInit(int nThreads) {
+        threadPool = std::make_unique<ThreadPool>(nThreads <= 0 ? AvailableCores() : nThreads);
+    }
+
+    void ParallelCleanup() {
+        threadPool.reset();
+    }
+
+    int RunningThreads() {
+        return threadPool ? threadPool->Size() : 1;
+    }
+
+    void ParallelFor(int64_t start, int64_t end, std::function<void(int64_t, int64_t)> func) {
+        if (!threadPool || end - start <= 1) {
+            func(start, end);
+            return;
+        }
+        // A few chunks per thread evens out imbalance without much overhead
+        int64_t chunkSize = std::max<int64_t>(1, (end - start) / (8 * threadPool->Size()));
+        threadPool->ParallelFor(start, end, chunkSize, func);
+    }
+
+    void ForEachThread(std::function<void(void)> func) {
+        if (threadPool)
+            threadPool->ForEachThread(func);
+        else
+            func();
+    }
+
+#pragma endregion Parallel Functions
+}
@@ -0,0 +1,124 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "util/profile.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace jadehare {
+
+    namespace profiling {
+        bool enabled = false;
+    }
+
+    // TraceEvent Definition
+    struct TraceEvent {
+        const char *name;
+        int64_t arg;
+        int64_t startNs, endNs;
+    };
+
+    // ThreadTrace Definition
+    // Ring buffer of one thread's events, written only by that thread; once
+    // full, new events overwrite the oldest. Buffers outlive their threads,
+    // so that the events of a thread pool that has since been shut down
+    // still make it into the trace.
+    struct ThreadTrace {
+        static constexpr size_t Capacity = size_t(1) << 16;
+
+        explicit ThreadTrace(int index) : index(index), events(Capacity) {}
+
+        int index;
+        std::vector<TraceEvent> events;
+        // Number of events recorded, including overwritten ones
+        std::atomic<uint64_t> count{0};
+    };
+
+    static std::mutex traceMutex;
+    static std::vector<std::unique_ptr<ThreadTrace>> threadTraces;
+    static std::string traceFilename;
+    static int64_t traceStartNs;
+
+    static ThreadTrace *GetThreadTrace() {
+        thread_local ThreadTrace *trace = nullptr;
+        if (!trace) {
+            std::lock_guard<std::mutex> lock(traceMutex);
+            threadTraces.push_back(std::make_unique<ThreadTrace>(int(threadTraces.size())));
+            trace = threadTraces.back().get();
+        }
+        return trace;
+    }
+
+    void InitProfiler(const std::string &filename) {
+        {
+            std::lock_guard<std::mutex> lock(traceMutex);
+            for (std::unique_ptr<ThreadTrace> &trace : threadTraces)
+                trace->count.store(0, std::memory_order_relaxed);
+        }
+        // The calling thread gets the first timeline
+        GetThreadTrace();
+        traceFilename = filename;
+        traceStartNs = profiling::NowNs();
+        profiling::enabled = true;
+    }
+
+    void profiling::Record(const char *name, int64_t arg, int64_t startNs, int64_t endNs) {
+        ThreadTrace *trace = GetThreadTrace();
+        uint64_t n = trace->count.load(std::memory_order_relaxed);
+        trace->events[n & (ThreadTrace::Capacity - 1)] = TraceEvent{name, arg, startNs, endNs};
+        trace->count.store(n + 1, std::memory_order_release);
+    }
+
+    void WriteTrace() {
+        if (!profiling::enabled)
+            return;
+        profiling::enabled = false;
+
+        FILE *f = std::fopen(traceFilename.c_str(), "w");
+        if (!f)
+            throw std::runtime_error(traceFilename + ": " + std::strerror(errno));
+        std::fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+        std::lock_guard<std::mutex> lock(traceMutex);
+        bool first = true;
+        for (const std::unique_ptr<ThreadTrace> &trace : threadTraces) {
+            uint64_t count = trace->count.load(std::memory_order_acquire);
+            if (count == 0 && trace->index != 0)
+                continue;
+            uint64_t nDropped = count > ThreadTrace::Capacity ? count - ThreadTrace::Capacity : 0;
+
+            // Name the timeline, noting events lost to the ring buffer wrapping around
+            std::fprintf(f, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                            "\"args\": {\"name\": \"", first ? "" : ",\n", trace->index);
+            if (trace->index == 0)
+                std::fprintf(f, "main");
+            else
+                std::fprintf(f, "worker %d", trace->index);
+            if (nDropped > 0)
+                std::fprintf(f, " (%llu oldest events dropped)", (unsigned long long) nDropped);
+            std::fprintf(f, "\"}}");
+            first = false;
+
+            for (uint64_t i = nDropped; i < count; ++i) {
+                const TraceEvent &e = trace->events[i & (ThreadTrace::Capacity - 1)];
+                std::fprintf(f, ",\n{\"name\": \"%s\", \"cat\": \"jadehare\", \"ph\": \"X\", \"pid\": 1, "
+                                "\"tid\": %d, \"ts\": %.3f, \"dur\": %.3f",
+                             e.name, trace->index, (e.startNs - traceStartNs) / 1e3, (e.endNs - e.startNs) / 1e3);
+                if (e.arg >= 0)
+                    std::fprintf(f, ", \"args\": {\"arg\": %lld}", (long long) e.arg);
+                std::fprintf(f, "}");
+            }
+        }
+        std::fprintf(f, "\n]}\n");
+        bool ok = !std::ferror(f);
+        if (std::fclose(f) != 0 || !ok)
+            throw std::runtime_error(traceFilename + ": unable to write trace");
+    }
+}
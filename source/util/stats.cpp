@@ -0,0 +1,145 @@
+//
+// Created by chege on 2026/10/19.
+//
+
+#include "util/stats.h"
+
+#include <mutex>
+#include <vector>
+
+namespace jadehare {
+
+#pragma region StatsAccumulator
+
+    void StatsAccumulator::ReportIntDistribution(const char *name, int64_t sum, int64_t count, int64_t min,
+                                                 int64_t max) {
+        Distribution &d = intDistributions[name];
+        d.sum += sum;
+        d.count += count;
+        d.min = std::min(d.min, min);
+        d.max = std::max(d.max, max);
+    }
+
+    void StatsAccumulator::Clear() {
+        counters.clear();
+        memoryCounters.clear();
+        intDistributions.clear();
+        percentages.clear();
+        ratios.clear();
+    }
+
+    static void SplitTitle(const std::string &title, std::string *category, std::string *name) {
+        size_t slash = title.find('/');
+        *category = slash == std::string::npos ? std::string() : title.substr(0, slash);
+        *name = slash == std::string::npos ? title : title.substr(slash + 1);
+    }
+
+    static std::string FormatMemory(int64_t bytes) {
+        char buf[64];
+        double kb = double(bytes) / 1024;
+        if (kb < 1024)
+            snprintf(buf, sizeof(buf), "%9.2f kB", kb);
+        else if (kb < 1024 * 1024)
+            snprintf(buf, sizeof(buf), "%9.2f MiB", kb / 1024);
+        else
+            snprintf(buf, sizeof(buf), "%9.2f GiB", kb / (1024 * 1024));
+        return buf;
+    }
+
+    void StatsAccumulator::Print(FILE *dest, double seconds) const {
+        // Format every statistic, then print them sorted by category
+        std::map<std::string, std::vector<std::string>> toPrint;
+        char buf[256];
+        std::string category, name;
+
+        for (const auto &[title, value] : counters) {
+            if (value == 0)
+                continue;
+            SplitTitle(title, &category, &name);
+            if (seconds > 0)
+                snprintf(buf, sizeof(buf), "%-42s %12lld  (%.3g/s)", name.c_str(), (long long) value,
+                         value / seconds);
+            else
+                snprintf(buf, sizeof(buf), "%-42s %12lld", name.c_str(), (long long) value);
+            toPrint[category].push_back(buf);
+        }
+        for (const auto &[title, bytes] : memoryCounters) {
+            if (bytes == 0)
+                continue;
+            SplitTitle(title, &category, &name);
+            snprintf(buf, sizeof(buf), "%-42s %s", name.c_str(), FormatMemory(bytes).c_str());
+            toPrint[category].push_back(buf);
+        }
+        for (const auto &[title, d] : intDistributions) {
+            if (d.count == 0)
+                continue;
+            SplitTitle(title, &category, &name);
+            snprintf(buf, sizeof(buf), "%-42s %.3f avg [range %lld - %lld]", name.c_str(),
+                     double(d.sum) / d.count, (long long) d.min, (long long) d.max);
+            toPrint[category].push_back(buf);
+        }
+        for (const auto &[title, counts] : percentages) {
+            if (counts.second == 0)
+                continue;
+            SplitTitle(title, &category, &name);
+            snprintf(buf, sizeof(buf), "%-42s %12lld / %12lld (%.2f%%)", name.c_str(), (long long) counts.first,
+                     (long long) counts.second, 100 * double(counts.first) / counts.second);
+            toPrint[category].push_back(buf);
+        }
+        for (const auto &[title, counts] : ratios) {
+            if (counts.second == 0)
+                continue;
+            SplitTitle(title, &category, &name);
+            snprintf(buf, sizeof(buf), "%-42s %12lld / %12lld (%.2fx)", name.c_str(), (long long) counts.first,
+                     (long long) counts.second, double(counts.first) / counts.second);
+            toPrint[category].push_back(buf);
+        }
+
+        fprintf(dest, "Statistics:\n");
+        for (auto &[cat, items] : toPrint) {
+            fprintf(dest, "  %s\n", cat.c_str());
+            for (const std::string &item : items)
+                fprintf(dest, "    %s\n", item.c_str());
+        }
+    }
+
+#pragma endregion StatsAccumulator
+
+#pragma region Stats Functions
+
+    // Function-local statics, so that registration from other translation
+    // units' static initializers finds them constructed
+    static std::vector<std::function<void(StatsAccumulator &)>> &StatFuncs() {
+        static std::vector<std::function<void(StatsAccumulator &)>> funcs;
+        return funcs;
+    }
+
+    static StatsAccumulator &Accumulator() {
+        static StatsAccumulator accum;
+        return accum;
+    }
+
+    static std::mutex statsMutex;
+
+    StatRegisterer::StatRegisterer(std::function<void(StatsAccumulator &)> func) {
+        StatFuncs().push_back(std::move(func));
+    }
+
+    void ReportThreadStats() {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        for (const std::function<void(StatsAccumulator &)> &func : StatFuncs())
+            func(Accumulator());
+    }
+
+    void PrintStats(FILE *dest, double seconds) {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        Accumulator().Print(dest, seconds);
+    }
+
+    void ClearStats() {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        Accumulator().Clear();
+    }
+
+#pragma endregion Stats Functions
+}